@@ -0,0 +1,45 @@
+#!/bin/sh
+# Fuzzing en el host de la ingesta NMEA del collar (TinyGPS++ → GpsInfo → payload).
+#
+# Uso:
+#   ./run_fuzz.sh nmea [segundos]   libFuzzer (clang), 60 s por defecto
+#   ./run_fuzz.sh replay nmea       reproduce el corpus con g++ (sin libFuzzer)
+#
+# TinyGPS++ se toma de las dependencias de PlatformIO (`pio pkg install -e rpipico`)
+# o de TINYGPS_DIR. Los casos nuevos se guardan en work/nmea; los fallos y entradas
+# lentas en artifacts/. Para sembrar con capturas reales basta con copiar volcados
+# del UART del receptor en corpus/nmea.
+#
+# FUZZ_SLOW_SCALE=<factor> relaja el presupuesto de tiempo por entrada.
+
+set -e
+cd "$(dirname "$0")"
+
+TINYGPS_DIR=${TINYGPS_DIR:-../.pio/libdeps/rpipico/TinyGPSPlus/src}
+MODE=$1
+TARGET=$2
+if [ "$MODE" != "replay" ]; then
+  TARGET=$1
+  SECONDS_MAX=${2:-60}
+fi
+
+case "$TARGET" in
+  nmea) SRCS="fuzz_nmea.cpp ../../lib/payload_codec/payload_codec.cpp $TINYGPS_DIR/TinyGPS++.cpp"; DICT="-dict=nmea.dict" ;;
+  *) echo "objetivo desconocido: '$TARGET' (nmea)"; exit 1 ;;
+esac
+
+CXXFLAGS="-std=gnu++17 -g -I../include -I../../lib/payload_codec -I$TINYGPS_DIR -Ihost"
+mkdir -p build "work/$TARGET" artifacts
+
+if [ "$MODE" = "replay" ]; then
+  ${CXX:-g++} $CXXFLAGS -O2 -DFUZZ_STANDALONE -fsanitize=address,undefined \
+    -o "build/replay_$TARGET" $SRCS
+  "./build/replay_$TARGET" "corpus/$TARGET" "work/$TARGET" -random=20000
+  exit 0
+fi
+
+${CXX:-clang++} $CXXFLAGS -O1 -fsanitize=fuzzer,address,undefined \
+  -o "build/fuzz_$TARGET" $SRCS
+"./build/fuzz_$TARGET" "work/$TARGET" "corpus/$TARGET" $DICT \
+  -max_total_time="$SECONDS_MAX" -timeout=2 -report_slow_units=1 \
+  -print_final_stats=1 -artifact_prefix=artifacts/
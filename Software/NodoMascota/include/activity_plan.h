@@ -0,0 +1,131 @@
+/** @file activity_plan.h
+ * @brief Horario de envíos aprendido: actividad de la mascota por hora del día.
+ *
+ * El collar aprende de sus propios fixes qué horas UTC del día suelen ser de
+ * actividad y planifica para cada una el periodo de envío y si el receptor
+ * GNSS puede dormir entre envíos:
+ * - Muestras: desplazamiento entre un fix ancla y el primero que llega al
+ *   menos ACT_SLOT_S después (con el GNSS dormido, de un envío al siguiente).
+ *   Hay movimiento si supera ACT_MOVE_M. Con huecos de más de ACT_SLOT_MAX_S
+ *   no se cuenta nada y se reancla.
+ * - Al cerrar cada hora, su fracción de muestras con movimiento entra en una
+ *   media exponencial por hora (ACT_LEARN_ALPHA: cada día pesa un 25 %).
+ * - Plan de una hora con al menos ACT_MIN_DAYS días aprendidos:
+ *   - ≥ ACT_BUSY_FRAC: periodo normal y GNSS encendido.
+ *   - ≥ ACT_CALM_FRAC: ACT_CALM_PERIOD_S con GNSS encendido.
+ *   - Menos: ACT_REST_PERIOD_S y el GNSS duerme hasta ACT_GNSS_LEAD_S antes del
+ *     siguiente envío (arranque en caliente).
+ *   Nunca se envía más a menudo que el periodo normal.
+ * - Movimiento inesperado: una muestra con movimiento en una hora planificada
+ *   como tranquila devuelve el periodo normal (y el GNSS encendido) durante
+ *   ACT_BOOST_S, que se prolonga mientras siga moviéndose.
+ *
+ * Con el GNSS dormido las muestras abarcan todo el periodo, así que una hora
+ * tranquila parece algo más activa de lo que es: el error va hacia enviar más.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t  ACT_HOURS            = 24;
+static const uint16_t ACT_SLOT_S           = 60;
+static const uint16_t ACT_SLOT_MAX_S       = 900;
+static const float    ACT_MOVE_M           = 30.0f;
+/** Muestras mínimas para aprender una hora (con ACT_REST_PERIOD_S hay 12 por hora). */
+static const uint8_t  ACT_MIN_SAMPLES      = 6;
+static const float    ACT_LEARN_ALPHA      = 0.25f;
+static const uint8_t  ACT_MIN_DAYS         = 3;
+static const float    ACT_BUSY_FRAC        = 0.10f;
+static const float    ACT_CALM_FRAC        = 0.02f;
+static const uint16_t ACT_CALM_PERIOD_S    = 60;    ///< Divisor de 3600.
+static const uint16_t ACT_REST_PERIOD_S    = 300;   ///< Divisor de 3600.
+static const uint16_t ACT_BOOST_S          = 900;
+static const uint16_t ACT_GNSS_LEAD_S      = 20;
+static const uint16_t ACT_GNSS_MIN_SLEEP_S = 60;
+
+/** Bits devueltos por ACT_observe(). */
+static const uint8_t ACT_EV_HOUR   = 0x01;   ///< Se ha aprendido una hora (guardar el perfil).
+static const uint8_t ACT_EV_MOTION = 0x02;   ///< Movimiento inesperado: empieza el refuerzo.
+
+/**
+ * \brief Perfil aprendido (se persiste tal cual).
+ */
+struct ActProfile {
+  uint32_t magic;
+  uint8_t  activity[ACT_HOURS];   ///< Fracción de muestras con movimiento ·255.
+  uint8_t  days[ACT_HOURS];       ///< Días aprendidos por hora (satura en 255).
+};
+
+/**
+ * \brief Plan de una hora.
+ */
+struct ActHourPlan {
+  uint16_t periodS;     ///< Segundos entre envíos.
+  bool     gnssSleep;   ///< El receptor puede dormir entre envíos.
+};
+
+/**
+ * \brief Perfil vacío: todas las horas con el periodo normal hasta aprenderlas.
+ */
+void ACT_begin();
+
+/**
+ * \brief Restaura un perfil guardado.
+ * \return false (y perfil vacío) si la longitud o la firma no cuadran.
+ */
+bool ACT_load(const uint8_t* data, size_t len);
+
+/**
+ * \brief Perfil actual (para guardarlo o mostrarlo).
+ */
+const ActProfile& ACT_profile();
+
+/**
+ * \brief Añade un fix válido.
+ * \param sod Segundos del día UTC.
+ * \return Combinación de ACT_EV_HOUR y ACT_EV_MOTION (0 si nada).
+ */
+uint8_t ACT_observe(uint32_t sod, double lat, double lon);
+
+/**
+ * \brief Plan aprendido para la hora \p hour con periodo normal \p basePeriodS (sin refuerzo).
+ */
+ActHourPlan ACT_plan(uint8_t hour, uint16_t basePeriodS);
+
+/**
+ * \brief true si en \p sod sigue el refuerzo por movimiento inesperado.
+ */
+bool ACT_isBoosted(uint32_t sod);
+
+/**
+ * \brief Periodo a usar en \p sod: el del plan de su hora, o el normal con refuerzo.
+ */
+uint16_t ACT_periodS(uint32_t sod, uint16_t basePeriodS);
+
+/**
+ * \brief Segundos que puede dormir el GNSS tras un envío en \p sod.
+ * \details Hasta ACT_GNSS_LEAD_S antes del siguiente envío o del comienzo de la
+ *          hora siguiente (su plan puede ser otro).
+ * \return 0 si la hora no lo permite, hay refuerzo o quedaría menos de ACT_GNSS_MIN_SLEEP_S.
+ */
+uint32_t ACT_gnssSleepS(uint32_t sod, uint16_t basePeriodS);
+
+/**
+ * \brief Mensaje que duerme el receptor \p ms (UBX-RXM-PMREQ en backup que
+ *        despierta solo o por su UART o, con `-DAID_PROTOCOL_MTK`, PMTK161 en standby).
+ * \return Longitud escrita (0 si no cabe).
+ */
+size_t ACT_buildGnssSleepMsg(uint32_t ms, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Mensaje que lo despierta antes de tiempo (o, en MTK, al acabar: el
+ *        standby no tiene duración): PMTK000 o bytes 0xFF para el u-blox.
+ * \return Longitud escrita (0 si no cabe).
+ */
+size_t ACT_buildGnssWakeMsg(uint8_t* out, size_t outSize);
@@ -6,7 +6,10 @@
  * - Actualizar el parser NMEA.
  * - Comprobar disponibilidad de fix.
  * - Obtener la estampa actual.
- * - Empaquetar y desempaquetar el payload binario (13 B) para LoRa.
+ * - Empaquetar y desempaquetar el payload binario (13 B) para LoRa (ver payload_codec.h).
+ * - Inyectar la asistencia recibida de la base y medir el tiempo hasta el fix
+ *   (TTFF) y la energía por adquisición, con y sin asistencia.
+ * - Resumir TTFF y ocupación del UART para la trama de salud (health_monitor).
  *
  * @note Precisión típica con escala lat/lon·1e5 ≈ 1 m.
  *
@@ -17,21 +20,8 @@
 #pragma once
 #include <Arduino.h>
 #include <TinyGPSPlus.h>
-
-/**
- * \brief Estructura estandarizada para intercambiar datos GNSS.
- *
- * Campos mínimos para el caso de uso.
- *  - lat, lon en grados decimales (WGS84).
- *  - hhmmss UTC (6 dígitos empaquetados en uint32_t).
- *  - valid indica que lat/lon y hora son válidos y recientes.
- */
-struct GpsInfo {
-  double   lat;      ///< Latitud (grados decimales, WGS84).
-  double   lon;      ///< Longitud (grados decimales, WGS84).
-  uint32_t hhmmss;   ///< Hora UTC en formato HHMMSS (p.ej., 211507 = 21:15:07).
-  bool     valid;    ///< true si posición y hora son válidas (ver GPS_hasFix()).
-};
+#include "payload_codec.h"
+#include "gnss_aiding.h"
 
 /**
  * \brief Inicializa el enlace serie con el receptor GNSS.
@@ -63,13 +53,53 @@ bool GPS_hasFix();
 GpsInfo GPS_getInfo();
 
 /**
- * \brief Construye payload binario de 13B (1B=fix, 4B=HHMMSS, 4B=lat*1e5, 4B=lon*1e5).
- * \return Devuelve 13 si OK, 0 si no hay fix o buffer insuficiente.
+ * \brief Inyecta en el receptor la hora y la posición aproximada recibidas de la base.
+ * \param aid   Datos de asistencia.
+ * \param ageMs Tiempo desde que la base selló la hora (aire de la trama + espera).
+ * \return false si ya hay fix (no hace falta) o el receptor no está en adquisición.
+ * \note El formato (UBX o PMTK) se elige en gnss_aiding.h.
+ */
+bool GPS_applyAiding(const AidData& aid, uint32_t ageMs);
+
+/**
+ * \brief Sigue la adquisición en curso: al primer fix registra el TTFF y la
+ *        energía estimada (métricas `gps_ttff_*_seconds` y `gps_acq_energy_mj_total`).
+ * \details Una pérdida del fix de más de 10 s abre una adquisición nueva.
+ *          Llamar desde loop() tras GPS_update().
+ */
+void GPS_acqTick();
+
+/**
+ * \brief Distribución del TTFF (media, p50, p90) y energía media por fix, con y sin asistencia.
+ */
+void GPS_acqReport(Stream& port);
+
+/**
+ * \brief Último TTFF y p90 de las últimas adquisiciones (con y sin asistencia juntas).
+ * \param lastMs (salida) Último TTFF en ms (0 si aún no hay fix).
+ * \param p90Ms  (salida) Percentil 90 en ms (0 si aún no hay fix).
+ */
+void GPS_ttffSummary(uint32_t& lastMs, uint32_t& p90Ms);
+
+/**
+ * \brief Duerme el receptor \p ms (horas tranquilas del horario aprendido, activity_plan.h).
+ * \details Mientras duerme, GPS_hasFix() devuelve false y no se abre ninguna
+ *          adquisición; el arranque en caliente al despertar no entra en el TTFF.
+ */
+void GPS_sleep(uint32_t ms);
+
+/**
+ * \brief Despierta el receptor (llamar al vencer el plazo de GPS_sleep() o antes).
+ */
+void GPS_wake();
+
+/**
+ * \brief true entre GPS_sleep() y GPS_wake().
  */
-size_t GPS_buildBinaryPayload(const GpsInfo& info, uint8_t* out, size_t outSize);
+bool GPS_isAsleep();
 
 /**
- * \brief Decodifica un payload de 13B a GpsInfo.
- * \return  Devuelve true si OK.
+ * \brief Máximo de bytes pendientes en el UART del GNSS observado en GPS_update().
+ * \details Cerca del tamaño del FIFO indica que loop() tarda demasiado en vaciarlo.
  */
-bool GPS_parsePayload(const uint8_t* in, size_t len, GpsInfo& out);
+uint32_t GPS_rxHighWater();
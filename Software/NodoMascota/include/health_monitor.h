@@ -0,0 +1,80 @@
+/** @file health_monitor.h
+ * @brief Estado interno del collar y planificación de la trama de salud.
+ *
+ * Reúne los datos de diagnóstico que se envían en la trama de salud
+ * (health_frame.h):
+ * - Causa del reinicio y contador de arranques (persistente en LittleFS).
+ * - Duración máxima de loop() y mínimo de heap libre.
+ * - Fallos de transmisión (estado de LoRa al terminar cada TX).
+ * - Temperatura del die del RP2040 y márgenes del UART del GNSS y del TTFF
+ *   (gps_handler).
+ *
+ * La trama sale justo después de una posición transmitida con éxito, siempre que
+ * haya pasado el intervalo mínimo calculado con HLT_minIntervalS() para la
+ * modulación de ese momento (MON_setAirtime()). Así ocupa el
+ * hueco que la base ya reserva tras cada posición y no queda en el aire cuando
+ * llegan comandos.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "health_frame.h"
+
+/**
+ * \brief Determina la causa del reinicio y actualiza el contador de arranques.
+ * \param fsOk true si LittleFS está montado (TRACK_begin()); sin él el contador no persiste.
+ */
+void MON_begin(bool fsOk);
+
+/**
+ * \brief Marca el inicio del trabajo de loop() (tras despertar de WFI).
+ */
+void MON_loopStart();
+
+/**
+ * \brief Marca el fin del trabajo de loop() (antes de WFI) y actualiza los máximos.
+ */
+void MON_loopEnd();
+
+/**
+ * \brief Registra el resultado de una transmisión (fin de TX o fallo al iniciarla).
+ * \param state Código RadioLib (\c RADIOLIB_ERR_NONE si fue bien).
+ */
+void MON_noteTx(int state);
+
+/**
+ * \brief true si ya se puede enviar otra trama de salud sin salir del presupuesto.
+ * \details La primera trama tras el arranque no espera (lleva la causa del reinicio).
+ */
+bool MON_isDue();
+
+/**
+ * \brief Construye la trama con el estado actual y reinicia los máximos por intervalo.
+ * \return HLT_FRAME_LEN o 0 si el buffer no basta.
+ */
+size_t MON_buildFrame(uint8_t* out, size_t outSize);
+
+/**
+ * \brief Anota que la trama se ha enviado (abre el siguiente intervalo).
+ */
+void MON_markSent();
+
+/**
+ * \brief Intervalo mínimo entre tramas de salud (s).
+ */
+uint32_t MON_intervalS();
+
+/**
+ * \brief Recalcula el intervalo con el aire de la trama de salud (\p airtimeMs)
+ *        con la modulación activa. Llamar en cada cambio de BW, SF o data rate.
+ * \details Hasta la primera llamada se supone SF9/125 kHz.
+ */
+void MON_setAirtime(float airtimeMs);
+
+/**
+ * \brief Volcado legible del estado actual (comando USB `HEALTH`).
+ */
+void MON_report(Stream& port);
@@ -0,0 +1,88 @@
+/** @file hot_path.h
+ * @brief Ubicación en SRAM de la ruta crítica y perfilado ligero por ciclos.
+ *
+ * El RP2040 ejecuta desde la flash QSPI a través de la caché XIP (16 kB). Un fallo
+ * de caché en la ISR de la radio o en el bucle de lectura GNSS añade latencia
+ * variable. Este fichero ofrece:
+ * - `HOT_FUNC(nombre)`: con `-DHOT_IN_RAM` coloca la función en SRAM
+ *   (`__not_in_flash_func`); sin el flag no tiene efecto.
+ * - `HOT_PROF_SCOPE(slot)`: con `-DHOT_PROFILE` mide ciclos por llamada de un
+ *   ámbito (nº de llamadas, total y máximo); sin el flag no genera código.
+ * - `HOT_loopMark()`: mide el periodo de `loop()` (jitter del bucle).
+ *
+ * Entornos de PlatformIO: `rpipico` (flash), `rpipico_prof` (flash + perfil),
+ * `rpipico_ram` (SRAM) y `rpipico_ram_prof` (SRAM + perfil).
+ *
+ * @note Las funciones de librerías (TinyGPS++ y RadioLib) siguen en flash.
+ *       En compilación nativa (tests en el host) todas las macros quedan vacías.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#if defined(ARDUINO)
+  #include <Arduino.h>
+#else
+  #undef HOT_IN_RAM
+  #undef HOT_PROFILE
+#endif
+
+#if defined(HOT_IN_RAM)
+  #define HOT_FUNC(name) __not_in_flash_func(name)
+#else
+  #define HOT_FUNC(name) name
+#endif
+
+/**
+ * \brief Ámbitos medidos por el perfilador.
+ */
+enum HotSlot : uint8_t {
+  HOT_SLOT_LOOP = 0,     ///< Periodo entre llamadas a loop() (jitter).
+  HOT_SLOT_GPS_UPDATE,   ///< GPS_update(): vaciado del UART y parser NMEA.
+  HOT_SLOT_CODEC,        ///< GPS_buildBinaryPayload().
+  HOT_SLOT_LORA_ISR,     ///< ISR de fin de TX (DIO1).
+  HOT_SLOT_ISR_SERVICE,  ///< Latencia ISR → atención en loop().
+  HOT_SLOT_COUNT
+};
+
+#if defined(HOT_PROFILE)
+
+/**
+ * \brief Acumula una muestra de ciclos en el slot indicado.
+ */
+void HOT_record(HotSlot slot, uint32_t cycles);
+
+/**
+ * \brief Registra la entrada en loop() y acumula el periodo desde la anterior.
+ */
+void HOT_loopMark();
+
+/**
+ * \brief Vuelca la tabla de perfilado (llamadas, ciclos medios y máximos).
+ * \param reset Si es true, pone a cero los contadores tras el volcado.
+ */
+void HOT_report(Stream& port, bool reset);
+
+/**
+ * \brief Mide los ciclos transcurridos entre su construcción y su destrucción.
+ */
+struct HotScope {
+  HotSlot  slot;
+  uint32_t t0;
+  explicit HotScope(HotSlot s) : slot(s), t0(rp2040.getCycleCount()) {}
+  ~HotScope() { HOT_record(slot, rp2040.getCycleCount() - t0); }
+};
+
+  #define HOT_PROF_SCOPE(slot) HotScope _hotScope(slot)
+  #define HOT_CYCLES()         rp2040.getCycleCount()
+#else
+  #define HOT_PROF_SCOPE(slot) do {} while (0)
+  #define HOT_CYCLES()         0u
+  inline void HOT_record(HotSlot, uint32_t) {}
+  inline void HOT_loopMark() {}
+  #if defined(ARDUINO)
+  inline void HOT_report(Stream&, bool) {}
+  #endif
+#endif
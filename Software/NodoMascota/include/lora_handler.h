@@ -6,6 +6,13 @@
  * - `LORA_startTx(buf,len)`: inicio de transmisión asíncrona.
  * - `LORA_isTxDone()/LORA_lastState()`: consulta del estado de TX.
  * - `LORA_finishTx()`: cierre explícito de la transmisión.
+ * - `LORA_startSniff()/LORA_pollDownlink()`: escucha duty-cycle entre envíos y
+ *   recepción de comandos (ver wake_radio.h), asistencia GNSS (gnss_aiding.h)
+ *   y la valla de casa (geofence.h) de la base.
+ * - `LORA_adjustFrequency()/LORA_setUplinkBandwidth()`: corrección del error de
+ *   frecuencia medido por la base y subidas a 62,5 kHz (la escucha sigue a 125 kHz).
+ *
+ * - `LORA_radio()`: acceso al SX1262 para la pila LoRaWAN (lorawan_link.h).
  *
  * @warning Comprobar límites de duty-cycle según ETSI EN 300 220 (EU 868 MHz).
  *
@@ -16,6 +23,14 @@
 #pragma once
 #include <Arduino.h>
 #include <RadioLib.h>
+#include "wake_radio.h"
+#include "gnss_aiding.h"
+#include "geofence.h"
+
+/** Ancho de banda de LORA_begin(), de la escucha y de las subidas por defecto (kHz). */
+static const float   LORA_BW_KHZ          = 125.0f;
+/** Corrección de frecuencia acumulada máxima (±20 ppm de cada cristal a 868 MHz). */
+static const int32_t LORA_FREQ_CORR_MAX_HZ = 35000;
 
 /**
  * \brief Inicializa el SX1262 con parámetros LoRa por defecto.
@@ -49,3 +64,78 @@ int  LORA_lastState();
  * \details Útil como secuencia de limpieza si abortas o cambias de modo.
  */
 void LORA_finishTx();
+
+/**
+ * \brief Deja la radio en escucha duty-cycle (RX \c rxUs / sleep \c sleepUs) con el ajuste actual.
+ * \details LORA_startTx() sale de la escucha; hay que volver a llamarla tras LORA_finishTx().
+ * \return true si la radio aceptó el modo.
+ */
+bool LORA_startSniff();
+
+/**
+ * \brief Selecciona el ajuste de escucha (índice en la tabla de wake_radio).
+ * \return false si el índice no existe.
+ */
+bool LORA_setSniffPreset(uint8_t index);
+
+/**
+ * \brief Índice del ajuste de escucha actual.
+ */
+uint8_t LORA_sniffPreset();
+
+/**
+ * \brief Desplaza la portadora \p hz respecto a la corrección actual (WOR_CMD_FREQ_CORR).
+ * \details Afecta a subidas y escucha; si se estaba escuchando, la reinicia. La
+ *          resolución real es la del float de RadioLib (~61 Hz a 868 MHz).
+ * \return false si el total superaría ±LORA_FREQ_CORR_MAX_HZ o la radio lo rechaza.
+ */
+bool LORA_adjustFrequency(int16_t hz);
+
+/**
+ * \brief Corrección de frecuencia acumulada (Hz).
+ */
+int32_t LORA_freqCorrectionHz();
+
+/**
+ * \brief Ancho de banda de las subidas: LORA_BW_KHZ o WOR_NARROW_BW_KHZ (WOR_CMD_SET_UL_BW).
+ * \details Se aplica, con su SF (WOR_uplinkSF()), en la siguiente LORA_startTx();
+ *          la escucha usa siempre SF9/LORA_BW_KHZ.
+ * \return false si el valor no es uno de los dos admitidos.
+ */
+bool LORA_setUplinkBandwidth(float kHz);
+
+/**
+ * \brief Ancho de banda de las subidas (kHz).
+ */
+float LORA_uplinkBandwidth();
+
+/**
+ * \brief Tiempo en el aire (ms) de una subida de \p len bytes con la modulación
+ *        actual de las subidas y \p preambleSymbols de preámbulo.
+ */
+float LORA_uplinkAirtimeMs(size_t len, uint16_t preambleSymbols);
+
+/**
+ * \brief Tipo de paquete de bajada atendido por LORA_pollDownlink().
+ */
+enum LoraDownlink : uint8_t {
+  LORA_DL_NONE = 0,   ///< Nada pendiente, repetido o no válido.
+  LORA_DL_COMMAND,    ///< Comando nuevo en \p cmd.
+  LORA_DL_AIDING,     ///< Asistencia GNSS en \p aid.
+  LORA_DL_FENCE       ///< Valla de casa en \p fence.
+};
+
+/**
+ * \brief Atiende un paquete recibido durante la escucha.
+ * \param cmd Comando decodificado (sólo con LORA_DL_COMMAND).
+ * \param aid Datos de asistencia GNSS (sólo con LORA_DL_AIDING).
+ * \param fence Valla decodificada (sólo con LORA_DL_FENCE).
+ */
+LoraDownlink LORA_pollDownlink(WorCommand& cmd, AidData& aid, GeoFence& fence);
+
+/**
+ * \brief Instancia del SX1262 (inicializada por LORA_begin()).
+ * \details En el modo LoRaWAN la usa `LoRaWANNode`, que reconfigura modulación y
+ *          sync word; a partir de entonces no deben usarse LORA_startTx() ni LORA_startSniff().
+ */
+SX1262& LORA_radio();
@@ -0,0 +1,114 @@
+/** @file lorawan_link.h
+ * @brief Modo LoRaWAN clase A del collar (build con `-DLORAWAN_MODE`, entorno `rpipico_lorawan`).
+ *
+ * Sustituye el protocolo LoRa privado (sync word 0x12, base única) por subidas
+ * LoRaWAN que recibe cualquier gateway de la red. La pila MAC (join, cifrado,
+ * contadores de trama, ADR, duty-cycle) es `LoRaWANNode` de RadioLib sobre el
+ * mismo SX1262; las reglas propias del collar están en lorawan_policy.h.
+ *
+ * Activación (flags de compilación; las claves en hexadecimal, MSB primero,
+ * tal y como las muestra la consola del servidor de red):
+ * - OTAA (por defecto): `LW_JOIN_EUI`, `LW_DEV_EUI` (enteros de 64 bits),
+ *   `LW_APP_KEY` y, en LoRaWAN 1.1, `LW_NWK_KEY`.
+ * - ABP (`-DLW_ABP`): `LW_DEV_ADDR`, `LW_NWK_SKEY`, `LW_APP_SKEY` (LoRaWAN 1.0.x).
+ *
+ * Los nonces del join y la sesión (DevAddr, claves de sesión, FCntUp/FCntDown y
+ * estado del ADR) se guardan en LittleFS tras cada intento y cada subida: un
+ * reinicio no reutiliza DevNonce ni contadores, que el servidor rechazaría.
+ *
+ * Clase A: tras cada subida se abren las ventanas RX1/RX2 y se atienden las
+ * bajadas de aplicación (comandos y asistencia GNSS, mismos formatos que en el
+ * modo privado). No hay escucha wake-on-radio entre envíos.
+ *
+ * @warning LW_tick() y LW_send() bloquean mientras duran la transmisión y las
+ *          ventanas de recepción (hasta ~4 s con DR0 y ~7 s en un join). El UART
+ *          del GNSS se amplía en este modo para no perder NMEA (gps_handler.cpp).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "lorawan_policy.h"
+
+// ----------------- Credenciales (flags de compilación) -----------------
+#ifndef LW_JOIN_EUI
+  #define LW_JOIN_EUI 0x0000000000000000ULL
+#endif
+#ifndef LW_DEV_EUI
+  #define LW_DEV_EUI  0x0000000000000000ULL
+#endif
+#ifndef LW_APP_KEY
+  #define LW_APP_KEY  "00000000000000000000000000000000"
+#endif
+/** LoRaWAN 1.0.x: la NwkKey coincide con la AppKey. */
+#ifndef LW_NWK_KEY
+  #define LW_NWK_KEY  LW_APP_KEY
+#endif
+#ifndef LW_DEV_ADDR
+  #define LW_DEV_ADDR 0x00000000UL
+#endif
+#ifndef LW_NWK_SKEY
+  #define LW_NWK_SKEY "00000000000000000000000000000000"
+#endif
+#ifndef LW_APP_SKEY
+  #define LW_APP_SKEY "00000000000000000000000000000000"
+#endif
+
+/**
+ * \brief Prepara el nodo LoRaWAN sobre la radio ya inicializada (LORA_begin()).
+ * \details Restaura los nonces y la sesión guardados; con ABP o una sesión OTAA
+ *          restaurada queda activo sin transmitir.
+ * \param fsOk true si LittleFS está montado (sin él la sesión no persiste).
+ * \return false si las claves no son válidas o RadioLib rechaza la configuración.
+ */
+bool LW_begin(bool fsOk);
+
+/**
+ * \brief Intenta el join OTAA si no hay sesión y ya ha pasado la espera del duty-cycle.
+ * \details Bloquea durante el intento. Llamar desde loop().
+ */
+void LW_tick();
+
+/**
+ * \brief true si hay sesión activa (join aceptado, restaurada o ABP).
+ */
+bool LW_isJoined();
+
+/**
+ * \brief Envía una subida sin confirmación y atiende las ventanas RX1/RX2.
+ * \param port Puerto de aplicación (LWP_PORT_POSITION o LWP_PORT_HEALTH).
+ * \param cmd  Comando recibido (sólo con LWP_DL_COMMAND).
+ * \param aid  Asistencia GNSS recibida (sólo con LWP_DL_AIDING).
+ * \return Tipo de bajada recibida; LWP_DL_NONE también si la subida falla
+ *         (ver LW_lastState()).
+ */
+LwpDownlink LW_send(uint8_t port, const uint8_t* data, size_t len, WorCommand& cmd, AidData& aid);
+
+/**
+ * \brief Último código de RadioLib (≥0 si la última subida fue bien).
+ */
+int LW_lastState();
+
+/**
+ * \brief Milisegundos hasta que el duty-cycle permite otra subida (0 = ya).
+ */
+uint32_t LW_timeUntilUplinkMs();
+
+/**
+ * \brief Periodo de envío (divisor de 86400) para una subida de \p len bytes con
+ *        el data rate actual, sin bajar de \p wantedS (ver LWP_periodS()).
+ */
+uint16_t LW_periodS(uint16_t wantedS, size_t len);
+
+/**
+ * \brief Tiempo en el aire (ms) de una subida de \p len bytes de aplicación con
+ *        el data rate actual.
+ */
+float LW_airtimeMs(size_t len);
+
+/**
+ * \brief Estado de la sesión (comando USB `LORAWAN`).
+ */
+void LW_report(Stream& port);
@@ -0,0 +1,84 @@
+/** @file lorawan_policy.h
+ * @brief Reglas del modo LoRaWAN clase A que no dependen de la radio.
+ *
+ * En el modo LoRaWAN (`-DLORAWAN_MODE`, ver lorawan_link.h) la pila MAC es la de
+ * RadioLib (`LoRaWANNode`). Este módulo reúne lo que decide el collar alrededor
+ * de ella:
+ * - Tiempo en el aire por data rate de EU868 (DR0..DR5 = SF12..SF7, 125 kHz).
+ * - Periodo de envío compatible con tx_scheduler (divisor de 86400) que respeta
+ *   el duty-cycle con el data rate que haya fijado el ADR.
+ * - Espera entre intentos de join (LoRaWAN 1.0.4 §7: 1 % la primera hora,
+ *   0,1 % las 10 siguientes y 0,01 % después).
+ * - Claves en hexadecimal desde los flags de compilación.
+ * - Puertos de aplicación y clasificación de las bajadas (comandos y asistencia
+ *   GNSS reutilizan las tramas de wake_radio.h y gnss_aiding.h).
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "wake_radio.h"
+#include "gnss_aiding.h"
+
+// ----------------- Puertos de aplicación (FPort) -----------------
+static const uint8_t LWP_PORT_POSITION = 1;    ///< Subida: payload de posición (13 B).
+static const uint8_t LWP_PORT_HEALTH   = 2;    ///< Subida: trama de salud (health_frame.h).
+static const uint8_t LWP_PORT_COMMAND  = 10;   ///< Bajada: comando (wake_radio.h).
+static const uint8_t LWP_PORT_AIDING   = 11;   ///< Bajada: asistencia GNSS (gnss_aiding.h).
+
+/** Cabecera MAC + FHDR (sin FOpts) + FPort + MIC de una trama de datos. */
+static const size_t LWP_FRAME_OVERHEAD   = 13;
+/** PHYPayload de un Join-request. */
+static const size_t LWP_JOIN_REQUEST_LEN = 23;
+/** Data rates de EU868 con BW 125 kHz. */
+static const uint8_t LWP_DR_MAX = 5;
+
+/**
+ * \brief Tipo de bajada de aplicación.
+ */
+enum LwpDownlink : uint8_t {
+  LWP_DL_NONE = 0,   ///< Sin datos, puerto desconocido o trama no válida.
+  LWP_DL_COMMAND,    ///< Comando en \p cmd.
+  LWP_DL_AIDING      ///< Asistencia GNSS en \p aid.
+};
+
+/**
+ * \brief Tiempo en el aire (ms) de un PHYPayload de \p phyLen bytes con el data rate \p dr.
+ * \details CR 4/5, preámbulo de 8 símbolos, cabecera explícita y CRC; optimización
+ *          de baja tasa en SF11/SF12. Un \p dr mayor que LWP_DR_MAX se trata como DR5.
+ */
+float LWP_airtimeMs(uint8_t dr, size_t phyLen);
+
+/**
+ * \brief Periodo de envío que respeta el duty-cycle.
+ * \param airtimeMs    Aire de cada subida (ms).
+ * \param wantedS      Periodo pedido (s).
+ * \param dutyFraction Duty-cycle de la sub-banda (0.01 = 1 %).
+ * \return El menor divisor de 86400 que no baja de \p wantedS ni del mínimo
+ *         del duty-cycle (como mucho 43200 s).
+ */
+uint16_t LWP_periodS(float airtimeMs, uint16_t wantedS, float dutyFraction);
+
+/**
+ * \brief Espera mínima (ms) tras un Join-request sin respuesta.
+ * \param sinceBootMs   Tiempo desde el primer intento (define el tramo del duty-cycle).
+ * \param joinAirtimeMs Aire del Join-request enviado.
+ */
+uint32_t LWP_joinDelayMs(uint32_t sinceBootMs, float joinAirtimeMs);
+
+/**
+ * \brief Convierte una cadena hexadecimal (sin separadores) en \p outLen bytes.
+ * \return false si la longitud no es 2·outLen o hay caracteres no hexadecimales.
+ */
+bool LWP_parseHex(const char* hex, uint8_t* out, size_t outLen);
+
+/**
+ * \brief Clasifica una bajada de aplicación según su puerto y su contenido.
+ */
+LwpDownlink LWP_parseDownlink(uint8_t port, const uint8_t* buf, size_t len,
+                              WorCommand& cmd, AidData& aid);
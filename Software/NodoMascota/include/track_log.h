@@ -0,0 +1,78 @@
+/** @file track_log.h
+ * @brief Declaraciones del registro local de trayectoria (flash) del nodo de la mascota.
+ *
+ * El enlace LoRa sólo transporta una posición por periodo, pero el receptor GNSS
+ * entrega un fix por segundo. Este módulo guarda todos los fixes en un fichero
+ * de LittleFS con codificación compacta y escritura por páginas completas:
+ * - Registro clave (13 B): el mismo formato que el payload LoRa (`fix=1`).
+ * - Registro delta (≥3 B): `[0x80|dt][zigzag-varint dlat][zigzag-varint dlon]`.
+ * - Relleno `0xFF` hasta el final de cada página de 256 B (valor de flash borrada).
+ *
+ * Cada página comienza con un registro clave, por lo que puede decodificarse de
+ * forma independiente. El log se exporta por el puerto USB (CDC) con el comando
+ * `DUMP` (ver TRACK_handleCommand()).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "gps_handler.h"
+
+/**
+ * \brief Contadores del registro de trayectoria (para estimar coste energético).
+ */
+struct TrackStats {
+  uint32_t records;     ///< Registros añadidos desde el arranque.
+  uint32_t keyRecords;  ///< De ellos, registros clave (13 B).
+  uint32_t fileBytes;   ///< Bytes almacenados en flash (páginas completas).
+  uint32_t pageBytes;   ///< Bytes pendientes en la página en RAM.
+  uint32_t pageWrites;  ///< Páginas escritas en flash desde el arranque.
+  uint32_t writeUs;     ///< Tiempo acumulado en escrituras a flash (µs).
+  uint32_t dropped;     ///< Registros descartados por log lleno o error de FS.
+};
+
+/**
+ * \brief Monta LittleFS y prepara el fichero de trayectoria.
+ * \return true si el sistema de ficheros está disponible.
+ * \note Debe llamarse una vez en setup().
+ */
+bool TRACK_begin();
+
+/**
+ * \brief Añade un fix al log (en RAM; se escribe al completar la página).
+ * \param info Estampa GNSS; se ignora si \c valid es false.
+ * \return true si el registro quedó almacenado.
+ */
+bool TRACK_append(const GpsInfo& info);
+
+/**
+ * \brief Fuerza la escritura de la página en curso (rellenando con 0xFF).
+ * \return true si no había nada pendiente o la escritura fue correcta.
+ * \warning Cada llamada consume una página completa de flash.
+ */
+bool TRACK_flush();
+
+/**
+ * \brief Borra el log completo (fichero y página en RAM).
+ */
+void TRACK_erase();
+
+/**
+ * \brief Devuelve los contadores del log.
+ */
+TrackStats TRACK_getStats();
+
+/**
+ * \brief Atiende un comando de consola USB relacionado con el log.
+ * \param cmd  Línea recibida (sin fin de línea).
+ * \param port Puerto por el que se responde (normalmente \c Serial).
+ * \return true si el comando pertenece a este módulo.
+ *
+ * Comandos:
+ * - `TRACK?`: contadores del log.
+ * - `DUMP`  : cabecera `TRACK <n>\n`, n bytes binarios y `OK <ms> ms` al final.
+ * - `ERASE` : borra el log.
+ */
+bool TRACK_handleCommand(const String& cmd, Stream& port);
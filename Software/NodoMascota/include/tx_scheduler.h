@@ -0,0 +1,54 @@
+/** @file tx_scheduler.h
+ * @brief Planificador de transmisiones periódicas del nodo de la mascota.
+ *
+ * Decide en qué segundo GNSS se envía la posición: cuando empieza un segundo
+ * nuevo y los segundos del día (UTC) son múltiplo del periodo. Así todos los
+ * collares con el mismo periodo transmiten alineados con la hora GNSS y el
+ * receptor sabe cuándo esperar la siguiente trama.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @note Para periodos divisores de 60 equivale a la regla anterior `SS % PERIOD == 0`;
+ *       con segundos del día también son válidos periodos ≥ 60 s (divisores de 86400).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+
+/** Periodo más largo (s): dos envíos al día. */
+static const uint16_t TXS_PERIOD_MAX = 43200;
+
+/**
+ * \brief Reinicia el planificador con el periodo indicado.
+ * \param periodS Segundos entre envíos (≥1).
+ */
+void TXS_begin(uint16_t periodS);
+
+/**
+ * \brief Indica si en la hora \p hhmmss toca transmitir.
+ * \return true si es un segundo distinto del último envío y múltiplo del periodo.
+ */
+bool TXS_isDue(uint32_t hhmmss);
+
+/**
+ * \brief Anota que se ha iniciado una transmisión en \p hhmmss.
+ */
+void TXS_markSent(uint32_t hhmmss);
+
+/**
+ * \brief Periodo configurado (s).
+ */
+uint16_t TXS_period();
+
+/**
+ * \brief Periodo de envío que respeta el duty-cycle.
+ * \param airtimeMs    Aire de cada subida (ms).
+ * \param wantedS      Periodo pedido (s; 0 se trata como 1).
+ * \param dutyFraction Duty-cycle de la sub-banda (0.01 = 1 %; 0 sin límite).
+ * \return El menor divisor de 86400 que no baja de \p wantedS ni del mínimo
+ *         del duty-cycle (como mucho TXS_PERIOD_MAX).
+ */
+uint16_t TXS_dutyPeriodS(float airtimeMs, uint16_t wantedS, float dutyFraction);
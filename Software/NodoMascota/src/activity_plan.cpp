@@ -0,0 +1,218 @@
+/** @file activity_plan.cpp
+ * @brief Implementación del horario de envíos aprendido.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "activity_plan.h"
+#include "gnss_aiding.h"
+#include "payload_codec.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t ACT_MAGIC = 0x31544341UL;   // "ACT1"
+
+// ----------------- Estado interno -----------------------
+static ActProfile s_prof;
+/** Fix ancla de la muestra en curso. */
+static bool     s_hasAnchor = false;
+static uint32_t s_anchorSod = 0;
+static double   s_anchorLat = 0.0, s_anchorLon = 0.0;
+/** Muestras de la hora en curso. */
+static uint8_t  s_accHour   = 0xFF;
+static uint16_t s_accMoving = 0, s_accTotal = 0;
+/** Refuerzo por movimiento inesperado. */
+static bool     s_boost      = false;
+static uint32_t s_boostStart = 0;
+
+/**
+ * \brief Segundos de \p from a \p to dentro del día (pasa por medianoche).
+ */
+static uint32_t sodDiff(uint32_t from, uint32_t to) {
+  return (to + 86400UL - from) % 86400UL;
+}
+
+/**
+ * \brief Incorpora la hora acumulada al perfil si tiene muestras suficientes.
+ * \return true si se ha aprendido.
+ */
+static bool closeHour() {
+  bool learned = false;
+  if (s_accHour < ACT_HOURS && s_accTotal >= ACT_MIN_SAMPLES) {
+    float frac = (float)s_accMoving / (float)s_accTotal;
+    uint8_t& a = s_prof.activity[s_accHour];
+    uint8_t& d = s_prof.days[s_accHour];
+    float next = d == 0 ? frac : a / 255.0f + ACT_LEARN_ALPHA * (frac - a / 255.0f);
+    a = (uint8_t)lroundf(next * 255.0f);
+    if (d < 255) d++;
+    learned = true;
+  }
+  s_accMoving = 0;
+  s_accTotal  = 0;
+  return learned;
+}
+
+void ACT_begin() {
+  memset(&s_prof, 0, sizeof(s_prof));
+  s_prof.magic = ACT_MAGIC;
+  s_hasAnchor  = false;
+  s_accHour    = 0xFF;
+  s_accMoving  = 0;
+  s_accTotal   = 0;
+  s_boost      = false;
+}
+
+bool ACT_load(const uint8_t* data, size_t len) {
+  ACT_begin();
+  if (!data || len != sizeof(ActProfile)) return false;
+  ActProfile p;
+  memcpy(&p, data, sizeof(p));
+  if (p.magic != ACT_MAGIC) return false;
+  s_prof = p;
+  return true;
+}
+
+const ActProfile& ACT_profile() {
+  return s_prof;
+}
+
+/**
+ * \brief Cierra la hora al cambiar, comprueba el movimiento frente al ancla y,
+ *        pasado ACT_SLOT_S, cuenta la muestra y reancla.
+ */
+uint8_t ACT_observe(uint32_t sod, double lat, double lon) {
+  sod %= 86400UL;
+  uint8_t ev   = 0;
+  uint8_t hour = (uint8_t)(sod / 3600);
+  if (hour != s_accHour) {
+    if (closeHour()) ev |= ACT_EV_HOUR;
+    s_accHour = hour;
+  }
+  if (!s_hasAnchor) {
+    s_hasAnchor = true;
+    s_anchorSod = sod;
+    s_anchorLat = lat;
+    s_anchorLon = lon;
+    return ev;
+  }
+
+  uint32_t dt = sodDiff(s_anchorSod, sod);
+  if (dt > ACT_SLOT_MAX_S) {
+    s_anchorSod = sod;
+    s_anchorLat = lat;
+    s_anchorLon = lon;
+    return ev;
+  }
+  bool moving = GPS_distanceM(s_anchorLat, s_anchorLon, lat, lon) > ACT_MOVE_M;
+  if (moving) {
+    if (ACT_isBoosted(sod)) {
+      s_boostStart = sod;   // sigue moviéndose: se prolonga
+    } else if (ACT_plan(hour, 0).periodS > 0) {
+      s_boost      = true;
+      s_boostStart = sod;
+      ev |= ACT_EV_MOTION;
+    }
+  }
+  if (dt >= ACT_SLOT_S) {
+    s_accTotal++;
+    if (moving) s_accMoving++;
+    s_anchorSod = sod;
+    s_anchorLat = lat;
+    s_anchorLon = lon;
+  }
+  return ev;
+}
+
+/**
+ * \brief Reglas del plan; con \p basePeriodS = 0 el periodo es 0 en las horas activas.
+ */
+ActHourPlan ACT_plan(uint8_t hour, uint16_t basePeriodS) {
+  ActHourPlan p{basePeriodS, false};
+  if (hour >= ACT_HOURS || s_prof.days[hour] < ACT_MIN_DAYS) return p;
+  float frac = s_prof.activity[hour] / 255.0f;
+  if (frac >= ACT_BUSY_FRAC) return p;
+  if (frac >= ACT_CALM_FRAC) {
+    if (ACT_CALM_PERIOD_S > p.periodS) p.periodS = ACT_CALM_PERIOD_S;
+    return p;
+  }
+  if (ACT_REST_PERIOD_S > p.periodS) p.periodS = ACT_REST_PERIOD_S;
+  p.gnssSleep = true;
+  return p;
+}
+
+bool ACT_isBoosted(uint32_t sod) {
+  if (s_boost && sodDiff(s_boostStart, sod % 86400UL) >= ACT_BOOST_S) s_boost = false;
+  return s_boost;
+}
+
+uint16_t ACT_periodS(uint32_t sod, uint16_t basePeriodS) {
+  if (ACT_isBoosted(sod)) return basePeriodS;
+  return ACT_plan((uint8_t)((sod % 86400UL) / 3600), basePeriodS).periodS;
+}
+
+/**
+ * \brief Hasta el siguiente envío alineado (como tx_scheduler) o la hora siguiente, menos el margen.
+ */
+uint32_t ACT_gnssSleepS(uint32_t sod, uint16_t basePeriodS) {
+  sod %= 86400UL;
+  if (ACT_isBoosted(sod)) return 0;
+  ActHourPlan p = ACT_plan((uint8_t)(sod / 3600), basePeriodS);
+  if (!p.gnssSleep || p.periodS == 0) return 0;
+  uint32_t next    = (sod / p.periodS + 1) * p.periodS;
+  uint32_t hourEnd = (sod / 3600 + 1) * 3600;
+  uint32_t wake    = (next < hourEnd ? next : hourEnd) - ACT_GNSS_LEAD_S;
+  if (wake <= sod || wake - sod < ACT_GNSS_MIN_SLEEP_S) return 0;
+  return wake - sod;
+}
+
+// ----------------- Mensajes al receptor -----------------------
+#if defined(AID_PROTOCOL_MTK)
+
+/**
+ * \brief Sentencia PMTK con `*CS\r\n`.
+ */
+static size_t pmtk(const char* body, uint8_t* out, size_t outSize) {
+  int n = snprintf((char*)out, outSize, "%s", body);
+  if (n < 0 || (size_t)n >= outSize) return 0;
+  return AID_nmeaFinish((char*)out, (size_t)n, outSize);
+}
+
+size_t ACT_buildGnssSleepMsg(uint32_t, uint8_t* out, size_t outSize) {
+  return pmtk("$PMTK161,0", out, outSize);
+}
+
+size_t ACT_buildGnssWakeMsg(uint8_t* out, size_t outSize) {
+  return pmtk("$PMTK000", out, outSize);
+}
+
+#else
+
+static const uint8_t UBX_CLASS_RXM = 0x02, UBX_ID_RXM_PMREQ = 0x41, UBX_PMREQ_LEN = 16;
+
+/**
+ * \brief UBX-RXM-PMREQ versión 0 (16 B): duración en ms, backup forzado y
+ *        despertar también por actividad en su UART RX.
+ */
+size_t ACT_buildGnssSleepMsg(uint32_t ms, uint8_t* out, size_t outSize) {
+  uint8_t p[UBX_PMREQ_LEN] = {0};  // version 0, reserved1
+  const uint32_t flags   = 0x06;   // backup | force
+  const uint32_t sources = 0x08;   // uartrx
+  memcpy(&p[4], &ms, 4);
+  memcpy(&p[8], &flags, 4);
+  memcpy(&p[12], &sources, 4);
+  return AID_ubxFrame(UBX_CLASS_RXM, UBX_ID_RXM_PMREQ, p, UBX_PMREQ_LEN, out, outSize);
+}
+
+/**
+ * \brief Bytes 0xFF: el receptor los descarta pero despierta por actividad en RX.
+ */
+size_t ACT_buildGnssWakeMsg(uint8_t* out, size_t outSize) {
+  const size_t n = 4;
+  if (!out || outSize < n) return 0;
+  memset(out, 0xFF, n);
+  return n;
+}
+
+#endif
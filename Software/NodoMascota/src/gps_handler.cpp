@@ -5,16 +5,30 @@
 * - Inicializa el puerto serie hacia el receptor GNSS (NMEA).
 * - Alimenta el parser TinyGPS++ con las tramas NMEA entrantes.
 * - Expone el estado actual (lat, lon, hhmmss, valid).
-* - Serializa/deserializa un payload binario compacto (13 B) para LoRa.
+* - El payload binario compacto (13 B) para LoRa está en payload_codec.cpp.
+* - Inyecta la asistencia de la base y mide TTFF y energía por adquisición.
+* - Duerme y despierta el receptor según el horario aprendido (activity_plan.h).
+* - Con `-DREPLAY_MODE` lee el NMEA de la traza `/replay.nmea` con sus tiempos
+*   en lugar del receptor, sin abrir su UART (una alarma hardware despierta
+*   loop() cuando toca cada sentencia); con `-DREPLAY_RECORD` escribe por
+*   Serial cada sentencia recibida en el formato de las trazas (replay_trace.h).
 *
 * @author Verónica Lechón Rodríguez
 * @date 23/07/2025
 */
 
 #include "gps_handler.h"
+#include "hot_path.h"
+#include "metrics.h"
+#include "activity_plan.h"
 #include <SoftwareSerial.h>
-#include <math.h>
-#include <string.h>
+#if defined(REPLAY_MODE) || defined(REPLAY_RECORD)
+  #include "replay_trace.h"
+#endif
+#if defined(REPLAY_MODE)
+  #include <LittleFS.h>
+  #include <pico/time.h>
+#endif
 
 // ----------------- Configuración pines -----------------
 static const uint8_t GPS_RX_PIN = 5;   // Pico RX <- TX del GPS
@@ -22,29 +36,215 @@ static const uint8_t GPS_TX_PIN = 4;   // Pico TX -> RX del GPS
 
 // ----------------- Estado interno -----------------------
 static TinyGPSPlus gps;
+#if !defined(REPLAY_MODE)
 static SoftwareSerial gpsSerial(GPS_RX_PIN, GPS_TX_PIN);  
+#endif
+#if defined(LORAWAN_MODE)
+static const size_t GPS_FIFO_LORAWAN = 8192;
+#endif
+
+// ----------------- Adquisición (TTFF) --------------------
+static const uint32_t GPS_FIX_LOST_MS  = 10000;   // sin posición nueva: adquisición nueva
+static const uint8_t  GPS_TTFF_SAMPLES = 16;      // por clase (con/sin asistencia)
+
+struct AcqStats {
+  uint32_t ttffMs[GPS_TTFF_SAMPLES];   // circular
+  uint8_t  n;
+  uint8_t  head;
+  uint32_t fixes;
+  float    energyMj;
+};
+static AcqStats s_acq[2];                 // [0] sin asistencia, [1] con asistencia
+static bool     s_acquiring   = true;
+static bool     s_acqAided    = false;
+static uint32_t s_acqStartMs  = 0;
+static uint32_t s_lastTtffMs  = 0;
+static uint32_t s_rxHwm       = 0;      // máximo de available() al entrar en GPS_update()
+static bool     s_asleep      = false;
+static bool     s_wakeAcq     = false;  // adquisición tras despertar (no cuenta en el TTFF)
+
+// ----------------- Métricas ------------------------------
+METRIC_COUNTER(m_gpsBytes, "gps_nmea_bytes_total", "Bytes NMEA recibidos del receptor GNSS");
+METRIC_HISTOGRAM(m_ttffUnaided, "gps_ttff_unaided_seconds", "Tiempo hasta el fix sin asistencia (s)",
+                 1, 5, 10, 30, 60, 120);
+METRIC_HISTOGRAM(m_ttffAided, "gps_ttff_aided_seconds", "Tiempo hasta el fix con asistencia de la base (s)",
+                 1, 5, 10, 30, 60, 120);
+METRIC_COUNTER_L(m_energyUnaided, "gps_acq_energy_mj_total", "Energía estimada de adquisición GNSS (mJ)", "aided=\"no\"");
+METRIC_COUNTER_L(m_energyAided,   "gps_acq_energy_mj_total", "Energía estimada de adquisición GNSS (mJ)", "aided=\"yes\"");
+METRIC_COUNTER_L(m_fixUnaided, "gps_acq_fixes_total", "Adquisiciones completadas", "aided=\"no\"");
+METRIC_COUNTER_L(m_fixAided,   "gps_acq_fixes_total", "Adquisiciones completadas", "aided=\"yes\"");
+METRIC_COUNTER(m_sleepS, "gps_sleep_seconds_total", "Segundos pedidos de receptor dormido (horario aprendido)");
+METRIC_COUNTER(m_aidInjected, "gps_aid_injected_total", "Asistencias inyectadas en el receptor");
+
+// ----------------- Reproducción y grabación (replay_trace.h) ----------
+#if defined(REPLAY_MODE)
+static const char*   REPLAY_FILE      = "/replay.nmea";
+static const uint8_t REPLAY_MAX_LINES = 8;   // sentencias por llamada (una época son 4-8)
+static File     s_replay;
+static bool     s_replayPending = false;
+static uint32_t s_replayT       = 0;
+static char     s_replayLine[RPL_MAX_LINE];
+static RplRecord s_replayRec;
+/** Alarma del siguiente registro: sin UART, nada más saca a loop() del WFI. */
+static volatile alarm_id_t s_replayAlarm = 0;
+
+/**
+ * \brief Lee la siguiente sentencia de la traza; al final informa de la pasada
+ *        (retrasos y perfilado) y vuelve a empezar.
+ */
+static bool nextReplayLine() {
+  for (uint8_t tries = 0; tries < 16; tries++) {   // acota el trabajo por llamada
+    if (!s_replay.available()) {
+      RplStats st = RPL_rewind(millis());
+      Serial.print("[RPL] Pasada "); Serial.print(st.passes);
+      Serial.print(": "); Serial.print(st.records);
+      Serial.print(" sentencias, retraso max "); Serial.print(st.lateMaxMs);
+      Serial.print(" ms, medio "); Serial.print(st.records ? (float)st.lateSumMs / st.records : 0.0f, 1);
+      Serial.println(" ms");
+      HOT_report(Serial, true);
+      if (st.records == 0) {
+        Serial.println("[RPL] La traza no tiene sentencias validas");
+        s_replay.close();
+        return false;
+      }
+      s_replay.seek(0);
+    }
+    size_t n = s_replay.readBytesUntil('\n', s_replayLine, sizeof(s_replayLine) - 1);
+    if (RPL_parseLine(s_replayLine, n, s_replayRec)) {
+      s_replayT = s_replayRec.tMs;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int64_t onReplayAlarm(alarm_id_t, void*) {
+  s_replayAlarm = 0;
+  return 0;   // sin repetición; basta con la interrupción
+}
+
+/**
+ * \brief Arma la alarma para cuando toque el registro pendiente (ya, si quedan
+ *        atrasados o hay que seguir leyendo la traza).
+ */
+static void armReplayAlarm() {
+  if (!s_replay || s_replayAlarm > 0) return;
+  uint32_t ms = s_replayPending ? RPL_msUntil(s_replayT, millis()) : 0;
+  alarm_id_t id = add_alarm_in_ms(ms ? ms : 1, onReplayAlarm, nullptr, true);
+  s_replayAlarm = id > 0 ? id : 0;
+}
+
+/**
+ * \brief Pasa al parser las sentencias grabadas que ya tocan.
+ * \details Con el receptor dormido se descartan: el tiempo de la traza sigue
+ *          corriendo igual que el del cielo.
+ * \return Bytes entregados.
+ */
+static uint32_t replayFeed() {
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < REPLAY_MAX_LINES && s_replay; i++) {
+    if (!s_replayPending) s_replayPending = nextReplayLine();
+    if (!s_replayPending || !RPL_due(s_replayT, millis())) break;
+    if (!s_asleep) {
+      for (size_t k = 0; k < s_replayRec.len; k++) gps.encode(s_replayRec.text[k]);
+      gps.encode('\r');
+      gps.encode('\n');
+      n += s_replayRec.len + 2;
+    }
+    RPL_delivered(s_replayT, millis());
+    s_replayPending = false;
+  }
+  armReplayAlarm();
+  return n;
+}
+#endif
+
+#if defined(REPLAY_RECORD)
+static char   s_recLine[RPL_MAX_LINE];
+static size_t s_recLen = 0;
+
+/**
+ * \brief Acumula la sentencia en curso y la escribe al completarse.
+ */
+static void recordChar(char c) {
+  if (c == '\r') return;
+  if (c != '\n') {
+    if (s_recLen < sizeof(s_recLine) - 1) s_recLine[s_recLen++] = c;
+    return;
+  }
+  s_recLine[s_recLen] = '\0';
+  if (s_recLen > 0 && s_recLine[0] == '$') {
+    Serial.print("RPL "); Serial.print(millis()); Serial.print(' '); Serial.println(s_recLine);
+  }
+  s_recLen = 0;
+}
+#endif
+
+/**
+ * \brief Envía un mensaje al receptor (en reproducción no hay a quién).
+ */
+static void gpsWrite(const uint8_t* msg, size_t len) {
+#if defined(REPLAY_MODE)
+  (void)msg; (void)len;
+#else
+  gpsSerial.write(msg, len);
+#endif
+}
 
 /**
  * \brief Inicializa SoftwareSerial hacia el receptor GNSS.
  */
 bool GPS_begin(uint32_t baud) {
+#if defined(REPLAY_MODE)
+  (void)baud;   // el receptor no se abre: la traza sustituye a su NMEA
+#else
+  #if defined(LORAWAN_MODE)
+  // Las subidas LoRaWAN bloquean loop() hasta ~7 s (join con RX1/RX2): el FIFO
+  // guarda ese NMEA (≈1 KB/s a 9600 baudios) en lugar de perderlo
+  gpsSerial.setFIFOSize(GPS_FIFO_LORAWAN);
+  #endif
   gpsSerial.begin(baud);
+#endif
+  s_acquiring  = true;
+  s_acqAided   = false;
+  s_acqStartMs = millis();
+#if defined(REPLAY_MODE)
+  // Antes que TRACK_begin(): montar otra vez no hace nada
+  s_replay = LittleFS.begin() ? LittleFS.open(REPLAY_FILE, "r") : File();
+  Serial.print(s_replay ? "[RPL] Reproduciendo " : "[RPL] Sin traza "); Serial.println(REPLAY_FILE);
+  RPL_begin(millis());
+#endif
   return true;
 }
 
 /**
  * \brief Lee los mensajes recibidos y los pasa al parser NMEA.
  */
-void GPS_update() {
+void HOT_FUNC(GPS_update)() {
+  HOT_PROF_SCOPE(HOT_SLOT_GPS_UPDATE);
+  uint32_t n = 0;
+#if defined(REPLAY_MODE)
+  n = replayFeed();
+#else
+  int pending = gpsSerial.available();
+  if (pending > 0 && (uint32_t)pending > s_rxHwm) s_rxHwm = (uint32_t)pending;
   while (gpsSerial.available() > 0) {
-    gps.encode(gpsSerial.read());
+    char c = (char)gpsSerial.read();
+    gps.encode(c);
+  #if defined(REPLAY_RECORD)
+    recordChar(c);
+  #endif
+    n++;
   }
+#endif
+  if (n) m_gpsBytes.inc(n);
 }
 
 /**
  * \brief Comprobación mínima de validez (posición + hora).
  */
 bool GPS_hasFix() {
+  if (s_asleep) return false;   // TinyGPS++ conserva el último fix
   return gps.location.isValid() && gps.time.isValid();
 }
 
@@ -65,42 +265,159 @@ GpsInfo GPS_getInfo() {
 }
 
 /**
- * \brief Genera el payload de 13 B: [fix|hhmmss|lat*1e5|lon*1e5] (LE).
+ * \brief Hora corregida con la antigüedad, mensaje de hora y, después, de posición.
+ */
+bool GPS_applyAiding(const AidData& aid, uint32_t ageMs) {
+  if (!s_acquiring) return false;
+  uint32_t utc = aid.utc + (ageMs + 500UL) / 1000UL;
+  uint8_t msg[64];
+  size_t len = AID_buildTimeMsg(utc, aid.timeAccS + 1, msg, sizeof(msg));
+  if (len) gpsWrite(msg, len);
+  len = AID_buildPosMsg(aid, utc, msg, sizeof(msg));
+  if (len) gpsWrite(msg, len);
+  s_acqAided = true;
+  m_aidInjected.inc();
+  return true;
+}
+
+/**
+ * \brief Cierra la adquisición al primer fix fresco o abre una nueva al perderlo.
  */
-size_t GPS_buildBinaryPayload(const GpsInfo& info, uint8_t* out, size_t outSize) {
-  if (!out || outSize < 13 || !info.valid) return 0;
+void GPS_acqTick() {
+  if (s_asleep) return;
+  bool fresh = gps.location.isValid() && gps.time.isValid() &&
+               gps.location.age() < GPS_FIX_LOST_MS;
+  uint32_t now = millis();
+
+  if (!s_acquiring) {
+    if (!fresh) {
+      s_acquiring  = true;
+      s_acqAided   = false;
+      s_acqStartMs = now - (gps.location.isValid() ? gps.location.age() : 0);
+    }
+    return;
+  }
+  if (!fresh || gps.location.age() > 2000) return;
+  if (s_wakeAcq) {
+    s_wakeAcq   = false;
+    s_acquiring = false;
+    return;
+  }
+
+  uint32_t ttff = now - s_acqStartMs;
+  float    mj   = AID_acquisitionEnergyMj(ttff);
+  AcqStats& st  = s_acq[s_acqAided ? 1 : 0];
+  st.ttffMs[st.head] = ttff;
+  st.head = (st.head + 1) % GPS_TTFF_SAMPLES;
+  if (st.n < GPS_TTFF_SAMPLES) st.n++;
+  st.fixes++;
+  st.energyMj += mj;
+  s_lastTtffMs = ttff;
 
-  out[0] = 1;  // fix válido
+  if (s_acqAided) {
+    m_ttffAided.observe(ttff / 1000.0f);
+    m_energyAided.inc((uint32_t)(mj + 0.5f));
+    m_fixAided.inc();
+  } else {
+    m_ttffUnaided.observe(ttff / 1000.0f);
+    m_energyUnaided.inc((uint32_t)(mj + 0.5f));
+    m_fixUnaided.inc();
+  }
+  s_acquiring = false;
+}
+
+/**
+ * \brief Envía el mensaje de dormir; el fix anterior deja de valer.
+ */
+void GPS_sleep(uint32_t ms) {
+  uint8_t msg[32];
+  size_t len = ACT_buildGnssSleepMsg(ms, msg, sizeof(msg));
+  if (!len) return;
+  gpsWrite(msg, len);
+  s_asleep = true;
+  m_sleepS.inc((ms + 500) / 1000);
+}
 
-  // HHMMSS (uint32)
-  memcpy(&out[1], &info.hhmmss, 4);
+/**
+ * \brief Mensaje de despertar y adquisición en caliente fuera de las estadísticas.
+ */
+void GPS_wake() {
+  if (!s_asleep) return;
+  uint8_t msg[16];
+  size_t len = ACT_buildGnssWakeMsg(msg, sizeof(msg));
+  if (len) gpsWrite(msg, len);
+  s_asleep     = false;
+  s_acquiring  = true;
+  s_acqAided   = false;
+  s_wakeAcq    = true;
+  s_acqStartMs = millis();
+}
 
-  // lat/lon * 1e5 → int32 (≈1 m)
-  int32_t latFixed = (int32_t)lround(info.lat * 100000.0);
-  int32_t lonFixed = (int32_t)lround(info.lon * 100000.0);
-  memcpy(&out[5],  &latFixed, 4);
-  memcpy(&out[9],  &lonFixed, 4);
+bool GPS_isAsleep() {
+  return s_asleep;
+}
 
-  return 13;
+/**
+ * \brief Percentil \p p (0..100) de \p n muestras (ordena \p v in situ).
+ */
+static uint32_t percentile(uint32_t* v, uint8_t n, uint8_t p) {
+  for (uint8_t i = 1; i < n; i++) {
+    uint32_t x = v[i];
+    int8_t j = i - 1;
+    while (j >= 0 && v[j] > x) { v[j + 1] = v[j]; j--; }
+    v[j + 1] = x;
+  }
+  return v[(n - 1) * p / 100];
 }
 
 /**
- * \brief Decodifica 13 B a GpsInfo; exige fix_flag==1.
+ * \brief Percentil \p p (0..100) de las muestras de una clase (ordena una copia).
  */
-bool GPS_parsePayload(const uint8_t* in, size_t len, GpsInfo& out) {
-  if (!in || len != 13) return false;
-  if (in[0] != 1) return false; 
+static uint32_t ttffPercentile(const AcqStats& st, uint8_t p) {
+  uint32_t v[GPS_TTFF_SAMPLES];
+  memcpy(v, st.ttffMs, st.n * sizeof(uint32_t));
+  return percentile(v, st.n, p);
+}
 
-  uint32_t hhmmss = 0;
-  int32_t latFixed = 0, lonFixed = 0;
+/**
+ * \brief Una línea por clase (las últimas 16 adquisiciones para los percentiles).
+ */
+void GPS_acqReport(Stream& port) {
+  port.println("[TTFF] clase     fixes  p50_s  p90_s  mJ/fix");
+  for (uint8_t c = 0; c < 2; c++) {
+    const AcqStats& st = s_acq[c];
+    char line[64];
+    if (st.n == 0) {
+      snprintf(line, sizeof(line), "[TTFF] %-9s %5lu      -      -       -", c ? "asistida" : "sin_asist",
+               (unsigned long)st.fixes);
+    } else {
+      snprintf(line, sizeof(line), "[TTFF] %-9s %5lu %6.1f %6.1f %7.0f", c ? "asistida" : "sin_asist",
+               (unsigned long)st.fixes, ttffPercentile(st, 50) / 1000.0,
+               ttffPercentile(st, 90) / 1000.0, (double)(st.energyMj / st.fixes));
+    }
+    port.println(line);
+  }
+  if (s_acquiring) {
+    port.print("[TTFF] adquisición en curso desde hace ");
+    port.print((millis() - s_acqStartMs) / 1000UL);
+    port.println(s_acqAided ? " s (asistida)" : " s");
+  }
+}
 
-  memcpy(&hhmmss,   &in[1], 4);
-  memcpy(&latFixed, &in[5], 4);
-  memcpy(&lonFixed, &in[9], 4);
+/**
+ * \brief Une las muestras de ambas clases para el percentil.
+ */
+void GPS_ttffSummary(uint32_t& lastMs, uint32_t& p90Ms) {
+  uint32_t v[2 * GPS_TTFF_SAMPLES];
+  uint8_t n = 0;
+  for (uint8_t c = 0; c < 2; c++) {
+    memcpy(&v[n], s_acq[c].ttffMs, s_acq[c].n * sizeof(uint32_t));
+    n += s_acq[c].n;
+  }
+  lastMs = s_lastTtffMs;
+  p90Ms  = n ? percentile(v, n, 90) : 0;
+}
 
-  out.hhmmss = hhmmss;
-  out.lat    = ((double)latFixed) / 100000.0;
-  out.lon    = ((double)lonFixed) / 100000.0;
-  out.valid  = true;
-  return true;
+uint32_t GPS_rxHighWater() {
+  return s_rxHwm;
 }
@@ -0,0 +1,188 @@
+/** @file health_monitor.cpp
+ * @brief Implementación del estado de salud del collar y de su planificación.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "health_monitor.h"
+#include "gps_handler.h"
+#include "metrics.h"
+#include "wake_radio.h"
+#include <LittleFS.h>
+#include <RadioLib.h>
+#include "hardware/watchdog.h"
+#include "hardware/structs/vreg_and_chip_reset.h"
+
+// ----------------- Configuración -----------------------
+static const char*    BOOT_COUNT_FILE = "/boot.cnt";
+static const uint16_t HLT_PREAMBLE    = 8;   // uplink normal, SF9/125 kHz (hasta MON_setAirtime())
+
+// ----------------- Métricas -----------------------------
+METRIC_COUNTER(m_hltSent, "health_frames_sent_total", "Tramas de salud enviadas a la base");
+METRIC_GAUGE(m_loopMax, "loop_work_max_ms", "Duración máxima de loop() en el intervalo de salud actual (ms)");
+METRIC_GAUGE(m_dieTemp, "mcu_temperature_celsius", "Temperatura del die del RP2040 (°C)");
+METRIC_COUNTER(m_txFail, "lora_tx_failures_total", "Transmisiones LoRa fallidas (inicio o fin)");
+
+// ----------------- Estado interno -----------------------
+static uint8_t  s_resetReason = HLT_RESET_OTHER;
+static uint32_t s_bootCount   = 0;
+static uint32_t s_intervalMs  = 0;
+static uint32_t s_lastSentMs  = 0;
+static bool     s_sentOnce    = false;
+static uint8_t  s_seq         = 0;
+static uint32_t s_loopStartUs = 0;
+static uint32_t s_loopMaxUs   = 0;      // desde la última trama
+static uint32_t s_minFreeHeap = 0xFFFFFFFFUL;
+static uint32_t s_txFailures  = 0;
+static int      s_lastTxError = RADIOLIB_ERR_NONE;
+
+/**
+ * \brief Causa del reinicio a partir del watchdog y del registro CHIP_RESET.
+ */
+static uint8_t readResetReason() {
+  if (watchdog_enable_caused_reboot()) return HLT_RESET_WATCHDOG;
+  if (watchdog_caused_reboot())        return HLT_RESET_SOFTWARE;   // watchdog_reboot() sin timeout
+  uint32_t cr = vreg_and_chip_reset_hw->chip_reset;
+  if (cr & (VREG_AND_CHIP_RESET_CHIP_RESET_HAD_POR_BITS | VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS)) {
+    return HLT_RESET_POWER_ON;
+  }
+  return HLT_RESET_OTHER;   // p. ej. reinicio desde el depurador (PSM)
+}
+
+/**
+ * \brief Lee, incrementa y guarda el contador de arranques.
+ */
+static uint32_t bumpBootCount() {
+  uint32_t n = 0;
+  File f = LittleFS.open(BOOT_COUNT_FILE, "r");
+  if (f) {
+    if (f.read((uint8_t*)&n, sizeof(n)) != sizeof(n)) n = 0;
+    f.close();
+  }
+  n++;
+  f = LittleFS.open(BOOT_COUNT_FILE, "w");
+  if (f) {
+    f.write((const uint8_t*)&n, sizeof(n));
+    f.close();
+  }
+  return n;
+}
+
+/**
+ * \brief Causa del reinicio, contador persistente e intervalo según el presupuesto.
+ */
+void MON_begin(bool fsOk) {
+  s_resetReason = readResetReason();
+  s_bootCount   = fsOk ? bumpBootCount() : 0;
+  MON_setAirtime(WOR_airtimeMs(HLT_FRAME_LEN, HLT_PREAMBLE));
+  s_sentOnce    = false;
+}
+
+/**
+ * \brief Intervalo en ms, saturado (HLT_minIntervalS() llega a 0xFFFFFFFF s).
+ */
+void MON_setAirtime(float airtimeMs) {
+  uint32_t s = HLT_minIntervalS(airtimeMs, HLT_BUDGET_PCT / 100.0f);
+  s_intervalMs = s > 0xFFFFFFFFUL / 1000UL ? 0xFFFFFFFFUL : s * 1000UL;
+}
+
+void MON_loopStart() {
+  s_loopStartUs = micros();
+}
+
+/**
+ * \brief Máximo de duración de loop() y mínimo de heap libre.
+ */
+void MON_loopEnd() {
+  uint32_t dur = micros() - s_loopStartUs;
+  if (dur > s_loopMaxUs) {
+    s_loopMaxUs = dur;
+    m_loopMax.set(dur / 1000.0f);
+  }
+  uint32_t heap = (uint32_t)rp2040.getFreeHeap();
+  if (heap < s_minFreeHeap) s_minFreeHeap = heap;
+}
+
+/**
+ * \brief Cuenta los fallos y guarda el último código de error.
+ */
+void MON_noteTx(int state) {
+  if (state == RADIOLIB_ERR_NONE) return;
+  s_txFailures++;
+  s_lastTxError = state;
+  m_txFail.inc();
+}
+
+bool MON_isDue() {
+  return !s_sentOnce || millis() - s_lastSentMs >= s_intervalMs;
+}
+
+/**
+ * \brief Satura a 8 bits.
+ */
+static uint8_t sat8(uint32_t v) {
+  return v > 0xFFU ? 0xFFU : (uint8_t)v;
+}
+
+/**
+ * \brief Toma una muestra de cada fuente y reinicia el máximo de loop().
+ */
+size_t MON_buildFrame(uint8_t* out, size_t outSize) {
+  uint32_t ttffLastMs, ttffP90Ms;
+  GPS_ttffSummary(ttffLastMs, ttffP90Ms);
+  float temp = analogReadTemp();
+  m_dieTemp.set(temp);
+
+  HealthFrame h;
+  h.seq           = s_seq;
+  h.uptimeMin     = millis() / 60000UL;
+  h.resetReason   = s_resetReason;
+  h.resetCount    = (uint8_t)s_bootCount;
+  h.ttffLastS     = (uint16_t)((ttffLastMs + 500UL) / 1000UL);
+  h.ttffP90S      = (uint16_t)((ttffP90Ms + 500UL) / 1000UL);
+  h.txFailures    = (uint8_t)s_txFailures;
+  h.lastTxError   = (int16_t)s_lastTxError;
+  h.tempC         = (int8_t)lroundf(temp);
+  h.loopMaxMs     = sat8((s_loopMaxUs + 500UL) / 1000UL);
+  h.gpsRxHwm      = sat8(GPS_rxHighWater());
+  h.minFreeHeapKb = s_minFreeHeap == 0xFFFFFFFFUL ? 0 : sat8(s_minFreeHeap / 1024UL);
+
+  size_t len = HLT_buildFrame(h, out, outSize);
+  if (len) s_loopMaxUs = 0;
+  return len;
+}
+
+void MON_markSent() {
+  s_lastSentMs = millis();
+  s_sentOnce   = true;
+  s_seq++;
+  m_hltSent.inc();
+}
+
+uint32_t MON_intervalS() {
+  return s_intervalMs / 1000UL;
+}
+
+/**
+ * \brief Una línea por campo, con los mismos valores que llevaría la trama.
+ */
+void MON_report(Stream& port) {
+  uint32_t ttffLastMs, ttffP90Ms;
+  GPS_ttffSummary(ttffLastMs, ttffP90Ms);
+  port.print("[HEALTH] reinicio="); port.print(HLT_resetName(s_resetReason));
+  port.print(" arranques="); port.println(s_bootCount);
+  port.print("[HEALTH] uptime_min="); port.print(millis() / 60000UL);
+  port.print(" temp_C="); port.println(analogReadTemp(), 1);
+  port.print("[HEALTH] ttff_ultimo_s="); port.print(ttffLastMs / 1000.0f, 1);
+  port.print(" ttff_p90_s="); port.println(ttffP90Ms / 1000.0f, 1);
+  port.print("[HEALTH] tx_fallos="); port.print(s_txFailures);
+  port.print(" ultimo_error="); port.println(s_lastTxError);
+  port.print("[HEALTH] loop_max_ms="); port.print(s_loopMaxUs / 1000.0f, 1);
+  port.print(" gps_rx_hwm="); port.print(GPS_rxHighWater());
+  port.print(" heap_min_B="); port.println(s_minFreeHeap == 0xFFFFFFFFUL ? 0 : s_minFreeHeap);
+  port.print("[HEALTH] seq="); port.print(s_seq);
+  port.print(" intervalo_s="); port.print(MON_intervalS());
+  port.print(" presupuesto="); port.print(HLT_BUDGET_PCT);
+  port.println("% del duty-cycle");
+}
@@ -4,8 +4,13 @@
  * Este módulo:
  * - Inicializa el transceptor SX1262 con BW=125 kHz, SF=9, CR=4/7, Ptx=14 dBm.
  * - Gestiona el RF switch (RX/TX enable) y el bus SPI del RP2040.
- * - Lanza transmisiones asíncronas (startTransmit) y atiende la ISR de fin de TX.
+ * - Lanza transmisiones asíncronas (startTransmit) y atiende la ISR de DIO1.
  * - Expone utilidades para conocer el estado final y finalizar TX explícitamente.
+ * - Entre envíos deja la radio en escucha duty-cycle (wake-on-radio) y
+ *   decodifica los comandos, la asistencia GNSS y la valla de casa de la base.
+* - Aplica la corrección de frecuencia pedida por la base (sin TCXO) y, si se le
+*   ordena, emite las subidas a SF8/62,5 kHz (WOR_NARROW_SF: el mismo aire que
+*   a SF9/125 kHz); la escucha sigue a SF9/125 kHz.
  *
  * @note El sync word usado es 0x12 (privado). La salida se ajusta a la banda EU 868 MHz.
  *
@@ -15,6 +20,9 @@
 
 #include "lora_handler.h"
 #include <RadioLib.h>
+#include "hot_path.h"
+#include "metrics.h"
+#include "wake_radio.h"
 
 //-------------- Configuración pines SX1262 ------------------
 // Raspberry Pi Pico (SPI0 por defecto): NSS=17, DIO1=20, RST=22, BUSY=28
@@ -29,18 +37,60 @@
 // SX1262 sobre SPI0 con SPI settings por defecto del core.
 SX1262 radio = new Module(LORA_NSS, LORA_DIO1, LORA_RST, LORA_BUSY, SPI, RADIOLIB_DEFAULT_SPI_SETTINGS);
 
+//--------------- Métricas ---------------------------------
+METRIC_COUNTER_L(m_txOk,    "lora_tx_frames_total", "Transmisiones LoRa por resultado", "result=\"ok\"");
+METRIC_COUNTER_L(m_txError, "lora_tx_frames_total", "Transmisiones LoRa por resultado", "result=\"error\"");
+METRIC_COUNTER_L(m_txStartFail, "lora_tx_frames_total", "Transmisiones LoRa por resultado", "result=\"start_failed\"");
+METRIC_COUNTER_L(m_cmdOk,      "lora_cmd_rx_total", "Comandos recibidos en escucha por resultado", "result=\"ok\"");
+METRIC_COUNTER_L(m_cmdDup,     "lora_cmd_rx_total", "Comandos recibidos en escucha por resultado", "result=\"duplicate\"");
+METRIC_COUNTER_L(m_cmdInvalid, "lora_cmd_rx_total", "Comandos recibidos en escucha por resultado", "result=\"invalid\"");
+METRIC_COUNTER(m_aidRx, "lora_aid_rx_total", "Tramas de asistencia GNSS recibidas en escucha");
+METRIC_COUNTER(m_fenceRx, "lora_fence_rx_total", "Tramas de valla recibidas en escucha");
+METRIC_GAUGE(m_freqCorr, "lora_freq_correction_hz", "Corrección de frecuencia acumulada pedida por la base (Hz)");
+METRIC_GAUGE(m_ulBw, "lora_uplink_bandwidth_khz", "Ancho de banda de las subidas (kHz)");
+METRIC_HISTOGRAM(m_txDuration, "lora_tx_duration_ms", "Tiempo desde startTransmit hasta la ISR de fin (ms)",
+                 100, 200, 300, 500, 1000);
+
 //--------------- Variables de estado -----------------------
-/** Flag levantado por la ISR de fin de paquete TX. */
-static volatile bool transmittedFlag = false;
+/** Uso actual de la radio (determina el significado de DIO1). */
+enum LoraMode : uint8_t { LORA_MODE_IDLE, LORA_MODE_TX, LORA_MODE_SNIFF };
+static volatile LoraMode radioMode = LORA_MODE_IDLE;
+/** Flag levantado por la ISR de DIO1 (fin de TX o paquete recibido en escucha). */
+static volatile bool dio1Flag = false;
 /** Último estado devuelto por RadioLib. */
 static int transmissionState = RADIOLIB_ERR_NONE;
+/** Ciclo de CPU en que saltó la ISR (sólo con perfilado, HOT_PROFILE). */
+static volatile uint32_t txDoneCycles = 0;
+/** Instante (ms) de inicio de la transmisión en curso. */
+static uint32_t txStartMs = 0;
+/** Ajuste de escucha actual (índice en wake_radio) y último comando atendido. */
+static uint8_t sniffPreset = WOR_SNIFF_PRESET;
+static int16_t lastCmdSeq  = -1;
+/** Frecuencia nominal, corrección acumulada y anchos de banda (subidas y el configurado en la radio). */
+static float   baseFreqMHz = 0.0f;
+static int32_t freqCorrHz  = 0;
+static float   uplinkBwKHz = LORA_BW_KHZ;
+static float   radioBwKHz  = LORA_BW_KHZ;
 
-//----------------- ISR fin de paquete ----------------------
+//----------------- ISR DIO1 --------------------------------
 /**
- * \brief Callback de RadioLib cuando termina la transmisión.
+ * \brief Única ISR de DIO1: fin de transmisión o paquete recibido en escucha.
  */
-static void onPacketSentISR() {
-  transmittedFlag = true;
+static void HOT_FUNC(onDio1ISR)() {
+  HOT_PROF_SCOPE(HOT_SLOT_LORA_ISR);
+  txDoneCycles = HOT_CYCLES();
+  dio1Flag = true;
+}
+
+/**
+ * \brief Configura \p kHz y su SF (WOR_uplinkSF()) si no lo están ya (radio en reposo).
+ */
+static void useBandwidth(float kHz) {
+  if (kHz == radioBwKHz) return;
+  if (radio.setBandwidth(kHz) == RADIOLIB_ERR_NONE &&
+      radio.setSpreadingFactor(WOR_uplinkSF(kHz)) == RADIOLIB_ERR_NONE) {
+    radioBwKHz = kHz;
+  }
 }
 
 /**
@@ -66,7 +116,7 @@ bool LORA_begin(float freqMHz) {
   pinMode(LORA_NSS, OUTPUT);
   digitalWrite(LORA_NSS, HIGH);
 
-  int state = radio.begin(freqMHz, 125.0, 9, 7, 0x12, 14, 8, 0, false);
+  int state = radio.begin(freqMHz, LORA_BW_KHZ, 9, 7, 0x12, 14, 8, 0, false);
   if (state != RADIOLIB_ERR_NONE) {
     transmissionState = state;
     return false;
@@ -75,26 +125,36 @@ bool LORA_begin(float freqMHz) {
   // Control de RF switch discreto (enable RX/TX)
   radio.setRfSwitchPins(LORA_RXEN, LORA_TXEN);
 
-  // Registrar ISR de fin de TX
-  radio.setPacketSentAction(onPacketSentISR);
+  // Una sola ISR para TX y escucha (ambas usan DIO1)
+  radio.setDio1Action(onDio1ISR);
 
-  transmittedFlag = false;
+  radioMode = LORA_MODE_IDLE;
+  dio1Flag = false;
   transmissionState = RADIOLIB_ERR_NONE;
+  baseFreqMHz = freqMHz;
+  freqCorrHz  = 0;
+  radioBwKHz  = LORA_BW_KHZ;
+  m_ulBw.set(uplinkBwKHz);
   return true;
 }
 
 /**
  * \brief Lanza transmisión asíncrona (non-blocking).
  * \details Valida puntero/longitud y delega en \c radio.startTransmit().
- *          El resultado final se detecta por ISR (transmittedFlag).
+ *          El resultado final se detecta por ISR (dio1Flag).
  */
-bool LORA_startTx(const uint8_t* payload, size_t len) {
+bool HOT_FUNC(LORA_startTx)(const uint8_t* payload, size_t len) {
   if (!payload || len == 0 || len > 256) {
     transmissionState = RADIOLIB_ERR_INVALID_PAYLOAD;
     return false;
   }
-  transmittedFlag = false;
+  if (radioMode == LORA_MODE_SNIFF) radio.standby();   // sale de la escucha
+  useBandwidth(uplinkBwKHz);
+  radioMode = LORA_MODE_TX;
+  dio1Flag = false;
+  txStartMs = millis();
   transmissionState = radio.startTransmit(payload, len);
+  if (transmissionState != RADIOLIB_ERR_NONE) m_txStartFail.inc();
   return (transmissionState == RADIOLIB_ERR_NONE);
 }
 
@@ -102,7 +162,7 @@ bool LORA_startTx(const uint8_t* payload, size_t len) {
  * \brief Indica si la ISR de fin de transmisión ya se disparó.
  */
 bool LORA_isTxDone() {
-  return transmittedFlag;
+  return radioMode == LORA_MODE_TX && dio1Flag;
 }
 
 /**
@@ -113,10 +173,133 @@ int LORA_lastState() {
 }
 
 /**
- * \brief Finaliza transmisión (bloqueante corta) y marca TX hecho.
+ * \brief Finaliza transmisión (bloqueante corta) y deja la radio en reposo (ver LORA_startSniff()).
  * \note Útil para secuencias que requieran asegurar fin antes de cambiar modo.
  */
 void LORA_finishTx() {
+  // Latencia desde la ISR hasta que loop() atiende el fin de TX
+  if (dio1Flag) {
+    HOT_record(HOT_SLOT_ISR_SERVICE, HOT_CYCLES() - txDoneCycles);
+    m_txDuration.observe((float)(millis() - txStartMs));
+    if (transmissionState == RADIOLIB_ERR_NONE) m_txOk.inc();
+    else                                        m_txError.inc();
+  }
   radio.finishTransmit();
-  transmittedFlag = true;
+  radioMode = LORA_MODE_IDLE;
+  dio1Flag = false;
+}
+
+/**
+ * \brief Arranca la escucha duty-cycle con el ajuste actual.
+ */
+bool LORA_startSniff() {
+  const WorSniffPreset& p = WOR_preset(sniffPreset);
+  useBandwidth(LORA_BW_KHZ);   // la base emite las bajadas a SF9/125 kHz
+  dio1Flag = false;
+  radioMode = LORA_MODE_SNIFF;
+  transmissionState = radio.startReceiveDutyCycle(p.rxUs, p.sleepUs);
+  if (transmissionState != RADIOLIB_ERR_NONE) radioMode = LORA_MODE_IDLE;
+  return (transmissionState == RADIOLIB_ERR_NONE);
+}
+
+/**
+ * \brief Cambia el ajuste de escucha y la reinicia si estaba activa.
+ */
+bool LORA_setSniffPreset(uint8_t index) {
+  if (index >= WOR_presetCount()) return false;
+  sniffPreset = index;
+  if (radioMode == LORA_MODE_SNIFF) {
+    radio.standby();
+    LORA_startSniff();
+  }
+  return true;
+}
+
+/**
+ * \brief Ajuste de escucha actual.
+ */
+uint8_t LORA_sniffPreset() {
+  return sniffPreset;
+}
+
+/**
+ * \brief Retoca la frecuencia con la radio en reposo y rearma la escucha si estaba activa.
+ */
+bool LORA_adjustFrequency(int16_t hz) {
+  int32_t total = freqCorrHz + hz;
+  if (total > LORA_FREQ_CORR_MAX_HZ || total < -LORA_FREQ_CORR_MAX_HZ) return false;
+  bool sniffing = radioMode == LORA_MODE_SNIFF;
+  if (sniffing) radio.standby();
+  bool ok = radio.setFrequency(baseFreqMHz + (float)total * 1e-6f) == RADIOLIB_ERR_NONE;
+  if (ok) {
+    freqCorrHz = total;
+    m_freqCorr.set((float)total);
+  }
+  if (sniffing) LORA_startSniff();
+  return ok;
+}
+
+int32_t LORA_freqCorrectionHz() {
+  return freqCorrHz;
+}
+
+/**
+ * \brief Sólo anota el ancho de banda: LORA_startTx() lo aplica.
+ */
+bool LORA_setUplinkBandwidth(float kHz) {
+  if (kHz != LORA_BW_KHZ && kHz != WOR_NARROW_BW_KHZ) return false;
+  uplinkBwKHz = kHz;
+  m_ulBw.set(kHz);
+  return true;
+}
+
+float LORA_uplinkBandwidth() {
+  return uplinkBwKHz;
+}
+
+float LORA_uplinkAirtimeMs(size_t len, uint16_t preambleSymbols) {
+  return WOR_uplinkAirtimeMs(len, preambleSymbols, uplinkBwKHz);
+}
+
+/**
+ * \brief Lee el paquete recibido en escucha, lo decodifica y rearma la escucha.
+ * \details Un reenvío del mismo comando (mismo número de secuencia) se descarta.
+ */
+LoraDownlink LORA_pollDownlink(WorCommand& cmd, AidData& aid, GeoFence& fence) {
+  if (radioMode != LORA_MODE_SNIFF || !dio1Flag) return LORA_DL_NONE;
+  dio1Flag = false;
+
+  LoraDownlink kind = LORA_DL_NONE;
+  uint8_t buf[GEO_FENCE_MAX_LEN];   // la mayor de las tramas de bajada
+  static_assert(GEO_FENCE_MAX_LEN >= AID_FRAME_LEN && GEO_FENCE_MAX_LEN >= WOR_FRAME_LEN, "buffer de bajada");
+  size_t len = radio.getPacketLength();
+  bool read = len <= sizeof(buf) && radio.readData(buf, len) == RADIOLIB_ERR_NONE;
+  if (read && WOR_parseCommand(buf, len, cmd)) {
+    if ((int16_t)cmd.seq == lastCmdSeq) {
+      m_cmdDup.inc();
+    } else {
+      lastCmdSeq = cmd.seq;
+      m_cmdOk.inc();
+      kind = LORA_DL_COMMAND;
+    }
+  } else if (read && AID_parseFrame(buf, len, aid)) {
+    m_aidRx.inc();
+    kind = LORA_DL_AIDING;
+  } else if (read && GEO_parseFence(buf, len, fence)) {
+    m_fenceRx.inc();
+    kind = LORA_DL_FENCE;
+  } else {
+    m_cmdInvalid.inc();
+  }
+
+  // Tras un paquete (o un error) el SX1262 sale del modo duty-cycle
+  LORA_startSniff();
+  return kind;
+}
+
+/**
+ * \brief Radio compartida con la pila LoRaWAN.
+ */
+SX1262& LORA_radio() {
+  return radio;
 }
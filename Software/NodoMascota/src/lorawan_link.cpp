@@ -0,0 +1,200 @@
+/** @file lorawan_link.cpp
+ * @brief Implementación del modo LoRaWAN clase A sobre `LoRaWANNode` de RadioLib.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "lorawan_link.h"
+
+#if defined(LORAWAN_MODE)
+#include "lora_handler.h"
+#include "metrics.h"
+#include <LittleFS.h>
+#include <RadioLib.h>
+
+// ----------------- Configuración -----------------------
+static const char*   LW_NONCES_FILE  = "/lw_nonces.bin";
+static const char*   LW_SESSION_FILE = "/lw_session.bin";
+static const uint32_t LW_MS_PER_HOUR = 36000UL;   // 1 % de la sub-banda g1 (ETSI EN 300 220)
+static const float    LW_DUTY_CYCLE  = 0.01f;
+static const size_t   LW_KEY_LEN     = 16;
+
+// ----------------- Métricas -----------------------------
+METRIC_COUNTER(m_joinAttempts, "lorawan_join_attempts_total", "Join-request enviados");
+METRIC_COUNTER_L(m_upOk,    "lorawan_uplinks_total", "Subidas LoRaWAN por resultado", "result=\"ok\"");
+METRIC_COUNTER_L(m_upError, "lorawan_uplinks_total", "Subidas LoRaWAN por resultado", "result=\"error\"");
+METRIC_COUNTER(m_downlinks, "lorawan_downlinks_total", "Bajadas de aplicación recibidas en RX1/RX2");
+METRIC_GAUGE(m_fcntUp, "lorawan_fcnt_up", "Contador de tramas de subida");
+METRIC_GAUGE(m_dataRate, "lorawan_data_rate", "Data rate de la última subida (EU868 DR0..DR5)");
+
+// ----------------- Estado interno -----------------------
+static LoRaWANNode* s_node       = nullptr;
+static bool         s_fsOk       = false;
+static bool         s_joined     = false;
+static int          s_state      = RADIOLIB_ERR_NONE;
+static uint8_t      s_dr         = 0;          // DR0 hasta la primera subida (peor caso)
+static uint32_t     s_firstJoinMs = 0;
+static uint32_t     s_nextJoinMs = 0;
+static uint32_t     s_joinAttempts = 0;
+
+/**
+ * \brief Lee un buffer persistente completo (false si falta o tiene otro tamaño).
+ */
+static bool loadBuffer(const char* path, uint8_t* buf, size_t len) {
+  if (!s_fsOk) return false;
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+  bool ok = f.size() == len && (size_t)f.read(buf, len) == len;
+  f.close();
+  return ok;
+}
+
+/**
+ * \brief Sobrescribe un buffer persistente.
+ */
+static void saveBuffer(const char* path, const uint8_t* buf, size_t len) {
+  if (!s_fsOk || !buf) return;
+  File f = LittleFS.open(path, "w");
+  if (!f) return;
+  f.write(buf, len);
+  f.close();
+}
+
+/**
+ * \brief Claves de los flags, restauración de la sesión y ajustes de la MAC.
+ */
+bool LW_begin(bool fsOk) {
+  static LoRaWANNode node(&LORA_radio(), &EU868);
+  s_node = &node;
+  s_fsOk = fsOk;
+
+#if defined(LW_ABP)
+  uint8_t nwkSKey[LW_KEY_LEN], appSKey[LW_KEY_LEN];
+  if (!LWP_parseHex(LW_NWK_SKEY, nwkSKey, LW_KEY_LEN) || !LWP_parseHex(LW_APP_SKEY, appSKey, LW_KEY_LEN)) {
+    s_state = RADIOLIB_ERR_INVALID_PAYLOAD;
+    return false;
+  }
+  s_state = node.beginABP(LW_DEV_ADDR, nullptr, nullptr, nwkSKey, appSKey);
+#else
+  uint8_t appKey[LW_KEY_LEN], nwkKey[LW_KEY_LEN];
+  if (!LWP_parseHex(LW_APP_KEY, appKey, LW_KEY_LEN) || !LWP_parseHex(LW_NWK_KEY, nwkKey, LW_KEY_LEN)) {
+    s_state = RADIOLIB_ERR_INVALID_PAYLOAD;
+    return false;
+  }
+  s_state = node.beginOTAA(LW_JOIN_EUI, LW_DEV_EUI, nwkKey, appKey);
+#endif
+  if (s_state != RADIOLIB_ERR_NONE) return false;
+
+  node.setADR(true);
+  node.setDutyCycle(true, LW_MS_PER_HOUR);
+
+  // Sin los nonces, un join tras el reinicio repetiría DevNonce
+  uint8_t nonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+  uint8_t session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+  if (loadBuffer(LW_NONCES_FILE, nonces, sizeof(nonces))) node.setBufferNonces(nonces);
+  if (loadBuffer(LW_SESSION_FILE, session, sizeof(session))) node.setBufferSession(session);
+
+#if defined(LW_ABP)
+  s_state  = node.activateABP();
+  s_joined = s_state == RADIOLIB_ERR_NONE || s_state == RADIOLIB_LORAWAN_NEW_SESSION ||
+             s_state == RADIOLIB_LORAWAN_SESSION_RESTORED;
+#else
+  s_joined = node.isActivated();   // sesión OTAA restaurada
+#endif
+  s_firstJoinMs = millis();
+  s_nextJoinMs  = s_firstJoinMs;
+  return true;
+}
+
+/**
+ * \brief Un Join-request; sin respuesta, espera según el tramo del duty-cycle de join.
+ */
+void LW_tick() {
+  if (!s_node || s_joined || (int32_t)(millis() - s_nextJoinMs) < 0) return;
+
+  m_joinAttempts.inc();
+  s_joinAttempts++;
+  s_state = s_node->activateOTAA();
+  saveBuffer(LW_NONCES_FILE, s_node->getBufferNonces(), RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+
+  if (s_state == RADIOLIB_LORAWAN_NEW_SESSION || s_state == RADIOLIB_LORAWAN_SESSION_RESTORED) {
+    s_joined = true;
+    saveBuffer(LW_SESSION_FILE, s_node->getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    return;
+  }
+  // El join se envía con el DR más robusto: su aire fija la espera
+  float air = LWP_airtimeMs(0, LWP_JOIN_REQUEST_LEN);
+  s_nextJoinMs = millis() + LWP_joinDelayMs(millis() - s_firstJoinMs, air);
+}
+
+bool LW_isJoined() {
+  return s_joined;
+}
+
+/**
+ * \brief Subida, guardado de la sesión (FCntUp) y clasificación de la bajada.
+ */
+LwpDownlink LW_send(uint8_t port, const uint8_t* data, size_t len, WorCommand& cmd, AidData& aid) {
+  if (!s_node || !s_joined) {
+    s_state = RADIOLIB_ERR_INVALID_PAYLOAD;
+    return LWP_DL_NONE;
+  }
+  uint8_t down[64];
+  size_t  downLen = 0;
+  LoRaWANEvent_t up{}, dn{};
+  s_state = s_node->sendReceive(data, len, port, down, &downLen, false, &up, &dn);
+  if (s_state < RADIOLIB_ERR_NONE) {
+    m_upError.inc();
+    return LWP_DL_NONE;
+  }
+  m_upOk.inc();
+  s_dr = up.datarate;
+  m_dataRate.set(s_dr);
+  m_fcntUp.set((float)up.fCnt);
+  saveBuffer(LW_SESSION_FILE, s_node->getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+
+  if (s_state == 0 || downLen == 0) return LWP_DL_NONE;   // sin bajada o sólo comandos MAC
+  m_downlinks.inc();
+  return LWP_parseDownlink(dn.fPort, down, downLen, cmd, aid);
+}
+
+int LW_lastState() {
+  return s_state;
+}
+
+uint32_t LW_timeUntilUplinkMs() {
+  return s_node ? (uint32_t)s_node->timeUntilUplink() : 0;
+}
+
+/**
+ * \brief Aire de la subida con el data rate de la última (o DR0) y el periodo resultante.
+ */
+uint16_t LW_periodS(uint16_t wantedS, size_t len) {
+  return LWP_periodS(LW_airtimeMs(len), wantedS, LW_DUTY_CYCLE);
+}
+
+float LW_airtimeMs(size_t len) {
+  return LWP_airtimeMs(s_dr, len + LWP_FRAME_OVERHEAD);
+}
+
+void LW_report(Stream& port) {
+#if defined(LW_ABP)
+  port.print("[LW] ABP");
+#else
+  port.print("[LW] OTAA");
+#endif
+  port.print(s_joined ? " sesion activa" : " sin sesion");
+  port.print(" joins="); port.print(s_joinAttempts);
+  port.print(" DR="); port.print(s_dr);
+  port.print(" FCntUp="); port.print(s_node ? s_node->getFCntUp() : 0);
+  port.print(" estado="); port.println(s_state);
+  if (!s_joined && s_node) {
+    port.print("[LW] proximo join en ");
+    int32_t wait = (int32_t)(s_nextJoinMs - millis());
+    port.print(wait > 0 ? wait / 1000 : 0);
+    port.println(" s");
+  }
+}
+
+#endif   // LORAWAN_MODE
@@ -0,0 +1,84 @@
+/** @file lorawan_policy.cpp
+ * @brief Implementación de las reglas del modo LoRaWAN (aire, periodo, join, bajadas).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "lorawan_policy.h"
+#include "tx_scheduler.h"
+#include <math.h>
+
+// ----------------- Modulación EU868 (125 kHz) -----------------
+static const float   LWP_BW_KHZ   = 125.0f;
+static const uint8_t LWP_CR       = 1;      // 4/5
+static const uint8_t LWP_PREAMBLE = 8;
+
+// ----------------- Duty-cycle de los join (LoRaWAN 1.0.4 §7) ---
+static const uint32_t JOIN_TIER1_MS = 3600000UL;     // primera hora: 1 %
+static const uint32_t JOIN_TIER2_MS = 39600000UL;    // hasta las 11 h: 0,1 %
+
+/**
+ * \brief Fórmula de la nota AN1200.13 de Semtech.
+ */
+float LWP_airtimeMs(uint8_t dr, size_t phyLen) {
+  if (dr > LWP_DR_MAX) dr = LWP_DR_MAX;
+  const int   sf   = 12 - dr;
+  const int   de   = sf >= 11 ? 1 : 0;
+  const float tSym = (float)(1UL << sf) / LWP_BW_KHZ;
+  const float tPre = (LWP_PREAMBLE + 4.25f) * tSym;
+  const int   num  = 8 * (int)phyLen - 4 * sf + 28 + 16;
+  int nPayload = 8;
+  if (num > 0) nPayload += (int)ceilf((float)num / (4.0f * (sf - 2 * de))) * (LWP_CR + 4);
+  return tPre + nPayload * tSym;
+}
+
+/**
+ * \brief La regla es la del enlace propio (tx_scheduler).
+ */
+uint16_t LWP_periodS(float airtimeMs, uint16_t wantedS, float dutyFraction) {
+  return TXS_dutyPeriodS(airtimeMs, wantedS, dutyFraction);
+}
+
+/**
+ * \brief off = aire · (1/dc − 1): de media, el dc del tramo en que se hizo el intento.
+ */
+uint32_t LWP_joinDelayMs(uint32_t sinceBootMs, float joinAirtimeMs) {
+  float dc = sinceBootMs < JOIN_TIER1_MS ? 0.01f : sinceBootMs < JOIN_TIER2_MS ? 0.001f : 0.0001f;
+  return (uint32_t)ceilf(joinAirtimeMs * (1.0f / dc - 1.0f));
+}
+
+/**
+ * \brief Valor de un dígito hexadecimal (−1 si no lo es).
+ */
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * \brief Dos dígitos por byte, el más significativo primero (orden MSB de las consolas LNS).
+ */
+bool LWP_parseHex(const char* hex, uint8_t* out, size_t outLen) {
+  if (!hex || !out) return false;
+  for (size_t i = 0; i < outLen; i++) {
+    if (!hex[2 * i] || !hex[2 * i + 1]) return false;
+    int hi = hexDigit(hex[2 * i]), lo = hexDigit(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0) return false;
+    out[i] = (uint8_t)(hi << 4 | lo);
+  }
+  return hex[2 * outLen] == '\0';
+}
+
+/**
+ * \brief El puerto decide el formato; el contenido se valida con el códec de cada trama.
+ */
+LwpDownlink LWP_parseDownlink(uint8_t port, const uint8_t* buf, size_t len,
+                              WorCommand& cmd, AidData& aid) {
+  if (!buf || len == 0) return LWP_DL_NONE;
+  if (port == LWP_PORT_COMMAND && WOR_parseCommand(buf, len, cmd)) return LWP_DL_COMMAND;
+  if (port == LWP_PORT_AIDING && AID_parseFrame(buf, len, aid))    return LWP_DL_AIDING;
+  return LWP_DL_NONE;
+}
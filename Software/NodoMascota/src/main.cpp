@@ -6,10 +6,30 @@
  * - Actualiza continuamente el parser GNSS.
  * - Construye payloads de 13 B (fix, hhmmss, lat*1e5, lon*1e5) y los transmite por LoRa
  *   con temporización periódica (p.ej., cada N segundos).
+ * - Registra todos los fixes (1 Hz) en flash y los exporta por USB (track_log).
+ * - Registra la línea temporal de arranque (fases, primer fix, primera TX).
+ * - Entre envíos escucha comandos de la base (wake-on-radio, ver wake_radio.h)
+ *   y el RP2040 duerme con WFI hasta la siguiente interrupción.
+ * - Inyecta en el receptor la asistencia GNSS de la base (hora y posición
+ *   aproximadas) y mide el TTFF con y sin ella.
+ * - Con `-DLORAWAN_MODE` (entorno `rpipico_lorawan`) envía por LoRaWAN clase A
+ *   (lorawan_link.h) en lugar del protocolo privado: sin escucha entre envíos,
+ *   bajadas en RX1/RX2 y periodo ajustado al data rate que fije el ADR.
+ * - Tras una posición, si toca, envía la trama de salud (reinicios, TTFF, fallos
+ *   de TX, temperatura, márgenes; ver health_monitor.h) dentro de su presupuesto
+ *   de duty-cycle.
+ * - Comprueba cada fix frente a la valla de casa que envía la base (geofence.h,
+ *   guardada en `/fence.bin`): al salir o volver transmite una alerta sin
+ *   esperar al turno (como mucho una cada GEO_ALERT_GAP_S, con su aire
+ *   descontado del 1 % de las posiciones), y mientras está fuera envía cada
+ *   GEO_BREACH_PERIOD_S.
+ * - Aprende qué horas del día suele moverse la mascota (activity_plan.h,
+ *   guardado en `/activity.bin`): en las tranquilas alarga el periodo y duerme
+ *   el GNSS entre envíos, y vuelve al periodo normal si se mueve sin esperarlo.
  * - Muestra estado por LCD y expone portal web para configuración WiFi.
  *
- * @note La temporización por `SS % PERIOD == 0` es válida para PERIOD < 60;
- *       para periodos mayores, usar planificador por `millis()`.
+ * @note La temporización (tx_scheduler) usa los segundos del día UTC: cualquier
+ *       PERIOD divisor de 86400 es válido.
  *
  * @author Verónica Lechón Rodríguez
  * @date 23/07/2025
@@ -18,68 +38,547 @@
 #include <Arduino.h>
 #include "gps_handler.h"
 #include "lora_handler.h"
+#include "track_log.h"
+#include "hot_path.h"
+#include "metrics.h"
+#include "tx_scheduler.h"
+#include "boot_timeline.h"
+#include "wake_radio.h"
+#include "health_monitor.h"
+#include "geofence.h"
+#include "activity_plan.h"
+#if defined(LORAWAN_MODE)
+  #include "lorawan_link.h"
+#endif
+#include <hardware/sync.h>
+#include <pico/time.h>
+#include <LittleFS.h>
+#include <string.h>
 
 static uint8_t payload[13];
+static uint8_t healthFrame[HLT_FRAME_LEN];
 
 // ----------------- Configuración -----------------
 static const uint32_t GPS_BAUD = 9600;
 /**
- * \brief Segundos entre envíos.
- * \warning Válido con esta lógica sólo para PERIOD < 60
+ * \brief Segundos entre envíos (divisor de 86400, ver tx_scheduler.h).
  */
 static const uint16_t PERIOD   = 10;   // 10->10 s
+/** Preámbulo de las posiciones (símbolos, el de LORA_begin()). */
+static const uint16_t UPLINK_PREAMBLE = 8;
+/** Copia de la valla de casa (la misma trama que envía la base). */
+static const char* FENCE_FILE  = "/fence.bin";
+/** Perfil de actividad por hora (se guarda cada vez que se aprende una hora). */
+static const char* ACTIVITY_FILE = "/activity.bin";
 
 // ----------------- Estado -----------------
-static uint32_t lastSentHHMMSS = 0;
+static uint32_t lastLoggedHHMMSS = 0;
 static bool txInProgress = false;
+/** La base pidió la posición (WOR_CMD_PING): se envía con el próximo fix. */
+static bool txRequested = false;
+/** La TX en curso es la trama de salud (no se encadena otra tras ella). */
+static bool txIsHealth = false;
+/** Periodo pedido (PERIOD o comando de la base); en LoRaWAN puede alargarse por el duty-cycle. */
+static uint16_t wantedPeriod = PERIOD;
+/** LittleFS montado (TRACK_begin()). */
+static bool fsOk = false;
+static uint8_t geoFrame[GEO_ALERT_LEN];
+/** La TX en curso es una alerta de valla (tampoco encadena la de salud). */
+static bool txIsAlert = false;
+/** Venció el plazo del GNSS dormido (lo levanta la alarma hardware). */
+static volatile bool gnssWakeDue = false;
+
+METRIC_COUNTER(m_actBoosts, "activity_unexpected_motion_total", "Movimientos en horas tranquilas (periodo normal durante ACT_BOOST_S)");
+METRIC_COUNTER(m_actHours, "activity_hours_learned_total", "Horas incorporadas al perfil de actividad");
+
+/**
+ * \brief Periodo que respeta el duty-cycle del 1 % (divisor de 86400, no menor
+ *        que \p wantS) con la modulación actual de las posiciones del enlace propio.
+ * \details Con valla, las alertas (una cada GEO_ALERT_GAP_S como mucho) salen
+ *          del mismo 1 %: su parte se descuenta antes de repartir el resto.
+ */
+static uint16_t dutyPeriodS(uint16_t wantS) {
+#if defined(LORAWAN_MODE)
+  return TXS_dutyPeriodS(0.0f, wantS, 0.0f);   // el aire depende del ADR: lo aplica applyPeriod()
+#else
+  float airMs = LORA_uplinkAirtimeMs(sizeof(payload), UPLINK_PREAMBLE);
+  float duty  = HLT_DUTY_CYCLE;
+  if (GEO_fence().count > 0) {
+    duty -= LORA_uplinkAirtimeMs(GEO_ALERT_LEN, UPLINK_PREAMBLE) / (1000.0f * GEO_ALERT_GAP_S);
+  }
+  return TXS_dutyPeriodS(airMs, wantS, duty);
+#endif
+}
+
+/**
+ * \brief Aplica el periodo pedido, alargado en las horas tranquilas del horario
+ *        aprendido y más corto fuera de la valla, sin pasar del duty-cycle del
+ *        1 % (en LoRaWAN, con el data rate actual).
+ * \details También rehace el intervalo de la trama de salud: se llama en cada
+ *          cambio de modulación (ancho de banda de subida, data rate del ADR).
+ */
+static void applyPeriod() {
+  uint16_t want = ACT_periodS(GPS_hhmmssToSod(lastLoggedHHMMSS), wantedPeriod);
+  if (GEO_isOutside() && GEO_BREACH_PERIOD_S < want) want = GEO_BREACH_PERIOD_S;
+#if defined(LORAWAN_MODE)
+  uint16_t p = LW_periodS(want, sizeof(payload));
+  MON_setAirtime(LW_airtimeMs(HLT_FRAME_LEN));
+#else
+  uint16_t p = dutyPeriodS(want);   // también el de fuera de la valla: nunca por encima del 1 %
+  MON_setAirtime(LORA_uplinkAirtimeMs(HLT_FRAME_LEN, UPLINK_PREAMBLE));
+#endif
+  if (p != TXS_period()) TXS_begin(p);
+}
+
+/**
+ * \brief Tabla de ajustes de escucha: corriente añadida frente a latencia de comando.
+ */
+static void printSniffTable(Stream& port) {
+  port.println("[SNIFF] n  rx_ms  sleep_ms  preamb  +uA    latencia_ms");
+  for (uint8_t i = 0; i < WOR_presetCount(); i++) {
+    const WorSniffPreset& p = WOR_preset(i);
+    char line[72];
+    snprintf(line, sizeof(line), "[SNIFF] %u%c %5lu  %8lu  %6u  %5.1f  %6.0f", i,
+             i == LORA_sniffPreset() ? '*' : ' ',
+             (unsigned long)(p.rxUs / 1000UL), (unsigned long)(p.sleepUs / 1000UL),
+             WOR_preambleSymbols(i), (double)WOR_addedCurrentUa(i),
+             (double)WOR_commandLatencyMs(i));
+    port.println(line);
+  }
+}
+
+/**
+ * \brief Aplica un comando recibido de la base.
+ */
+static void applyCommand(const WorCommand& cmd) {
+  Serial.print("[CMD] seq="); Serial.print(cmd.seq);
+  switch (cmd.cmd) {
+    case WOR_CMD_PING:
+      txRequested = true;
+      GPS_wake();   // si dormía, la posición sale con el primer fix
+      Serial.println(" PING");
+      break;
+    case WOR_CMD_SET_PERIOD:
+      wantedPeriod = dutyPeriodS(cmd.param);
+      TXS_begin(wantedPeriod);
+      applyPeriod();
+      Serial.print(" PERIOD="); Serial.println(TXS_period());
+      break;
+    case WOR_CMD_SET_SNIFF:
+      Serial.print(" SNIFF=");
+      Serial.println(LORA_setSniffPreset((uint8_t)cmd.param) ? cmd.param : LORA_sniffPreset());
+      break;
+#if defined(LORAWAN_MODE)
+    case WOR_CMD_FREQ_CORR:
+    case WOR_CMD_SET_UL_BW:
+      Serial.println(" no aplica en LoRaWAN");   // la pila fija frecuencia y modulación
+      break;
+#else
+    case WOR_CMD_FREQ_CORR:
+      LORA_adjustFrequency((int16_t)cmd.param);
+      Serial.print(" FREQ_CORR="); Serial.print((int16_t)cmd.param);
+      Serial.print(" total="); Serial.println(LORA_freqCorrectionHz());
+      break;
+    case WOR_CMD_SET_UL_BW:
+      LORA_setUplinkBandwidth(cmd.param ? WOR_NARROW_BW_KHZ : LORA_BW_KHZ);
+      applyPeriod();   // más aire por trama: periodo e intervalo de salud
+      Serial.print(" UL_BW="); Serial.println(LORA_uplinkBandwidth(), 1);
+      break;
+#endif
+  }
+}
+
+/**
+ * \brief Inyecta la asistencia GNSS recibida.
+ * \param ageMs Tiempo desde que se selló la hora.
+ */
+static void applyAiding(const AidData& aid, uint32_t ageMs) {
+  bool used = GPS_applyAiding(aid, ageMs);
+  Serial.print("[AID] utc="); Serial.print(aid.utc);
+  Serial.print(" lat="); Serial.print(aid.lat, 2);
+  Serial.print(" lon="); Serial.print(aid.lon, 2);
+  Serial.println(used ? " inyectada" : " ignorada (con fix)");
+}
+
+/**
+ * \brief Restaura la valla guardada (sin fichero o no válido: sin valla).
+ */
+static void loadFence() {
+  File f = fsOk ? LittleFS.open(FENCE_FILE, "r") : File();
+  if (!f) return;
+  uint8_t buf[GEO_FENCE_MAX_LEN];
+  size_t len = f.read(buf, sizeof(buf));
+  f.close();
+  GeoFence fence;
+  if (GEO_parseFence(buf, len, fence)) GEO_setFence(fence);
+}
+
+/**
+ * \brief Activa y guarda la valla recibida; una repetida no reinicia el estado.
+ */
+static void applyFence(const GeoFence& fence) {
+  uint8_t next[GEO_FENCE_MAX_LEN], cur[GEO_FENCE_MAX_LEN];
+  size_t len = GEO_buildFence(fence, next, sizeof(next));
+  Serial.print("[GEO] Valla id="); Serial.print(fence.id);
+  Serial.print(" vertices="); Serial.print(fence.count);
+  if (len == GEO_buildFence(GEO_fence(), cur, sizeof(cur)) && memcmp(next, cur, len) == 0) {
+    Serial.println(" (repetida)");
+    return;
+  }
+  GEO_setFence(fence);
+  applyPeriod();
+  File f = fsOk ? LittleFS.open(FENCE_FILE, "w") : File();
+  bool saved = f && f.write(next, len) == len;
+  if (f) f.close();
+  Serial.println(saved ? " guardada" : " (sin guardar: se pierde al reiniciar)");
+}
+
+/**
+ * \brief Evalúa un fix nuevo frente a la valla (la alerta la decide GEO_alertDue()).
+ */
+static void serviceFence(const GpsInfo& info) {
+  GeoEvent ev = GEO_update(info);
+  if (ev == GEO_EV_NONE) return;
+  applyPeriod();
+  Serial.print(ev == GEO_EV_BREACH ? "[GEO] SALIDA" : "[GEO] Vuelta");
+  Serial.print(" hhmmss="); Serial.print(info.hhmmss);
+  Serial.print(" periodo="); Serial.println(TXS_period());
+}
+
+/**
+ * \brief Restaura el perfil de actividad guardado (sin fichero o no válido: vacío).
+ */
+static void loadActivity() {
+  ACT_begin();
+  File f = fsOk ? LittleFS.open(ACTIVITY_FILE, "r") : File();
+  if (!f) return;
+  uint8_t buf[sizeof(ActProfile)];
+  size_t len = f.read(buf, sizeof(buf));
+  f.close();
+  ACT_load(buf, len);
+}
+
+/**
+ * \brief Aprende del fix nuevo, guarda el perfil al cerrar cada hora y ajusta el periodo.
+ */
+static void serviceActivity(const GpsInfo& info) {
+  uint8_t ev = ACT_observe(GPS_hhmmssToSod(info.hhmmss), info.lat, info.lon);
+  if (ev & ACT_EV_HOUR) {
+    m_actHours.inc();
+    File f = fsOk ? LittleFS.open(ACTIVITY_FILE, "w") : File();
+    if (f) {
+      f.write((const uint8_t*)&ACT_profile(), sizeof(ActProfile));
+      f.close();
+    }
+  }
+  if (ev & ACT_EV_MOTION) {
+    m_actBoosts.inc();
+    Serial.print("[ACT] Movimiento en hora tranquila hhmmss="); Serial.println(info.hhmmss);
+  }
+  applyPeriod();
+}
+
+static int64_t onGnssWakeAlarm(alarm_id_t, void*) {
+  gnssWakeDue = true;
+  return 0;   // sin repetición
+}
+
+/**
+ * \brief Tras enviar una posición, duerme el GNSS si el horario lo permite.
+ * \details No duerme fuera de la valla (la comprueba cada segundo) ni con una
+ *          petición o alerta pendiente. Una alarma hardware saca a loop() del
+ *          WFI al vencer el plazo, porque sin NMEA no hay otra interrupción.
+ */
+static void maybeSleepGnss(uint32_t hhmmss) {
+  if (GEO_isOutside() || txRequested || GEO_alertPending()) return;
+  uint32_t s = ACT_gnssSleepS(GPS_hhmmssToSod(hhmmss), wantedPeriod);
+  if (!s || add_alarm_in_ms(s * 1000UL, onGnssWakeAlarm, nullptr, true) <= 0) return;
+  GPS_sleep(s * 1000UL);
+  Serial.print("[ACT] GNSS dormido "); Serial.print(s); Serial.println(" s");
+}
+
+/**
+ * \brief Plan de las 24 horas: actividad aprendida, días, periodo y GNSS.
+ */
+static void printPlan(Stream& port) {
+  const ActProfile& p = ACT_profile();
+  port.println("[PLAN] hora  actividad  dias  periodo_s  gnss");
+  for (uint8_t h = 0; h < ACT_HOURS; h++) {
+    ActHourPlan hp = ACT_plan(h, wantedPeriod);
+    char line[64];
+    snprintf(line, sizeof(line), "[PLAN] %02u    %5.1f %%   %4u  %9u  %s", h,
+             p.activity[h] * 100.0 / 255.0, p.days[h], hp.periodS, hp.gnssSleep ? "duerme" : "activo");
+    port.println(line);
+  }
+  port.println(ACT_isBoosted(GPS_hhmmssToSod(lastLoggedHHMMSS)) ? "[PLAN] refuerzo activo" : "[PLAN] sin refuerzo");
+}
+
+#if defined(LORAWAN_MODE)
+/** La bajada llega en RX1 (1 s tras la subida) con la hora sellada al programarla. */
+static const uint32_t LW_AID_AGE_MS = 1000;
+
+/**
+ * \brief Atiende la bajada recibida en las ventanas RX1/RX2 de una subida.
+ */
+static void applyLorawanDownlink(LwpDownlink dl, const WorCommand& cmd, const AidData& aid) {
+  if (dl == LWP_DL_COMMAND)     applyCommand(cmd);
+  else if (dl == LWP_DL_AIDING) applyAiding(aid, LW_AID_AGE_MS);
+}
+
+/**
+ * \brief Subida de la posición y, si toca, de la trama de salud (bloqueante, clase A).
+ * \return true si la posición se envió.
+ */
+static bool sendLorawan(const uint8_t* data, size_t len) {
+  WorCommand cmd;
+  AidData aid;
+  LwpDownlink dl = LW_send(LWP_PORT_POSITION, data, len, cmd, aid);
+  bool ok = LW_lastState() >= 0;
+  MON_noteTx(ok ? RADIOLIB_ERR_NONE : LW_lastState());
+  if (!ok) {
+    Serial.print("[LW] TX FAIL, code ");
+    Serial.println(LW_lastState());
+    return false;
+  }
+  Serial.println("[LW] TX OK");
+  if (BOOT_event("first_tx")) BOOT_report(Serial);
+  applyLorawanDownlink(dl, cmd, aid);
+
+  if (MON_isDue() && LW_timeUntilUplinkMs() == 0 &&
+      MON_buildFrame(healthFrame, sizeof(healthFrame)) == HLT_FRAME_LEN) {
+    dl = LW_send(LWP_PORT_HEALTH, healthFrame, HLT_FRAME_LEN, cmd, aid);
+    MON_noteTx(LW_lastState() >= 0 ? RADIOLIB_ERR_NONE : LW_lastState());
+    if (LW_lastState() >= 0) {
+      MON_markSent();
+      applyLorawanDownlink(dl, cmd, aid);
+    }
+  }
+  applyPeriod();   // el ADR puede haber cambiado el data rate
+  return true;
+}
+#endif
+
+/**
+ * \brief Lee líneas de la consola USB (CDC) y las despacha a los módulos.
+ * \details Comandos de una línea terminados en '\n' (ver TRACK_handleCommand()).
+ *          `PROF` vuelca el perfilado de la ruta crítica (build con HOT_PROFILE) y
+ *          `METRICS` las métricas en formato de texto de Prometheus, `BOOT` la
+ *          línea temporal de arranque, `SNIFF?` / `SNIFF n` la tabla y el
+ *          ajuste de escucha (wake-on-radio), `TTFF` la distribución del tiempo
+ *          hasta el fix con y sin asistencia, `HEALTH` el contenido de la
+ *          trama de salud, `GEO` la valla activa y su estado, `PLAN` el
+ *          horario aprendido (`PLAN RESET` lo olvida) y `LORAWAN` el
+ *          estado de la sesión (modo LoRaWAN).
+ */
+static void serviceConsole() {
+  static String line;
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (line.length() < 32) line += c;
+      continue;
+    }
+    line.trim();
+    if (line == "SNIFF?") {
+      printSniffTable(Serial);
+    } else if (line.startsWith("SNIFF ")) {
+      bool ok = LORA_setSniffPreset((uint8_t)line.substring(6).toInt());
+      Serial.println(ok ? "OK" : "ERR");
+    } else if (line == "TTFF") {
+      GPS_acqReport(Serial);
+    } else if (line == "HEALTH") {
+      MON_report(Serial);
+    } else if (line == "PLAN") {
+      printPlan(Serial);
+    } else if (line == "PLAN RESET") {
+      ACT_begin();
+      if (fsOk) LittleFS.remove(ACTIVITY_FILE);
+      applyPeriod();
+      Serial.println("OK");
+    } else if (line == "GEO") {
+      const GeoFence& f = GEO_fence();
+      Serial.print("[GEO] id="); Serial.print(f.id);
+      Serial.print(" vertices="); Serial.print(f.count);
+      Serial.println(f.count == 0 ? " (sin valla)" : GEO_isOutside() ? " fuera" : " dentro");
+#if defined(LORAWAN_MODE)
+    } else if (line == "LORAWAN") {
+      LW_report(Serial);
+#endif
+    } else if (line == "BOOT") {
+      BOOT_report(Serial);
+    } else if (line == "PROF") {
+      HOT_report(Serial, true);
+    } else if (line == "METRICS") {
+      METRICS_render([](const char* data, size_t len, void*) {
+        Serial.write((const uint8_t*)data, len);
+      }, nullptr);
+    } else if (line.length() > 0 && !TRACK_handleCommand(line, Serial)) {
+      Serial.print("[USB] Comando desconocido: ");
+      Serial.println(line);
+    }
+    line = "";
+  }
+}
 
 void setup() {
+  BOOT_event("setup");
+  // Sin esperar al USB CDC: los mensajes de arranque pueden perderse si no hay
+  // terminal abierto, pero el informe BOOT se repite tras la primera TX.
   Serial.begin(115200);
-  delay(800);
-
   Serial.println("\n[GPS TEST] Arrancando...");
 
+  // GNSS primero: el UART empieza a llenarse mientras se configuran radio y FS
+  BootPhase phase = BOOT_start("gps");
   bool ok = GPS_begin(GPS_BAUD);
+  BOOT_end(phase);
   Serial.println(ok ? "GPS OK" : "GPS FAIL");
 
-  if (!LORA_begin(868.0)) {
+  phase = BOOT_start("lora");
+  ok = LORA_begin(868.0);
+  BOOT_end(phase);
+  if (!ok) {
     Serial.print("[LoRa] INIT FAIL, code ");
     Serial.println(LORA_lastState());
     // En el prototipo seguimos ejecutando para poder ver los logs de GPS
   } else {
     Serial.println("[LoRa] INIT OK");
+#if !defined(LORAWAN_MODE)
+    LORA_startSniff();   // escucha comandos de la base hasta el primer envío
+#endif
+  }
+  GPS_update();
+
+  TXS_begin(PERIOD);
+
+  phase = BOOT_start("track_fs");
+  ok = TRACK_begin();
+  BOOT_end(phase);
+  if (!ok) {
+    Serial.println("[TRACK] FS FAIL (registro local deshabilitado)");
+  }
+  MON_begin(ok);   // contador de arranques en el mismo LittleFS
+  fsOk = ok;
+  loadFence();
+  loadActivity();
+#if defined(LORAWAN_MODE)
+  // Sesión y nonces en el mismo LittleFS; el join se intenta desde loop()
+  if (!LW_begin(ok)) {
+    Serial.print("[LW] INIT FAIL, code ");
+    Serial.println(LW_lastState());
   }
+  applyPeriod();
+#endif
+  GPS_update();
+
+  BOOT_event("ready");
 }
 
 void loop() {
-  // 1) Actualizar GPS siempre (alimentar parser NMEA)
+  HOT_loopMark();
+  MON_loopStart();
+
+  // 1) Actualizar GPS siempre (alimentar parser NMEA); despertarlo si toca
+  if (gnssWakeDue) {
+    gnssWakeDue = false;
+    GPS_wake();
+  }
   GPS_update();
+  GPS_acqTick();
+
+  // 1b) Consola USB (volcado del registro de trayectoria)
+  serviceConsole();
 
+#if defined(LORAWAN_MODE)
+  // 2) LoRaWAN: join pendiente (las bajadas llegan con cada subida)
+  LW_tick();
+#else
   // 2) Cerrar TX previa si terminó (una sola vez por paquete)
   if (txInProgress && LORA_isTxDone()) {
-    if (LORA_lastState() == RADIOLIB_ERR_NONE) {
-      Serial.println("[LoRa] TX OK");
+    bool txOk = LORA_lastState() == RADIOLIB_ERR_NONE;
+    MON_noteTx(LORA_lastState());
+    if (txOk) {
+      Serial.println(txIsHealth ? "[LoRa] TX salud OK" : txIsAlert ? "[LoRa] TX alerta OK" : "[LoRa] TX OK");
+      if (BOOT_event("first_tx")) BOOT_report(Serial);
     } else {
       Serial.print("[LoRa] TX FAIL, code ");
       Serial.println(LORA_lastState());
     }
     LORA_finishTx();          // limpieza explícita
     txInProgress = false;
+
+    // La trama de salud va justo detrás de una posición (hueco que la base ya
+    // reserva tras cada trama); si no toca, se vuelve a escuchar
+    bool wasPosition = !txIsHealth && !txIsAlert;
+    txIsHealth = false;
+    txIsAlert  = false;
+    if (txOk && wasPosition && MON_isDue() &&
+        MON_buildFrame(healthFrame, sizeof(healthFrame)) == HLT_FRAME_LEN) {
+      if (LORA_startTx(healthFrame, HLT_FRAME_LEN)) {
+        txInProgress = true;
+        txIsHealth   = true;
+        MON_markSent();
+      } else {
+        MON_noteTx(LORA_lastState());
+      }
+    }
+    if (!txInProgress) LORA_startSniff();   // vuelve a escuchar hasta el próximo envío
+  }
+
+  // 2b) Comando, asistencia GNSS o valla de la base recibidos durante la escucha
+  WorCommand cmd;
+  AidData aid;
+  GeoFence fence;
+  LoraDownlink dl = txInProgress ? LORA_DL_NONE : LORA_pollDownlink(cmd, aid, fence);
+  if (dl == LORA_DL_COMMAND) {
+    applyCommand(cmd);
+  } else if (dl == LORA_DL_AIDING) {
+    // La base sella la hora al empezar a transmitir: se compensa el aire de la trama
+    applyAiding(aid, (uint32_t)WOR_airtimeMs(AID_FRAME_LEN, WOR_preambleSymbols(LORA_sniffPreset())));
+  } else if (dl == LORA_DL_FENCE) {
+    applyFence(fence);
   }
+#endif
 
   // 3) Si hay fix válido (posición + hora)
   if (GPS_hasFix()) {
     GpsInfo info = GPS_getInfo();
 
+    // Registro local a resolución completa (un fix por segundo)
+    if (info.valid && info.hhmmss != lastLoggedHHMMSS) {
+      TRACK_append(info);
+      lastLoggedHHMMSS = info.hhmmss;
+      BOOT_event("first_fix");
+      serviceFence(info);
+      serviceActivity(info);
+    }
+
+#if !defined(LORAWAN_MODE)
+    // Alerta de valla: sale sin esperar al turno del planificador, con la
+    // posición actual, si pasó GEO_ALERT_GAP_S desde la anterior. Si se pierde
+    // no se repite; las posiciones fuera ya van cada GEO_BREACH_PERIOD_S
+    bool geoOut;
+    if (info.valid && !txInProgress && GEO_alertDue(millis(), geoOut)) {
+      GEO_alertSent(millis());
+      GeoAlert a{GEO_fence().id, geoOut, info};
+      if (GEO_buildAlert(a, geoFrame, sizeof(geoFrame)) == GEO_ALERT_LEN) {
+        if (LORA_startTx(geoFrame, GEO_ALERT_LEN)) {
+          txInProgress = true;
+          txIsAlert    = true;
+          TXS_markSent(info.hhmmss);   // la alerta ya lleva esta posición
+          Serial.println("[GEO] Alerta enviada");
+        } else {
+          MON_noteTx(LORA_lastState());
+        }
+      }
+    }
+#endif
+
     if (info.valid && !txInProgress) {
-      // Evita doble envío en el mismo segundo
-      bool nuevoSegundo = (info.hhmmss != lastSentHHMMSS);
-
-      // === Temporización basada en SS (segundo dentro del minuto) ===
-      // Enviar cuando SS % PERIOD == 0
-      // LIMITACIÓN: sólo correcto para PERIOD < 60
-      uint8_t ss = info.hhmmss % 100;     // extrae SS de HHMMSS
-      if (nuevoSegundo && (ss % PERIOD == 0)) {
+      // === Temporización alineada con la hora GNSS ===
+      // Enviar en un segundo nuevo cuando (segundos del día) % PERIOD == 0,
+      // o en cuanto haya fix si la base lo ha pedido
+      if (TXS_isDue(info.hhmmss) || txRequested) {
         size_t len = GPS_buildBinaryPayload(info, payload, sizeof(payload));
         if (len == 13) {
           // Dump HEX (debug)
@@ -99,19 +598,41 @@ void loop() {
             Serial.print(" lon="); Serial.println(check.lon, 6);
           }
 
+#if defined(LORAWAN_MODE)
+          // Transmitir por LoRaWAN (bloqueante: subida + RX1/RX2)
+          if (!LW_isJoined()) {
+            Serial.println("[LW] sin sesion, se omite el envio");
+            TXS_markSent(info.hhmmss);
+          } else if (LW_timeUntilUplinkMs() > 0) {
+            Serial.println("[LW] duty-cycle agotado, se omite el envio");
+            TXS_markSent(info.hhmmss);
+          } else {
+            TXS_markSent(info.hhmmss);
+            if (sendLorawan(payload, len)) {
+              txRequested = false;
+              maybeSleepGnss(info.hhmmss);
+            }
+          }
+#else
           // Transmitir por LoRa (asíncrono)
           if (LORA_startTx(payload, len)) {
             txInProgress = true;
-            lastSentHHMMSS = info.hhmmss;
+            txRequested  = false;
+            TXS_markSent(info.hhmmss);
             Serial.println("[LoRa] TX started");
+            maybeSleepGnss(info.hhmmss);
           } else {
+            MON_noteTx(LORA_lastState());
             Serial.print("[LoRa] startTx FAILED, code ");
             Serial.println(LORA_lastState());
           }
+#endif
         }
       }
     }
   }
 
-  delay(1);
+  // 4) Dormir hasta la siguiente interrupción (DIO1, UART del GNSS, USB o alarma)
+  MON_loopEnd();
+  __wfi();
 }
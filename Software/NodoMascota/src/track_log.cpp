@@ -0,0 +1,239 @@
+/** @file track_log.cpp
+ * @brief Implementación del registro local de trayectoria en flash (LittleFS).
+ *
+ * Este módulo:
+ * - Codifica cada fix como registro clave (13 B) o delta (típicamente 3 B a 1 Hz).
+ * - Acumula los registros en una página de 256 B en RAM y la añade al fichero
+ *   sólo cuando está completa (una escritura de flash por página).
+ * - Exporta el log por USB CDC mediante un protocolo de volcado binario simple.
+ *
+ * @note Si se pierde la alimentación se pierde, como mucho, la página en RAM.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "track_log.h"
+#include <LittleFS.h>
+#include "metrics.h"
+#include <math.h>
+#include <string.h>
+
+// ----------------- Configuración -----------------------
+#define TRACK_FILE "/track.bin"
+static const size_t   TRACK_PAGE_SIZE = 256;          // página de flash del RP2040
+static const uint32_t TRACK_MAX_BYTES = 512UL * 1024; // límite del fichero
+static const uint8_t  TRACK_KEY_LEN   = 13;           // registro clave = payload LoRa
+static const uint8_t  TRACK_DELTA_TAG = 0x80;         // 0x80|dt, dt = 1..126 s
+static const uint8_t  TRACK_MAX_DT    = 126;          // 0xFF queda para el relleno
+static const uint8_t  TRACK_PAD       = 0xFF;
+
+// ----------------- Métricas -----------------------------
+METRIC_COUNTER(m_pageWrites, "track_page_writes_total", "Páginas de 256 B escritas en flash por el log");
+METRIC_COUNTER(m_records, "track_records_total", "Fixes añadidos al log de trayectoria");
+METRIC_COUNTER(m_dropped, "track_dropped_total", "Fixes descartados (log lleno o error de FS)");
+
+// ----------------- Estado interno -----------------------
+static uint8_t  s_page[TRACK_PAGE_SIZE];
+static size_t   s_pageLen  = 0;
+static bool     s_fsOk     = false;
+static bool     s_hasPrev  = false;   // hay registro previo en la página en curso
+static uint32_t s_prevSod  = 0;       // segundos del día del registro previo
+static int32_t  s_prevLat  = 0;       // lat*1e5 del registro previo
+static int32_t  s_prevLon  = 0;       // lon*1e5 del registro previo
+static TrackStats s_stats  = {0,0,0,0,0,0,0};
+
+/**
+ * \brief Escribe un entero con signo como zigzag + varint (LEB128).
+ * \return Número de bytes escritos (1..5).
+ */
+static size_t putZigzagVarint(int32_t v, uint8_t* out) {
+  uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+  size_t n = 0;
+  while (z >= 0x80) {
+    out[n++] = (uint8_t)(z | 0x80);
+    z >>= 7;
+  }
+  out[n++] = (uint8_t)z;
+  return n;
+}
+
+/**
+ * \brief Rellena y escribe la página en curso al final del fichero.
+ */
+static bool writePage() {
+  if (s_pageLen == 0) return true;
+  memset(&s_page[s_pageLen], TRACK_PAD, TRACK_PAGE_SIZE - s_pageLen);
+
+  bool ok = false;
+  uint32_t t0 = micros();
+  File f = LittleFS.open(TRACK_FILE, "a");
+  if (f) {
+    ok = (f.write(s_page, TRACK_PAGE_SIZE) == TRACK_PAGE_SIZE);
+    f.close();
+  }
+  s_stats.writeUs += micros() - t0;
+
+  if (ok) {
+    m_pageWrites.inc();
+    s_stats.pageWrites++;
+    s_stats.fileBytes += TRACK_PAGE_SIZE;
+  }
+  // La página siguiente empieza siempre con un registro clave
+  s_pageLen = 0;
+  s_hasPrev = false;
+  return ok;
+}
+
+/**
+ * \brief Monta LittleFS y recupera el tamaño actual del log.
+ */
+bool TRACK_begin() {
+  s_fsOk = LittleFS.begin();
+  if (!s_fsOk) return false;
+
+  File f = LittleFS.open(TRACK_FILE, "r");
+  if (f) {
+    s_stats.fileBytes = f.size();
+    f.close();
+  }
+  s_pageLen = 0;
+  s_hasPrev = false;
+  return true;
+}
+
+/**
+ * \brief Codifica el fix (clave o delta) en la página en curso.
+ */
+bool TRACK_append(const GpsInfo& info) {
+  if (!info.valid) return false;
+  if (!s_fsOk || s_stats.fileBytes + TRACK_PAGE_SIZE > TRACK_MAX_BYTES) {
+    s_stats.dropped++;
+    m_dropped.inc();
+    return false;
+  }
+
+  uint32_t sod = GPS_hhmmssToSod(info.hhmmss);
+  int32_t  lat = (int32_t)lround(info.lat * 100000.0);
+  int32_t  lon = (int32_t)lround(info.lon * 100000.0);
+
+  uint8_t rec[TRACK_KEY_LEN];
+  size_t  len = 0;
+
+  // Delta sólo si hay referencia en esta página y dt cabe en la cabecera
+  // (un salto de medianoche o un hueco largo fuerzan registro clave)
+  if (s_hasPrev && sod > s_prevSod && (sod - s_prevSod) <= TRACK_MAX_DT) {
+    rec[len++] = TRACK_DELTA_TAG | (uint8_t)(sod - s_prevSod);
+    len += putZigzagVarint(lat - s_prevLat, &rec[len]);
+    len += putZigzagVarint(lon - s_prevLon, &rec[len]);
+  }
+
+  // Si no cabe (o no hay referencia), la página se cierra y se usa registro clave
+  if (len == 0 || s_pageLen + len > TRACK_PAGE_SIZE) {
+    if (len != 0 && !writePage()) {
+      s_stats.dropped++;
+      m_dropped.inc();
+      return false;
+    }
+    len = GPS_buildBinaryPayload(info, rec, sizeof(rec));
+    if (len != TRACK_KEY_LEN) return false;
+    if (s_pageLen + len > TRACK_PAGE_SIZE && !writePage()) {
+      s_stats.dropped++;
+      m_dropped.inc();
+      return false;
+    }
+    s_stats.keyRecords++;
+  }
+
+  memcpy(&s_page[s_pageLen], rec, len);
+  s_pageLen += len;
+  s_hasPrev = true;
+  s_prevSod = sod;
+  s_prevLat = lat;
+  s_prevLon = lon;
+  s_stats.records++;
+  m_records.inc();
+  return true;
+}
+
+/**
+ * \brief Cierra la página en curso aunque no esté completa.
+ */
+bool TRACK_flush() {
+  if (!s_fsOk) return false;
+  return writePage();
+}
+
+/**
+ * \brief Elimina el fichero y descarta la página en RAM.
+ */
+void TRACK_erase() {
+  if (s_fsOk) LittleFS.remove(TRACK_FILE);
+  s_pageLen = 0;
+  s_hasPrev = false;
+  s_stats.fileBytes = 0;
+}
+
+/**
+ * \brief Copia de los contadores (incluye el llenado de la página en RAM).
+ */
+TrackStats TRACK_getStats() {
+  TrackStats st = s_stats;
+  st.pageBytes = s_pageLen;
+  return st;
+}
+
+/**
+ * \brief Vuelca fichero + página en RAM por el puerto indicado.
+ * \details El receptor conoce la longitud por la cabecera; el final de la página
+ *          en RAM no lleva relleno (el decodificador termina al agotar los datos).
+ */
+static void dumpLog(Stream& port) {
+  File f = s_fsOk ? LittleFS.open(TRACK_FILE, "r") : File();
+  uint32_t fileLen = f ? (uint32_t)f.size() : 0;
+
+  port.print("TRACK ");
+  port.println(fileLen + (uint32_t)s_pageLen);
+
+  uint32_t t0 = millis();
+  uint8_t  chunk[TRACK_PAGE_SIZE];
+  if (f) {
+    int n;
+    while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+      port.write(chunk, (size_t)n);
+    }
+    f.close();
+  }
+  if (s_pageLen) port.write(s_page, s_pageLen);
+
+  port.print("\nOK ");
+  port.print(millis() - t0);
+  port.println(" ms");
+}
+
+/**
+ * \brief Intérprete de comandos del log (consola USB).
+ */
+bool TRACK_handleCommand(const String& cmd, Stream& port) {
+  if (cmd == "TRACK?") {
+    TrackStats st = TRACK_getStats();
+    port.print("records=");     port.print(st.records);
+    port.print(" key=");        port.print(st.keyRecords);
+    port.print(" file_bytes="); port.print(st.fileBytes);
+    port.print(" page_bytes="); port.print(st.pageBytes);
+    port.print(" pages=");      port.print(st.pageWrites);
+    port.print(" write_us=");   port.print(st.writeUs);
+    port.print(" dropped=");    port.println(st.dropped);
+    return true;
+  }
+  if (cmd == "DUMP") {
+    dumpLog(port);
+    return true;
+  }
+  if (cmd == "ERASE") {
+    TRACK_erase();
+    port.println("OK");
+    return true;
+  }
+  return false;
+}
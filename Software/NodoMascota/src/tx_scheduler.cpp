@@ -0,0 +1,62 @@
+/** @file tx_scheduler.cpp
+ * @brief Implementación del planificador de transmisiones periódicas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "tx_scheduler.h"
+#include "payload_codec.h"
+#include <math.h>
+
+static const uint32_t SOD_DAY = 86400UL;
+
+// ----------------- Estado interno -----------------------
+static uint16_t s_period   = 10;
+static uint32_t s_lastSent = 0xFFFFFFFFUL;   // ningún envío todavía
+
+/**
+ * \brief Fija el periodo (mínimo 1 s) y olvida el último envío.
+ */
+void TXS_begin(uint16_t periodS) {
+  s_period   = periodS ? periodS : 1;
+  s_lastSent = 0xFFFFFFFFUL;
+}
+
+/**
+ * \brief Segundo nuevo (evita doble envío) y alineado con el periodo.
+ */
+bool TXS_isDue(uint32_t hhmmss) {
+  if (hhmmss == s_lastSent) return false;
+  return (GPS_hhmmssToSod(hhmmss) % s_period) == 0;
+}
+
+/**
+ * \brief Guarda la hora del último envío.
+ */
+void TXS_markSent(uint32_t hhmmss) {
+  s_lastSent = hhmmss;
+}
+
+/**
+ * \brief Periodo actual.
+ */
+uint16_t TXS_period() {
+  return s_period;
+}
+
+/**
+ * \brief Recorre los divisores de 86400 desde el mínimo necesario.
+ */
+uint16_t TXS_dutyPeriodS(float airtimeMs, uint16_t wantedS, float dutyFraction) {
+  uint32_t need = wantedS ? wantedS : 1;
+  if (dutyFraction > 0.0f) {
+    float minS = ceilf(airtimeMs / (1000.0f * dutyFraction));
+    if (minS > TXS_PERIOD_MAX) return TXS_PERIOD_MAX;
+    if ((uint32_t)minS > need) need = (uint32_t)minS;
+  }
+  for (uint32_t p = need; p < TXS_PERIOD_MAX; p++) {
+    if (SOD_DAY % p == 0) return (uint16_t)p;
+  }
+  return TXS_PERIOD_MAX;
+}
@@ -0,0 +1,343 @@
+/** @file test_main.cpp
+ * @brief Tests del horario de envíos aprendido y simulación de energía sobre varias semanas.
+ *
+ * La simulación reproduce a 1 Hz cuatro semanas de una mascota con rutina
+ * (duerme de 22:00 a 07:00, paseos hacia las 07:30 y las 18:00, algún
+ * movimiento corto de día) y una salida nocturna inesperada de 20 min
+ * cada tres noches. Compara el periodo fijo de 10 s con GNSS siempre encendido frente al
+ * horario aprendido (GNSS dormido entre envíos en las horas tranquilas) en:
+ * energía del GNSS y de las transmisiones, antigüedad de la última posición
+ * mientras la mascota se mueve y retraso en avisar de una salida inesperada.
+ * Se descarta la primera semana (aprendizaje).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "activity_plan.h"
+#include "wake_radio.h"
+
+static const double HOME_LAT = 40.4168, HOME_LON = -3.7038;
+static const double M_PER_DEG = 111319.5;
+static const uint16_t BASE_PERIOD_S = 10;
+
+void setUp() {
+  ACT_begin();
+}
+void tearDown() {}
+
+// ----------------- Utilidades -----------------
+
+static uint32_t s_rng = 4242;
+
+static double uniform() {
+  s_rng = s_rng * 1664525UL + 1013904223UL;
+  return ((s_rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static void toDeg(double east, double north, double& lat, double& lon) {
+  lat = HOME_LAT + north / M_PER_DEG;
+  lon = HOME_LON + east / (M_PER_DEG * cos(HOME_LAT * M_PI / 180.0));
+}
+
+static uint8_t observeAt(double east, double north, uint32_t sod) {
+  double lat, lon;
+  toDeg(east, north, lat, lon);
+  return ACT_observe(sod, lat, lon);
+}
+
+/**
+ * \brief Un día: quieto salvo de \p fromS a \p toS, moviéndose a \p mps (una muestra por minuto).
+ */
+static void learnDay(uint32_t fromS, uint32_t toS, double mps) {
+  double east = 0;
+  for (uint32_t sod = 0; sod < 86400; sod += 60) {
+    if (sod >= fromS && sod < toS) east += mps * 60;
+    observeAt(east, 0, sod);
+  }
+}
+
+// ----------------- Tests -----------------
+
+/** Sin días aprendidos el plan es el periodo normal con el GNSS encendido. */
+static void test_unlearned_plan() {
+  for (uint8_t h = 0; h < ACT_HOURS; h++) {
+    ActHourPlan p = ACT_plan(h, BASE_PERIOD_S);
+    TEST_ASSERT_EQUAL_UINT16(BASE_PERIOD_S, p.periodS);
+    TEST_ASSERT_FALSE(p.gnssSleep);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_gnssSleepS(3 * 3600, BASE_PERIOD_S));
+  TEST_ASSERT_EQUAL_UINT16(BASE_PERIOD_S, ACT_periodS(3 * 3600, BASE_PERIOD_S));
+}
+
+/** Tres días con paseo de 08:00 a 09:00: esa hora activa, el resto en reposo. */
+static void test_learns_routine() {
+  for (int d = 0; d < ACT_MIN_DAYS; d++) {
+    learnDay(8 * 3600, 9 * 3600, 1.0);
+    ActHourPlan p = ACT_plan(3, BASE_PERIOD_S);
+    TEST_ASSERT_EQUAL(d + 1 >= ACT_MIN_DAYS, p.gnssSleep);
+  }
+  ActHourPlan walk = ACT_plan(8, BASE_PERIOD_S);
+  TEST_ASSERT_EQUAL_UINT16(BASE_PERIOD_S, walk.periodS);
+  TEST_ASSERT_FALSE(walk.gnssSleep);
+  ActHourPlan night = ACT_plan(3, BASE_PERIOD_S);
+  TEST_ASSERT_EQUAL_UINT16(ACT_REST_PERIOD_S, night.periodS);
+  TEST_ASSERT_TRUE(night.gnssSleep);
+  TEST_ASSERT_EQUAL_UINT8(255, ACT_profile().activity[8]);
+  TEST_ASSERT_EQUAL_UINT8(ACT_MIN_DAYS, ACT_profile().days[8]);
+  // Un periodo normal más largo que el del plan manda
+  TEST_ASSERT_EQUAL_UINT16(600, ACT_plan(3, 600).periodS);
+}
+
+/** Movimiento en una hora tranquila: refuerzo que se prolonga y caduca. */
+static void test_unexpected_motion() {
+  for (int d = 0; d < ACT_MIN_DAYS; d++) learnDay(8 * 3600, 9 * 3600, 1.0);
+  uint32_t t = 2 * 3600 + 100;
+  TEST_ASSERT_EQUAL_UINT8(0, observeAt(0, 0, t) & ACT_EV_MOTION);
+  TEST_ASSERT_EQUAL_UINT8(0, observeAt(5, 0, t + 5) & ACT_EV_MOTION);   // ruido
+  TEST_ASSERT_TRUE(observeAt(40, 0, t + 20) & ACT_EV_MOTION);
+  TEST_ASSERT_TRUE(ACT_isBoosted(t + 20));
+  TEST_ASSERT_EQUAL_UINT16(BASE_PERIOD_S, ACT_periodS(t + 20, BASE_PERIOD_S));
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_gnssSleepS(t + 20, BASE_PERIOD_S));
+
+  // Sigue moviéndose 10 min: sin evento nuevo, el refuerzo se prolonga
+  for (uint32_t s = 60; s <= 600; s += 60)
+    TEST_ASSERT_EQUAL_UINT8(0, observeAt(40 + s, 0, t + 20 + s) & ACT_EV_MOTION);
+  TEST_ASSERT_TRUE(ACT_isBoosted(t + 620 + ACT_BOOST_S - 1));
+  TEST_ASSERT_FALSE(ACT_isBoosted(t + 620 + ACT_BOOST_S));
+  TEST_ASSERT_EQUAL_UINT16(ACT_REST_PERIOD_S, ACT_periodS(t + 620 + ACT_BOOST_S, BASE_PERIOD_S));
+
+  // En una hora activa no hay refuerzo (ya va al periodo normal)
+  observeAt(0, 0, 8 * 3600 + 100);
+  TEST_ASSERT_EQUAL_UINT8(0, observeAt(100, 0, 8 * 3600 + 130) & ACT_EV_MOTION);
+}
+
+/** El GNSS despierta ACT_GNSS_LEAD_S antes del envío o de la hora siguiente. */
+static void test_gnss_sleep() {
+  for (int d = 0; d < ACT_MIN_DAYS; d++) learnDay(8 * 3600, 9 * 3600, 1.0);
+  observeAt(3600, 0, 0);   // cierra las 23:00 del último día
+  TEST_ASSERT_EQUAL_UINT32(ACT_REST_PERIOD_S - ACT_GNSS_LEAD_S, ACT_gnssSleepS(3 * 3600, BASE_PERIOD_S));
+  TEST_ASSERT_EQUAL_UINT32(ACT_REST_PERIOD_S - 100 - ACT_GNSS_LEAD_S,
+                           ACT_gnssSleepS(3 * 3600 + 100, BASE_PERIOD_S));
+  // Cerca del envío no compensa dormir
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_gnssSleepS(3 * 3600 + ACT_REST_PERIOD_S - 70, BASE_PERIOD_S));
+  // 07:55: la hora de paseo empieza a las 08:00
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_gnssSleepS(7 * 3600 + 3300 + 250, BASE_PERIOD_S));
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_gnssSleepS(8 * 3600, BASE_PERIOD_S));
+  // Medianoche
+  TEST_ASSERT_EQUAL_UINT32(ACT_REST_PERIOD_S - ACT_GNSS_LEAD_S, ACT_gnssSleepS(86400 - 300, BASE_PERIOD_S));
+}
+
+/** El perfil se restaura tal cual; una firma o longitud incorrecta deja el perfil vacío. */
+static void test_persistence() {
+  for (int d = 0; d < ACT_MIN_DAYS; d++) learnDay(8 * 3600, 9 * 3600, 1.0);
+  ActProfile saved = ACT_profile();
+  ACT_begin();
+  TEST_ASSERT_TRUE(ACT_load((const uint8_t*)&saved, sizeof(saved)));
+  TEST_ASSERT_EQUAL_MEMORY(&saved, &ACT_profile(), sizeof(saved));
+  TEST_ASSERT_FALSE(ACT_load((const uint8_t*)&saved, sizeof(saved) - 1));
+  TEST_ASSERT_EQUAL_UINT8(0, ACT_profile().days[8]);
+  saved.magic ^= 1;
+  TEST_ASSERT_FALSE(ACT_load((const uint8_t*)&saved, sizeof(saved)));
+}
+
+/** UBX-RXM-PMREQ: cabecera, duración, backup forzado, despertar por UART y checksum. */
+static void test_sleep_message() {
+  uint8_t m[32];
+  TEST_ASSERT_EQUAL_UINT32(24, ACT_buildGnssSleepMsg(280000, m, sizeof(m)));
+  const uint8_t hdr[6] = {0xB5, 0x62, 0x02, 0x41, 0x10, 0x00};
+  TEST_ASSERT_EQUAL_MEMORY(hdr, m, 6);
+  uint32_t ms, flags, sources;
+  memcpy(&ms, &m[10], 4);
+  memcpy(&flags, &m[14], 4);
+  memcpy(&sources, &m[18], 4);
+  TEST_ASSERT_EQUAL_UINT32(280000, ms);
+  TEST_ASSERT_EQUAL_UINT32(0x06, flags);
+  TEST_ASSERT_EQUAL_UINT32(0x08, sources);
+  TEST_ASSERT_EQUAL_UINT8(0x6A, m[22]);
+  TEST_ASSERT_EQUAL_UINT8(0x8A, m[23]);
+  TEST_ASSERT_EQUAL_UINT32(0, ACT_buildGnssSleepMsg(280000, m, 23));
+  TEST_ASSERT_EQUAL_UINT32(4, ACT_buildGnssWakeMsg(m, sizeof(m)));
+  TEST_ASSERT_EQUAL_UINT8(0xFF, m[3]);
+}
+
+// ----------------- Simulación -----------------
+
+/** Intervalo de movimiento: ida y vuelta en línea recta. */
+struct Move {
+  uint32_t start, dur;
+  double   mps, heading;
+  bool     unexpected;
+};
+
+static std::vector<Move> dayMoves(int day) {
+  std::vector<Move> m;
+  m.push_back({(uint32_t)(7 * 3600 + 1800 + gauss(600)), 2700, 1.2, uniform() * 2 * M_PI, false});
+  m.push_back({(uint32_t)(18 * 3600 + gauss(900)), 3600, 1.2, uniform() * 2 * M_PI, false});
+  for (uint32_t b = 9 * 3600; b < 22 * 3600; b += 600) {
+    if (uniform() < 0.05)
+      m.push_back({b + (uint32_t)(uniform() * 300), 120 + (uint32_t)(uniform() * 180), 0.5,
+                   uniform() * 2 * M_PI, false});
+  }
+  if (day % 3 == 1)
+    m.push_back({(uint32_t)(1800 + uniform() * 4 * 3600), 1200, 1.5, uniform() * 2 * M_PI, true});
+  return m;
+}
+
+/** Posición real en \p sod según los movimientos del día (en casa fuera de ellos). */
+static void petAt(const std::vector<Move>& moves, uint32_t sod, double& east, double& north, bool& moving) {
+  east = north = 0;
+  moving = false;
+  for (const Move& m : moves) {
+    if (sod < m.start || sod >= m.start + m.dur) continue;
+    uint32_t t = sod - m.start;
+    double d = m.mps * (double)(t < m.dur / 2 ? t : m.dur - t);
+    east  = d * cos(m.heading);
+    north = d * sin(m.heading);
+    moving = true;
+  }
+}
+
+struct SimResult {
+  double   gnssMah, txMah;
+  uint32_t reports;
+  double   ageSum;        ///< Suma de la antigüedad de la última posición en segundos en movimiento.
+  uint32_t movingS;
+  double   alertSum;      ///< Retraso hasta la primera posición tras alejarse > ACT_MOVE_M (salidas inesperadas).
+  uint32_t alertMax, alerts;
+};
+
+/**
+ * \brief Reproduce \p days días; sólo cuenta a partir de \p fromDay.
+ */
+static SimResult simulate(bool learned, int days, int fromDay) {
+  const double GNSS_TRACK_MA = 25.0, GNSS_ACQ_MA = 30.0, GNSS_BACKUP_MA = 0.015, TX_MA = 45.0;
+  const double airS = WOR_airtimeMs(13, 8) / 1000.0;
+  SimResult r{};
+  s_rng = 4242;
+  ACT_begin();
+
+  bool     gnssOn = true;
+  uint32_t wakeAt = 0, acqLeft = 0;   // segundos absolutos / restantes de adquisición
+  uint32_t lastReport = 0;
+  uint16_t period = BASE_PERIOD_S;
+  for (int day = 0; day < days; day++) {
+    std::vector<Move> moves = dayMoves(day);
+    bool counting = day >= fromDay;
+    uint32_t awaySince = 0;      // instante en que la mascota se alejó en una salida inesperada
+    bool     alerted   = false;
+    for (uint32_t sod = 0; sod < 86400; sod++) {
+      uint32_t now = (uint32_t)day * 86400 + sod;
+      double east, north;
+      bool moving;
+      petAt(moves, sod, east, north, moving);
+      bool unexpectedAway = false;
+      for (const Move& m : moves)
+        if (m.unexpected && sod >= m.start && sod < m.start + m.dur && sqrt(east * east + north * north) > ACT_MOVE_M)
+          unexpectedAway = true;
+      if (unexpectedAway && !awaySince) awaySince = now;
+
+      // Receptor GNSS
+      if (!gnssOn && now >= wakeAt) {
+        gnssOn  = true;
+        acqLeft = 2 + (uint32_t)(uniform() * 3);   // arranque en caliente
+      }
+      bool fix = false;
+      if (gnssOn) {
+        if (acqLeft) {
+          acqLeft--;
+          if (counting) r.gnssMah += GNSS_ACQ_MA / 3600.0;
+        } else {
+          fix = true;
+          if (counting) r.gnssMah += GNSS_TRACK_MA / 3600.0;
+        }
+      } else if (counting) {
+        r.gnssMah += GNSS_BACKUP_MA / 3600.0;
+      }
+
+      if (fix) {
+        double ne = east + gauss(3.0), nn = north + gauss(3.0);
+        if (learned) {
+          double lat, lon;
+          toDeg(ne, nn, lat, lon);
+          ACT_observe(sod, lat, lon);
+          period = ACT_periodS(sod, BASE_PERIOD_S);
+        }
+        if (sod % period == 0) {
+          lastReport = now;
+          if (counting) {
+            r.reports++;
+            r.txMah += TX_MA * airS / 3600.0;
+          }
+          if (awaySince && !alerted) {
+            uint32_t lag = now - awaySince;
+            if (counting) {
+              r.alertSum += lag;
+              if (lag > r.alertMax) r.alertMax = lag;
+              r.alerts++;
+            }
+            alerted = true;   // una por salida
+          }
+          uint32_t s = learned ? ACT_gnssSleepS(sod, BASE_PERIOD_S) : 0;
+          if (s) {
+            gnssOn = false;
+            wakeAt = now + s;
+          }
+        }
+      }
+      if (moving && counting) {
+        r.movingS++;
+        r.ageSum += now - lastReport;
+      }
+    }
+  }
+  return r;
+}
+
+/** Cuatro semanas: energía frente al periodo fijo, seguimiento en movimiento y avisos. */
+static void test_replay_energy() {
+  const int DAYS = 28, FROM = 7;
+  SimResult fixed = simulate(false, DAYS, FROM);
+  SimResult plan  = simulate(true, DAYS, FROM);
+  const double n = DAYS - FROM;
+
+  double eFixed = (fixed.gnssMah + fixed.txMah) / n, ePlan = (plan.gnssMah + plan.txMah) / n;
+  printf("[ACT] fijo 10 s:   %.1f mAh/día (GNSS %.1f, TX %.2f), %u envíos/día\n", eFixed,
+         fixed.gnssMah / n, fixed.txMah / n, (unsigned)(fixed.reports / n));
+  printf("[ACT] aprendido:   %.1f mAh/día (GNSS %.1f, TX %.2f), %u envíos/día -> %.0f %% menos\n", ePlan,
+         plan.gnssMah / n, plan.txMah / n, (unsigned)(plan.reports / n), 100.0 * (1.0 - ePlan / eFixed));
+  printf("[ACT] antigüedad media en movimiento: fijo %.1f s, aprendido %.1f s\n",
+         fixed.ageSum / fixed.movingS, plan.ageSum / plan.movingS);
+  printf("[ACT] salidas inesperadas: %u; aviso fijo media %.0f s, aprendido media %.0f s (máx %u s)\n",
+         (unsigned)plan.alerts, fixed.alertSum / fixed.alerts, plan.alertSum / plan.alerts,
+         (unsigned)plan.alertMax);
+  printf("[ACT] plan por hora (s):");
+  for (uint8_t h = 0; h < ACT_HOURS; h++) printf(" %u", ACT_plan(h, BASE_PERIOD_S).periodS);
+  printf("\n");
+
+  TEST_ASSERT_TRUE(fixed.alerts > 0);
+  TEST_ASSERT_TRUE(ePlan < 0.6 * eFixed);
+  TEST_ASSERT_TRUE(plan.ageSum / plan.movingS < 30.0);
+  TEST_ASSERT_TRUE(plan.alertMax <= ACT_REST_PERIOD_S + BASE_PERIOD_S);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_unlearned_plan);
+  RUN_TEST(test_learns_routine);
+  RUN_TEST(test_unexpected_motion);
+  RUN_TEST(test_gnss_sleep);
+  RUN_TEST(test_persistence);
+  RUN_TEST(test_sleep_message);
+  RUN_TEST(test_replay_energy);
+  return UNITY_END();
+}
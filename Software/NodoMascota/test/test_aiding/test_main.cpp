@@ -0,0 +1,125 @@
+/** @file test_main.cpp
+ * @brief Tests de la trama de ayuda GNSS y de los mensajes de inyección UBX.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "gnss_aiding.h"
+
+void setUp() {}
+void tearDown() {}
+
+/** Valores de referencia (calculados con el calendario de Python) e ida y vuelta. */
+static void test_utc_date() {
+  TEST_ASSERT_EQUAL_UINT32(0, AID_utcFromDate(AidDate{2000, 1, 1, 0, 0, 0}));
+  TEST_ASSERT_EQUAL_UINT32(845642096UL, AID_utcFromDate(AidDate{2026, 10, 18, 12, 34, 56}));
+  TEST_ASSERT_EQUAL_UINT32(762566399UL, AID_utcFromDate(AidDate{2024, 2, 29, 23, 59, 59}));
+
+  // Un punto cada ~5 días durante 80 años (cubre bisiestos y 2000/2100 no)
+  for (uint32_t utc = 0; utc < 80UL * 365 * 86400; utc += 432001UL) {
+    AidDate d = AID_dateFromUtc(utc);
+    TEST_ASSERT_EQUAL_UINT32(utc, AID_utcFromDate(d));
+    TEST_ASSERT_TRUE(d.month >= 1 && d.month <= 12 && d.day >= 1 && d.day <= 31);
+  }
+}
+
+/** Ida y vuelta de la trama con cuantificación a centésimas de grado. */
+static void test_frame_roundtrip() {
+  AidData in = {845642096UL, 40.41683f, -3.70379f, 5, 2};
+  uint8_t buf[AID_FRAME_LEN];
+  TEST_ASSERT_EQUAL_UINT32(AID_FRAME_LEN, AID_buildFrame(in, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_HEX8(AID_FRAME_TYPE, buf[0]);
+
+  AidData out{};
+  TEST_ASSERT_TRUE(AID_parseFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT32(in.utc, out.utc);
+  TEST_ASSERT_FLOAT_WITHIN(0.005f, in.lat, out.lat);
+  TEST_ASSERT_FLOAT_WITHIN(0.005f, in.lon, out.lon);
+  TEST_ASSERT_EQUAL_UINT8(5, out.posAccKm);
+  TEST_ASSERT_EQUAL_UINT8(2, out.timeAccS);
+}
+
+/** Tipo, longitud y rangos; posiciones no válidas no se serializan. */
+static void test_frame_rejects() {
+  AidData in = {1, 10.0f, 20.0f, 1, 1};
+  uint8_t buf[AID_FRAME_LEN + 2];
+  AidData out{};
+  TEST_ASSERT_EQUAL_UINT32(0, AID_buildFrame(in, buf, AID_FRAME_LEN - 1));
+  in.lat = NAN;
+  TEST_ASSERT_EQUAL_UINT32(0, AID_buildFrame(in, buf, sizeof(buf)));
+  in.lat = 10.0f; in.lon = 181.0f;
+  TEST_ASSERT_EQUAL_UINT32(0, AID_buildFrame(in, buf, sizeof(buf)));
+
+  in.lon = 20.0f;
+  AID_buildFrame(in, buf, sizeof(buf));
+  TEST_ASSERT_FALSE(AID_parseFrame(buf, AID_FRAME_LEN + 1, out));
+  TEST_ASSERT_FALSE(AID_parseFrame(nullptr, AID_FRAME_LEN, out));
+  buf[6] = 0x7F;   // lat = 0x7FE8 → fuera de rango
+  TEST_ASSERT_FALSE(AID_parseFrame(buf, AID_FRAME_LEN, out));
+  buf[0] = 0xC1;
+  TEST_ASSERT_FALSE(AID_parseFrame(buf, AID_FRAME_LEN, out));
+}
+
+/** UBX-MGA-INI-TIME_UTC byte a byte (checksum calculado aparte). */
+static void test_ubx_time() {
+  const uint8_t expected[] = {
+    0xB5, 0x62, 0x13, 0x40, 0x18, 0x00, 0x10, 0x00, 0x00, 0x80, 0xEA, 0x07, 0x0A, 0x12,
+    0x0C, 0x22, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x70, 0xD5};
+  uint8_t buf[64];
+  TEST_ASSERT_EQUAL_UINT32(sizeof(expected), AID_buildTimeMsg(845642096UL, 2, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, sizeof(expected));
+  TEST_ASSERT_EQUAL_UINT32(0, AID_buildTimeMsg(0, 2, buf, sizeof(expected) - 1));
+}
+
+/** UBX-MGA-INI-POS_LLH: lat/lon en 1e-7 grados y precisión en cm. */
+static void test_ubx_pos() {
+  AidData aid = {0, 40.41f, -3.70f, 5, 2};
+  uint8_t buf[64];
+  TEST_ASSERT_EQUAL_UINT32(28, AID_buildPosMsg(aid, 0, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_HEX8(0x01, buf[6]);
+
+  int32_t lat, lon;
+  uint32_t acc;
+  memcpy(&lat, &buf[10], 4);
+  memcpy(&lon, &buf[14], 4);
+  memcpy(&acc, &buf[22], 4);
+  TEST_ASSERT_INT32_WITHIN(10, 404100000, lat);
+  TEST_ASSERT_INT32_WITHIN(10, -37000000, lon);
+  TEST_ASSERT_EQUAL_UINT32(500000UL, acc);
+
+  uint8_t ckA = 0, ckB = 0;
+  for (size_t i = 2; i < 26; i++) { ckA += buf[i]; ckB += ckA; }
+  TEST_ASSERT_EQUAL_HEX8(ckA, buf[26]);
+  TEST_ASSERT_EQUAL_HEX8(ckB, buf[27]);
+}
+
+/** Energía proporcional al TTFF. */
+/** Cierre NMEA común a la asistencia PMTK y a los mensajes de sueño del receptor. */
+static void test_nmea_finish() {
+  char s[16] = "$PMTK000";
+  TEST_ASSERT_EQUAL_UINT32(13, AID_nmeaFinish(s, 8, sizeof(s)));
+  TEST_ASSERT_EQUAL_STRING("$PMTK000*32\r\n", s);
+  char small[12] = "$PMTK000";
+  TEST_ASSERT_EQUAL_UINT32(0, AID_nmeaFinish(small, 8, sizeof(small)));
+}
+
+static void test_energy() {
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, AID_acquisitionEnergyMj(0));
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 2970.0f, AID_acquisitionEnergyMj(30000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_utc_date);
+  RUN_TEST(test_frame_roundtrip);
+  RUN_TEST(test_frame_rejects);
+  RUN_TEST(test_ubx_time);
+  RUN_TEST(test_ubx_pos);
+  RUN_TEST(test_nmea_finish);
+  RUN_TEST(test_energy);
+  return UNITY_END();
+}
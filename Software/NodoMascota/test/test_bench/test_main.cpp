@@ -0,0 +1,66 @@
+/** @file test_main.cpp
+ * @brief Micro-benchmarks del códec y del planificador (regresiones de rendimiento).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "bench.h"
+#include "payload_codec.h"
+#include "tx_scheduler.h"
+
+// Líneas base (unidades de calibración de bench.h por operación, -O2, x86-64 de desarrollo)
+static const double BASE_BUILD_U   = 0.4;
+static const double BASE_PARSE_U   = 0.4;
+static const double BASE_SCHED_U   = 0.6;
+static const uint32_t ITERS        = 1000000;
+
+void setUp() {}
+void tearDown() {}
+
+static void bench_build_payload() {
+  GpsInfo gi{};
+  gi.lat = 40.41678; gi.lon = -3.70379; gi.valid = true;
+  uint8_t buf[13];
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    gi.hhmmss = i;
+    g_benchSink += (uint32_t)GPS_buildBinaryPayload(gi, buf, sizeof(buf)) + buf[7];
+  }, ITERS);
+  BENCH_check("GPS_buildBinaryPayload", ns, BASE_BUILD_U);
+}
+
+static void bench_parse_payload() {
+  GpsInfo gi{};
+  gi.lat = 40.41678; gi.lon = -3.70379; gi.hhmmss = 120000; gi.valid = true;
+  // Tramas ya escritas, como el búfer de la radio: escribir un byte justo antes
+  // de leerlo en palabras de 4 frustra el reenvío almacén-carga y la medida
+  // pasaba a depender del estado de la CPU anfitriona
+  uint8_t frames[8][13];
+  for (uint8_t k = 0; k < 8; k++) {
+    gi.hhmmss = 120000 + k;
+    GPS_buildBinaryPayload(gi, frames[k], sizeof(frames[k]));
+  }
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    GpsInfo out{};
+    g_benchSink += GPS_parsePayload(frames[i & 7], sizeof(frames[0]), out) ? out.hhmmss : 0;
+  }, ITERS);
+  BENCH_check("GPS_parsePayload", ns, BASE_PARSE_U);
+}
+
+static void bench_scheduler() {
+  TXS_begin(10);
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    g_benchSink += TXS_isDue(i % 235960) ? 1u : 0u;
+  }, ITERS);
+  BENCH_check("TXS_isDue", ns, BASE_SCHED_U);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(bench_build_payload);
+  RUN_TEST(bench_parse_payload);
+  RUN_TEST(bench_scheduler);
+  return UNITY_END();
+}
@@ -0,0 +1,147 @@
+/** @file test_main.cpp
+ * @brief Tests del códec del payload binario LoRa (13 B).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "payload_codec.h"
+
+void setUp() {}
+void tearDown() {}
+
+static GpsInfo makeInfo(double lat, double lon, uint32_t hhmmss) {
+  GpsInfo gi{};
+  gi.lat    = lat;
+  gi.lon    = lon;
+  gi.hhmmss = hhmmss;
+  gi.valid  = true;
+  return gi;
+}
+
+/** Ida y vuelta con coordenadas de Madrid. */
+static void test_roundtrip() {
+  GpsInfo in = makeInfo(40.41678, -3.70379, 211507);
+  uint8_t buf[13];
+  TEST_ASSERT_EQUAL_UINT32(13, GPS_buildBinaryPayload(in, buf, sizeof(buf)));
+
+  GpsInfo out{};
+  TEST_ASSERT_TRUE(GPS_parsePayload(buf, sizeof(buf), out));
+  TEST_ASSERT_TRUE(out.valid);
+  TEST_ASSERT_EQUAL_UINT32(211507, out.hhmmss);
+  TEST_ASSERT_DOUBLE_WITHIN(0.000005, in.lat, out.lat);
+  TEST_ASSERT_DOUBLE_WITHIN(0.000005, in.lon, out.lon);
+}
+
+/** Distribución exacta de los bytes (little-endian). */
+static void test_layout() {
+  GpsInfo in = makeInfo(0.00001, -0.00001, 0x00033A4B);
+  uint8_t buf[13];
+  TEST_ASSERT_EQUAL_UINT32(13, GPS_buildBinaryPayload(in, buf, sizeof(buf)));
+
+  const uint8_t expected[13] = {
+    0x01,
+    0x4B, 0x3A, 0x03, 0x00,
+    0x01, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF
+  };
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, 13);
+}
+
+/** Redondeo al entero más próximo (no truncado). */
+static void test_rounding() {
+  GpsInfo in = makeInfo(1.000006, -1.000006, 0);
+  uint8_t buf[13];
+  GPS_buildBinaryPayload(in, buf, sizeof(buf));
+
+  int32_t lat, lon;
+  memcpy(&lat, &buf[5], 4);
+  memcpy(&lon, &buf[9], 4);
+  TEST_ASSERT_EQUAL_INT32(100001, lat);
+  TEST_ASSERT_EQUAL_INT32(-100001, lon);
+}
+
+/** Extremos de latitud/longitud. */
+static void test_extremes() {
+  const double coords[][2] = {{90.0, 180.0}, {-90.0, -180.0}, {0.0, 0.0}};
+  for (const auto& c : coords) {
+    GpsInfo in = makeInfo(c[0], c[1], 235959);
+    uint8_t buf[13];
+    TEST_ASSERT_EQUAL_UINT32(13, GPS_buildBinaryPayload(in, buf, sizeof(buf)));
+    GpsInfo out{};
+    TEST_ASSERT_TRUE(GPS_parsePayload(buf, sizeof(buf), out));
+    TEST_ASSERT_DOUBLE_WITHIN(0.000005, c[0], out.lat);
+    TEST_ASSERT_DOUBLE_WITHIN(0.000005, c[1], out.lon);
+  }
+}
+
+/** Sin fix, sin buffer o buffer corto: no se genera payload. */
+static void test_build_rejects() {
+  uint8_t buf[13];
+  GpsInfo noFix = makeInfo(40.0, -3.0, 120000);
+  noFix.valid = false;
+  TEST_ASSERT_EQUAL_UINT32(0, GPS_buildBinaryPayload(noFix, buf, sizeof(buf)));
+
+  GpsInfo ok = makeInfo(40.0, -3.0, 120000);
+  TEST_ASSERT_EQUAL_UINT32(0, GPS_buildBinaryPayload(ok, buf, 12));
+  TEST_ASSERT_EQUAL_UINT32(0, GPS_buildBinaryPayload(ok, nullptr, 13));
+}
+
+/** Coordenadas u hora fuera de rango (p.ej. NMEA corrupto): no se genera payload. */
+static void test_build_rejects_out_of_range() {
+  uint8_t buf[13];
+  const GpsInfo bad[] = {
+    makeInfo(90.00001, 0.0, 120000),
+    makeInfo(0.0, -180.00001, 120000),
+    makeInfo(1e12, 0.0, 120000),
+    makeInfo(NAN, 0.0, 120000),
+    makeInfo(0.0, 0.0, 240000),
+    makeInfo(0.0, 0.0, 126000),
+    makeInfo(0.0, 0.0, 120061),
+  };
+  for (const GpsInfo& gi : bad) {
+    TEST_ASSERT_FALSE(GPS_isPlausible(gi));
+    TEST_ASSERT_EQUAL_UINT32(0, GPS_buildBinaryPayload(gi, buf, sizeof(buf)));
+  }
+  TEST_ASSERT_TRUE(GPS_isPlausible(makeInfo(0.0, 0.0, 235960)));
+}
+
+/** Longitud distinta de 13, puntero nulo o fix=0: se rechaza sin tocar la salida. */
+static void test_parse_rejects() {
+  GpsInfo in = makeInfo(40.0, -3.0, 120000);
+  uint8_t buf[14];
+  GPS_buildBinaryPayload(in, buf, sizeof(buf));
+
+  GpsInfo out{};
+  TEST_ASSERT_FALSE(GPS_parsePayload(buf, 12, out));
+  TEST_ASSERT_FALSE(GPS_parsePayload(buf, 14, out));
+  TEST_ASSERT_FALSE(GPS_parsePayload(nullptr, 13, out));
+
+  buf[0] = 0;
+  TEST_ASSERT_FALSE(GPS_parsePayload(buf, 13, out));
+  TEST_ASSERT_FALSE(out.valid);
+}
+
+/** HHMMSS → segundos del día. */
+static void test_hhmmss_to_sod() {
+  TEST_ASSERT_EQUAL_UINT32(0, GPS_hhmmssToSod(0));
+  TEST_ASSERT_EQUAL_UINT32(59, GPS_hhmmssToSod(59));
+  TEST_ASSERT_EQUAL_UINT32(3600 + 60 + 1, GPS_hhmmssToSod(10101));
+  TEST_ASSERT_EQUAL_UINT32(86399, GPS_hhmmssToSod(235959));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip);
+  RUN_TEST(test_layout);
+  RUN_TEST(test_rounding);
+  RUN_TEST(test_extremes);
+  RUN_TEST(test_build_rejects);
+  RUN_TEST(test_build_rejects_out_of_range);
+  RUN_TEST(test_parse_rejects);
+  RUN_TEST(test_hhmmss_to_sod);
+  return UNITY_END();
+}
@@ -0,0 +1,378 @@
+/** @file test_main.cpp
+ * @brief Tests de la valla virtual y simulación de la latencia de detección.
+ *
+ * La simulación compara cuándo se entera la base de que la mascota ha salido:
+ * - Sólo en la base: con la primera posición periódica que cae fuera (cada
+ *   PERIOD segundos) más su tiempo en el aire.
+ * - En el collar: con la salida confirmada a 1 Hz (GEO_CONFIRM_FIXES fixes más
+ *   allá de la banda de GEO_MARGIN_M) más el aire de la alerta.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "geofence.h"
+#include "wake_radio.h"
+#include "tx_scheduler.h"
+#include "health_frame.h"
+
+static const double HOME_LAT = 40.4168, HOME_LON = -3.7038;
+static const double M_PER_DEG = 111319.5;
+
+void setUp() {
+  GeoFence none{};
+  GEO_setFence(none);
+}
+void tearDown() {}
+
+// ----------------- Utilidades -----------------
+
+static uint32_t s_rng = 777;
+
+static double uniform() {
+  s_rng = s_rng * 1664525UL + 1013904223UL;
+  return ((s_rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static void toDeg(double east, double north, double& lat, double& lon) {
+  lat = HOME_LAT + north / M_PER_DEG;
+  lon = HOME_LON + east / (M_PER_DEG * cos(HOME_LAT * M_PI / 180.0));
+}
+
+static GpsInfo fixAt(double east, double north, uint32_t sod) {
+  GpsInfo g{};
+  toDeg(east, north, g.lat, g.lon);
+  g.hhmmss = (sod / 3600) * 10000 + ((sod / 60) % 60) * 100 + sod % 60;
+  g.valid = true;
+  return g;
+}
+
+/** Parcela en L (no convexa) de ~80 × 60 m con la casa en la esquina. */
+static const double L_EAST[6]  = {0, 80, 80, 30, 30, 0};
+static const double L_NORTH[6] = {0, 0, 25, 25, 60, 60};
+
+static GeoFence lFence(uint8_t id) {
+  double lat[6], lon[6];
+  for (int i = 0; i < 6; i++) toDeg(L_EAST[i] - 20, L_NORTH[i] - 20, lat[i], lon[i]);
+  GeoFence f{};
+  GEO_fenceFromPoints(id, lat, lon, 6, f);   // count = 0 si fallara
+  return f;
+}
+
+/** Referencia en coma flotante (misma regla de cruces). */
+static bool refInside(double px, double py) {
+  bool in = false;
+  for (int i = 0, j = 5; i < 6; j = i++) {
+    double xi = L_EAST[i] - 20, yi = L_NORTH[i] - 20, xj = L_EAST[j] - 20, yj = L_NORTH[j] - 20;
+    if ((yi > py) != (yj > py) && px < xi + (xj - xi) * (py - yi) / (yj - yi)) in = !in;
+  }
+  return in;
+}
+
+static double edgeDistance(double px, double py) {
+  double best = 1e9;
+  for (int i = 0, j = 5; i < 6; j = i++) {
+    double ax = L_EAST[j] - 20, ay = L_NORTH[j] - 20, bx = L_EAST[i] - 20, by = L_NORTH[i] - 20;
+    double t = ((px - ax) * (bx - ax) + (py - ay) * (by - ay)) / ((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    double dx = px - (ax + t * (bx - ax)), dy = py - (ay + t * (by - ay));
+    best = std::min(best, sqrt(dx * dx + dy * dy));
+  }
+  return best;
+}
+
+// ----------------- Tests -----------------
+
+static void test_fence_frame_roundtrip() {
+  GeoFence f = lFence(7);
+  uint8_t buf[GEO_FENCE_MAX_LEN];
+  size_t len = GEO_buildFence(f, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT32(GEO_FENCE_HDR_LEN + 4 * 6, len);
+  TEST_ASSERT_EQUAL_HEX8(GEO_FENCE_TYPE, buf[0]);
+
+  GeoFence g{};
+  TEST_ASSERT_TRUE(GEO_parseFence(buf, len, g));
+  TEST_ASSERT_EQUAL_UINT8(7, g.id);
+  TEST_ASSERT_EQUAL_UINT8(6, g.count);
+  TEST_ASSERT_EQUAL_INT32(f.lat0, g.lat0);
+  TEST_ASSERT_EQUAL_UINT32(f.lonScaleQ16, g.lonScaleQ16);
+  TEST_ASSERT_TRUE(memcmp(f.east, g.east, sizeof(f.east)) == 0);
+  TEST_ASSERT_TRUE(memcmp(f.north, g.north, sizeof(f.north)) == 0);
+  TEST_ASSERT_INT32_WITHIN(1, 80, f.east[1]);     // 80 m al este del primer vértice
+
+  // Longitud, tipo y número de vértices
+  TEST_ASSERT_FALSE(GEO_parseFence(buf, len - 1, g));
+  TEST_ASSERT_FALSE(GEO_parseFence(nullptr, len, g));
+  buf[2] = 2;
+  TEST_ASSERT_FALSE(GEO_parseFence(buf, GEO_FENCE_HDR_LEN + 8, g));
+  buf[2] = 9;
+  TEST_ASSERT_FALSE(GEO_parseFence(buf, GEO_FENCE_HDR_LEN + 36, g));
+  buf[0] = GEO_ALERT_TYPE;
+  buf[2] = 6;
+  TEST_ASSERT_FALSE(GEO_parseFence(buf, len, g));
+
+  // Sin vértices: desactiva
+  GeoFence off{};
+  len = GEO_buildFence(off, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT32(GEO_FENCE_HDR_LEN, len);
+  TEST_ASSERT_TRUE(GEO_parseFence(buf, len, g));
+  TEST_ASSERT_EQUAL_UINT8(0, g.count);
+
+  // Demasiados vértices o demasiado lejos
+  double lat[9], lon[9];
+  for (int i = 0; i < 9; i++) toDeg(i, i * i, lat[i], lon[i]);
+  TEST_ASSERT_FALSE(GEO_fenceFromPoints(1, lat, lon, 9, g));
+  toDeg(40000, 0, lat[2], lon[2]);
+  TEST_ASSERT_FALSE(GEO_fenceFromPoints(1, lat, lon, 3, g));
+}
+
+/** Entero frente a coma flotante en puntos aleatorios a más de 2 m del borde. */
+static void test_contains_matches_reference() {
+  GeoFence f = lFence(1);
+  int checked = 0;
+  for (int k = 0; k < 5000; k++) {
+    double e = uniform() * 140 - 50, n = uniform() * 120 - 50;
+    if (edgeDistance(e, n) < 2.0) continue;
+    GpsInfo g = fixAt(e, n, 0);
+    bool got = GEO_contains(f, (int32_t)lround(g.lat * 1e5), (int32_t)lround(g.lon * 1e5));
+    TEST_ASSERT_EQUAL(refInside(e, n), got);
+    checked++;
+  }
+  TEST_ASSERT_GREATER_THAN(4000, checked);
+  // Muy lejos (fuera de ±32 km): fuera sin desbordar
+  TEST_ASSERT_FALSE(GEO_contains(f, f.lat0 + 100000, f.lon0));
+}
+
+static void test_hysteresis() {
+  GEO_setFence(lFence(2));
+  uint32_t t = 0;
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(0, 0, t++)));
+  // Un fix suelto fuera (ruido) no dispara
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-30, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(0, 0, t++)));
+  TEST_ASSERT_FALSE(GEO_isOutside());
+  // Dos seguidos sí
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-30, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_BREACH, GEO_update(fixAt(-31, 0, t++)));
+  TEST_ASSERT_TRUE(GEO_isOutside());
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-40, 0, t++)));
+  // Vuelta, también confirmada
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(0, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_RETURN, GEO_update(fixAt(0, 1, t++)));
+  TEST_ASSERT_FALSE(GEO_isOutside());
+
+  // Dentro de la banda no cuenta hacia ningún lado: fuera a 3 m, dentro a 3 m
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-23, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-23, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-23, 0, t++)));
+  TEST_ASSERT_FALSE(GEO_isOutside());
+  // ...y corta la racha: fuera, banda, fuera no confirma
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-30, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-22, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-30, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_BREACH, GEO_update(fixAt(-30, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-17, 0, t++)));   // dentro a 3 m
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-17, 0, t++)));
+  TEST_ASSERT_TRUE(GEO_isOutside());
+  // Junto a la esquina interior de la L (10, 5): a 5 m de ella, banda
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(5, 5, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(5, 5, t++)));
+  TEST_ASSERT_TRUE(GEO_isOutside());
+
+  // Fix no válido o sin valla: nada
+  GpsInfo bad = fixAt(-30, 0, t++);
+  bad.valid = false;
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(bad));
+  GeoFence none{};
+  GEO_setFence(none);
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-300, 0, t++)));
+  TEST_ASSERT_EQUAL_UINT8(GEO_EV_NONE, GEO_update(fixAt(-300, 0, t++)));
+}
+
+/**
+ * \brief Mascota tumbada sobre el borde una hora (fixes a 1 Hz, ruido de 3 m):
+ *        alertas con la banda y la separación frente a sólo 2 fixes.
+ */
+static void test_loitering_on_boundary() {
+  const double NOISE = 3.0;
+  const uint32_t HOUR = 3600;
+  GeoFence fence = lFence(4);
+  // Referencia: el criterio anterior (2 fixes seguidos al otro lado, sin banda)
+  uint32_t naive = 0;
+  bool naiveOut = false;
+  uint8_t naiveRun = 0;
+  uint32_t events = 0, alerts = 0;
+  uint32_t lastAlertS = 0;
+  GEO_setFence(fence);
+  for (uint32_t s = 0; s < HOUR; s++) {
+    // Junto al lado oeste, pasando de un lado a otro a ±1 m
+    double e = -20 + (s / 300 % 2 ? 1.0 : -1.0);
+    GpsInfo g = fixAt(e + gauss(NOISE), 10 + gauss(NOISE), s);
+    bool in = GEO_contains(fence, (int32_t)lround(g.lat * 1e5), (int32_t)lround(g.lon * 1e5));
+    if (in == naiveOut && ++naiveRun >= GEO_CONFIRM_FIXES) {
+      naiveRun = 0;
+      naiveOut = !in;
+      naive++;
+    } else if (in != naiveOut) {
+      naiveRun = 0;
+    }
+    events += GEO_update(g) != GEO_EV_NONE;
+    bool out;
+    if (GEO_alertDue(s * 1000UL, out)) {
+      TEST_ASSERT_TRUE(alerts == 0 || s - lastAlertS >= GEO_ALERT_GAP_S);
+      GEO_alertSent(s * 1000UL);
+      lastAlertS = s;
+      alerts++;
+    }
+  }
+  printf("[GEO] una hora sobre el borde: %u cambios sin banda, %u con banda de %u m, %u alertas\n",
+         (unsigned)naive, (unsigned)events, GEO_MARGIN_M, (unsigned)alerts);
+  TEST_ASSERT_TRUE(events * 10 <= naive);
+  TEST_ASSERT_TRUE(alerts <= HOUR / GEO_ALERT_GAP_S);
+
+  // Separación: una vuelta y otra salida dentro del hueco no avisan de nada
+  GEO_setFence(fence);
+  uint32_t t = 10000, now = 1000000UL;
+  bool out = false;
+  GEO_update(fixAt(-35, 10, t++));
+  GEO_update(fixAt(-35, 10, t++));
+  TEST_ASSERT_TRUE(GEO_alertDue(now, out));
+  TEST_ASSERT_TRUE(out);
+  GEO_alertSent(now);
+  TEST_ASSERT_FALSE(GEO_alertDue(now, out));
+  GEO_update(fixAt(0, 10, t++));
+  GEO_update(fixAt(0, 10, t++));
+  TEST_ASSERT_FALSE(GEO_isOutside());
+  TEST_ASSERT_FALSE(GEO_alertDue(now + 30000UL, out));
+  GEO_update(fixAt(-35, 10, t++));
+  GEO_update(fixAt(-35, 10, t++));
+  TEST_ASSERT_FALSE(GEO_alertDue(now + GEO_ALERT_GAP_S * 1000UL, out));   // ya avisado
+  // Una vuelta que dura más que el hueco sí sale, con el estado actual
+  GEO_update(fixAt(0, 10, t++));
+  GEO_update(fixAt(0, 10, t++));
+  TEST_ASSERT_FALSE(GEO_alertDue(now + GEO_ALERT_GAP_S * 1000UL - 1, out));
+  TEST_ASSERT_TRUE(GEO_alertDue(now + GEO_ALERT_GAP_S * 1000UL, out));
+  TEST_ASSERT_FALSE(out);
+}
+
+static void test_alert_roundtrip() {
+  GeoAlert a{9, true, fixAt(-35.5, 12.25, 12 * 3600 + 34 * 60 + 56)};
+  uint8_t buf[GEO_ALERT_LEN];
+  TEST_ASSERT_EQUAL_UINT32(GEO_ALERT_LEN, GEO_buildAlert(a, buf, sizeof(buf)));
+  GeoAlert b{};
+  TEST_ASSERT_TRUE(GEO_parseAlert(buf, sizeof(buf), b));
+  TEST_ASSERT_EQUAL_UINT8(9, b.fenceId);
+  TEST_ASSERT_TRUE(b.outside);
+  TEST_ASSERT_EQUAL_UINT32(123456, b.fix.hhmmss);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-5, a.fix.lat, b.fix.lat);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-5, a.fix.lon, b.fix.lon);
+
+  TEST_ASSERT_FALSE(GEO_parseAlert(buf, sizeof(buf) - 1, b));
+  buf[2] = 2;
+  TEST_ASSERT_FALSE(GEO_parseAlert(buf, sizeof(buf), b));
+  a.fix.valid = false;
+  TEST_ASSERT_EQUAL_UINT32(0, GEO_buildAlert(a, buf, sizeof(buf)));
+}
+
+/**
+ * \brief Salidas a 1,4 m/s en direcciones y fases aleatorias, fixes a 1 Hz con
+ *        ruido de 3 m: latencia desde el cruce real hasta que la base lo sabe.
+ * \details Los dos detectores cuentan igual: sólo vale lo detectado desde el
+ *          cruce; lo anterior (ruido junto al borde) son falsas alarmas y se
+ *          cuentan aparte. Si el collar ya estaba en estado "fuera" por una
+ *          falsa alarma al cruzar, la prueba no entra en su latencia.
+ */
+static void test_detection_latency_simulation() {
+  const double SPEED = 1.4, NOISE = 3.0;
+  const float posAirMs   = WOR_airtimeMs(13, 8);
+  const float alertAirMs = WOR_airtimeMs(GEO_ALERT_LEN, 8);
+  // Periodo normal del collar (main.cpp, 10 s) llevado al 1 % de duty-cycle,
+  // menos el aire reservado a las alertas
+  const float duty = HLT_DUTY_CYCLE - alertAirMs / (1000.0f * GEO_ALERT_GAP_S);
+  const uint16_t PERIOD = TXS_dutyPeriodS(posAirMs, 10, duty);
+  GeoFence fence = lFence(3);
+
+  std::vector<double> baseLat, collarLat;
+  uint32_t baseEarly = 0, collarEarly = 0, collarStuck = 0;
+  for (int trial = 0; trial < 300; trial++) {
+    GEO_setFence(fence);
+    double ang = uniform() * 2 * M_PI;
+    uint32_t t0 = (uint32_t)(uniform() * 3600);   // fase respecto al periodo
+    double e = 5, n = 5, crossT = -1;
+    double baseT = -1, collarT = -1;
+    bool collarWasOut = false;
+    for (uint32_t s = 0; s < 600 && (baseT < 0 || collarT < 0); s++) {
+      uint32_t sod = t0 + s;
+      e += SPEED * cos(ang);
+      n += SPEED * sin(ang);
+      if (crossT < 0 && !refInside(e, n)) {
+        crossT = s;
+        collarWasOut = GEO_isOutside();
+      }
+      GpsInfo g = fixAt(e + gauss(NOISE), n + gauss(NOISE), sod);
+      bool collarAlert = GEO_update(g) == GEO_EV_BREACH;
+      bool baseSeesOut = sod % PERIOD == 0 &&
+          !GEO_contains(fence, (int32_t)lround(g.lat * 1e5), (int32_t)lround(g.lon * 1e5));
+      if (crossT < 0) {
+        collarEarly += collarAlert;
+        baseEarly   += baseSeesOut;
+        continue;
+      }
+      if (collarT < 0 && collarAlert) collarT = s + alertAirMs / 1000.0;
+      if (baseT < 0 && baseSeesOut) baseT = s + posAirMs / 1000.0;
+      if (collarWasOut && collarT < 0 && baseT >= 0) break;
+    }
+    TEST_ASSERT_TRUE(crossT >= 0 && baseT >= 0);
+    baseLat.push_back(baseT - crossT);
+    if (collarT >= 0) collarLat.push_back(collarT - crossT);
+    else {
+      TEST_ASSERT_TRUE(collarWasOut);
+      collarStuck++;
+    }
+  }
+
+  auto stats = [](std::vector<double>& v, double& mean, double& p95, double& mx) {
+    std::sort(v.begin(), v.end());
+    mean = 0;
+    for (double x : v) mean += x;
+    mean /= v.size();
+    p95 = v[(size_t)(0.95 * (v.size() - 1))];
+    mx  = v.back();
+  };
+  double bMean, bP95, bMax, cMean, cP95, cMax;
+  stats(baseLat, bMean, bP95, bMax);
+  stats(collarLat, cMean, cP95, cMax);
+  printf("[GEO] latencia base  (periodo %u s): media %.1f s, p95 %.1f s, max %.1f s\n", PERIOD, bMean, bP95, bMax);
+  printf("[GEO] latencia collar (1 Hz, %u fixes): media %.1f s, p95 %.1f s, max %.1f s (%u pruebas)\n",
+         GEO_CONFIRM_FIXES, cMean, cP95, cMax, (unsigned)collarLat.size());
+  printf("[GEO] falsas alarmas antes del cruce en 300 pruebas: collar %u, base %u; "
+         "collar ya fuera al cruzar %u\n", (unsigned)collarEarly, (unsigned)baseEarly, (unsigned)collarStuck);
+
+  // La banda de GEO_MARGIN_M retrasa la salida ~GEO_MARGIN_M / SPEED s a cambio
+  // de no dar falsas alarmas con el ruido junto al borde
+  TEST_ASSERT_TRUE(cMean >= 0.0);   // desde el cruce, nunca antes
+  TEST_ASSERT_TRUE(cMean < bMean * 0.75);
+  TEST_ASSERT_TRUE(cP95 < bP95 * 0.75);
+  TEST_ASSERT_TRUE(collarEarly * 4 <= baseEarly);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fence_frame_roundtrip);
+  RUN_TEST(test_contains_matches_reference);
+  RUN_TEST(test_hysteresis);
+  RUN_TEST(test_loitering_on_boundary);
+  RUN_TEST(test_alert_roundtrip);
+  RUN_TEST(test_detection_latency_simulation);
+  return UNITY_END();
+}
@@ -0,0 +1,115 @@
+/** @file test_main.cpp
+ * @brief Tests de la trama de salud (empaquetado por bits, saturación y presupuesto).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include "health_frame.h"
+#include "wake_radio.h"
+
+void setUp() {}
+void tearDown() {}
+
+static HealthFrame sample() {
+  HealthFrame h{};
+  h.seq = 201; h.uptimeMin = 123456; h.resetReason = HLT_RESET_WATCHDOG; h.resetCount = 17;
+  h.ttffLastS = 34; h.ttffP90S = 612; h.txFailures = 3; h.lastTxError = -705;
+  h.tempC = -12; h.loopMaxMs = 48; h.gpsRxHwm = 63; h.minFreeHeapKb = 190;
+  return h;
+}
+
+/** Ida y vuelta de todos los campos. */
+static void test_roundtrip() {
+  HealthFrame in = sample(), out{};
+  uint8_t buf[HLT_FRAME_LEN];
+  TEST_ASSERT_EQUAL_UINT32(HLT_FRAME_LEN, HLT_buildFrame(in, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_HEX8(HLT_FRAME_TYPE, buf[0]);
+  TEST_ASSERT_TRUE(HLT_parseFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT8(in.seq, out.seq);
+  TEST_ASSERT_EQUAL_UINT32(in.uptimeMin, out.uptimeMin);
+  TEST_ASSERT_EQUAL_UINT8(in.resetReason, out.resetReason);
+  TEST_ASSERT_EQUAL_UINT8(in.resetCount, out.resetCount);
+  TEST_ASSERT_EQUAL_UINT32(in.ttffLastS, out.ttffLastS);
+  TEST_ASSERT_EQUAL_UINT32(in.ttffP90S, out.ttffP90S);
+  TEST_ASSERT_EQUAL_UINT8(in.txFailures, out.txFailures);
+  TEST_ASSERT_EQUAL_INT32(in.lastTxError, out.lastTxError);
+  TEST_ASSERT_EQUAL_INT32(in.tempC, out.tempC);
+  TEST_ASSERT_EQUAL_UINT8(in.loopMaxMs, out.loopMaxMs);
+  TEST_ASSERT_EQUAL_UINT8(in.gpsRxHwm, out.gpsRxHwm);
+  TEST_ASSERT_EQUAL_UINT8(in.minFreeHeapKb, out.minFreeHeapKb);
+}
+
+/** Posición de los primeros campos en el flujo de bits (LSB primero). */
+static void test_bit_layout() {
+  HealthFrame h{};
+  h.seq = 0xFF;
+  uint8_t buf[HLT_FRAME_LEN];
+  HLT_buildFrame(h, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_HEX8(0xF0 | HLT_VERSION, buf[1]);   // versión en los 4 bits bajos
+  TEST_ASSERT_EQUAL_HEX8(0x0F, buf[2]);                 // seq cruza el byte
+  TEST_ASSERT_EQUAL_HEX8(40 << 2, buf[11]);             // tempC = 0 → 40, desde el bit 82
+  TEST_ASSERT_EQUAL_HEX8(0x00, buf[15]);                // relleno
+}
+
+/** Los valores fuera de rango se saturan en lugar de desbordar. */
+static void test_saturation() {
+  HealthFrame in = sample(), out{};
+  in.uptimeMin = 5000000; in.ttffLastS = 4000; in.lastTxError = -30000;
+  in.tempC = 120; in.resetReason = 9;
+  uint8_t buf[HLT_FRAME_LEN];
+  HLT_buildFrame(in, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(HLT_parseFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFF, out.uptimeMin);
+  TEST_ASSERT_EQUAL_UINT32(1023, out.ttffLastS);
+  TEST_ASSERT_EQUAL_INT32(-2047, out.lastTxError);
+  TEST_ASSERT_EQUAL_INT32(87, out.tempC);
+  TEST_ASSERT_EQUAL_UINT8(HLT_RESET_OTHER, out.resetReason);
+
+  in.tempC = -100; in.lastTxError = 5;   // códigos positivos no son errores
+  HLT_buildFrame(in, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(HLT_parseFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_INT32(-40, out.tempC);
+  TEST_ASSERT_EQUAL_INT32(0, out.lastTxError);
+}
+
+/** Tipo, longitud, versión, causa y relleno. */
+static void test_rejects() {
+  HealthFrame in = sample(), out{};
+  uint8_t buf[HLT_FRAME_LEN + 1];
+  TEST_ASSERT_EQUAL_UINT32(0, HLT_buildFrame(in, buf, HLT_FRAME_LEN - 1));
+  HLT_buildFrame(in, buf, sizeof(buf));
+  TEST_ASSERT_FALSE(HLT_parseFrame(buf, HLT_FRAME_LEN + 1, out));
+  TEST_ASSERT_FALSE(HLT_parseFrame(nullptr, HLT_FRAME_LEN, out));
+
+  buf[15] = 0x80;   // relleno distinto de cero
+  TEST_ASSERT_FALSE(HLT_parseFrame(buf, HLT_FRAME_LEN, out));
+  HLT_buildFrame(in, buf, sizeof(buf));
+  buf[1] ^= 0x03;   // versión
+  TEST_ASSERT_FALSE(HLT_parseFrame(buf, HLT_FRAME_LEN, out));
+  HLT_buildFrame(in, buf, sizeof(buf));
+  buf[0] = 0xA1;
+  TEST_ASSERT_FALSE(HLT_parseFrame(buf, HLT_FRAME_LEN, out));
+}
+
+/** El intervalo mantiene la trama dentro de la fracción del duty-cycle. */
+static void test_budget() {
+  float air = WOR_airtimeMs(HLT_FRAME_LEN, 8);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 197.6f, air);
+  uint32_t s = HLT_minIntervalS(air, HLT_BUDGET_PCT / 100.0f);
+  TEST_ASSERT_EQUAL_UINT32(989, s);
+  TEST_ASSERT_TRUE(air / (s * 1000.0f) <= HLT_DUTY_CYCLE * HLT_BUDGET_PCT / 100.0f);
+  TEST_ASSERT_EQUAL_UINT32(1, HLT_minIntervalS(0.001f, 1.0f));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFUL, HLT_minIntervalS(air, 0.0f));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip);
+  RUN_TEST(test_bit_layout);
+  RUN_TEST(test_saturation);
+  RUN_TEST(test_rejects);
+  RUN_TEST(test_budget);
+  return UNITY_END();
+}
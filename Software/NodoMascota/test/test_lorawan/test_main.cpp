@@ -0,0 +1,160 @@
+/** @file test_main.cpp
+ * @brief Tests de las reglas del modo LoRaWAN frente a un servidor de red simulado.
+ *
+ * El servidor de red simulado (NsStandIn) reproduce lo que ve un LNS local: cuenta
+ * el aire por ventana de tiempo, acepta el join en un intento dado, baja el data
+ * rate por ADR tras unas cuantas subidas con buen margen y encola bajadas de
+ * aplicación. El collar simulado aplica las mismas reglas que lorawan_link.cpp
+ * (espera entre joins, periodo según el aire del data rate actual).
+ *
+ * @note No es un LNS: no pasan tramas reales por `LoRaWANNode` (join-request,
+ *       MIC, FCnt cifrado), que sólo existe con RadioLib en la placa. Aquí se
+ *       prueba lo que decide el collar alrededor de la pila MAC.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "lorawan_policy.h"
+
+void setUp() {}
+void tearDown() {}
+
+// ----------------- Servidor de red simulado -----------------
+struct NsStandIn {
+  uint32_t acceptJoinAt;      // nº de intento aceptado (0 = nunca)
+  uint32_t joinAttempts;
+  uint8_t  dr;                // data rate que impone el ADR
+  uint32_t uplinks;
+  uint32_t lastFCnt;
+  float    airMs[48];         // aire recibido por hora
+};
+
+static bool nsJoin(NsStandIn& ns, uint32_t tMs, float airMs) {
+  ns.joinAttempts++;
+  ns.airMs[tMs / 3600000UL] += airMs;
+  return ns.acceptJoinAt && ns.joinAttempts >= ns.acceptJoinAt;
+}
+
+static void nsUplink(NsStandIn& ns, uint32_t tMs, uint32_t fcnt, float airMs) {
+  TEST_ASSERT_TRUE(ns.uplinks == 0 || fcnt > ns.lastFCnt);   // sin reutilizar FCnt
+  ns.lastFCnt = fcnt;
+  ns.uplinks++;
+  ns.airMs[tMs / 3600000UL] += airMs;
+  if (ns.uplinks % 20 == 0 && ns.dr < LWP_DR_MAX) ns.dr++;   // ADR: buen SNR, sube DR
+}
+
+/** Valores de referencia de la calculadora de Semtech (CR 4/5, preámbulo 8). */
+static void test_airtime() {
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 41.2f, LWP_airtimeMs(5, 10));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 991.2f, LWP_airtimeMs(0, 10));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 1482.8f, LWP_airtimeMs(0, LWP_JOIN_REQUEST_LEN));
+  TEST_ASSERT_EQUAL_FLOAT(LWP_airtimeMs(LWP_DR_MAX, 20), LWP_airtimeMs(9, 20));
+}
+
+/** Divisor de 86400, nunca por debajo de lo pedido ni del duty-cycle. */
+static void test_period() {
+  TEST_ASSERT_EQUAL_UINT16(10, LWP_periodS(LWP_airtimeMs(5, 26), 10, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(180, LWP_periodS(LWP_airtimeMs(0, 26), 10, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(600, LWP_periodS(LWP_airtimeMs(0, 26), 600, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(45, LWP_periodS(0.0f, 41, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(43200, LWP_periodS(1e9f, 10, 0.01f));
+  for (uint16_t w = 1; w < 2000; w += 37) {
+    uint16_t p = LWP_periodS(LWP_airtimeMs(2, 26), w, 0.01f);
+    TEST_ASSERT_EQUAL_UINT32(0, 86400UL % p);
+    TEST_ASSERT_TRUE(p >= w);
+  }
+}
+
+/** Claves MSB primero; longitudes y caracteres no válidos. */
+static void test_parse_hex() {
+  uint8_t k[4];
+  TEST_ASSERT_TRUE(LWP_parseHex("00A1fF7e", k, sizeof(k)));
+  TEST_ASSERT_EQUAL_HEX8(0x00, k[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xA1, k[1]);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, k[2]);
+  TEST_ASSERT_EQUAL_HEX8(0x7E, k[3]);
+  TEST_ASSERT_FALSE(LWP_parseHex("00A1fF7", k, sizeof(k)));
+  TEST_ASSERT_FALSE(LWP_parseHex("00A1fF7e00", k, sizeof(k)));
+  TEST_ASSERT_FALSE(LWP_parseHex("00A1fG7e", k, sizeof(k)));
+  TEST_ASSERT_FALSE(LWP_parseHex(nullptr, k, sizeof(k)));
+}
+
+/** Puerto y contenido deben coincidir. */
+static void test_downlink() {
+  uint8_t buf[16];
+  WorCommand cmd{}, in = {WOR_CMD_SET_PERIOD, 9, 60};
+  AidData aid{};
+  size_t n = WOR_buildCommand(in, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT8(LWP_DL_COMMAND, LWP_parseDownlink(LWP_PORT_COMMAND, buf, n, cmd, aid));
+  TEST_ASSERT_EQUAL_UINT16(60, cmd.param);
+  TEST_ASSERT_EQUAL_UINT8(LWP_DL_NONE, LWP_parseDownlink(LWP_PORT_AIDING, buf, n, cmd, aid));
+  TEST_ASSERT_EQUAL_UINT8(LWP_DL_NONE, LWP_parseDownlink(LWP_PORT_COMMAND, buf, 0, cmd, aid));
+
+  AidData a = {845642096UL, 40.41f, -3.70f, 5, 2};
+  n = AID_buildFrame(a, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT8(LWP_DL_AIDING, LWP_parseDownlink(LWP_PORT_AIDING, buf, n, cmd, aid));
+  TEST_ASSERT_EQUAL_UINT32(a.utc, aid.utc);
+  TEST_ASSERT_EQUAL_UINT8(LWP_DL_NONE, LWP_parseDownlink(LWP_PORT_POSITION, buf, n, cmd, aid));
+}
+
+/** Sin respuesta del servidor, los join respetan 1 % / 0,1 % / 0,01 % durante 48 h. */
+static void test_join_duty_cycle() {
+  static NsStandIn ns;
+  memset(&ns, 0, sizeof(ns));
+  const float air = LWP_airtimeMs(0, LWP_JOIN_REQUEST_LEN);
+  uint32_t t = 0;
+  while (t < 48UL * 3600000UL) {
+    TEST_ASSERT_FALSE(nsJoin(ns, t, air));
+    t += (uint32_t)air + LWP_joinDelayMs(t, air);
+  }
+  // Cada ventana admite además el intento que empezó justo antes de cerrarse
+  TEST_ASSERT_TRUE(ns.airMs[0] <= 36000.0f + air);      // 1 % de la primera hora
+  float tier2 = 0, tier3 = 0;
+  for (int h = 1; h < 11; h++)  tier2 += ns.airMs[h];
+  for (int h = 24; h < 48; h++) tier3 += ns.airMs[h];
+  TEST_ASSERT_TRUE(tier2 <= 36000.0f + air);            // 0,1 % de 10 h
+  TEST_ASSERT_TRUE(tier3 <= 8640.0f + air);             // 0,01 % de 24 h
+  TEST_ASSERT_TRUE(ns.joinAttempts > 40);
+}
+
+/** Join aceptado y 6 h de subidas: con el ADR el periodo baja y el aire por hora no pasa del 1 %. */
+static void test_uplinks_with_adr() {
+  static NsStandIn ns;
+  memset(&ns, 0, sizeof(ns));
+  ns.acceptJoinAt = 3;
+  const float joinAir = LWP_airtimeMs(0, LWP_JOIN_REQUEST_LEN);
+  uint32_t t = 0;
+  while (!nsJoin(ns, t, joinAir)) t += (uint32_t)joinAir + LWP_joinDelayMs(t, joinAir);
+  TEST_ASSERT_EQUAL_UINT32(3, ns.joinAttempts);
+
+  const uint16_t wanted = 10;
+  uint32_t fcnt = 0;
+  uint16_t firstPeriod = 0, lastPeriod = 0;
+  t = 3600000UL;   // a partir de la hora 1 (el aire del join queda en la hora 0)
+  while (t < 7UL * 3600000UL) {
+    float air = LWP_airtimeMs(ns.dr, 13 + LWP_FRAME_OVERHEAD);
+    uint16_t period = LWP_periodS(air, wanted, 0.01f);
+    if (!firstPeriod) firstPeriod = period;
+    lastPeriod = period;
+    nsUplink(ns, t, ++fcnt, air);
+    t += period * 1000UL;
+  }
+  for (int h = 1; h < 7; h++) TEST_ASSERT_TRUE(ns.airMs[h] <= 36000.0f);
+  TEST_ASSERT_EQUAL_UINT8(LWP_DR_MAX, ns.dr);
+  TEST_ASSERT_EQUAL_UINT16(180, firstPeriod);
+  TEST_ASSERT_EQUAL_UINT16(wanted, lastPeriod);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_airtime);
+  RUN_TEST(test_period);
+  RUN_TEST(test_parse_hex);
+  RUN_TEST(test_downlink);
+  RUN_TEST(test_join_duty_cycle);
+  RUN_TEST(test_uplinks_with_adr);
+  return UNITY_END();
+}
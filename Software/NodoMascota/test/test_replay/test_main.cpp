@@ -0,0 +1,86 @@
+/** @file test_main.cpp
+ * @brief Tests de las trazas NMEA del modo reproducción del collar.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "replay_trace.h"
+
+void setUp() { RPL_begin(0); }
+void tearDown() {}
+
+/** \brief Comprueba el `*XX` de una sentencia NMEA. */
+static bool nmeaChecksumOk(const char* s, size_t len) {
+  if (len < 4 || s[0] != '$' || s[len - 3] != '*') return false;
+  uint8_t x = 0;
+  for (size_t i = 1; i < len - 3; i++) x ^= (uint8_t)s[i];
+  return x == (uint8_t)strtoul(s + len - 2, nullptr, 16);
+}
+
+// ----------------- Tests -----------------
+
+static void test_nmea_lines_intact() {
+  static const char* const LINES[] = {
+    "30350 $GPGGA,090530.00,4025.0080,N,00342.2280,W,1,07,1.0,655.0,M,51.0,M,,*73\r",
+    "30395\t$GPRMC,090530.00,A,4025.0080,N,00342.2280,W,1.10,0.0,181026,,,A*79  ",
+    "350 $GPGGA,090500.00,,,,,0,00,,,,,,,*44",
+  };
+  for (const char* l : LINES) {
+    RplRecord r;
+    TEST_ASSERT_TRUE_MESSAGE(RPL_parseLine(l, strlen(l), r), l);
+    TEST_ASSERT_TRUE_MESSAGE(nmeaChecksumOk(r.text, r.len), l);
+  }
+  RplRecord r;
+  TEST_ASSERT_FALSE(RPL_parseLine("# Traza de ejemplo", 18, r));
+  TEST_ASSERT_FALSE(RPL_parseLine("$GPGGA,090500.00,,,,,0,00,,,,,,,*44", 35, r));
+}
+
+/**
+ * Traza de 1 Hz con un hueco de 60 s (receptor dormido al grabar) y un loop()
+ * que sólo despierta con la alarma del siguiente registro (RPL_msUntil) y que
+ * una vez se bloquea 2500 ms (como una TX larga): el hueco se respeta y, tras
+ * el bloqueo, las épocas atrasadas salen seguidas sin desplazar el resto de
+ * la traza.
+ */
+static void test_gap_and_catch_up() {
+  uint32_t trace[40];
+  for (int i = 0; i < 40; i++) trace[i] = 350 + (uint32_t)i * 1000 + (i >= 20 ? 60000u : 0u);
+
+  uint32_t now = 1000;
+  RPL_begin(now);
+  uint32_t deliveredAt[40];
+  bool blocked = false;
+  for (int i = 0; i < 40;) {
+    if (RPL_due(trace[i], now)) {
+      RPL_delivered(trace[i], now);
+      deliveredAt[i++] = now;
+      continue;
+    }
+    if (!blocked && i == 30) { now += 2500; blocked = true; }
+    else now += RPL_msUntil(trace[i], now);
+  }
+  RplStats s = RPL_rewind(now);
+  printf("[RPL] collar: %u sentencias, retraso max %u ms, medio %.1f ms\n", (unsigned)s.records,
+         (unsigned)s.lateMaxMs, (double)s.lateSumMs / s.records);
+  TEST_ASSERT_EQUAL_UINT32(40, s.records);
+  TEST_ASSERT_EQUAL_UINT32(60000 + 1000, deliveredAt[20] - deliveredAt[19]);
+  TEST_ASSERT_EQUAL_UINT32(1500, s.lateMaxMs);
+  TEST_ASSERT_EQUAL_UINT32(deliveredAt[30], deliveredAt[31]);   // se pone al día
+  TEST_ASSERT_EQUAL_UINT32(trace[39] - trace[32], deliveredAt[39] - deliveredAt[32]);
+
+  RPL_due(500, now);
+  TEST_ASSERT_EQUAL_UINT32(1000, RPL_msUntil(1500, now));
+  TEST_ASSERT_EQUAL_UINT32(0, RPL_msUntil(400, now));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nmea_lines_intact);
+  RUN_TEST(test_gap_and_catch_up);
+  return UNITY_END();
+}
@@ -0,0 +1,88 @@
+/** @file test_main.cpp
+ * @brief Tests del planificador de transmisiones periódicas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include "tx_scheduler.h"
+
+void setUp() {
+  TXS_begin(10);
+}
+void tearDown() {}
+
+/** Con periodo 10 s sólo tocan los segundos múltiplo de 10. */
+static void test_aligned_to_period() {
+  TEST_ASSERT_TRUE(TXS_isDue(120000));
+  TEST_ASSERT_FALSE(TXS_isDue(120001));
+  TEST_ASSERT_FALSE(TXS_isDue(120009));
+  TEST_ASSERT_TRUE(TXS_isDue(120010));
+  TEST_ASSERT_TRUE(TXS_isDue(120050));
+  TEST_ASSERT_FALSE(TXS_isDue(120055));
+}
+
+/** El mismo segundo GNSS no se envía dos veces (varias vueltas de loop()). */
+static void test_no_double_send() {
+  TEST_ASSERT_TRUE(TXS_isDue(120010));
+  TXS_markSent(120010);
+  TEST_ASSERT_FALSE(TXS_isDue(120010));
+  TEST_ASSERT_TRUE(TXS_isDue(120020));
+}
+
+/** Un periodo de 60 s o más se alinea con los segundos del día, no con SS. */
+static void test_long_period() {
+  TXS_begin(300);
+  TEST_ASSERT_EQUAL_UINT16(300, TXS_period());
+  TEST_ASSERT_TRUE(TXS_isDue(120000));
+  TEST_ASSERT_FALSE(TXS_isDue(120100));
+  TEST_ASSERT_TRUE(TXS_isDue(120500));
+  TEST_ASSERT_TRUE(TXS_isDue(0));
+}
+
+/** Paso por medianoche: 00:00:00 tras 23:59:50. */
+static void test_midnight() {
+  TXS_markSent(235950);
+  TEST_ASSERT_FALSE(TXS_isDue(235959));
+  TEST_ASSERT_TRUE(TXS_isDue(0));
+}
+
+/** TXS_begin() olvida el último envío y un periodo 0 se trata como 1 s. */
+static void test_begin_resets() {
+  TXS_markSent(120010);
+  TXS_begin(10);
+  TEST_ASSERT_TRUE(TXS_isDue(120010));
+
+  TXS_begin(0);
+  TEST_ASSERT_EQUAL_UINT16(1, TXS_period());
+  TEST_ASSERT_TRUE(TXS_isDue(120011));
+}
+
+/** Periodo ajustado al duty-cycle: divisor de 86400 y nunca por debajo del mínimo. */
+static void test_duty_period() {
+  // Posición a SF9/125 kHz (~198 ms): con un 1 %, 20 s como mínimo
+  TEST_ASSERT_EQUAL_UINT16(20, TXS_dutyPeriodS(198.1f, 1, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(20, TXS_dutyPeriodS(198.1f, 0, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(40, TXS_dutyPeriodS(396.2f, 10, 0.01f));   // a 62,5 kHz
+  TEST_ASSERT_EQUAL_UINT16(300, TXS_dutyPeriodS(198.1f, 300, 0.01f));
+  TEST_ASSERT_EQUAL_UINT16(480, TXS_dutyPeriodS(198.1f, 457, 0.01f)); // siguiente divisor
+  TEST_ASSERT_EQUAL_UINT16(1, TXS_dutyPeriodS(0.0f, 0, 0.0f));
+  TEST_ASSERT_EQUAL_UINT16(TXS_PERIOD_MAX, TXS_dutyPeriodS(198.1f, 60000, 0.01f));
+  for (uint16_t w = 1; w < 2000; w += 7) {
+    uint16_t p = TXS_dutyPeriodS(198.1f, w, 0.01f);
+    TEST_ASSERT_EQUAL_UINT32(0, 86400UL % p);
+    TEST_ASSERT_TRUE(p >= w && p >= 20);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_aligned_to_period);
+  RUN_TEST(test_no_double_send);
+  RUN_TEST(test_long_period);
+  RUN_TEST(test_midnight);
+  RUN_TEST(test_begin_resets);
+  RUN_TEST(test_duty_period);
+  return UNITY_END();
+}
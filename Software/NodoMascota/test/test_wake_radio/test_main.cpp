@@ -0,0 +1,79 @@
+/** @file test_main.cpp
+ * @brief Tests de las tramas de comando y del coste de la escucha (wake-on-radio).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include "wake_radio.h"
+
+void setUp() {}
+void tearDown() {}
+
+/** Ida y vuelta y distribución de los bytes. */
+static void test_command_roundtrip() {
+  WorCommand in = {WOR_CMD_SET_PERIOD, 7, 300};
+  uint8_t buf[WOR_FRAME_LEN];
+  TEST_ASSERT_EQUAL_UINT32(WOR_FRAME_LEN, WOR_buildCommand(in, buf, sizeof(buf)));
+
+  const uint8_t expected[WOR_FRAME_LEN] = {0xC1, 0x02, 0x07, 0x2C, 0x01};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, WOR_FRAME_LEN);
+
+  WorCommand out{};
+  TEST_ASSERT_TRUE(WOR_parseCommand(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT8(WOR_CMD_SET_PERIOD, out.cmd);
+  TEST_ASSERT_EQUAL_UINT8(7, out.seq);
+  TEST_ASSERT_EQUAL_UINT16(300, out.param);
+}
+
+/** Tipo, longitud o comando desconocidos; un payload de posición no es un comando. */
+static void test_command_rejects() {
+  uint8_t buf[13] = {0xC1, 0x01, 0x00, 0x00, 0x00};
+  WorCommand out{};
+  TEST_ASSERT_FALSE(WOR_parseCommand(buf, 4, out));
+  TEST_ASSERT_FALSE(WOR_parseCommand(buf, 13, out));
+  TEST_ASSERT_FALSE(WOR_parseCommand(nullptr, WOR_FRAME_LEN, out));
+
+  buf[1] = 0;    TEST_ASSERT_FALSE(WOR_parseCommand(buf, WOR_FRAME_LEN, out));
+  buf[1] = 0x7F; TEST_ASSERT_FALSE(WOR_parseCommand(buf, WOR_FRAME_LEN, out));
+  buf[1] = 1; buf[0] = 0x01;
+  TEST_ASSERT_FALSE(WOR_parseCommand(buf, WOR_FRAME_LEN, out));
+
+  TEST_ASSERT_EQUAL_UINT32(0, WOR_buildCommand(WorCommand{WOR_CMD_PING, 0, 0}, buf, 4));
+}
+
+/** Tiempo en el aire con la calculadora de Semtech (SF9/125 kHz/4-7, 8 símbolos). */
+static void test_airtime() {
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 197.6f, WOR_airtimeMs(13, 8));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 140.3f, WOR_airtimeMs(5, 8));
+}
+
+/** El preámbulo cubre un ciclo completo de escucha de cada ajuste. */
+static void test_preamble_covers_cycle() {
+  for (uint8_t i = 0; i < WOR_presetCount(); i++) {
+    const WorSniffPreset& p = WOR_preset(i);
+    float preambleMs = WOR_preambleSymbols(i) * 4.096f;
+    TEST_ASSERT_TRUE(preambleMs * 1000.0f >= (float)(p.sleepUs + p.rxUs));
+  }
+}
+
+/** Más tiempo dormido: menos corriente y más latencia. */
+static void test_tradeoff_monotonic() {
+  for (uint8_t i = 1; i < WOR_presetCount(); i++) {
+    TEST_ASSERT_TRUE(WOR_addedCurrentUa(i) < WOR_addedCurrentUa(i - 1));
+    TEST_ASSERT_TRUE(WOR_commandLatencyMs(i) > WOR_commandLatencyMs(i - 1));
+  }
+  // Índice fuera de rango: se usa el último ajuste
+  TEST_ASSERT_EQUAL_UINT32(WOR_preset(WOR_presetCount() - 1).sleepUs, WOR_preset(200).sleepUs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_command_roundtrip);
+  RUN_TEST(test_command_rejects);
+  RUN_TEST(test_airtime);
+  RUN_TEST(test_preamble_covers_cycle);
+  RUN_TEST(test_tradeoff_monotonic);
+  return UNITY_END();
+}
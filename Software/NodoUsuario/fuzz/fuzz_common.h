@@ -0,0 +1,155 @@
+/** @file fuzz_common.h
+ * @brief Utilidades comunes de los harness de fuzzing (host).
+ *
+ * - `FUZZ_TIMED(len)`: mide el tiempo de cada entrada y aborta si supera el
+ *   presupuesto (`FUZZ_BASE_US` + 1 µs por cada `FUZZ_BYTES_PER_US` bytes),
+ *   de modo que libFuzzer guarda la entrada patológica como un fallo más.
+ *   `FUZZ_SLOW_SCALE=<factor>` escala el presupuesto (sanitizers, máquinas lentas).
+ * - Al terminar se imprime un resumen: entradas, bytes, entrada más lenta y
+ *   rendimiento (entradas/s y MB/s).
+ * - Con `-DFUZZ_STANDALONE` se añade un `main()` que reproduce ficheros o
+ *   directorios de corpus sin libFuzzer (p.ej. con g++ en CI) y, con
+ *   `-random=N`, ejecuta N entradas aleatorias.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <chrono>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const double FUZZ_BASE_US      = 2000.0;  // margen fijo por entrada
+static const double FUZZ_BYTES_PER_US = 8.0;     // ≈125 ns por byte de entrada
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+struct FuzzStats {
+  uint64_t inputs;
+  uint64_t bytes;
+  double   totalUs;
+  double   maxUs;
+  size_t   maxLen;
+};
+static FuzzStats g_fuzz = {0, 0, 0.0, 0.0, 0};
+
+/**
+ * \brief Resumen de rendimiento (se registra con atexit en la primera entrada).
+ */
+static void fuzzReport() {
+  if (g_fuzz.inputs == 0) return;
+  double s = g_fuzz.totalUs / 1e6;
+  fprintf(stderr, "[FUZZ] entradas=%llu bytes=%llu max_us=%.1f (len=%zu) %.0f entradas/s %.2f MB/s\n",
+          (unsigned long long)g_fuzz.inputs, (unsigned long long)g_fuzz.bytes,
+          g_fuzz.maxUs, g_fuzz.maxLen,
+          s > 0 ? g_fuzz.inputs / s : 0.0, s > 0 ? g_fuzz.bytes / s / 1e6 : 0.0);
+}
+
+static double fuzzSlowScale() {
+  static double scale = 0.0;
+  if (scale == 0.0) {
+    const char* env = getenv("FUZZ_SLOW_SCALE");
+    scale = env ? atof(env) : 1.0;
+    if (scale <= 0.0) scale = 1.0;
+    atexit(fuzzReport);
+  }
+  return scale;
+}
+
+/**
+ * \brief Mide una entrada; aborta si supera el presupuesto de tiempo.
+ */
+class FuzzTimer {
+ public:
+  explicit FuzzTimer(size_t len) : len_(len), t0_(std::chrono::steady_clock::now()) {}
+  ~FuzzTimer() {
+    double us = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - t0_).count();
+    g_fuzz.inputs++;
+    g_fuzz.bytes   += len_;
+    g_fuzz.totalUs += us;
+    if (us > g_fuzz.maxUs) {
+      g_fuzz.maxUs  = us;
+      g_fuzz.maxLen = len_;
+    }
+    double limit = (FUZZ_BASE_US + len_ / FUZZ_BYTES_PER_US) * fuzzSlowScale();
+    if (us > limit) {
+      fprintf(stderr, "[FUZZ] entrada lenta: %.1f us para %zu B (límite %.1f us)\n", us, len_, limit);
+      abort();
+    }
+  }
+
+ private:
+  size_t len_;
+  std::chrono::steady_clock::time_point t0_;
+};
+
+#define FUZZ_TIMED(len) FuzzTimer _fuzzTimer(len)
+
+/** \brief Violación de un invariante: termina como fallo para el fuzzer. */
+#define FUZZ_ASSERT(cond)                                               \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "[FUZZ] invariante: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+      abort();                                                          \
+    }                                                                   \
+  } while (0)
+
+#if defined(FUZZ_STANDALONE)
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+static void fuzzRunFile(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return;
+  std::vector<uint8_t> buf;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+  fclose(f);
+  LLVMFuzzerTestOneInput(buf.data(), buf.size());
+}
+
+static void fuzzRunPath(const char* path) {
+  struct stat st;
+  if (stat(path, &st) != 0) return;
+  if (!S_ISDIR(st.st_mode)) {
+    fuzzRunFile(path);
+    return;
+  }
+  DIR* d = opendir(path);
+  if (!d) return;
+  while (struct dirent* e = readdir(d)) {
+    if (e->d_name[0] == '.') continue;
+    char child[1024];
+    snprintf(child, sizeof(child), "%s/%s", path, e->d_name);
+    fuzzRunPath(child);
+  }
+  closedir(d);
+}
+
+/**
+ * \brief Reproduce corpus (ficheros o directorios) y, opcionalmente, entradas aleatorias.
+ */
+int main(int argc, char** argv) {
+  fuzzSlowScale();
+  unsigned long randomRuns = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "-random=", 8) == 0) randomRuns = strtoul(argv[i] + 8, nullptr, 10);
+    else fuzzRunPath(argv[i]);
+  }
+  srand(1);
+  std::vector<uint8_t> buf;
+  for (unsigned long r = 0; r < randomRuns; r++) {
+    buf.resize((size_t)(rand() % 512));
+    for (uint8_t& b : buf) b = (uint8_t)rand();
+    LLVMFuzzerTestOneInput(buf.data(), buf.size());
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,57 @@
+/** @file fuzz_nmea.cpp
+ * @brief Harness libFuzzer de la ingesta NMEA (TinyGPS++) y su paso a GpsInfo.
+ *
+ * Cada entrada es un flujo de bytes tal como llega por el UART del receptor
+ * (NMEA, restos de UBX, ruido). Se alimenta byte a byte al parser y, cada vez
+ * que se actualiza la posición, se extrae un GpsInfo con el mismo criterio que
+ * GPS_getInfo() y se pasa por el códec.
+ *
+ * Invariantes comprobados:
+ * - Si el códec acepta el fix, la posición está en rango y sobrevive a la ida y
+ *   vuelta por el payload de 13 B (±0,5·10⁻⁵ grados).
+ * - El tiempo por entrada es lineal en su tamaño (FUZZ_TIMED).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "fuzz_common.h"
+#include "payload_codec.h"
+#include <TinyGPS++.h>
+#include <math.h>
+
+/** \brief Mismo criterio que GPS_getInfo() en gps_handler.cpp. */
+static GpsInfo infoFrom(TinyGPSPlus& gps) {
+  GpsInfo info {0, 0, 0, false};
+  if (gps.location.isValid() && gps.time.isValid()) {
+    info.lat = gps.location.lat();
+    info.lon = gps.location.lng();
+    info.hhmmss = (uint32_t)(gps.time.hour() * 10000UL +
+                             gps.time.minute() * 100UL +
+                             gps.time.second());
+    info.valid = true;
+  }
+  return info;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  FUZZ_TIMED(size);
+  TinyGPSPlus gps;
+
+  for (size_t i = 0; i < size; i++) {
+    gps.encode((char)data[i]);
+    if (!gps.location.isUpdated()) continue;
+
+    GpsInfo info = infoFrom(gps);
+    uint8_t payload[13];
+    if (GPS_buildBinaryPayload(info, payload, sizeof(payload)) == 0) continue;
+
+    FUZZ_ASSERT(GPS_isPlausible(info));
+    GpsInfo back{};
+    FUZZ_ASSERT(GPS_parsePayload(payload, sizeof(payload), back));
+    FUZZ_ASSERT(back.hhmmss == info.hhmmss);
+    FUZZ_ASSERT(fabs(back.lat - info.lat) <= 0.0000051);
+    FUZZ_ASSERT(fabs(back.lon - info.lon) <= 0.0000051);
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+/** @file fuzz_rx_decoder.cpp
+ * @brief Harness libFuzzer de la ruta de recepción LoRa (RX_clampLength + RX_decodeFrame).
+ *
+ * Formato de la entrada: `[longitud informada: int16 LE][bytes del FIFO de la radio]`.
+ * Reproduce lo que hace LORA_rxTick(): la longitud que devuelve
+ * `radio.getPacketLength()` puede ser cualquiera (incluidos códigos de error
+ * negativos) y no tiene por qué coincidir con los bytes realmente recibidos; el
+ * resto del buffer conserva contenido anterior.
+ *
+ * Invariantes comprobados:
+ * - La longitud saneada nunca supera el buffer.
+ * - Una posición aceptada mide 13 B, está en rango y se recodifica byte a byte igual.
+ * - Una trama de salud aceptada mide 16 B y también se recodifica igual.
+ * - Una alerta de valla aceptada mide 15 B y también se recodifica igual.
+ *
+ * Los formatos nuevos que se añadan a RX_decodeFrame() quedan cubiertos sin
+ * cambiar el harness.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "fuzz_common.h"
+#include "rx_decoder.h"
+#include <string.h>
+
+static const size_t RX_BUF_LEN = 64;   // = LORA_MAX_READ en lora_handler.cpp
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 2) return 0;
+  FUZZ_TIMED(size);
+
+  int16_t reported;
+  memcpy(&reported, data, sizeof(reported));
+  const uint8_t* fifo  = data + 2;
+  size_t         avail = size - 2;
+
+  uint8_t rx[RX_BUF_LEN];
+  memset(rx, 0xA5, sizeof(rx));   // contenido residual de una recepción anterior
+
+  size_t len = RX_clampLength(reported, sizeof(rx));
+  FUZZ_ASSERT(len <= sizeof(rx));
+  memcpy(rx, fifo, len < avail ? len : avail);
+
+  GpsInfo out{};
+  HealthFrame health{};
+  GeoAlert alert{};
+  RxResult r = RX_decodeFrame(rx, len, out, &health, &alert);
+  FUZZ_ASSERT(r == RX_POSITION || r == RX_BAD_LENGTH || r == RX_BAD_FORMAT || r == RX_HEALTH ||
+              r == RX_GEO_ALERT);
+
+  if (r == RX_POSITION) {
+    FUZZ_ASSERT(len == 13);
+    FUZZ_ASSERT(out.valid);
+    FUZZ_ASSERT(GPS_isPlausible(out));
+
+    uint8_t again[13];
+    FUZZ_ASSERT(GPS_buildBinaryPayload(out, again, sizeof(again)) == 13);
+    FUZZ_ASSERT(memcmp(again, rx, 13) == 0);
+  } else if (r == RX_HEALTH) {
+    FUZZ_ASSERT(len == HLT_FRAME_LEN);
+    FUZZ_ASSERT(!out.valid);
+
+    uint8_t again[HLT_FRAME_LEN];
+    FUZZ_ASSERT(HLT_buildFrame(health, again, sizeof(again)) == HLT_FRAME_LEN);
+    FUZZ_ASSERT(memcmp(again, rx, HLT_FRAME_LEN) == 0);
+  } else if (r == RX_GEO_ALERT) {
+    FUZZ_ASSERT(len == GEO_ALERT_LEN);
+    FUZZ_ASSERT(!out.valid);
+
+    uint8_t again[GEO_ALERT_LEN];
+    FUZZ_ASSERT(GEO_buildAlert(alert, again, sizeof(again)) == GEO_ALERT_LEN);
+    FUZZ_ASSERT(memcmp(again, rx, GEO_ALERT_LEN) == 0);
+  } else {
+    FUZZ_ASSERT(!out.valid);
+  }
+  return 0;
+}
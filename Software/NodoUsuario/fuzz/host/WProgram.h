@@ -0,0 +1,28 @@
+/** @file WProgram.h
+ * @brief Sustituto mínimo del núcleo Arduino para compilar TinyGPS++ en el host.
+ *
+ * TinyGPS++ incluye `WProgram.h` cuando no está definido `ARDUINO`; sólo usa
+ * `millis()`, las macros matemáticas y las cabeceras estándar de C.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#ifndef TWO_PI
+  #define TWO_PI 6.283185307179586476925286766559
+#endif
+#define radians(deg) ((deg) * 0.017453292519943295769236907684886)
+#define degrees(rad) ((rad) * 57.295779513082320876798154814105)
+#define sq(x)        ((x) * (x))
+
+/** Reloj fijo: el fuzzer no debe depender del tiempo real (la edad de los datos es 0). */
+inline unsigned long millis() { return 0; }
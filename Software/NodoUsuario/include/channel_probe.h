@@ -0,0 +1,74 @@
+/** @file channel_probe.h
+ * @brief Secuencia de una visita de sondeo de canal (RSSI + CAD) sin perder tramas.
+ *
+ * Resintonizar y la CAD pasan la radio por standby, y eso aborta la trama que
+ * esté entrando. La ventana segura de channel_survey sólo conoce el calendario
+ * de posiciones; las alertas de valla, las respuestas a PING y las tramas de
+ * salud pueden caer dentro. Por eso PRB_visit():
+ * - No toca la radio si hay una trama recibida sin atender o si los IRQ del
+ *   SX126x indican preámbulo detectado o cabecera válida (trama en curso).
+ * - Mide el RSSI del canal de trabajo sin salir de recepción, y abandona la
+ *   visita (dejando la radio escuchando) si en ese tiempo empieza o termina
+ *   una trama.
+ * - Nunca borra el aviso de trama recibida: lo atiende LORA_rxTick().
+ *
+ * Un preámbulo falso (ruido) deja el IRQ puesto sin llegar a trama: si sigue
+ * ahí más de PRB_STALE_MS, más que cualquier trama del collar, se borra.
+ *
+ * Al medir otro canal se pierde lo que llegue al de trabajo mientras tanto
+ * (~10 ms); eso sólo lo evita la ventana segura.
+ *
+ * La radio se abstrae en ProbeRadio para probar la secuencia en el entorno
+ * nativo con una radio simulada. Sin dependencias de Arduino.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+
+static const uint8_t  PRB_RSSI_SAMPLES = 8;
+static const uint32_t PRB_RSSI_GAP_US  = 500;
+/** Actividad sin trama más larga que esto es un preámbulo falso (ms). */
+static const uint32_t PRB_STALE_MS     = 2000;
+
+/**
+ * \brief Operaciones de radio que necesita una visita.
+ */
+struct ProbeRadio {
+  bool   (*rxActivity)();            ///< IRQ de preámbulo detectado o cabecera válida.
+  void   (*clearActivity)();         ///< Borra esos IRQ (no interrumpe la recepción).
+  bool   (*rxPending)();             ///< Trama recibida aún sin leer.
+  bool   (*tune)(float freqMHz);     ///< Standby, frecuencia y recepción continua.
+  float  (*rssi)();                  ///< RSSI instantáneo (dBm).
+  int8_t (*cad)();                   ///< 1 actividad LoRa, 0 libre, <0 error.
+  void   (*delayUs)(uint32_t us);
+};
+
+/**
+ * \brief Resultado de una visita.
+ */
+enum ProbeResult : uint8_t {
+  PRB_DONE = 0,       ///< Medida completa; radio escuchando en el canal de trabajo.
+  PRB_SKIPPED_BUSY,   ///< Trama en curso o pendiente: no se tocó la radio.
+  PRB_ABORTED_RX,     ///< Empezó una trama durante el muestreo: radio escuchando.
+  PRB_ERROR           ///< Fallo de la radio; se intentó volver al canal de trabajo.
+};
+
+/**
+ * \brief Olvida la actividad observada (arranque).
+ */
+void PRB_begin();
+
+/**
+ * \brief Mide un canal: mediana de PRB_RSSI_SAMPLES muestras de RSSI y una CAD.
+ * \param r       Radio.
+ * \param workMHz Canal de trabajo (al que se vuelve).
+ * \param freqMHz Canal a medir.
+ * \param nowMs   Instante actual (para descartar actividad obsoleta).
+ * \param rssiDbm (salida) RSSI con PRB_DONE.
+ * \param busy    (salida) CAD con actividad, con PRB_DONE.
+ */
+ProbeResult PRB_visit(const ProbeRadio& r, float workMHz, float freqMHz, uint32_t nowMs,
+                      float& rssiDbm, bool& busy);
@@ -0,0 +1,85 @@
+/** @file channel_survey.h
+ * @brief Sondeo del suelo de ruido y de la ocupación de los canales de 868 MHz.
+ *
+ * En los huecos entre uplinks (el collar transmite alineado con la hora GNSS,
+ * así que la siguiente trama es predecible) la base visita un canal cada vez:
+ * mide el RSSI instantáneo y lanza una CAD. Por canal mantiene:
+ * - Suelo de ruido: media exponencial del RSSI en las visitas sin actividad LoRa.
+ * - Ocupación: fracción (exponencial) de visitas con la CAD positiva.
+ * - Interferencia: visitas sin LoRa pero con RSSI ≥ suelo + 10 dB (otras tecnologías).
+ *
+ * Con ello distingue pérdidas por alcance (margen de enlace bajo), colisiones
+ * (ocupación alta) o interferencia, y publica en `/metrics` una recomendación de
+ * canal y de factor de ensanchado (SF) para el enlace.
+ *
+ * @note Las recomendaciones son informativas: el cambio de canal o de SF tiene
+ *       que aplicarse también en el collar.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * \brief Estadísticas de un canal.
+ */
+struct SurveyChannelStats {
+  float    freqMHz;
+  float    noiseFloorDbm;   ///< Suelo de ruido estimado (NAN hasta la primera visita libre).
+  float    busyRatio;       ///< Fracción de visitas con actividad LoRa (0..1).
+  uint32_t visits;
+  uint32_t busy;
+  uint32_t interference;
+};
+
+/**
+ * \brief Inicializa las estadísticas de los canales sondeados.
+ */
+void SURVEY_begin();
+
+/**
+ * \brief Llamar desde loop(): actualiza la estimación del periodo y, si es un
+ *        hueco seguro, visita el siguiente canal.
+ */
+void SURVEY_tick();
+
+/**
+ * \brief Alerta de valla del collar (o valla nueva, con \p outside false).
+ * \details Fuera de la valla el collar envía cada pocos segundos y sin
+ *          calendario: no se sondea mientras \p outside ni durante un minuto
+ *          después de cada llamada.
+ */
+void SURVEY_noteAlert(bool outside);
+
+/**
+ * \brief Periodo de las subidas del collar estimado (ms): el intervalo más
+ *        repetido entre las tramas recientes (10 s sin datos).
+ */
+uint32_t SURVEY_periodMs();
+
+/**
+ * \brief Número de canales sondeados.
+ */
+uint8_t SURVEY_channelCount();
+
+/**
+ * \brief Estadísticas del canal \p i.
+ */
+const SurveyChannelStats& SURVEY_channel(uint8_t i);
+
+/**
+ * \brief Canal recomendado (MHz): menor suelo de ruido penalizado por ocupación.
+ */
+float SURVEY_recommendedChannel();
+
+/**
+ * \brief SF mínimo que mantiene el margen con la SNR observada (7..12).
+ */
+uint8_t SURVEY_recommendedSF();
+
+/**
+ * \brief Resumen por canal para la consola serie.
+ */
+void SURVEY_report(Stream& port);
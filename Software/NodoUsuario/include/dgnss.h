@@ -0,0 +1,72 @@
+/** @file dgnss.h
+ * @brief Corrección diferencial de las posiciones del collar con el GNSS de la base.
+ *
+ * Dos receptores cercanos comparten la mayor parte del error (ionosfera,
+ * troposfera, efemérides y reloj de los satélites). La base, quieta en una
+ * posición de referencia, calcula en cada época su propio error
+ * (`medida − referencia`) y lo guarda en un buffer circular indexado por los
+ * segundos del día UTC. Una posición del collar se corrige restando el error de
+ * la base en la misma época (interpolado si falta la exacta).
+ *
+ * Referencia:
+ * - Con `-DDGPS_REF_LAT=... -DDGPS_REF_LON=...` (posición topografiada) se usa
+ *   desde el arranque.
+ * - Si no, la base la estima promediando sus primeros `DGPS_SURVEY_SAMPLES`
+ *   fixes (survey-in); hasta entonces no se corrige.
+ *
+ * @note Sólo es válido si ambos receptores usan las mismas constelaciones y
+ *       satélites; con el collar a varios km la ganancia se reduce.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include "payload_codec.h"
+
+/** Fixes de la base promediados para estimar la referencia (1 Hz → 10 min). */
+#ifndef DGPS_SURVEY_SAMPLES
+  #define DGPS_SURVEY_SAMPLES 600
+#endif
+
+/**
+ * \brief Reinicia el buffer de errores y la referencia (la de los flags, si existe).
+ */
+void DGPS_begin();
+
+/**
+ * \brief Fija la posición de referencia de la base (grados) y termina el survey-in.
+ */
+void DGPS_setReference(double lat, double lon);
+
+/**
+ * \brief true si hay referencia (fijada o estimada).
+ */
+bool DGPS_hasReference();
+
+/**
+ * \brief Fixes acumulados del survey-in (DGPS_SURVEY_SAMPLES al terminar).
+ */
+uint32_t DGPS_surveySamples();
+
+/**
+ * \brief Añade un fix de la base: durante el survey-in alimenta la media; después,
+ *        guarda el error de esa época. Se ignoran épocas repetidas.
+ */
+void DGPS_addBaseFix(const GpsInfo& base);
+
+/**
+ * \brief Corrige una posición del collar con el error de la base en su época.
+ * \param in  Fix del collar (hhmmss = época de la medida).
+ * \param out Fix corregido (copia de \p in si devuelve false).
+ * \return false si no hay referencia o error de la base a ±2 s de la época.
+ */
+bool DGPS_correct(const GpsInfo& in, GpsInfo& out);
+
+/**
+ * \brief Módulo (m) del último error de la base almacenado.
+ */
+float DGPS_lastBaseErrorM();
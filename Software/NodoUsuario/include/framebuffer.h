@@ -0,0 +1,98 @@
+/** @file framebuffer.h
+ * @brief Framebuffer monocromo de 128x64 con envío sólo de las zonas cambiadas.
+ *
+ * Pensado para un panel SSD1306 (OLED): la memoria tiene el mismo formato que
+ * su GDDRAM (8 páginas de 128 columnas; cada byte son 8 píxeles verticales,
+ * bit 0 arriba), de modo que cualquier tramo de una página se envía tal cual.
+ *
+ * Hay dos copias:
+ * - La de dibujo, donde escriben las primitivas. Cada una anota, por página,
+ *   el intervalo de columnas que ha tocado.
+ * - La mostrada: lo que tiene el panel. FB_nextSegment() compara ambas sólo
+ *   dentro de lo tocado y devuelve, página a página, el tramo entre la primera
+ *   y la última columna que difieren, con los 6 bytes de comando que fijan la
+ *   ventana de escritura (0x21 columnas, 0x22 páginas) en direccionamiento
+ *   horizontal. Páginas seguidas que cambian de lado a lado se envían en una
+ *   sola ventana (sus datos son contiguos).
+ * Los datos del tramo apuntan a la copia mostrada, que sólo cambia en la
+ * siguiente llamada: se pueden enviar por DMA mientras se sigue dibujando.
+ * Redibujar una zona entera con el mismo contenido no genera tráfico.
+ *
+ * Texto con fuente de 5x7 (6x8 con separación): ASCII 32..95; las minúsculas
+ * se muestran en mayúsculas y el resto como '?'.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t  FB_WIDTH   = 128;
+static const uint8_t  FB_HEIGHT  = 64;
+static const uint8_t  FB_PAGES   = FB_HEIGHT / 8;
+static const size_t   FB_BYTES   = (size_t)FB_WIDTH * FB_PAGES;
+static const uint8_t  FB_CHAR_W  = 6;
+static const uint8_t  FB_CHAR_H  = 8;
+/** Bytes de comando por ventana de escritura. */
+static const uint8_t  FB_CMD_LEN = 6;
+
+/**
+ * \brief Ventana a enviar al panel: comandos y después datos.
+ */
+struct FbSegment {
+  uint8_t        cmd[FB_CMD_LEN];   ///< 0x21 x0 x1 0x22 p0 p1.
+  uint8_t        x0, x1;            ///< Columnas (inclusivas).
+  uint8_t        page0, page1;      ///< Páginas (inclusivas).
+  const uint8_t* data;              ///< (x1-x0+1)·(page1-page0+1) bytes en orden de página.
+  uint16_t       dataLen;
+};
+
+/**
+ * \brief Borra ambas copias y deja pendiente el envío de la pantalla entera.
+ */
+void FB_begin();
+
+/**
+ * \brief Olvida lo que tiene el panel (tras reiniciarlo): el siguiente envío es completo.
+ */
+void FB_invalidate();
+
+/**
+ * \brief Limita el dibujo al rectángulo dado (por defecto la pantalla entera).
+ */
+void FB_setClip(int x, int y, int w, int h);
+void FB_resetClip();
+
+void FB_pixel(int x, int y, bool on);
+bool FB_getPixel(int x, int y);
+void FB_fillRect(int x, int y, int w, int h, bool on);
+void FB_rect(int x, int y, int w, int h);
+/** \brief Recta de Bresenham entre ambos extremos (incluidos). */
+void FB_line(int x0, int y0, int x1, int y1);
+
+/**
+ * \brief Escribe \p s desde (\p x, \p y), esquina superior izquierda, sin fondo.
+ * \details Se corta en '\\0', '\\n' o el borde derecho del recorte.
+ * \return Caracteres dibujados.
+ */
+size_t FB_text(int x, int y, const char* s);
+
+/**
+ * \brief Copia de dibujo (FB_BYTES, formato GDDRAM).
+ */
+const uint8_t* FB_pixels();
+
+/**
+ * \brief Siguiente ventana con cambios; la da por enviada.
+ * \return false si el panel ya está al día.
+ */
+bool FB_nextSegment(FbSegment& seg);
+
+/**
+ * \brief true si hay zonas tocadas sin comparar (puede que no cambie nada).
+ */
+bool FB_isDirty();
@@ -0,0 +1,109 @@
+/** @file freq_track.h
+ * @brief Seguimiento del error de frecuencia del collar y presupuesto del enlace según el ancho de banda.
+ *
+ * Ningún nodo lleva TCXO: con cristales de ±20 ppm, a 868 MHz la portadora del
+ * collar puede estar a ±35 kHz de la de la base en el peor caso, más de lo que
+ * el SX1262 tolera a 62,5 kHz (±25 % del ancho de banda). La base mide el
+ * error de cada trama aceptada (`getFrequencyError()`) y:
+ * - Lo filtra con una media exponencial (FRQ_ALPHA) y su varianza, con
+ *   descarte de valores aislados (> FRQ_OUTLIER_SIGMA σ) y readquisición si
+ *   FRQ_REACQUIRE seguidos lo son (reinicio del collar, corrección aplicada).
+ * - Con FRQ_LOCK_SAMPLES muestras, si el residuo supera FRQ_CORR_MIN_HZ, pide
+ *   al collar que desplace su frecuencia (WOR_CMD_FREQ_CORR, en pasos
+ *   relativos: si el comando se pierde, el residuo sigue ahí y se repite).
+ * - Permite subidas a WOR_NARROW_BW_KHZ sólo si |residuo| + 3σ cabe en
+ *   FRQ_TOLERANCE_FRAC del ancho de banda.
+ *
+ * Incluye la sensibilidad y el tiempo en el aire para cualquier SF/BW (para
+ * comparar modos en simulación).
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const float    FRQ_ALPHA          = 0.25f;
+static const uint8_t  FRQ_LOCK_SAMPLES   = 6;
+static const float    FRQ_OUTLIER_SIGMA  = 4.0f;
+/** σ mínima supuesta al descartar (ruido de la medida del SX1262 con buena SNR). */
+static const float    FRQ_MIN_SIGMA_HZ   = 150.0f;
+static const uint8_t  FRQ_REACQUIRE      = 3;
+/** Tramas con peor SNR no se usan (la estimación del error se degrada). */
+static const float    FRQ_MIN_SNR_DB     = -15.0f;
+/** Residuo a partir del cual se corrige el collar. */
+static const float    FRQ_CORR_MIN_HZ    = 1000.0f;
+/** Corrección máxima por comando (param de 16 bits con signo). */
+static const int32_t  FRQ_CORR_MAX_HZ    = 30000;
+/** Fracción del ancho de banda usable como desvío (25 % en la hoja de datos, con margen). */
+static const float    FRQ_TOLERANCE_FRAC = 0.2f;
+
+/**
+ * \brief Estado del seguimiento.
+ */
+struct FrqState {
+  float    meanHz;     ///< Error filtrado (positivo: el collar emite por encima).
+  float    varHz2;     ///< Varianza filtrada.
+  uint16_t samples;    ///< Muestras desde la última (re)adquisición.
+  uint8_t  outliers;   ///< Descartes seguidos.
+  uint32_t accepted;   ///< Totales (métricas).
+  uint32_t rejected;
+};
+
+/**
+ * \brief Olvida el error (arranque o cambio de collar).
+ */
+void FRQ_begin();
+
+/**
+ * \brief Añade el error medido en una trama del collar.
+ * \return false si se descarta (SNR baja, valor aislado o no finito).
+ */
+bool FRQ_observe(float errHz, float snrDb);
+
+/**
+ * \brief Estado actual (sólo lectura).
+ */
+const FrqState& FRQ_state();
+
+/**
+ * \brief Desviación típica filtrada (Hz).
+ */
+float FRQ_stdHz();
+
+/**
+ * \brief true con FRQ_LOCK_SAMPLES muestras desde la última (re)adquisición.
+ */
+bool FRQ_isLocked();
+
+/**
+ * \brief Corrección (Hz) a enviar al collar o 0 si no hace falta o aún no hay enganche.
+ * \details Opuesta al error filtrado y recortada a ±FRQ_CORR_MAX_HZ.
+ */
+int16_t FRQ_correctionHz();
+
+/**
+ * \brief Anota una corrección enviada: el error esperado pasa a ser el residuo
+ *        y se exige enganchar de nuevo antes de otra.
+ */
+void FRQ_noteCorrection(int16_t hz);
+
+/**
+ * \brief true si el error seguido permite recibir con \p bwKHz.
+ */
+bool FRQ_bandwidthOk(float bwKHz);
+
+/**
+ * \brief Sensibilidad típica del SX1262 (dBm): −174 + 10·log10(BW) + NF + SNR límite del SF.
+ */
+float FRQ_sensitivityDbm(uint8_t sf, float bwKHz);
+
+/**
+ * \brief Tiempo en el aire (ms) con cabecera explícita y CRC (Semtech AN1200.13),
+ *        con optimización de baja tasa si el símbolo dura 16 ms o más.
+ */
+float FRQ_airtimeMs(size_t payloadLen, uint8_t sf, float bwKHz, uint8_t crDen, uint16_t preambleSymbols);
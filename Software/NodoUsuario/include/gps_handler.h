@@ -1,8 +1,8 @@
 /** @file gps_handler.h
  * @brief Declaraciones del módulo GPS (TinyGPS++) para lectura y codificación de coordenadas.
  *
- * Define la estructura estandarizada de datos GNSS (`GpsInfo`) y las funciones
- * de inicialización, actualización y empaquetado de información geográfica.
+ * Define las funciones de inicialización y actualización del receptor GNSS.
+ * La estructura `GpsInfo` y el códec del payload están en payload_codec.h.
  * Este módulo se utiliza tanto en el nodo transmisor como en el receptor para
  * garantizar compatibilidad en el formato del payload LoRa.
  *
@@ -14,21 +14,8 @@
 #pragma once
 #include <Arduino.h>
 #include <TinyGPSPlus.h>
-
-/**
- * \brief Estructura estandarizada para intercambiar datos GNSS.
- *
- * Campos mínimos para el caso de uso.
- *  - lat, lon en grados decimales (WGS84).
- *  - hhmmss UTC (6 dígitos empaquetados en uint32_t).
- *  - valid indica que lat/lon y hora son válidos y recientes.
- */
-struct GpsInfo {
-  double   lat;      ///< Latitud (grados decimales, WGS84).
-  double   lon;      ///< Longitud (grados decimales, WGS84).
-  uint32_t hhmmss;   ///< Hora UTC en formato HHMMSS (p.ej., 211507 = 21:15:07).
-  bool     valid;    ///< true si posición y hora son válidas (ver GPS_hasFix()).
-};
+#include "payload_codec.h"
+#include "gnss_aiding.h"
 
 /**
  * \brief Inicializa el enlace serie con el receptor GNSS.
@@ -60,11 +47,9 @@ bool GPS_hasFix();
 GpsInfo GPS_getInfo();
 
 /**
- * \brief Decodifica un payload de 13 bytes en GpsInfo.
- * \param in  Puntero al payload.
- * \param len Longitud del payload (debe ser 13).
- * \param out Estructura de salida.
- * \return true si se decodifica correctamente y el fix_flag==1.
- * \note Si quieres aceptar “no fix”, relaja la comprobación del primer byte.
+ * \brief Datos de asistencia para el collar a partir del fix de la base.
+ * \details Hora UTC compensada con la antigüedad de la última sentencia y
+ *          posición de la base con una incertidumbre que cubre el alcance LoRa.
+ * \return false si no hay fecha, hora y posición válidas y recientes.
  */
-bool GPS_parsePayload(const uint8_t* in, size_t len, GpsInfo& out);
+bool GPS_aidingData(AidData& out);
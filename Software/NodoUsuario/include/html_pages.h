@@ -38,4 +38,13 @@ String generateCredentialsSavedHTML();
  */
 String generateCoordsHTML();
 
+/**
+ * \brief Genera la página de reglas de alerta.
+ * \details Carga /rules.html y sustituye %%SOURCE%% por el texto de las reglas,
+ *          %%STATUS%% por \p status y %%RULES%% por una fila por regla compilada
+ *          (bytecode, `durante`, estado y avisos; rule_engine).
+ * \param nowS Reloj de RUL_evaluate() para la antigüedad del último aviso.
+ */
+String generateRulesHTML(const String& source, const String& status, uint32_t nowS);
+
 #endif
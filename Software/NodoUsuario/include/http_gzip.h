@@ -0,0 +1,97 @@
+/** @file http_gzip.h
+ * @brief Compresión gzip en streaming de las respuestas HTTP dinámicas.
+ *
+ * Los ficheros estáticos pueden ir precomprimidos, pero las páginas y CSV que
+ * se generan en cada petición (`/health`, `/anomalies`, `/metrics`, el
+ * escaneo WiFi...) viajaban en claro por el enlace lento del AP del Pico W.
+ * Este codificador DEFLATE (RFC 1951) con envoltorio gzip (RFC 1952) comprime
+ * por trozos a medida que se genera la respuesta:
+ * - LZ77 con ventana de GZ_WINDOW bytes, tabla hash de 3 bytes y cadenas de
+ *   como mucho GZ_MAX_CHAIN candidatos (coste por byte acotado).
+ * - Códigos Huffman fijos (bloque tipo 1): sin tablas dinámicas ni segunda
+ *   pasada; el texto repetitivo de HTML y Prometheus comprime
+ *   ~4×, los CSV numéricos ~2×.
+ * - Memoria fija: un GzStream (≈ 6,5 KB con la configuración por defecto). El
+ *   WebServer atiende un cliente cada vez, así que basta uno estático.
+ * - La salida se entrega al sumidero en trozos de GZ_OUT_CHUNK bytes (listos
+ *   para `sendContent()` con transferencia chunked).
+ *
+ * Por debajo de GZ_MIN_BYTES no compensa (cabecera + cola gzip de 18 bytes y
+ * la CPU): la decisión es de quien llama (GZ_worthIt()).
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/** Ventana LZ77 (potencia de 2, de 512 a 16384). */
+#ifndef GZ_WINDOW
+  #define GZ_WINDOW 1024
+#endif
+/** Respuestas más cortas se envían sin comprimir. */
+#ifndef GZ_MIN_BYTES
+  #define GZ_MIN_BYTES 512
+#endif
+
+static const uint8_t  GZ_HASH_BITS = 10;
+static const uint8_t  GZ_MAX_CHAIN = 16;
+static const uint16_t GZ_OUT_CHUNK = 512;
+
+/**
+ * \brief Recibe la salida comprimida (mismo formato que MetricsSink).
+ */
+typedef void (*GzSink)(const char* data, size_t len, void* ctx);
+
+/**
+ * \brief Estado de una compresión en curso (tamaño fijo).
+ */
+struct GzStream {
+  uint8_t  win[2 * GZ_WINDOW];        ///< Ventana + datos pendientes de codificar.
+  uint16_t head[1 << GZ_HASH_BITS];   ///< Última posición (+1) por hash; 0 = vacía.
+  uint16_t prev[GZ_WINDOW];           ///< Posición anterior (+1) con el mismo hash.
+  char     out[GZ_OUT_CHUNK];
+  uint16_t outLen;
+  uint16_t pos;                       ///< Siguiente byte a codificar en \c win.
+  uint16_t end;                       ///< Fin de los datos en \c win.
+  uint32_t bitBuf;
+  uint8_t  bitCount;
+  uint32_t crc;
+  uint32_t inBytes;
+  uint32_t outBytes;
+  GzSink   sink;
+  void*    ctx;
+};
+
+/**
+ * \brief true si la respuesta merece comprimirse (cliente con gzip y tamaño suficiente).
+ * \details Respeta los q-valores: `gzip;q=0` (o `*;q=0` sin gzip explícito) es
+ *          un rechazo, no una preferencia baja.
+ * \param acceptEncoding Cabecera `Accept-Encoding` de la petición (puede ser nullptr).
+ * \param len            Tamaño sin comprimir; 0 = desconocido (streaming).
+ */
+bool GZ_worthIt(const char* acceptEncoding, size_t len);
+
+/**
+ * \brief Empieza una respuesta comprimida (escribe la cabecera gzip).
+ */
+void GZ_begin(GzStream& z, GzSink sink, void* ctx);
+
+/**
+ * \brief Comprime \p len bytes más; entrega al sumidero los trozos que se llenan.
+ */
+void GZ_write(GzStream& z, const void* data, size_t len);
+
+/**
+ * \brief Codifica lo pendiente, cierra el flujo DEFLATE y escribe la cola gzip.
+ */
+void GZ_finish(GzStream& z);
+
+/**
+ * \brief Adaptador a MetricsSink/GzSink: \p ctx es el GzStream.
+ */
+void GZ_sink(const char* data, size_t len, void* ctx);
@@ -5,6 +5,11 @@
  * utilizada para mostrar el estado del nodo receptor, como la dirección IP o mensajes
  * de configuración. Compatible con el controlador HD44780 y la interfaz I²C.
  *
+ * Con `-DDISPLAY_OLED` (entorno `rpipicow_oled`) se usa en su lugar un OLED
+ * SSD1306 de 128x64 por SPI1: los mensajes ocupan las dos primeras líneas y
+ * debajo se dibuja el minimapa del collar (minimap.h). Sólo se envían las
+ * zonas que cambian (framebuffer.h), por DMA desde LCD_tick().
+ *
  * @author Verónica Lechón Rodríguez
  * @date 23/07/2025
  */
@@ -21,6 +26,9 @@
  * (GP2 → SDA1, GP3 → SCL1) e inicializa el controlador
  * `hd44780_I2Cexp`. Enciende la retroiluminación.
  *
+ * Con `-DDISPLAY_OLED` configura SPI1 (GP10 → SCK, GP11 → MOSI, GP13 → CS,
+ * GP14 → D/C, GP15 → RST), reinicia el SSD1306 y envía la pantalla entera.
+ *
  * \note Debe llamarse una única vez al arrancar el sistema
  *       (p. ej. en `setup()`).
  */
@@ -33,8 +41,27 @@ void confLCD();
  * recibido. Si el mensaje supera el ancho de una línea (16 caracteres),
  * continúa en la segunda línea.
  *
+ * En el OLED las líneas son de 21 caracteres, un '\\n' pasa a la segunda y
+ * el mensaje se envía en el acto (se usa durante el arranque, sin loop()).
+ *
  * \param message Cadena a mostrar (se trunca al tamaño del display).
  */
 void showLCDMessage(const String &message);
 
+/**
+ * \brief Posición de la base: centro del minimapa (sin efecto en el HD44780).
+ */
+void LCD_setBasePosition(double lat, double lon);
+
+/**
+ * \brief Añade una posición del collar al minimapa (sin efecto en el HD44780).
+ */
+void LCD_addTrackPoint(double lat, double lon);
+
+/**
+ * \brief Redibuja el minimapa cada segundo y envía los cambios por DMA sin
+ *        esperar (sin efecto en el HD44780). Llamar desde loop().
+ */
+void LCD_tick();
+
 #endif
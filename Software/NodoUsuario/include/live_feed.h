@@ -0,0 +1,130 @@
+/** @file live_feed.h
+ * @brief Difusión de las posiciones del collar en la LAN por UDP multicast.
+ *
+ * Los paneles y servidores de la red local no necesitan sondear el servidor
+ * HTTP (la ruta más cara de la base): cada posición aceptada sale una sola vez
+ * como un datagrama binario de LF_DATAGRAM_LEN bytes al grupo LF_GROUP, y el
+ * número de oyentes no cambia nada en la base.
+ *
+ * Formato (little-endian):
+ *
+ *     [magia 'L' 'F'][versión][flags][seq:4][arranque:2][envío_ms:4]
+ *     [lat:4][lon:4][hhmmss:4][espera_ms:2][-rssi][snr*4]
+ *
+ * - `seq` crece en uno por datagrama; `arranque` es aleatorio en cada arranque
+ *   de la base, de modo que el oyente distingue un reinicio de un hueco.
+ * - `envío_ms` es el reloj de la base al enviar: sin relojes sincronizados, su
+ *   diferencia con el reloj del oyente da la variación del retardo de la red.
+ * - `espera_ms` es el tiempo en la base entre la recepción LoRa y el envío
+ *   (incluida la espera a la corrección diferencial).
+ * - lat/lon en 1e-7 grados; hhmmss es la hora UTC del fix del collar.
+ *
+ * Este módulo contiene el formato y el seguimiento del lado del oyente
+ * (huecos, duplicados, desorden y retardo), común al firmware y a la
+ * herramienta `tools/feed_listen.cpp`.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/** Grupo multicast (ámbito de organización, RFC 2365) y puerto; puerto 0 = sin difusión. */
+#ifndef LF_GROUP
+  #define LF_GROUP "239.255.76.70"
+#endif
+#ifndef LF_PORT
+  #define LF_PORT 4270
+#endif
+
+static const uint8_t LF_VERSION      = 1;
+static const size_t  LF_DATAGRAM_LEN = 30;
+/** Datagramas recientes en los que se distingue un retraso de un duplicado. */
+static const uint8_t LF_WINDOW       = 64;
+
+/** \brief Bits de LiveFix::flags. */
+enum LfFlag : uint8_t {
+  LF_FLAG_DGPS    = 0x01,   ///< Corregida con el error de la base (dgnss).
+  LF_FLAG_ANOMALY = 0x02,   ///< Marcada por el modelo de movimiento.
+  LF_FLAG_OUTSIDE = 0x04    ///< Fuera de la valla según la última alerta.
+};
+
+/**
+ * \brief Contenido de un datagrama.
+ */
+struct LiveFix {
+  uint32_t seq;
+  uint16_t bootId;
+  uint8_t  flags;     ///< LF_FLAG_*.
+  uint32_t sendMs;    ///< Reloj de la base al enviar.
+  double   lat;
+  double   lon;
+  uint32_t hhmmss;
+  uint16_t holdMs;    ///< Recepción LoRa → envío (satura).
+  float    rssi;      ///< dBm (0 … −255).
+  float    snr;       ///< dB (pasos de 0,25).
+};
+
+/**
+ * \brief Codifica un datagrama.
+ * \return LF_DATAGRAM_LEN o 0 si no cabe.
+ */
+size_t LF_encode(const LiveFix& fix, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica un datagrama.
+ * \return false si la longitud, la magia o la versión no coinciden.
+ */
+bool LF_decode(const uint8_t* buf, size_t len, LiveFix& out);
+
+/**
+ * \brief Qué ha sido un datagrama para el oyente.
+ */
+enum LfKind : uint8_t {
+  LF_NEW = 0,     ///< El siguiente o posterior (los intermedios cuentan como perdidos).
+  LF_LATE,        ///< Llega tarde, dentro de la ventana: deja de contar como perdido (si se contó).
+  LF_DUPLICATE,   ///< Ya recibido.
+  LF_STALE,       ///< Más antiguo que la ventana (se ignora).
+  LF_RESTART      ///< Primer datagrama de un arranque nuevo de la base.
+};
+
+/**
+ * \brief Seguimiento de una base desde el oyente.
+ */
+struct LfTracker {
+  bool     started;
+  uint16_t bootId;
+  uint32_t first;       ///< Primer seq del arranque actual.
+  uint32_t highest;     ///< Mayor seq recibido.
+  uint64_t window;      ///< Bit i: recibido highest − i.
+  int32_t  minOwdMs;    ///< Menor (recepción − envío_ms) del arranque actual.
+  uint32_t received;
+  uint32_t lost;        ///< Huecos aún sin rellenar.
+  uint32_t late;
+  uint32_t duplicates;
+  uint32_t restarts;
+};
+
+/**
+ * \brief Resultado de LF_track().
+ */
+struct LfEvent {
+  LfKind   kind;
+  uint32_t gap;        ///< LF_NEW: datagramas saltados.
+  uint32_t jitterMs;   ///< Retardo sobre el mínimo observado (mismo arranque).
+};
+
+/**
+ * \brief Sin datagramas.
+ */
+void LF_trackBegin(LfTracker& t);
+
+/**
+ * \brief Anota un datagrama recibido.
+ * \param recvMs Reloj monótono del oyente al recibirlo.
+ */
+LfEvent LF_track(LfTracker& t, const LiveFix& fix, uint32_t recvMs);
@@ -3,7 +3,10 @@
 *
 * Este módulo define las siguientes funciones de inicialización del transceptor, la recepción
 * continua, la activación del flag ISR de "paquete recibido" y almacena y expone la última
-* estampa GNSS válida decodificada desde un payload binario de 13 B.
+* estampa GNSS válida decodificada desde un payload binario de 13 B y la última trama
+* de salud del collar y la última alerta de valla, junto con el error de frecuencia
+* de cada trama aceptada. Cada trama recibida puede entregarse además, con sus metadatos,
+* a un gancho (reenvío por UDP, pkt_forwarder.h).
 *
 * @author Verónica Lechón Rodríguez
 * @date 23/07/2025
@@ -14,13 +17,44 @@
 #include <RadioLib.h>
 #include <Arduino.h>
 #include "gps_handler.h"
+#include "wake_radio.h"
+#include "health_frame.h"
+#include "geofence.h"
+
+// ----------------- Modulación -----------------
+/** Palabra de sincronización: 0x12 (enlace privado) o 0x34 (subidas LoRaWAN públicas). */
+#ifndef LORA_SYNC_WORD
+  #define LORA_SYNC_WORD 0x12
+#endif
+/** Factor de ensanchado (SF9 = DR3 de EU868 al escuchar LoRaWAN). */
+#ifndef LORA_SF
+  #define LORA_SF 9
+#endif
+/** Denominador de la tasa de código 4/x (LoRaWAN usa 4/5). */
+#ifndef LORA_CR_DEN
+  #define LORA_CR_DEN 7
+#endif
+static const uint16_t LORA_BW_KHZ = 125;
+
+/**
+ * \brief Trama recibida y sus metadatos de radio.
+ */
+struct LoraRxFrame {
+  const uint8_t* data;
+  size_t         len;
+  float          rssi;   ///< dBm.
+  float          snr;    ///< dB.
+  float          freqErrHz;   ///< Error de frecuencia estimado por el SX1262 (Hz).
+  uint32_t       rxUs;   ///< micros() en la ISR de fin de recepción.
+};
 
 /**
  * \brief Inicializa el SX1262 con la configuración LoRa indicada.
  * \param freqMHz Frecuencia central en MHz (p.ej., 868.1).
  * \return true si el radio quedó inicializado.
- * \details Fija BW=125 kHz, SF=9, CR=4/7, syncWord=0x12 (privado), power=14 dBm,
- * preámbulo=8 símbolos. Configura los pines del RF switch (RX/TX enable).
+ * \details Fija BW=125 kHz, SF=LORA_SF (9), CR=4/LORA_CR_DEN (4/7),
+ * syncWord=LORA_SYNC_WORD (0x12, privado), power=14 dBm, preámbulo=8 símbolos.
+ * Configura los pines del RF switch (RX/TX enable).
  */
 bool LORA_begin(float freqMHz);
 
@@ -38,6 +72,24 @@ bool LORA_startRx();
  */
 void LORA_rxTick();
 
+/**
+ * \brief Registra la función que recibe cada trama leída sin error (nullptr = ninguna).
+ * \details Se llama desde LORA_rxTick() antes de decodificar la trama, con
+ *          \p data válido sólo durante la llamada: debe copiar y volver enseguida.
+ */
+void LORA_setRxHook(void (*hook)(const LoraRxFrame& frame));
+
+#if defined(REPLAY_MODE)
+/**
+ * \brief Entrega una trama grabada a la ruta de recepción (modo reproducción).
+ * \details LORA_rxTick() la procesa como si viniera de la radio (métricas,
+ *          gancho de reenvío, decodificación y perfilado), con los metadatos
+ *          grabados; las tramas que lleguen de verdad se descartan.
+ * \return false si aún hay otra trama o un envío pendiente (reintentar luego).
+ */
+bool LORA_injectFrame(const uint8_t* data, size_t len, float rssi, float snr, float freqErrHz);
+#endif
+
 /**
  * \brief Devuelve la última estampa GNSS válida y métricas RF asociadas.
  * \param out Estructura \c GpsInfo de salida (sólo válida si la función devuelve true).
@@ -46,3 +98,108 @@ void LORA_rxTick();
  * \return true si existe una estampa previa válida, false en caso contrario.
  */
 bool LORA_lastValidGPS(GpsInfo& out, float* rssi_dBm = nullptr, float* snr_dB = nullptr);
+
+/**
+ * \brief Devuelve la última trama de salud recibida del collar (health_frame.h).
+ * \param out  Trama decodificada (sólo válida si la función devuelve true).
+ * \param rxMs (opcional) Instante (millis) en que llegó.
+ * \return false si aún no ha llegado ninguna.
+ */
+bool LORA_lastHealth(HealthFrame& out, uint32_t* rxMs = nullptr);
+
+/**
+ * \brief Error de frecuencia de la última trama aceptada del collar (posición, salud o alerta).
+ * \param errHz (salida) Positivo si el collar emite por encima de la base.
+ * \param snrDb (salida) SNR de esa trama.
+ * \param rxMs  (salida) Instante (millis) en que llegó.
+ * \return false si aún no ha llegado ninguna.
+ */
+bool LORA_lastFreqError(float& errHz, float& snrDb, uint32_t& rxMs);
+
+/**
+ * \brief Cambia el ancho de banda de recepción de las subidas (125 kHz o WOR_NARROW_BW_KHZ).
+ * \details El estrecho se recibe a WOR_NARROW_SF (WOR_uplinkSF()), como emite el
+ *          collar. Las bajadas se emiten siempre a SF9/LORA_BW_KHZ. Con una bajada en curso,
+ *          el cambio se aplica al terminarla.
+ * \return false si el valor no es uno de los dos admitidos o la radio lo rechaza.
+ */
+bool LORA_setUplinkBandwidth(float kHz);
+
+/**
+ * \brief Ancho de banda de recepción de las subidas (kHz).
+ */
+float LORA_uplinkBandwidth();
+
+/**
+ * \brief Devuelve la última alerta de valla recibida del collar (geofence.h).
+ * \param out  Alerta decodificada (sólo válida si la función devuelve true).
+ * \param rxMs (opcional) Instante (millis) en que llegó.
+ * \return false si aún no ha llegado ninguna.
+ * \note La posición de la alerta actualiza también la última estampa GNSS.
+ */
+bool LORA_lastGeoAlert(GeoAlert& out, uint32_t* rxMs = nullptr);
+
+/**
+ * \brief Envía un comando al collar (wake-on-radio) con preámbulo largo.
+ * \param cmd    Comando (ver WorCmd).
+ * \param param  Parámetro del comando.
+ * \param seqOut (opcional) Número de secuencia asignado.
+ * \return false si hay un envío en curso, el duty-cycle no lo permite aún o la radio falla.
+ * \note Tras un WOR_CMD_SET_SNIFF aceptado, los siguientes comandos usan el preámbulo
+ *       del nuevo ajuste; tras un WOR_CMD_SET_UL_BW, la base recibe con el nuevo
+ *       ancho de banda.
+ */
+bool LORA_sendCommand(WorCmd cmd, uint16_t param, uint8_t* seqOut = nullptr);
+
+/**
+ * \brief Envía asistencia GNSS al collar (gnss_aiding.h) con el mismo preámbulo
+ *        largo y el mismo presupuesto de duty-cycle que los comandos.
+ * \param aid Datos de asistencia; la hora se sella justo antes de transmitir.
+ * \return false si hay un envío en curso, el duty-cycle no lo permite aún o la radio falla.
+ */
+bool LORA_sendAiding(const AidData& aid);
+
+/**
+ * \brief Envía la valla de casa al collar (geofence.h) con el mismo preámbulo
+ *        largo y el mismo presupuesto de duty-cycle que los comandos.
+ * \param fence Valla (count = 0 la desactiva en el collar).
+ * \return false si hay un envío en curso, el duty-cycle no lo permite aún o la radio falla.
+ */
+bool LORA_sendFence(const GeoFence& fence);
+
+/**
+ * \brief Milisegundos que faltan para poder enviar otro comando (0 = ya se puede).
+ */
+uint32_t LORA_commandWaitMs();
+
+/**
+ * \brief Ajuste de escucha que la base supone activo en el collar.
+ */
+uint8_t LORA_collarSniffPreset();
+
+/**
+ * \brief Instante (millis) de la última posición aceptada (0 si no ha llegado ninguna).
+ */
+uint32_t LORA_lastRxMs();
+
+/**
+ * \brief Instante (millis) del último comando enviado al collar (0 si ninguno).
+ */
+uint32_t LORA_lastCommandMs();
+
+/**
+ * \brief Frecuencia de trabajo configurada en LORA_begin() (MHz).
+ */
+float LORA_frequency();
+
+/**
+ * \brief Mide el canal indicado: RSSI instantáneo (mediana) y detección de actividad LoRa (CAD).
+ * \param freqMHz Canal a medir (si difiere del de trabajo, se resintoniza y se vuelve).
+ * \param rssiDbm (salida) RSSI instantáneo en dBm.
+ * \param busy    (salida) true si la CAD detectó un preámbulo LoRa.
+ * \return false si había un envío o una trama en curso o pendiente (se cede el
+ *         turno sin tocar la radio ni el aviso de trama) o falló la medida.
+ * \warning Fuera del canal de trabajo no se recibe durante ~10 ms: llamar sólo
+ *          fuera de las ventanas de uplink.
+ */
+bool LORA_probeChannel(float freqMHz, float* rssiDbm, bool* busy);
@@ -0,0 +1,77 @@
+/** @file minimap.h
+ * @brief Minimapa del collar respecto a la base, dibujado en el framebuffer.
+ *
+ * Mitad inferior de la pantalla de 128x64 (las dos primeras líneas son para
+ * los mensajes de estado):
+ * - Cuadro de MAP_SIZE píxeles a la izquierda, norte arriba, con la base en
+ *   el centro (cruz), el rastro de las últimas MAP_TRAIL posiciones unidas
+ *   por rectas y la última marcada con un cuadrado.
+ * - Escala automática: el menor radio de MAP_RADII_M que abarca todo el
+ *   rastro (lo que quede fuera se recorta en el borde).
+ * - A la derecha, en texto: radio del cuadro, distancia y rumbo desde la
+ *   base y antigüedad de la última posición.
+ * Sin posición de la base, el centro es la última posición del collar.
+ *
+ * Cada llamada a MAP_render() redibuja la zona entera; framebuffer sólo envía
+ * lo que cambia (normalmente la antigüedad y, con un fix nuevo, el tramo del
+ * rastro y la distancia).
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t  MAP_TRAIL   = 32;
+static const uint8_t  MAP_X       = 0;
+static const uint8_t  MAP_Y       = 16;
+static const uint8_t  MAP_SIZE    = 48;
+static const uint8_t  MAP_PANEL_X = MAP_X + MAP_SIZE + 4;
+static const uint8_t  MAP_RADII   = 11;
+static const uint32_t MAP_RADII_M[MAP_RADII] = {25, 50, 100, 200, 500, 1000, 2000, 5000,
+                                                10000, 20000, 50000};
+/** Desplazamiento de la base que recentra el mapa (m). */
+static const float    MAP_ORIGIN_MOVE_M = 20.0f;
+/** Antigüedad desconocida para MAP_render(). */
+static const uint32_t MAP_AGE_UNKNOWN = 0xFFFFFFFFUL;
+
+/**
+ * \brief Sin base ni rastro.
+ */
+void MAP_begin();
+
+/**
+ * \brief Fija la posición de la base (centro del mapa).
+ * \details Ya fijada, sólo cambia si se aleja más de MAP_ORIGIN_MOVE_M: con
+ *          el ruido del GNSS de la base se movería todo el rastro en cada fix.
+ * \return true si ha cambiado.
+ */
+bool MAP_setOrigin(double lat, double lon);
+bool MAP_hasOrigin();
+
+/**
+ * \brief Añade una posición del collar al rastro (descarta la más antigua si está lleno).
+ */
+void MAP_addFix(double lat, double lon);
+uint8_t MAP_count();
+
+/**
+ * \brief Radio del cuadro (m) con el rastro actual.
+ */
+uint32_t MAP_radiusM();
+
+/**
+ * \brief Píxel de (\p lat, \p lon) con la escala actual.
+ * \return false si cae fuera del cuadro o no hay centro.
+ */
+bool MAP_project(double lat, double lon, int& x, int& y);
+
+/**
+ * \brief Redibuja la mitad inferior.
+ * \param ageS Segundos desde la última posición (MAP_AGE_UNKNOWN si no se sabe).
+ */
+void MAP_render(uint32_t ageS);
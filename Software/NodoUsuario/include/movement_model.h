@@ -0,0 +1,99 @@
+/** @file movement_model.h
+ * @brief Detección en línea de movimientos anómalos del collar (zona y velocidad por hora del día).
+ *
+ * La base aprende, para cada hora UTC del día, dónde suele estar la mascota y a
+ * qué velocidad se mueve, y marca cada fix nuevo que se sale de lo habitual
+ * antes de incorporarlo al modelo (se evalúa al llegar, sin esperar a más fixes):
+ * - Zona: sketch count-min (MOV_DEPTH × MOV_WIDTH contadores de 16 bits)
+ *   indexado por (celda de ~150 m, hora). Un fix es anómalo si su celda y las
+ *   8 vecinas suman menos de MOV_LOC_MIN_FRAC de los fixes de esa hora.
+ *   El sketch sólo sobrestima, así que no produce falsas alarmas por colisiones
+ *   (sí puede ocultar alguna).
+ * - Velocidad: histograma por hora con MOV_SPEED_BINS clases (m/s) a partir de
+ *   fixes consecutivos. Es anómala si la probabilidad de ir a esa velocidad o
+ *   más es menor que MOV_SPEED_MIN_FRAC.
+ * - Sin MOV_WARMUP fixes en una hora no se marca nada en ella.
+ * - Olvido: cuando una hora acumula MOV_HALVE_AT fixes se dividen a la mitad
+ *   todos los contadores de zona (y los de velocidad de esa hora al llegar a
+ *   ese total), de modo que el modelo sigue los cambios de costumbres.
+ *
+ * Coste por fix constante: 36 lecturas del sketch, 4 escrituras y una suma de
+ * ≤ MOV_SPEED_BINS clases (el olvido, ocasional, recorre el sketch una vez).
+ * Memoria fija: sizeof(MovState) ≈ 9 KB, que se guarda tal cual en LittleFS.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "payload_codec.h"
+
+static const uint8_t  MOV_DEPTH          = 4;
+static const uint16_t MOV_WIDTH          = 1024;    ///< Potencia de 2.
+static const uint8_t  MOV_HOURS          = 24;
+static const uint8_t  MOV_SPEED_BINS     = 10;
+static const float    MOV_CELL_DEG       = 0.0015f; ///< Lado de la celda en latitud (~167 m).
+static const uint16_t MOV_WARMUP         = 60;      ///< Fixes por hora antes de evaluar.
+static const uint16_t MOV_HALVE_AT       = 4096;
+static const float    MOV_LOC_MIN_FRAC   = 0.01f;
+static const float    MOV_SPEED_MIN_FRAC = 0.01f;
+static const float    MOV_SPEED_MIN_MPS  = 1.0f;    ///< Por debajo nunca es anómala.
+static const uint16_t MOV_MAX_GAP_S      = 900;     ///< Hueco máximo para estimar velocidad.
+
+/** Bits de MovScore::flags. */
+static const uint8_t MOV_FLAG_LOCATION = 0x01;
+static const uint8_t MOV_FLAG_SPEED    = 0x02;
+
+/**
+ * \brief Estado aprendido (se persiste completo).
+ */
+struct MovState {
+  uint32_t magic;
+  uint32_t checksum;                               ///< FNV-1a del resto (desde \c cms).
+  uint16_t cms[MOV_DEPTH][MOV_WIDTH];
+  uint32_t locTotal[MOV_HOURS];
+  uint16_t speed[MOV_HOURS][MOV_SPEED_BINS];
+  uint32_t speedTotal[MOV_HOURS];
+};
+
+/**
+ * \brief Resultado de evaluar un fix.
+ */
+struct MovScore {
+  uint8_t flags;       ///< MOV_FLAG_*; 0 = normal.
+  uint8_t hour;        ///< Hora UTC del fix.
+  float   locFrac;     ///< Fracción de fixes de esa hora en la zona (−1 = sin datos suficientes).
+  float   speedMps;    ///< Velocidad desde el fix anterior (−1 = sin fix anterior utilizable).
+  float   speedTail;   ///< Probabilidad de ir a esa velocidad o más (−1 = sin datos suficientes).
+};
+
+/**
+ * \brief Modelo vacío (olvida lo aprendido y el fix anterior).
+ */
+void MOV_begin();
+
+/**
+ * \brief Evalúa un fix frente al modelo y después lo aprende.
+ * \param fix Posición del collar (hhmmss = época UTC del fix).
+ */
+MovScore MOV_observe(const GpsInfo& fix);
+
+/**
+ * \brief Estado aprendido, con la suma de control al día (para guardarlo).
+ */
+const MovState& MOV_state();
+
+/**
+ * \brief Restaura un estado guardado.
+ * \return false (y modelo vacío) si el tamaño, la marca o la suma de control no cuadran.
+ */
+bool MOV_load(const void* data, size_t len);
+
+/**
+ * \brief Fixes aprendidos en la hora \p hour (tras el último olvido).
+ */
+uint32_t MOV_hourSamples(uint8_t hour);
@@ -0,0 +1,50 @@
+/** @file pkt_forwarder.h
+ * @brief Modo packet forwarder de un canal: reenvío por UDP (Semtech) de las tramas recibidas.
+ *
+ * Con `-DPKT_FWD_MODE` (entorno `rpipicow_fwd`) la base entrega cada trama que
+ * recibe, con su `tmst`, hora UTC (del GNSS de la base, si tiene fix), RSSI,
+ * SNR, frecuencia y SF, a un servidor de red LoRaWAN local o a un backend
+ * propio mediante el protocolo UDP de Semtech (semtech_udp.h). Varias bases
+ * con distinto EUI se ven así como gateways de una misma red.
+ *
+ * - LORA_rxTick() sólo copia la trama a la cola (gancho LORA_setRxHook()); el
+ *   envío, los lotes y los reintentos se hacen en PF_tick(), un datagrama por
+ *   llamada, de modo que una ráfaga de tramas no retrasa el rearme de la radio.
+ * - Sin WiFi en modo estación o sin servidor, las tramas esperan en la cola.
+ * - Un servidor LoRaWAN sólo acepta tramas LoRaWAN: para él hay que compilar
+ *   la base con `-DLORA_SYNC_WORD=0x34 -DLORA_CR_DEN=5` y un SF fijo
+ *   (`-DLORA_SF`) y el collar en modo LoRaWAN con ese data rate (un solo canal).
+ *   Un backend propio puede recibir las tramas del enlace privado tal cual.
+ *
+ * Configuración (flags de compilación):
+ * - `PFWD_HOST`: nombre o IP del servidor (obligatorio).
+ * - `PFWD_PORT`: puerto UDP (1700 por defecto).
+ * - `PFWD_GATEWAY_EUI`: EUI de 64 bits; por defecto, la MAC del WiFi con FFFE en medio.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef PFWD_HOST
+  #define PFWD_HOST ""
+#endif
+#ifndef PFWD_PORT
+  #define PFWD_PORT 1700
+#endif
+
+/**
+ * \brief Fija el EUI del gateway y empieza a encolar las tramas recibidas.
+ * \details Llamar con el WiFi ya inicializado (el EUI por defecto sale de su MAC).
+ * \return false si no hay servidor configurado (PFWD_HOST vacío).
+ */
+bool PF_begin();
+
+/**
+ * \brief Recoge las confirmaciones del servidor y envía el siguiente datagrama que toque.
+ * \details Llamar desde loop(); no bloquea salvo la resolución DNS del servidor
+ *          (una vez, con el WiFi en modo estación).
+ */
+void PF_tick();
@@ -0,0 +1,141 @@
+/** @file rule_engine.h
+ * @brief Reglas de alerta configurables, compiladas a bytecode y evaluadas en cada fix.
+ *
+ * En lugar de programar cada alerta en loop(), el usuario escribe reglas en
+ * la página `/rules`; la base las compila a un bytecode de pila compacto y
+ * las evalúa con cada posición del collar y cada segundo.
+ *
+ * Sintaxis (una regla por línea; '#' empieza un comentario):
+ *
+ *     nombre: expresión [durante N]
+ *
+ * - Variables (RuleVar): `distancia` (m a la base), `velocidad` (km/h),
+ *   `edad_fix` (s desde la última posición), `fuera` (1 fuera de la valla),
+ *   `rssi` (dBm), `snr` (dB), `hora` (UTC), `temp` (°C del collar),
+ *   `fallos_tx` (del collar) y `anomalia` (1 si el modelo de movimiento
+ *   marcó la última posición).
+ * - Números con unidad opcional: `s`, `min`, `h` (a segundos), `m`, `km`
+ *   (a metros). P. ej. `edad_fix > 10min`, `distancia > 1.5km`.
+ * - Operadores por precedencia creciente: `||`/`o`, `&&`/`y`, `!`/`no`,
+ *   comparaciones (`< <= > >= == !=`), `+ -`, `* /`, signo y paréntesis.
+ * - `durante N`: la condición debe cumplirse N segundos seguidos (admite unidad).
+ *
+ * Una regla salta al pasar a cierta (y, con `durante`, tras mantenerse);
+ * vuelve a armarse cuando deja de serlo. Las variables sin dato son NaN y
+ * cualquier comparación con ellas es falsa.
+ *
+ * Bytecode: una operación por byte, con el operando detrás (índice de
+ * variable o constante de 1, 2 o 4 bytes), sin saltos. El compilador acota
+ * la longitud (RUL_MAX_CODE) y la profundidad de pila (RUL_STACK), de modo
+ * que el intérprete no comprueba nada en ejecución, no reserva memoria y
+ * tarda como mucho RUL_MAX_CODE operaciones por regla.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t  RUL_MAX_RULES = 64;
+static const uint8_t  RUL_MAX_CODE  = 64;     ///< Bytes por regla.
+static const uint16_t RUL_CODE_POOL = 2048;   ///< Bytes para todas las reglas.
+static const uint8_t  RUL_STACK     = 8;
+static const uint8_t  RUL_NAME_LEN  = 16;     ///< Con el '\\0'.
+static const uint8_t  RUL_MAX_PAREN = 8;
+static const uint16_t RUL_COL_MAX   = 0xFFFF; ///< Columna de error más alta (no da la vuelta).
+
+/**
+ * \brief Variables disponibles en las reglas (índice en el vector de entrada).
+ */
+enum RuleVar : uint8_t {
+  RUL_VAR_DISTANCE = 0,   ///< distancia (m).
+  RUL_VAR_SPEED,          ///< velocidad (km/h).
+  RUL_VAR_FIX_AGE,        ///< edad_fix (s).
+  RUL_VAR_OUTSIDE,        ///< fuera (0/1).
+  RUL_VAR_RSSI,           ///< rssi (dBm).
+  RUL_VAR_SNR,            ///< snr (dB).
+  RUL_VAR_HOUR,           ///< hora (UTC).
+  RUL_VAR_TEMP,           ///< temp (°C).
+  RUL_VAR_TX_FAILURES,    ///< fallos_tx.
+  RUL_VAR_ANOMALY,        ///< anomalia (0/1).
+  RUL_VAR_COUNT
+};
+
+/**
+ * \brief Operaciones del bytecode.
+ */
+enum RuleOp : uint8_t {
+  RUL_OP_LOAD = 1, ///< + índice de variable.
+  RUL_OP_I8,       ///< + entero de 1 byte.
+  RUL_OP_I16,      ///< + entero de 2 bytes (little-endian).
+  RUL_OP_F32,      ///< + float de 4 bytes.
+  RUL_OP_ADD, RUL_OP_SUB, RUL_OP_MUL, RUL_OP_DIV, RUL_OP_NEG,
+  RUL_OP_LT, RUL_OP_LE, RUL_OP_GT, RUL_OP_GE, RUL_OP_EQ, RUL_OP_NE,
+  RUL_OP_AND, RUL_OP_OR, RUL_OP_NOT
+};
+
+/**
+ * \brief Error de compilación.
+ */
+struct RuleError {
+  uint16_t    line;   ///< 1 = primera línea.
+  uint16_t    col;    ///< 1 = primer carácter; RUL_COL_MAX o más allá.
+  const char* msg;
+};
+
+/**
+ * \brief Regla compilada y su estado.
+ */
+struct RuleInfo {
+  char     name[RUL_NAME_LEN];
+  uint16_t codeOff;
+  uint8_t  codeLen;
+  uint32_t holdS;       ///< `durante` (0 = al instante).
+  bool     active;      ///< Cierta (y ya disparada).
+  bool     pending;     ///< Cierta, esperando a cumplir holdS.
+  uint32_t sinceS;      ///< Desde cuándo es cierta.
+  uint32_t fires;
+  uint32_t lastFireS;
+};
+
+/**
+ * \brief Sin reglas.
+ */
+void RUL_begin();
+
+/**
+ * \brief Compila el texto completo y, si no hay errores, sustituye las reglas.
+ * \details Las reglas que conservan nombre y bytecode conservan su estado.
+ * \return false (y reglas sin cambiar) con el primer error en \p err.
+ */
+bool RUL_compile(const char* src, RuleError& err);
+
+uint8_t RUL_count();
+const RuleInfo& RUL_info(uint8_t i);
+
+/**
+ * \brief Bytecode de la regla \p i (RUL_info(i).codeLen bytes).
+ */
+const uint8_t* RUL_code(uint8_t i);
+
+/**
+ * \brief Valor de la expresión de la regla \p i (sin tocar su estado).
+ */
+float RUL_value(uint8_t i, const float vars[RUL_VAR_COUNT]);
+
+/**
+ * \brief Evalúa todas las reglas y actualiza su estado.
+ * \param nowS     Reloj en segundos (monótono).
+ * \param fired    Índices de las reglas que saltan ahora (puede ser nullptr).
+ * \return Reglas que saltan (aunque no quepan en \p fired).
+ */
+size_t RUL_evaluate(const float vars[RUL_VAR_COUNT], uint32_t nowS, uint8_t* fired, size_t maxFired);
+
+/**
+ * \brief Nombre de una variable en las reglas.
+ */
+const char* RUL_varName(RuleVar v);
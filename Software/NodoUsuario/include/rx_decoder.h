@@ -0,0 +1,49 @@
+/** @file rx_decoder.h
+ * @brief Validación y decodificación de las tramas LoRa recibidas por el nodo de usuario.
+ *
+ * Separa de lora_handler la lógica que no depende de la radio (saneado de la
+ * longitud que informa el SX1262 y clasificación/decodificación del payload),
+ * de modo que puede probarse en el entorno nativo y someterse a fuzzing.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "payload_codec.h"
+#include "health_frame.h"
+#include "geofence.h"
+
+/**
+ * \brief Resultado de la decodificación de una trama.
+ */
+enum RxResult : uint8_t {
+  RX_POSITION = 0,   ///< Payload de posición de 13 B válido (fix=1).
+  RX_BAD_LENGTH,     ///< Longitud no reconocida.
+  RX_BAD_FORMAT,     ///< Longitud correcta pero contenido no válido.
+  RX_HEALTH,         ///< Trama de salud del collar de 16 B válida (health_frame.h).
+  RX_GEO_ALERT       ///< Alerta de valla de 15 B válida (geofence.h).
+};
+
+/**
+ * \brief Sanea la longitud informada por la radio.
+ * \param reported Valor devuelto por \c radio.getPacketLength().
+ * \param maxLen   Tamaño del buffer de lectura.
+ * \return Bytes a leer (1..maxLen) o 0 si la longitud no es utilizable.
+ */
+size_t RX_clampLength(int32_t reported, size_t maxLen);
+
+/**
+ * \brief Clasifica y decodifica una trama recibida.
+ * \param buf Bytes leídos de la radio.
+ * \param len Número de bytes válidos en \p buf.
+ * \param out Posición decodificada (sólo si devuelve RX_POSITION).
+ * \param health (opcional) Trama de salud decodificada (sólo si devuelve RX_HEALTH);
+ *        sin él, las tramas de salud se tratan como longitud no reconocida.
+ * \param alert (opcional) Alerta de valla decodificada (sólo si devuelve RX_GEO_ALERT);
+ *        sin ella, las alertas se tratan como longitud no reconocida.
+ */
+RxResult RX_decodeFrame(const uint8_t* buf, size_t len, GpsInfo& out, HealthFrame* health = nullptr,
+                        GeoAlert* alert = nullptr);
@@ -0,0 +1,144 @@
+/** @file semtech_udp.h
+ * @brief Protocolo UDP de Semtech (packet forwarder v2): cola, lotes y confirmaciones.
+ *
+ * En el modo packet forwarder (pkt_forwarder.h) la base reenvía cada trama
+ * recibida a un servidor de red LoRaWAN o a un backend propio, de modo que
+ * varias bases se vean como una sola red. Este módulo contiene la parte que no
+ * depende de la radio ni del WiFi:
+ * - Cola circular de tramas con sus metadatos (SUDP_QUEUE_LEN). Encolar es una
+ *   copia de tamaño fijo: se hace desde LORA_rxTick() sin retrasar la recepción.
+ *   Si la cola se llena (servidor caído mucho tiempo) se descarta la más antigua;
+ *   con uplinks seguidos (uno cada ~200 ms a SF9) cubre ~12 s sin servidor.
+ * - PUSH_DATA con varias `rxpk` por datagrama (hasta SUDP_BATCH_MAX o lo que
+ *   quepa en SUDP_DATAGRAM_MAX); un lote parcial sale cuando su trama más
+ *   antigua lleva SUDP_BATCH_WINDOW_MS esperando.
+ * - Parada y espera: un solo PUSH_DATA en vuelo; las tramas salen de la cola
+ *   con su PUSH_ACK. Sin confirmación se reintenta con espera exponencial
+ *   (SUDP_ACK_TIMEOUT_MS … SUDP_RETRY_MAX_MS) y mientras tanto la cola hace de
+ *   buffer offline. Un reintento puede duplicar tramas en el servidor (que las
+ *   descarta por contador de trama/MIC).
+ * - PULL_DATA cada SUDP_KEEPALIVE_MS (mantiene la ruta NAT y el estado
+ *   «conectado» del gateway) y un objeto `stat` cada SUDP_STAT_MS.
+ * - Las bajadas (PULL_RESP) no se transmiten: sólo se cuentan.
+ *
+ * Formato: `[versión=2][token:2][tipo][EUI del gateway:8][JSON]` para PUSH_DATA
+ * y PULL_DATA; las confirmaciones son `[2][token:2][tipo]`.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/** Tramas en cola (incluidas las del lote en vuelo). */
+#ifndef SUDP_QUEUE_LEN
+  #define SUDP_QUEUE_LEN 64
+#endif
+/** Espera máxima de una trama a que se complete su lote (ms). */
+#ifndef SUDP_BATCH_WINDOW_MS
+  #define SUDP_BATCH_WINDOW_MS 200
+#endif
+
+static const uint8_t  SUDP_VERSION        = 2;
+static const size_t   SUDP_MAX_FRAME      = 64;     ///< Igual que la lectura de lora_handler.
+static const uint8_t  SUDP_BATCH_MAX      = 8;
+static const size_t   SUDP_DATAGRAM_MAX   = 1472;   ///< Sin fragmentación IP (MTU 1500).
+static const uint32_t SUDP_ACK_TIMEOUT_MS = 1000;
+static const uint32_t SUDP_RETRY_MAX_MS   = 32000;
+static const uint32_t SUDP_KEEPALIVE_MS   = 10000;
+static const uint32_t SUDP_STAT_MS        = 30000;
+
+/**
+ * \brief Identificador de tipo (cuarto byte del datagrama).
+ */
+enum SudpType : uint8_t {
+  SUDP_PUSH_DATA = 0,
+  SUDP_PUSH_ACK  = 1,
+  SUDP_PULL_DATA = 2,
+  SUDP_PULL_RESP = 3,
+  SUDP_PULL_ACK  = 4,
+  SUDP_TX_ACK    = 5,
+  SUDP_INVALID   = 0xFF   ///< Versión o longitud incorrectas, o tipo desconocido.
+};
+
+/**
+ * \brief Metadatos de recepción de una trama (campos de `rxpk`).
+ */
+struct SudpRxMeta {
+  uint32_t tmstUs;    ///< Contador libre en µs al terminar la recepción (`tmst`).
+  uint32_t utc;       ///< Segundos desde 2000-01-01 UTC (`time`); 0 = sin hora.
+  float    freqMHz;   ///< Frecuencia (`freq`).
+  uint8_t  sf;        ///< Factor de ensanchado (`datr`).
+  uint16_t bwKHz;     ///< Ancho de banda (`datr`).
+  uint8_t  crDen;     ///< Denominador de la tasa de código 4/x (`codr`).
+  float    rssi;      ///< dBm (`rssi`).
+  float    snr;       ///< dB (`lsnr`).
+};
+
+/**
+ * \brief Contadores del reenvío (también alimentan el objeto `stat`).
+ */
+struct SudpStats {
+  uint32_t rxFrames;     ///< Tramas encoladas.
+  uint32_t fwdFrames;    ///< Tramas confirmadas por el servidor.
+  uint32_t dropped;      ///< Tramas descartadas por cola llena.
+  uint32_t pushSent;     ///< PUSH_DATA de tramas enviados (incluidos reintentos).
+  uint32_t pushAcked;    ///< PUSH_ACK que confirmaron un lote.
+  uint32_t retries;      ///< Reintentos por falta de PUSH_ACK.
+  uint32_t pullAcked;    ///< PULL_ACK recibidos.
+  uint32_t downlinks;    ///< PULL_RESP recibidos (no se transmiten).
+};
+
+/**
+ * \brief Vacía la cola y fija la identidad del gateway.
+ * \param eui  EUI de 8 bytes (MSB primero).
+ * \param seed Semilla del token (distinta en cada arranque).
+ */
+void SUDP_begin(const uint8_t eui[8], uint16_t seed);
+
+/**
+ * \brief Encola una trama recibida.
+ * \return false si la trama no es válida o se ha descartado la más antigua
+ *         para hacerle sitio (la nueva siempre se encola).
+ */
+bool SUDP_enqueue(const uint8_t* data, size_t len, const SudpRxMeta& meta, uint32_t nowMs);
+
+/**
+ * \brief Siguiente datagrama a enviar, si toca alguno.
+ * \details Por orden: reintento del lote en vuelo, lote nuevo, PULL_DATA y `stat`.
+ *          Llamar con frecuencia y enviar lo que devuelva.
+ * \param out     Buffer de salida (al menos SUDP_DATAGRAM_MAX bytes).
+ * \return Bytes del datagrama o 0 si no hay nada que enviar.
+ */
+size_t SUDP_poll(uint32_t nowMs, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Procesa un datagrama recibido del servidor.
+ * \return Su tipo; un PUSH_ACK con el token del lote en vuelo lo saca de la cola.
+ */
+SudpType SUDP_receive(const uint8_t* buf, size_t len, uint32_t nowMs);
+
+/**
+ * \brief Tramas en cola (confirmación pendiente incluida).
+ */
+size_t SUDP_pending();
+
+/**
+ * \brief true si el último PUSH_DATA se confirmó (false tras un timeout).
+ */
+bool SUDP_online();
+
+/**
+ * \brief Contadores desde SUDP_begin().
+ */
+const SudpStats& SUDP_stats();
+
+/**
+ * \brief Codifica en base64 (con relleno y terminador).
+ * \return Caracteres escritos (sin el terminador) o 0 si no cabe.
+ */
+size_t SUDP_base64(const uint8_t* in, size_t len, char* out, size_t outSize);
@@ -0,0 +1,108 @@
+/** @file supervisor.h
+ * @brief Supervisor del bucle principal: presupuestos de latencia por tarea y watchdog.
+ *
+ * Cada tarea de loop() se ejecuta dentro de `SUP_SCOPE(tarea)`:
+ * - Si su tiempo propio (sin las tareas anidadas) supera su presupuesto se
+ *   cuenta una violación (métrica `sup_budget_violations_total{task=...}`) y
+ *   se añade a `/stall.log` una línea `BUDGET` con la tarea, su duración y la
+ *   traza de las últimas tareas (como mucho una por minuto). También se
+ *   guarda la duración máxima.
+ * - Al entrar, la tarea en curso se anota en los registros scratch del watchdog
+ *   y cada tramo cerrado en una traza circular en RAM no inicializada; ambos
+ *   sobreviven al reset del watchdog.
+ * - Si loop() deja de alimentar el watchdog (p. ej. `server.handleClient()`
+ *   colgado o una transacción SPI bloqueada) el RP2040 se reinicia; en el
+ *   siguiente arranque SUP_begin() recupera la tarea que no terminó y la traza
+ *   de las últimas tareas, y SUP_arm() las añade a `/stall.log` en LittleFS.
+ *
+ * @note Con el bucle colgado no es seguro escribir en flash, por eso el
+ *       registro se conserva en RAM/scratch y se vuelca al arrancar.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+
+/** Tiempo sin alimentar el watchdog antes del reset (ms; máx. ~8300 en el RP2040). */
+#ifndef SUP_WATCHDOG_MS
+  #define SUP_WATCHDOG_MS 8000
+#endif
+
+/**
+ * \brief Tareas supervisadas.
+ */
+enum SupTask : uint8_t {
+  SUP_TASK_HTTP = 0,   ///< server.handleClient().
+  SUP_TASK_RADIO,      ///< LORA_rxTick() y hitos asociados.
+  SUP_TASK_SURVEY,     ///< SURVEY_tick() (visita de canal).
+  SUP_TASK_WIFI,       ///< WIFI_apTick() y WPM_tick().
+  SUP_TASK_GNSS,       ///< GPS_update() y envío de asistencia al collar.
+  SUP_TASK_SCAN,       ///< Escaneo WiFi bloqueante (~2 s), dentro de wifi o http.
+  SUP_TASK_COUNT
+};
+
+/**
+ * \brief Marca de la tarea abierta antes de SUP_enter() (se restaura al salir).
+ */
+struct SupMark {
+  uint32_t tag;
+  uint32_t startMs;
+};
+
+/**
+ * \brief Recupera el registro de un posible reset por watchdog. Llamar lo
+ *        primero en setup(), antes de que ninguna tarea lo sobrescriba.
+ */
+void SUP_begin();
+
+/**
+ * \brief Añade a `/stall.log` el registro recuperado (si lo hay) y arma el
+ *        watchdog. Llamar al final de setup(), con LittleFS montado.
+ */
+void SUP_arm();
+
+/**
+ * \brief Alimenta el watchdog (inicio de loop() y esperas largas).
+ */
+void SUP_feed();
+
+/**
+ * \brief Marca la entrada en una tarea.
+ * \return Marca previa que hay que pasar a SUP_exit() (permite anidar).
+ */
+SupMark SUP_enter(SupTask task);
+
+/**
+ * \brief Cierra la tarea abierta con SUP_enter() y comprueba su presupuesto.
+ */
+void SUP_exit(SupTask task, uint32_t startMs, const SupMark& prev);
+
+/**
+ * \brief Violaciones de presupuesto de \p task desde el arranque.
+ */
+uint32_t SUP_violations(SupTask task);
+
+/**
+ * \brief true si el último reset fue por el watchdog del supervisor.
+ */
+bool SUP_stalledLastBoot();
+
+/**
+ * \brief Tabla de tareas (presupuesto, violaciones, máximo) para la consola.
+ */
+void SUP_report(Stream& port);
+
+/**
+ * \brief Mide una tarea entre su construcción y su destrucción.
+ */
+struct SupScope {
+  SupTask  task;
+  uint32_t t0;
+  SupMark  prev;
+  explicit SupScope(SupTask t) : task(t), t0(millis()), prev(SUP_enter(t)) {}
+  ~SupScope() { SUP_exit(task, t0, prev); }
+};
+
+#define SUP_SCOPE(task) SupScope _supScope(task)
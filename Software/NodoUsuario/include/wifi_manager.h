@@ -51,6 +51,13 @@ bool saveWiFiConf(const String &ssid, const String &pwd);
  */
 bool initWiFiConnection(String &ssid, String &pwd);
 
+/**
+ * \brief Función a ejecutar durante las esperas de conexión/AP (p.ej. atender la radio).
+ * \details Las esperas de initWiFiConnection(), tryConnectWiFi() y startWiFiAP()
+ * llaman al gancho cada milisegundo en lugar de bloquear con delay().
+ */
+void WIFI_setIdleHook(void (*hook)());
+
 /**
  * \brief Intenta conectar al AP indicado en modo estación (bloqueo con timeout).
  * \param ssid SSID objetivo.
@@ -61,9 +68,44 @@ bool tryConnectWiFi(const String &ssid, const String &pwd);
 
 /**
  * \brief Levanta el punto de acceso para el portal de configuración.
+ * \details Elige el canal menos ocupado a partir de un escaneo (ver WIFI_scanCached()).
  */
 void startWiFiAP();
 
+/**
+ * \brief Escanea redes WiFi reutilizando el último resultado si es reciente.
+ * \param maxAgeMs Antigüedad máxima aceptable del escaneo en caché (ms).
+ * \return Número de redes en la caché (0 si no hay ninguna).
+ * \note El escaneo real bloquea ~2 s; la caché la comparten el portal y la selección de canal.
+ */
+int WIFI_scanCached(unsigned long maxAgeMs);
+
+/**
+ * \brief SSID de la entrada \p i de la caché de escaneo.
+ */
+String WIFI_scanSSID(int i);
+
+/**
+ * \brief Elige el canal 2.4 GHz (1..13) con menor ocupación según la caché de escaneo.
+ * \details Cada red suma una carga proporcional a su RSSI en su canal y, atenuada,
+ * en los ±4 canales solapados. En empate se prefieren 1, 6 y 11.
+ * \param load (opcional) Carga estimada del canal elegido.
+ * \return Canal recomendado.
+ */
+uint8_t WIFI_pickApChannel(uint32_t* load = nullptr);
+
+/**
+ * \brief Canal actual del AP (0 si el AP no está activo).
+ */
+uint8_t WIFI_apChannel();
+
+/**
+ * \brief Reevaluación periódica del canal del AP (llamar desde loop()).
+ * \details Sólo reescanea cuando no hay estaciones asociadas y cambia de canal
+ * si el nuevo es claramente mejor (histéresis), para no cortar a ningún cliente.
+ */
+void WIFI_apTick();
+
 /**
  * \brief Manejador del POST de formulario (/submit): guarda y redirige.
  * \details En éxito: 303 → /savedcredentials y dispara pendingReset.
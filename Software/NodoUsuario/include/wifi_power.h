@@ -0,0 +1,67 @@
+/** @file wifi_power.h
+ * @brief Declaraciones del gestor de ahorro de energía WiFi (CYW43) con presupuesto de latencia.
+ *
+ * El chip CYW43439 de la Pico W admite varios modos de ahorro que apagan la radio
+ * entre beacons a costa de añadir latencia a las peticiones. Este módulo elige el
+ * modo según la actividad HTTP (clientes distintos vistos recientemente y tasa de
+ * peticiones) respetando un presupuesto de latencia configurable, y contabiliza
+ * el tiempo pasado en cada modo.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#ifndef WIFI_POWER_H
+#define WIFI_POWER_H
+
+#include <Arduino.h>
+
+/**
+ * \brief Modos de energía, de mayor a menor consumo.
+ */
+enum WpmMode : uint8_t {
+  WPM_PERFORMANCE = 0, ///< Sin ahorro (CYW43_NONE_PM): latencia añadida nula.
+  WPM_BALANCED,        ///< PM2 (CYW43_PERFORMANCE_PM): duerme 200 ms tras el tráfico.
+  WPM_POWERSAVE,       ///< PM1 (CYW43_AGGRESSIVE_PM): despierta sólo en DTIM.
+  WPM_MODE_COUNT
+};
+
+/**
+ * \brief Inicializa el gestor y aplica el modo de reposo.
+ * \param latencyBudgetMs Latencia añadida máxima admisible con clientes activos (ms).
+ * \note Llamar tras levantar la WiFi (STA o AP).
+ */
+void WPM_begin(uint16_t latencyBudgetMs);
+
+/**
+ * \brief Anota una petición HTTP del cliente actual (\c server.client()).
+ * \details Llamar al inicio de cada manejador de ruta.
+ */
+void WPM_noteRequest();
+
+/**
+ * \brief Reevalúa el modo según la actividad reciente (llamar desde loop()).
+ */
+void WPM_tick();
+
+/**
+ * \brief Modo aplicado actualmente.
+ */
+WpmMode WPM_mode();
+
+/**
+ * \brief Número de clientes distintos con peticiones en la ventana de actividad.
+ */
+uint8_t WPM_activeViewers();
+
+/**
+ * \brief Tiempo acumulado (ms) en el modo indicado, incluido el tramo en curso.
+ */
+uint32_t WPM_timeInMode(WpmMode mode);
+
+/**
+ * \brief Vuelca por \p port el modo actual, clientes y tiempo en cada modo.
+ */
+void WPM_report(Stream& port);
+
+#endif
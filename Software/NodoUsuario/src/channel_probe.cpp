@@ -0,0 +1,76 @@
+/** @file channel_probe.cpp
+ * @brief Implementación de la visita de sondeo de canal (ver channel_probe.h).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "channel_probe.h"
+
+// ----------------- Estado interno -----------------------
+static bool     s_activity   = false;   // actividad vista en la visita anterior
+static uint32_t s_activityMs = 0;       // desde cuándo
+
+void PRB_begin() {
+  s_activity = false;
+}
+
+/**
+ * \brief true si hay una trama en curso o sin leer (se cede el turno).
+ * \details El IRQ de preámbulo que dura más que PRB_STALE_MS se borra: la
+ *          visita se cede igualmente y la siguiente ya lo encuentra limpio.
+ */
+static bool radioBusy(const ProbeRadio& r, uint32_t nowMs) {
+  if (r.rxPending()) return true;
+  if (!r.rxActivity()) {
+    s_activity = false;
+    return false;
+  }
+  if (!s_activity) {
+    s_activity   = true;
+    s_activityMs = nowMs;
+  } else if (nowMs - s_activityMs >= PRB_STALE_MS) {
+    r.clearActivity();
+    s_activity = false;
+  }
+  return true;
+}
+
+ProbeResult PRB_visit(const ProbeRadio& r, float workMHz, float freqMHz, uint32_t nowMs,
+                      float& rssiDbm, bool& busy) {
+  if (radioBusy(r, nowMs)) return PRB_SKIPPED_BUSY;
+
+  bool retune = (freqMHz != workMHz);
+  if (retune) {
+    if (!r.tune(freqMHz)) {
+      r.tune(workMHz);
+      return PRB_ERROR;
+    }
+    r.delayUs(PRB_RSSI_GAP_US);              // asentamiento del PLL y del AGC
+  }
+
+  float samples[PRB_RSSI_SAMPLES];
+  for (uint8_t i = 0; i < PRB_RSSI_SAMPLES; i++) {
+    samples[i] = r.rssi();
+    r.delayUs(PRB_RSSI_GAP_US);
+  }
+  // En el canal de trabajo la radio ha seguido escuchando: si entra una trama,
+  // se deja recibir (la CAD la abortaría)
+  if (!retune && (r.rxPending() || r.rxActivity())) return PRB_ABORTED_RX;
+
+  // Mediana (inserción: 8 elementos)
+  for (uint8_t i = 1; i < PRB_RSSI_SAMPLES; i++) {
+    float v = samples[i];
+    int8_t j = i - 1;
+    while (j >= 0 && samples[j] > v) { samples[j + 1] = samples[j]; j--; }
+    samples[j + 1] = v;
+  }
+
+  int8_t cad = r.cad();
+  // Vuelta a recepción continua en el canal de trabajo (la CAD la deja en standby)
+  bool back = r.tune(workMHz);
+  if (cad < 0 || !back) return PRB_ERROR;
+  rssiDbm = samples[PRB_RSSI_SAMPLES / 2];
+  busy    = (cad > 0);
+  return PRB_DONE;
+}
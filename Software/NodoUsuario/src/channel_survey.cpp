@@ -0,0 +1,281 @@
+/** @file channel_survey.cpp
+ * @brief Implementación del sondeo de ruido y ocupación de canales.
+ *
+ * Ventana segura: desde 1,5 s después de la última posición (cubre la trama de
+ * salud que la sigue, también a 62,5 kHz) hasta 1 s antes de la siguiente
+ * prevista, y nunca en los 5 s siguientes a un comando (un PING provoca un
+ * uplink fuera de calendario). Sin collar a la vista se sondea a ritmo lento.
+ * Lo que caiga igualmente dentro de una visita lo protege channel_probe: no
+ * se toca la radio con una trama en curso.
+ *
+ * El periodo es el intervalo más repetido entre las tramas recientes (empates
+ * al menor), o el de las dos últimas si coinciden (cambio de periodo
+ * confirmado): una trama suelta fuera de calendario no lo mueve. Las alertas
+ * de valla tampoco siguen el calendario, así que mientras el collar está
+ * fuera, y durante SURVEY_AFTER_ALERT tras cada alerta, no se sondea.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "channel_survey.h"
+#include "lora_handler.h"
+#include "payload_codec.h"
+#include "metrics.h"
+#include <math.h>
+#include <string.h>
+
+// ----------------- Configuración -----------------------
+/** Canales sondeados: el de trabajo (índice 0, se fija en SURVEY_begin) y los de EU868 g1. */
+static float s_freqs[] = {868.0f, 868.1f, 868.3f, 868.5f};
+static const uint8_t  SURVEY_N_CH         = sizeof(s_freqs) / sizeof(s_freqs[0]);
+static const uint32_t SURVEY_VISIT_GAP    = 1000UL;    // entre visitas en la ventana segura
+static const uint32_t SURVEY_IDLE_GAP     = 10000UL;   // sin collar a la vista
+static const uint32_t SURVEY_AFTER_RX     = 1500UL;    // guarda tras una trama (y su trama de salud)
+static const uint32_t SURVEY_BEFORE_RX    = 1000UL;    // guarda antes de la siguiente
+static const uint32_t SURVEY_AFTER_CMD    = 5000UL;    // guarda tras un comando
+static const uint32_t SURVEY_AFTER_ALERT  = 60000UL;   // guarda tras una alerta de valla
+static const uint32_t SURVEY_DEFAULT_PER  = 10000UL;   // periodo supuesto sin estimación
+static const float    SURVEY_ALPHA        = 1.0f / 16; // media exponencial
+static const float    SURVEY_INTERF_DB    = 10.0f;     // RSSI sobre el suelo sin LoRa
+static const float    SURVEY_BUSY_PENALTY = 20.0f;     // dB por unidad de ocupación
+static const float    SURVEY_HYST_DB      = 2.0f;      // preferencia por el canal actual
+static const float    SURVEY_SNR_MARGIN   = 5.0f;      // margen de desvanecimiento (dB)
+/** SNR mínima de demodulación por SF (SX126x, BW 125 kHz), SF7..SF12. */
+static const float    SURVEY_SNR_REQ[6]   = {-7.5f, -10.0f, -12.5f, -15.0f, -17.5f, -20.0f};
+static const uint8_t  SURVEY_PERIOD_HIST  = 8;
+
+// ----------------- Métricas -----------------------------
+METRIC_GAUGE_L(m_noise0, "lora_noise_floor_dbm", "Suelo de ruido estimado por canal (dBm)", "channel=\"0\"");
+METRIC_GAUGE_L(m_noise1, "lora_noise_floor_dbm", "Suelo de ruido estimado por canal (dBm)", "channel=\"1\"");
+METRIC_GAUGE_L(m_noise2, "lora_noise_floor_dbm", "Suelo de ruido estimado por canal (dBm)", "channel=\"2\"");
+METRIC_GAUGE_L(m_noise3, "lora_noise_floor_dbm", "Suelo de ruido estimado por canal (dBm)", "channel=\"3\"");
+METRIC_GAUGE_L(m_busy0, "lora_channel_busy_ratio", "Fracción de CAD con actividad LoRa por canal", "channel=\"0\"");
+METRIC_GAUGE_L(m_busy1, "lora_channel_busy_ratio", "Fracción de CAD con actividad LoRa por canal", "channel=\"1\"");
+METRIC_GAUGE_L(m_busy2, "lora_channel_busy_ratio", "Fracción de CAD con actividad LoRa por canal", "channel=\"2\"");
+METRIC_GAUGE_L(m_busy3, "lora_channel_busy_ratio", "Fracción de CAD con actividad LoRa por canal", "channel=\"3\"");
+METRIC_GAUGE_L(m_freq0, "lora_channel_freq_mhz", "Frecuencia de cada canal sondeado (MHz)", "channel=\"0\"");
+METRIC_GAUGE_L(m_freq1, "lora_channel_freq_mhz", "Frecuencia de cada canal sondeado (MHz)", "channel=\"1\"");
+METRIC_GAUGE_L(m_freq2, "lora_channel_freq_mhz", "Frecuencia de cada canal sondeado (MHz)", "channel=\"2\"");
+METRIC_GAUGE_L(m_freq3, "lora_channel_freq_mhz", "Frecuencia de cada canal sondeado (MHz)", "channel=\"3\"");
+METRIC_COUNTER(m_interference, "lora_channel_interference_total", "Visitas sin LoRa con RSSI muy por encima del suelo");
+METRIC_COUNTER(m_visits, "lora_survey_visits_total", "Visitas de sondeo de canal realizadas");
+METRIC_GAUGE(m_margin, "lora_link_margin_db", "RSSI de la última trama sobre el suelo de ruido del canal de trabajo (dB)");
+METRIC_GAUGE(m_recChannel, "lora_recommended_channel_mhz", "Canal recomendado por el sondeo (MHz)");
+METRIC_GAUGE(m_recSF, "lora_recommended_sf", "SF mínimo recomendado según la SNR observada");
+
+static MetricGauge* const NOISE_GAUGES[SURVEY_N_CH] = {&m_noise0, &m_noise1, &m_noise2, &m_noise3};
+static MetricGauge* const BUSY_GAUGES[SURVEY_N_CH]  = {&m_busy0, &m_busy1, &m_busy2, &m_busy3};
+static MetricGauge* const FREQ_GAUGES[SURVEY_N_CH]  = {&m_freq0, &m_freq1, &m_freq2, &m_freq3};
+
+// ----------------- Estado interno -----------------------
+static SurveyChannelStats s_ch[SURVEY_N_CH];
+static uint8_t  s_next        = 0;
+static uint32_t s_lastVisit   = 0;
+static uint32_t s_seenRxMs    = 0;      // última trama ya contabilizada
+static uint32_t s_prevSod     = 0xFFFFFFFFUL;
+static uint32_t s_periods[SURVEY_PERIOD_HIST];
+static uint8_t  s_nPeriods    = 0;
+static bool     s_outside     = false;  // collar fuera de la valla (SURVEY_noteAlert)
+static uint32_t s_alertMs     = 0;
+static float    s_snrEwma     = NAN;
+static uint8_t  s_recChannel  = 0;
+
+/**
+ * \brief Media exponencial (la primera muestra inicializa).
+ */
+static float ewma(float avg, float sample) {
+  return isnan(avg) ? sample : avg + SURVEY_ALPHA * (sample - avg);
+}
+
+/**
+ * \brief Periodo de uplink estimado (ms; ver cabecera del fichero).
+ */
+static uint32_t periodMs() {
+  if (s_nPeriods == 0) return SURVEY_DEFAULT_PER;
+  if (s_nPeriods >= 2 && s_periods[0] == s_periods[1]) return s_periods[0];
+  uint32_t best = 0;
+  uint8_t  bestCount = 0;
+  for (uint8_t i = 0; i < s_nPeriods; i++) {
+    uint8_t count = 0;
+    for (uint8_t j = 0; j < s_nPeriods; j++) count += s_periods[j] == s_periods[i];
+    if (count > bestCount || (count == bestCount && s_periods[i] < best)) {
+      best      = s_periods[i];
+      bestCount = count;
+    }
+  }
+  return best;
+}
+
+/**
+ * \brief Registra una trama nueva: intervalo con la anterior y SNR.
+ */
+static void noteFrame() {
+  GpsInfo gi;
+  float rssi = 0, snr = 0;
+  if (!LORA_lastValidGPS(gi, &rssi, &snr)) return;
+
+  uint32_t sod = GPS_hhmmssToSod(gi.hhmmss);
+  if (s_prevSod != 0xFFFFFFFFUL) {
+    uint32_t dt = (sod + 86400UL - s_prevSod) % 86400UL;
+    if (dt > 0) {
+      memmove(&s_periods[1], &s_periods[0], (SURVEY_PERIOD_HIST - 1) * sizeof(uint32_t));
+      s_periods[0] = dt * 1000UL;
+      if (s_nPeriods < SURVEY_PERIOD_HIST) s_nPeriods++;
+    }
+  }
+  s_prevSod = sod;
+
+  s_snrEwma = ewma(s_snrEwma, snr);
+  m_recSF.set(SURVEY_recommendedSF());
+  if (!isnan(s_ch[0].noiseFloorDbm)) m_margin.set(rssi - s_ch[0].noiseFloorDbm);
+}
+
+/**
+ * \brief true si ahora no se espera ninguna trama (ver cabecera del fichero).
+ */
+static bool inSafeWindow(uint32_t now) {
+  uint32_t lastCmd = LORA_lastCommandMs();
+  if (lastCmd && now - lastCmd < SURVEY_AFTER_CMD) return false;
+  if (s_outside || (s_alertMs && now - s_alertMs < SURVEY_AFTER_ALERT)) return false;
+
+  uint32_t lastRx = LORA_lastRxMs();
+  uint32_t period = periodMs();
+  if (lastRx == 0 || now - lastRx > 3 * period) {
+    // Collar no visible: sondeo lento
+    return now - s_lastVisit >= SURVEY_IDLE_GAP;
+  }
+  uint32_t sinceRx = (now - lastRx) % period;   // también tras tramas perdidas
+  return sinceRx >= SURVEY_AFTER_RX && sinceRx + SURVEY_BEFORE_RX <= period;
+}
+
+/**
+ * \brief Recalcula el canal recomendado (con histéresis a favor del actual).
+ */
+static void updateRecommendation() {
+  float best = INFINITY;
+  uint8_t bestIdx = s_recChannel;
+  for (uint8_t i = 0; i < SURVEY_N_CH; i++) {
+    if (isnan(s_ch[i].noiseFloorDbm)) continue;
+    float score = s_ch[i].noiseFloorDbm + SURVEY_BUSY_PENALTY * s_ch[i].busyRatio;
+    if (i == s_recChannel) score -= SURVEY_HYST_DB;
+    if (score < best) { best = score; bestIdx = i; }
+  }
+  s_recChannel = bestIdx;
+  m_recChannel.set(s_ch[bestIdx].freqMHz);
+}
+
+/**
+ * \brief El canal 0 pasa a ser el de trabajo de la radio.
+ */
+void SURVEY_begin() {
+  s_freqs[0] = LORA_frequency();
+  for (uint8_t i = 0; i < SURVEY_N_CH; i++) {
+    s_ch[i] = {s_freqs[i], NAN, 0.0f, 0, 0, 0};
+    FREQ_GAUGES[i]->set(s_freqs[i]);
+  }
+  s_recChannel = 0;
+  m_recChannel.set(s_freqs[0]);
+  m_recSF.set(9);
+}
+
+/**
+ * \brief Una visita de canal como máximo por SURVEY_VISIT_GAP.
+ */
+void SURVEY_tick() {
+  uint32_t now = millis();
+  if (LORA_lastRxMs() != s_seenRxMs) {
+    s_seenRxMs = LORA_lastRxMs();
+    noteFrame();
+  }
+  if (now - s_lastVisit < SURVEY_VISIT_GAP || !inSafeWindow(now)) return;
+  s_lastVisit = now;
+
+  SurveyChannelStats& ch = s_ch[s_next];
+  float rssi;
+  bool  busy;
+  if (!LORA_probeChannel(ch.freqMHz, &rssi, &busy)) return;
+
+  ch.visits++;
+  m_visits.inc();
+  ch.busyRatio = ch.busyRatio + SURVEY_ALPHA * ((busy ? 1.0f : 0.0f) - ch.busyRatio);
+  if (busy) {
+    ch.busy++;
+  } else if (!isnan(ch.noiseFloorDbm) && rssi >= ch.noiseFloorDbm + SURVEY_INTERF_DB) {
+    // Energía sin preámbulo LoRa: interferencia, no entra en el suelo de ruido
+    ch.interference++;
+    m_interference.inc();
+  } else {
+    ch.noiseFloorDbm = ewma(ch.noiseFloorDbm, rssi);
+  }
+  if (!isnan(ch.noiseFloorDbm)) NOISE_GAUGES[s_next]->set(ch.noiseFloorDbm);
+  BUSY_GAUGES[s_next]->set(ch.busyRatio);
+
+  updateRecommendation();
+  s_next = (s_next + 1) % SURVEY_N_CH;
+}
+
+/**
+ * \brief Suspende el sondeo (ver cabecera del fichero).
+ */
+void SURVEY_noteAlert(bool outside) {
+  s_outside = outside;
+  s_alertMs = millis();
+  if (!s_alertMs) s_alertMs = 1;
+}
+
+/**
+ * \brief Estimación usada para la ventana segura.
+ */
+uint32_t SURVEY_periodMs() {
+  return periodMs();
+}
+
+/**
+ * \brief Número de canales sondeados.
+ */
+uint8_t SURVEY_channelCount() {
+  return SURVEY_N_CH;
+}
+
+/**
+ * \brief Estadísticas del canal \p i (recortado al último).
+ */
+const SurveyChannelStats& SURVEY_channel(uint8_t i) {
+  return s_ch[i < SURVEY_N_CH ? i : SURVEY_N_CH - 1];
+}
+
+/**
+ * \brief Frecuencia del canal recomendado.
+ */
+float SURVEY_recommendedChannel() {
+  return s_ch[s_recChannel].freqMHz;
+}
+
+/**
+ * \brief Menor SF cuya SNR mínima + margen queda por debajo de la SNR media observada.
+ */
+uint8_t SURVEY_recommendedSF() {
+  if (isnan(s_snrEwma)) return 9;
+  for (uint8_t i = 0; i < 6; i++) {
+    if (SURVEY_SNR_REQ[i] + SURVEY_SNR_MARGIN <= s_snrEwma) return 7 + i;
+  }
+  return 12;
+}
+
+/**
+ * \brief Una línea por canal y la recomendación.
+ */
+void SURVEY_report(Stream& port) {
+  for (uint8_t i = 0; i < SURVEY_N_CH; i++) {
+    const SurveyChannelStats& ch = s_ch[i];
+    port.print("[SURVEY] ");          port.print(ch.freqMHz, 1);
+    port.print(" MHz suelo=");        port.print(ch.noiseFloorDbm, 1);
+    port.print(" dBm ocupacion=");    port.print(ch.busyRatio, 2);
+    port.print(" visitas=");          port.print(ch.visits);
+    port.print(" interf=");           port.println(ch.interference);
+  }
+  port.print("[SURVEY] recomendado ");  port.print(SURVEY_recommendedChannel(), 1);
+  port.print(" MHz, SF");               port.print(SURVEY_recommendedSF());
+  port.print(", periodo_ms=");          port.println(periodMs());
+}
@@ -0,0 +1,160 @@
+/** @file dgnss.cpp
+ * @brief Implementación de la corrección diferencial (buffer de errores por época).
+ *
+ * El buffer guarda 64 épocas (≈1 min a 1 Hz): suficiente para el retardo entre la
+ * medida del collar y su llegada (aire + cola). La época se indexa por segundos
+ * del día, así que el cruce de medianoche se trata con aritmética módulo 86400.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "dgnss.h"
+
+// ----------------- Configuración -----------------------
+static const uint8_t  DGPS_BUF_LEN     = 64;
+static const int32_t  DGPS_MAX_GAP_S   = 2;          // época más lejana utilizable
+static const uint32_t SOD_DAY          = 86400UL;
+
+/** Error de la base en una época (grados). */
+struct DgpsEpoch {
+  uint32_t sod;
+  float    dLat;
+  float    dLon;
+};
+
+// ----------------- Estado interno -----------------------
+static DgpsEpoch s_buf[DGPS_BUF_LEN];
+static uint8_t   s_head   = 0;       // siguiente hueco
+static uint8_t   s_count  = 0;
+static bool      s_hasRef = false;
+static double    s_refLat = 0, s_refLon = 0;
+static uint32_t  s_survey = 0;       // muestras acumuladas en la media
+static uint32_t  s_lastSod = SOD_DAY; // ninguna
+static float     s_lastErrM = 0;
+
+/**
+ * \brief Diferencia con signo a − b en segundos del día (−43200..43199).
+ */
+static int32_t sodDiff(uint32_t a, uint32_t b) {
+  int32_t d = (int32_t)a - (int32_t)b;
+  if (d >= (int32_t)(SOD_DAY / 2)) d -= SOD_DAY;
+  if (d < -(int32_t)(SOD_DAY / 2)) d += SOD_DAY;
+  return d;
+}
+
+/**
+ * \brief Vacía el buffer y carga la referencia de los flags de compilación.
+ */
+void DGPS_begin() {
+  s_head = s_count = 0;
+  s_survey  = 0;
+  s_lastSod = SOD_DAY;
+  s_lastErrM = 0;
+#if defined(DGPS_REF_LAT) && defined(DGPS_REF_LON)
+  DGPS_setReference(DGPS_REF_LAT, DGPS_REF_LON);
+#else
+  s_hasRef = false;
+  s_refLat = s_refLon = 0;
+#endif
+}
+
+/**
+ * \brief Referencia fija (termina el survey-in).
+ */
+void DGPS_setReference(double lat, double lon) {
+  s_refLat = lat;
+  s_refLon = lon;
+  s_hasRef = true;
+  s_survey = DGPS_SURVEY_SAMPLES;
+}
+
+/**
+ * \brief Estado de la referencia.
+ */
+bool DGPS_hasReference() {
+  return s_hasRef;
+}
+
+/**
+ * \brief Progreso del survey-in.
+ */
+uint32_t DGPS_surveySamples() {
+  return s_survey;
+}
+
+/**
+ * \brief Media incremental durante el survey-in; después, error de la época.
+ */
+void DGPS_addBaseFix(const GpsInfo& base) {
+  if (!base.valid || !GPS_isPlausible(base)) return;
+  uint32_t sod = GPS_hhmmssToSod(base.hhmmss);
+  if (sod == s_lastSod) return;
+  s_lastSod = sod;
+
+  if (!s_hasRef) {
+    s_survey++;
+    s_refLat += (base.lat - s_refLat) / s_survey;
+    s_refLon += (base.lon - s_refLon) / s_survey;
+    if (s_survey >= DGPS_SURVEY_SAMPLES) s_hasRef = true;
+    return;
+  }
+
+  DgpsEpoch& e = s_buf[s_head];
+  e.sod  = sod;
+  e.dLat = (float)(base.lat - s_refLat);
+  e.dLon = (float)(base.lon - s_refLon);
+  s_head = (s_head + 1) % DGPS_BUF_LEN;
+  if (s_count < DGPS_BUF_LEN) s_count++;
+
+  s_lastErrM = (float)GPS_distanceM(s_refLat, s_refLon, base.lat, base.lon);
+}
+
+/**
+ * \brief Busca la época exacta o interpola entre las vecinas más próximas (±2 s).
+ * \details Recorre del más reciente al más antiguo: el collar suele ir pocas
+ *          épocas por detrás de la base, así que la búsqueda acaba enseguida.
+ */
+bool DGPS_correct(const GpsInfo& in, GpsInfo& out) {
+  out = in;
+  if (!s_hasRef || !in.valid || s_count == 0) return false;
+  uint32_t sod = GPS_hhmmssToSod(in.hhmmss);
+
+  const DgpsEpoch* before = nullptr;   // época ≤ sod más cercana
+  const DgpsEpoch* after  = nullptr;   // época > sod más cercana
+  int32_t dBefore = DGPS_MAX_GAP_S + 1, dAfter = DGPS_MAX_GAP_S + 1;
+  for (uint8_t i = 0; i < s_count; i++) {
+    const DgpsEpoch& e = s_buf[(s_head + DGPS_BUF_LEN - 1 - i) % DGPS_BUF_LEN];
+    int32_t d = sodDiff(sod, e.sod);   // > 0: la época es anterior
+    if (d >= 0 && d < dBefore) { dBefore = d; before = &e; }
+    if (d < 0 && -d < dAfter)  { dAfter = -d; after = &e; }
+    if (dBefore == 0 || d > DGPS_MAX_GAP_S) break;   // exacta o ya demasiado antigua
+  }
+
+  float dLat, dLon;
+  if (before && dBefore == 0) {
+    dLat = before->dLat;
+    dLon = before->dLon;
+  } else if (before && after) {
+    float w = (float)dBefore / (float)(dBefore + dAfter);
+    dLat = before->dLat + w * (after->dLat - before->dLat);
+    dLon = before->dLon + w * (after->dLon - before->dLon);
+  } else if (before || after) {
+    const DgpsEpoch* e = before ? before : after;   // vecina más próxima (≤2 s)
+    dLat = e->dLat;
+    dLon = e->dLon;
+  } else {
+    return false;
+  }
+
+  out.lat = in.lat - dLat;
+  out.lon = in.lon - dLon;
+  return true;
+}
+
+/**
+ * \brief Último error de la base en metros.
+ */
+float DGPS_lastBaseErrorM() {
+  return s_lastErrM;
+}
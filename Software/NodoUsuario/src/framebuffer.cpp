@@ -0,0 +1,262 @@
+/** @file framebuffer.cpp
+ * @brief Implementación del framebuffer con seguimiento de zonas cambiadas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "framebuffer.h"
+#include <string.h>
+
+/** Fuente 5x7, ASCII 32..95: una columna por byte, bit 0 arriba. */
+static const uint8_t FONT_5X7[64][5] = {
+  {0x00, 0x00, 0x00, 0x00, 0x00},   // ' '
+  {0x00, 0x00, 0x5F, 0x00, 0x00},   // '!'
+  {0x00, 0x03, 0x00, 0x03, 0x00},   // '"'
+  {0x14, 0x7F, 0x14, 0x7F, 0x14},   // '#'
+  {0x24, 0x2A, 0x7F, 0x2A, 0x12},   // '$'
+  {0x23, 0x13, 0x08, 0x64, 0x62},   // '%'
+  {0x36, 0x49, 0x55, 0x22, 0x50},   // '&'
+  {0x00, 0x00, 0x03, 0x00, 0x00},   // '''
+  {0x00, 0x1C, 0x22, 0x41, 0x00},   // '('
+  {0x00, 0x41, 0x22, 0x1C, 0x00},   // ')'
+  {0x14, 0x08, 0x3E, 0x08, 0x14},   // '*'
+  {0x08, 0x08, 0x3E, 0x08, 0x08},   // '+'
+  {0x00, 0x50, 0x30, 0x00, 0x00},   // ','
+  {0x08, 0x08, 0x08, 0x08, 0x08},   // '-'
+  {0x00, 0x60, 0x60, 0x00, 0x00},   // '.'
+  {0x20, 0x10, 0x08, 0x04, 0x02},   // '/'
+  {0x3E, 0x51, 0x49, 0x45, 0x3E},   // '0'
+  {0x00, 0x42, 0x7F, 0x40, 0x00},   // '1'
+  {0x42, 0x61, 0x51, 0x49, 0x46},   // '2'
+  {0x21, 0x41, 0x45, 0x4B, 0x31},   // '3'
+  {0x18, 0x14, 0x12, 0x7F, 0x10},   // '4'
+  {0x27, 0x45, 0x45, 0x45, 0x39},   // '5'
+  {0x3C, 0x4A, 0x49, 0x49, 0x30},   // '6'
+  {0x01, 0x71, 0x09, 0x05, 0x03},   // '7'
+  {0x36, 0x49, 0x49, 0x49, 0x36},   // '8'
+  {0x06, 0x49, 0x49, 0x29, 0x1E},   // '9'
+  {0x00, 0x36, 0x36, 0x00, 0x00},   // ':'
+  {0x00, 0x56, 0x36, 0x00, 0x00},   // ';'
+  {0x08, 0x14, 0x22, 0x41, 0x00},   // '<'
+  {0x14, 0x14, 0x14, 0x14, 0x14},   // '='
+  {0x00, 0x41, 0x22, 0x14, 0x08},   // '>'
+  {0x02, 0x01, 0x51, 0x09, 0x06},   // '?'
+  {0x32, 0x49, 0x79, 0x41, 0x3E},   // '@'
+  {0x7E, 0x09, 0x09, 0x09, 0x7E},   // 'A'
+  {0x7F, 0x49, 0x49, 0x49, 0x36},   // 'B'
+  {0x3E, 0x41, 0x41, 0x41, 0x22},   // 'C'
+  {0x7F, 0x41, 0x41, 0x22, 0x1C},   // 'D'
+  {0x7F, 0x49, 0x49, 0x49, 0x41},   // 'E'
+  {0x7F, 0x09, 0x09, 0x09, 0x01},   // 'F'
+  {0x3E, 0x41, 0x49, 0x49, 0x7A},   // 'G'
+  {0x7F, 0x08, 0x08, 0x08, 0x7F},   // 'H'
+  {0x00, 0x41, 0x7F, 0x41, 0x00},   // 'I'
+  {0x20, 0x40, 0x41, 0x3F, 0x01},   // 'J'
+  {0x7F, 0x08, 0x14, 0x22, 0x41},   // 'K'
+  {0x7F, 0x40, 0x40, 0x40, 0x40},   // 'L'
+  {0x7F, 0x02, 0x0C, 0x02, 0x7F},   // 'M'
+  {0x7F, 0x04, 0x08, 0x10, 0x7F},   // 'N'
+  {0x3E, 0x41, 0x41, 0x41, 0x3E},   // 'O'
+  {0x7F, 0x09, 0x09, 0x09, 0x06},   // 'P'
+  {0x3E, 0x41, 0x51, 0x21, 0x5E},   // 'Q'
+  {0x7F, 0x09, 0x19, 0x29, 0x46},   // 'R'
+  {0x46, 0x49, 0x49, 0x49, 0x31},   // 'S'
+  {0x01, 0x01, 0x7F, 0x01, 0x01},   // 'T'
+  {0x3F, 0x40, 0x40, 0x40, 0x3F},   // 'U'
+  {0x1F, 0x20, 0x40, 0x20, 0x1F},   // 'V'
+  {0x3F, 0x40, 0x38, 0x40, 0x3F},   // 'W'
+  {0x63, 0x14, 0x08, 0x14, 0x63},   // 'X'
+  {0x07, 0x08, 0x70, 0x08, 0x07},   // 'Y'
+  {0x61, 0x51, 0x49, 0x45, 0x43},   // 'Z'
+  {0x00, 0x7F, 0x41, 0x41, 0x00},   // '['
+  {0x02, 0x04, 0x08, 0x10, 0x20},   // '\'
+  {0x00, 0x41, 0x41, 0x7F, 0x00},   // ']'
+  {0x04, 0x02, 0x01, 0x02, 0x04},   // '^'
+  {0x40, 0x40, 0x40, 0x40, 0x40},   // '_'
+};
+
+// ----------------- Estado interno -----------------------
+static uint8_t s_draw[FB_BYTES];
+static uint8_t s_shown[FB_BYTES];
+/** Columnas tocadas por página desde el último envío (x0 > x1 = ninguna). */
+static uint8_t s_touch0[FB_PAGES], s_touch1[FB_PAGES];
+/** El panel no tiene nada conocido: el siguiente tramo es la pantalla entera. */
+static bool    s_fullPending = true;
+static int     s_clipX0 = 0, s_clipY0 = 0, s_clipX1 = FB_WIDTH, s_clipY1 = FB_HEIGHT;
+
+static void touch(uint8_t page, int x0, int x1) {
+  if (x0 < s_touch0[page]) s_touch0[page] = (uint8_t)x0;
+  if (x1 > s_touch1[page]) s_touch1[page] = (uint8_t)x1;
+}
+
+void FB_begin() {
+  memset(s_draw, 0, sizeof(s_draw));
+  memset(s_touch0, 0xFF, sizeof(s_touch0));
+  memset(s_touch1, 0x00, sizeof(s_touch1));
+  FB_resetClip();
+  FB_invalidate();
+}
+
+void FB_invalidate() {
+  s_fullPending = true;
+}
+
+void FB_setClip(int x, int y, int w, int h) {
+  s_clipX0 = x < 0 ? 0 : x;
+  s_clipY0 = y < 0 ? 0 : y;
+  s_clipX1 = x + w > FB_WIDTH ? FB_WIDTH : x + w;
+  s_clipY1 = y + h > FB_HEIGHT ? FB_HEIGHT : y + h;
+}
+
+void FB_resetClip() {
+  FB_setClip(0, 0, FB_WIDTH, FB_HEIGHT);
+}
+
+static bool inClip(int x, int y) {
+  return x >= s_clipX0 && x < s_clipX1 && y >= s_clipY0 && y < s_clipY1;
+}
+
+void FB_pixel(int x, int y, bool on) {
+  if (!inClip(x, y)) return;
+  uint8_t& b   = s_draw[(y >> 3) * FB_WIDTH + x];
+  uint8_t mask = (uint8_t)(1u << (y & 7));
+  b = on ? (b | mask) : (b & ~mask);
+  touch((uint8_t)(y >> 3), x, x);
+}
+
+bool FB_getPixel(int x, int y) {
+  if (x < 0 || x >= FB_WIDTH || y < 0 || y >= FB_HEIGHT) return false;
+  return (s_draw[(y >> 3) * FB_WIDTH + x] >> (y & 7)) & 1;
+}
+
+/**
+ * \brief Por páginas: una máscara vertical por página aplicada a todas las columnas.
+ */
+void FB_fillRect(int x, int y, int w, int h, bool on) {
+  int x0 = x < s_clipX0 ? s_clipX0 : x, x1 = x + w > s_clipX1 ? s_clipX1 : x + w;
+  int y0 = y < s_clipY0 ? s_clipY0 : y, y1 = y + h > s_clipY1 ? s_clipY1 : y + h;
+  if (x0 >= x1 || y0 >= y1) return;
+  for (int p = y0 >> 3; p <= (y1 - 1) >> 3; p++) {
+    int top = p * 8 > y0 ? p * 8 : y0, bot = p * 8 + 8 < y1 ? p * 8 + 8 : y1;
+    uint8_t mask = (uint8_t)(((1u << (bot - top)) - 1) << (top - p * 8));
+    uint8_t* row = &s_draw[p * FB_WIDTH];
+    for (int c = x0; c < x1; c++) row[c] = on ? (row[c] | mask) : (row[c] & ~mask);
+    touch((uint8_t)p, x0, x1 - 1);
+  }
+}
+
+void FB_rect(int x, int y, int w, int h) {
+  if (w <= 0 || h <= 0) return;
+  FB_fillRect(x, y, w, 1, true);
+  FB_fillRect(x, y + h - 1, w, 1, true);
+  FB_fillRect(x, y, 1, h, true);
+  FB_fillRect(x + w - 1, y, 1, h, true);
+}
+
+void FB_line(int x0, int y0, int x1, int y1) {
+  int dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+  int dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    FB_pixel(x0, y0, true);
+    if (x0 == x1 && y0 == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+static const uint8_t* glyph(char c) {
+  if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+  if (c < 32 || c > 95) c = '?';
+  return FONT_5X7[c - 32];
+}
+
+/**
+ * \brief Con \p y múltiplo de 8 y el carácter entero dentro del recorte se
+ *        escriben las columnas directamente; si no, píxel a píxel.
+ */
+size_t FB_text(int x, int y, const char* s) {
+  size_t n = 0;
+  for (; s && *s && *s != '\n'; s++, n++, x += FB_CHAR_W) {
+    if (x + 5 > s_clipX1) break;
+    const uint8_t* g = glyph(*s);
+    if ((y & 7) == 0 && inClip(x, y) && inClip(x + 4, y + 6)) {
+      uint8_t* col = &s_draw[(y >> 3) * FB_WIDTH + x];
+      for (int c = 0; c < 5; c++) col[c] |= g[c];
+      touch((uint8_t)(y >> 3), x, x + 4);
+      continue;
+    }
+    for (int c = 0; c < 5; c++)
+      for (int r = 0; r < 7; r++)
+        if ((g[c] >> r) & 1) FB_pixel(x + c, y + r, true);
+  }
+  return n;
+}
+
+const uint8_t* FB_pixels() {
+  return s_draw;
+}
+
+bool FB_isDirty() {
+  if (s_fullPending) return true;
+  for (uint8_t p = 0; p < FB_PAGES; p++)
+    if (s_touch0[p] <= s_touch1[p]) return true;
+  return false;
+}
+
+/**
+ * \brief Acota lo tocado de la página \p p a las columnas que difieren.
+ * \return false si no difiere nada (y la página queda limpia).
+ */
+static bool pageDiff(uint8_t p, uint8_t& x0, uint8_t& x1) {
+  if (s_touch0[p] > s_touch1[p]) return false;
+  const uint8_t* d = &s_draw[p * FB_WIDTH];
+  const uint8_t* s = &s_shown[p * FB_WIDTH];
+  int a = s_touch0[p], b = s_touch1[p];
+  while (a <= b && d[a] == s[a]) a++;
+  while (b >= a && d[b] == s[b]) b--;
+  if (a > b) {
+    s_touch0[p] = 0xFF;
+    s_touch1[p] = 0;
+    return false;
+  }
+  x0 = (uint8_t)a;
+  x1 = (uint8_t)b;
+  return true;
+}
+
+bool FB_nextSegment(FbSegment& seg) {
+  uint8_t p = 0, x0 = 0, x1 = FB_WIDTH - 1, last = FB_PAGES - 1;
+  if (s_fullPending) {
+    s_fullPending = false;
+  } else {
+    while (p < FB_PAGES && !pageDiff(p, x0, x1)) p++;
+    if (p == FB_PAGES) return false;
+    last = p;
+  }
+
+  if (x0 == 0 && x1 == FB_WIDTH - 1) {
+    uint8_t a, b;
+    while (last + 1 < FB_PAGES && pageDiff(last + 1, a, b) && a == 0 && b == FB_WIDTH - 1) last++;
+  }
+
+  size_t off = (size_t)p * FB_WIDTH + x0;
+  size_t len = (size_t)(last - p) * FB_WIDTH + (x1 - x0 + 1);
+  memcpy(&s_shown[off], &s_draw[off], len);
+  for (uint8_t q = p; q <= last; q++) {
+    s_touch0[q] = 0xFF;
+    s_touch1[q] = 0;
+  }
+
+  const uint8_t cmd[FB_CMD_LEN] = {0x21, x0, x1, 0x22, p, last};
+  memcpy(seg.cmd, cmd, sizeof(cmd));
+  seg.x0      = x0;
+  seg.x1      = x1;
+  seg.page0   = p;
+  seg.page1   = last;
+  seg.data    = &s_shown[off];
+  seg.dataLen = (uint16_t)len;
+  return true;
+}
@@ -0,0 +1,104 @@
+/** @file freq_track.cpp
+ * @brief Implementación del seguimiento del error de frecuencia y del presupuesto del enlace.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "freq_track.h"
+#include <math.h>
+
+// ----------------- Receptor (SX1262, valores típicos) -----------------------
+static const float NOISE_FIGURE_DB = 6.0f;
+/** SNR mínima demodulable por SF (SF7..SF12). */
+static const float SNR_LIMIT_DB[6] = {-7.5f, -10.0f, -12.5f, -15.0f, -17.5f, -20.0f};
+
+// ----------------- Estado interno -----------------------
+static FrqState s_frq;
+
+void FRQ_begin() {
+  s_frq = FrqState{};
+}
+
+/**
+ * \brief La primera muestra fija la media; las siguientes se filtran si no son aisladas.
+ */
+bool FRQ_observe(float errHz, float snrDb) {
+  if (!isfinite(errHz) || !(snrDb >= FRQ_MIN_SNR_DB)) {
+    s_frq.rejected++;
+    return false;
+  }
+  if (s_frq.samples == 0) {
+    s_frq.meanHz   = errHz;
+    s_frq.varHz2   = 0.0f;
+    s_frq.samples  = 1;
+    s_frq.outliers = 0;
+    s_frq.accepted++;
+    return true;
+  }
+
+  float d     = errHz - s_frq.meanHz;
+  float sigma = fmaxf(FRQ_stdHz(), FRQ_MIN_SIGMA_HZ);
+  if (fabsf(d) > FRQ_OUTLIER_SIGMA * sigma) {
+    s_frq.rejected++;
+    if (++s_frq.outliers < FRQ_REACQUIRE) return false;
+    // Varios seguidos: el error ha cambiado de verdad, se vuelve a adquirir
+    s_frq.samples = 0;
+    s_frq.rejected--;
+    return FRQ_observe(errHz, snrDb);
+  }
+  s_frq.outliers = 0;
+  s_frq.meanHz += FRQ_ALPHA * d;
+  s_frq.varHz2  = (1.0f - FRQ_ALPHA) * (s_frq.varHz2 + FRQ_ALPHA * d * d);
+  if (s_frq.samples < 0xFFFF) s_frq.samples++;
+  s_frq.accepted++;
+  return true;
+}
+
+const FrqState& FRQ_state() {
+  return s_frq;
+}
+
+float FRQ_stdHz() {
+  return sqrtf(s_frq.varHz2);
+}
+
+bool FRQ_isLocked() {
+  return s_frq.samples >= FRQ_LOCK_SAMPLES;
+}
+
+int16_t FRQ_correctionHz() {
+  if (!FRQ_isLocked() || fabsf(s_frq.meanHz) < FRQ_CORR_MIN_HZ) return 0;
+  float c = -s_frq.meanHz;
+  if (c >  FRQ_CORR_MAX_HZ) c =  FRQ_CORR_MAX_HZ;
+  if (c < -FRQ_CORR_MAX_HZ) c = -FRQ_CORR_MAX_HZ;
+  return (int16_t)lroundf(c);
+}
+
+/**
+ * \brief El collar se desplaza \p hz: el error esperado cambia en la misma cantidad.
+ */
+void FRQ_noteCorrection(int16_t hz) {
+  s_frq.meanHz  += hz;
+  s_frq.samples  = 1;   // la media prevista cuenta como una muestra
+  s_frq.outliers = 0;
+}
+
+bool FRQ_bandwidthOk(float bwKHz) {
+  if (!FRQ_isLocked()) return false;
+  return fabsf(s_frq.meanHz) + 3.0f * FRQ_stdHz() <= FRQ_TOLERANCE_FRAC * bwKHz * 1000.0f;
+}
+
+float FRQ_sensitivityDbm(uint8_t sf, float bwKHz) {
+  uint8_t i = sf < 7 ? 0 : (sf > 12 ? 5 : sf - 7);
+  return -174.0f + 10.0f * log10f(bwKHz * 1000.0f) + NOISE_FIGURE_DB + SNR_LIMIT_DB[i];
+}
+
+float FRQ_airtimeMs(size_t payloadLen, uint8_t sf, float bwKHz, uint8_t crDen, uint16_t preambleSymbols) {
+  const float tSymMs = (float)(1UL << sf) / bwKHz;
+  const int   de     = tSymMs >= 16.0f ? 1 : 0;
+  const int   num    = 8 * (int)payloadLen - 4 * sf + 28 + 16;   // CRC on, cabecera explícita
+  int nPayload = 8;
+  if (num > 0) nPayload += (int)ceilf((float)num / (4.0f * (sf - 2 * de))) * crDen;
+  return (preambleSymbols + 4.25f) * tSymMs + nPayload * tSymMs;
+}
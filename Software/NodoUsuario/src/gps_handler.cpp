@@ -5,7 +5,7 @@
  * - Inicializa el enlace serie con el receptor GNSS (NMEA).
  * - Alimenta el parser TinyGPS++ con las tramas entrantes.
  * - Expone la última estampa válida (lat, lon, hhmmss, valid).
- * - Serializa/parsea el payload binario compacto (13 B) usado en LoRa.
+ * - El payload binario compacto (13 B) usado en LoRa está en payload_codec.cpp.
  *
  * @note La hora reportada es UTC. El formato binario es little-endian.
  *
@@ -14,9 +14,8 @@
  */
 
 #include "gps_handler.h"
+#include "hot_path.h"
 #include <SoftwareSerial.h>
-#include <math.h>
-#include <string.h>
 
 // ----------------- Configuración pines -----------------
 static const uint8_t GPS_RX_PIN = 5;   // Pico RX <- TX del GPS
@@ -26,6 +25,11 @@ static const uint8_t GPS_TX_PIN = 4;   // Pico TX -> RX del GPS
 static TinyGPSPlus gps;
 static SoftwareSerial gpsSerial(GPS_RX_PIN, GPS_TX_PIN);  
 
+// ----------------- Asistencia al collar ------------------
+static const uint32_t GPS_AID_MAX_AGE_MS = 5000;   // hora/posición aún utilizables
+static const uint8_t  GPS_AID_POS_ACC_KM = 20;     // alcance del enlace + cuantificación
+static const uint8_t  GPS_AID_TIME_ACC_S = 1;
+
 /**
  * \brief Inicializa SoftwareSerial hacia el receptor GNSS.
  */
@@ -37,7 +41,7 @@ bool GPS_begin(uint32_t baud) {
 /**
  * \brief Lee los mensajes recibidos y los pasa al parser NMEA.
  */
-void GPS_update() {
+void HOT_FUNC(GPS_update)() {
   while (gpsSerial.available() > 0) {
     gps.encode(gpsSerial.read());
   }
@@ -67,22 +71,19 @@ GpsInfo GPS_getInfo() {
 }
 
 /**
- * \brief Decodifica 13 B a GpsInfo; exige fix_flag==1.
+ * \brief Fecha y hora de TinyGPS++ más su antigüedad; posición de la base.
  */
-bool GPS_parsePayload(const uint8_t* in, size_t len, GpsInfo& out) {
-  if (!in || len != 13) return false;
-  if (in[0] != 1) return false;  // si quieres aceptar “no fix”, elimina esta línea
-
-  uint32_t hhmmss = 0;
-  int32_t latFixed = 0, lonFixed = 0;
-
-  memcpy(&hhmmss,   &in[1], 4);
-  memcpy(&latFixed, &in[5], 4);
-  memcpy(&lonFixed, &in[9], 4);
+bool GPS_aidingData(AidData& out) {
+  if (!gps.location.isValid() || !gps.date.isValid() || !gps.time.isValid()) return false;
+  if (gps.time.age() > GPS_AID_MAX_AGE_MS || gps.location.age() > GPS_AID_MAX_AGE_MS) return false;
 
-  out.hhmmss = hhmmss;
-  out.lat    = ((double)latFixed) / 100000.0;
-  out.lon    = ((double)lonFixed) / 100000.0;
-  out.valid  = true;
+  AidDate d = {gps.date.year(), gps.date.month(), gps.date.day(),
+               gps.time.hour(), gps.time.minute(), gps.time.second()};
+  if (d.year < 2000 || d.month < 1 || d.month > 12 || d.day < 1) return false;
+  out.utc      = AID_utcFromDate(d) + (gps.time.age() + 500UL) / 1000UL;
+  out.lat      = (float)gps.location.lat();
+  out.lon      = (float)gps.location.lng();
+  out.posAccKm = GPS_AID_POS_ACC_KM;
+  out.timeAccS = GPS_AID_TIME_ACC_S;
   return true;
 }
@@ -0,0 +1,67 @@
+/** @file hot_path.cpp
+ * @brief Implementación del perfilador por ciclos de la ruta crítica.
+ *
+ * Sólo se compila con `-DHOT_PROFILE`. Cada slot guarda el número de muestras,
+ * la suma y el máximo de ciclos (reloj del sistema, 133 MHz por defecto).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "hot_path.h"
+
+#if defined(HOT_PROFILE)
+
+struct HotStat {
+  uint32_t count;
+  uint64_t total;
+  uint32_t max;
+};
+
+static HotStat  s_stats[HOT_SLOT_COUNT];
+static uint32_t s_lastLoop = 0;
+
+static const char* const HOT_NAMES[HOT_SLOT_COUNT] = {
+  "loop_period", "http", "rx_tick", "codec_parse", "lora_isr", "isr_service",
+  "rules_eval"
+};
+
+/**
+ * \brief Acumula una muestra (también llamada desde ISR: sólo sumas y comparaciones).
+ */
+void HOT_FUNC(HOT_record)(HotSlot slot, uint32_t cycles) {
+  HotStat& st = s_stats[slot];
+  st.count++;
+  st.total += cycles;
+  if (cycles > st.max) st.max = cycles;
+}
+
+/**
+ * \brief Periodo de loop() en ciclos (la primera llamada sólo fija la referencia).
+ */
+void HOT_FUNC(HOT_loopMark)() {
+  uint32_t now = rp2040.getCycleCount();
+  if (s_lastLoop != 0) HOT_record(HOT_SLOT_LOOP, now - s_lastLoop);
+  s_lastLoop = now;
+}
+
+/**
+ * \brief Tabla legible: slot, llamadas, media y máximo en ciclos y en µs.
+ */
+void HOT_report(Stream& port, bool reset) {
+  const uint32_t cyclesPerUs = rp2040.f_cpu() / 1000000UL;
+  port.println("[PROF] slot calls avg_cyc max_cyc avg_us max_us");
+  for (uint8_t i = 0; i < HOT_SLOT_COUNT; i++) {
+    HotStat st = s_stats[i];
+    uint32_t avg = st.count ? (uint32_t)(st.total / st.count) : 0;
+    port.print("[PROF] "); port.print(HOT_NAMES[i]);
+    port.print(' ');       port.print(st.count);
+    port.print(' ');       port.print(avg);
+    port.print(' ');       port.print(st.max);
+    port.print(' ');       port.print(avg / cyclesPerUs);
+    port.print(' ');       port.println(st.max / cyclesPerUs);
+    if (reset) s_stats[i] = HotStat{0, 0, 0};
+  }
+}
+
+#endif
@@ -6,6 +6,7 @@
  * - Listado de redes WiFi disponibles.
  * - Confirmación de credenciales almacenadas.
  * - Visualización de coordenadas GNSS recibidas.
+ * - Edición y estado de las reglas de alerta.
  *
  * Las páginas se cargan desde el sistema de ficheros LittleFS y se envían mediante
  * el servidor web integrado (WebServer).
@@ -15,6 +16,8 @@
  */
 
 #include "html_pages.h"
+#include "wifi_manager.h"
+#include "rule_engine.h"
 #include <WiFi.h>
 #include <WebServer.h>
 #include <LittleFS.h>
@@ -28,15 +31,15 @@ String generateScanNetworksHTML() {
   String html = file.readString();
   file.close();
 
-  int n = WiFi.scanNetworks();
+  // Escaneo de redes WiFi disponibles (reutiliza el del arranque del AP si es reciente)
+  int n = WIFI_scanCached(30000UL);
   String options;
 
-  // Escaneo de redes WiFi disponibles
   if (n == 0) {
     options = "<option disabled>No se encontraron redes</option>";
   } else {
     for (int i = 0; i < n; i++) { // Busca y sitúa el nombre de los ssid encontrados en los tags HTML
-      String ssid = WiFi.SSID(i);
+      String ssid = WIFI_scanSSID(i);
       ssid.replace("\"", "&quot;");
       options += "<option value=\"" + ssid + "\">" + ssid + "</option>";
     }
@@ -65,3 +68,36 @@ String generateCoordsHTML(){
   file.close();
   return html;
 }
+
+/// @brief Escapa el texto para insertarlo en el HTML
+static String escapeHTML(const String& text) {
+  String out = text;
+  out.replace("&", "&amp;");
+  out.replace("<", "&lt;");
+  out.replace(">", "&gt;");
+  return out;
+}
+
+/// @brief Genera la página de edición y estado de las reglas de alerta
+String generateRulesHTML(const String& source, const String& status, uint32_t nowS) {
+  File file = LittleFS.open("/rules.html", "r");
+  if (!file) return "<p>Error cargando página rules.html</p>";
+
+  String html = file.readString();
+  file.close();
+
+  String rows;
+  for (uint8_t i = 0; i < RUL_count(); i++) {
+    const RuleInfo& r = RUL_info(i);
+    const char* state = r.active ? "activa" : r.pending ? "esperando" : "-";
+    String last = r.fires ? "hace " + String(nowS - r.lastFireS) + " s" : "-";
+    rows += "<tr><td>" + String(r.name) + "</td><td>" + String(r.codeLen) + "</td><td>" +
+            (r.holdS ? String(r.holdS) + " s" : "-") + "</td><td>" + state + "</td><td>" +
+            String(r.fires) + "</td><td>" + last + "</td></tr>";
+  }
+
+  html.replace("%%STATUS%%", escapeHTML(status));
+  html.replace("%%RULES%%", rows);
+  html.replace("%%SOURCE%%", escapeHTML(source));   // el último: el texto puede contener marcadores
+  return html;
+}
@@ -0,0 +1,287 @@
+/** @file http_gzip.cpp
+ * @brief Implementación del codificador DEFLATE (Huffman fijo) con envoltorio gzip.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "http_gzip.h"
+#include <string.h>
+
+static_assert((GZ_WINDOW & (GZ_WINDOW - 1)) == 0, "GZ_WINDOW debe ser potencia de 2");
+static_assert(GZ_WINDOW >= 512 && GZ_WINDOW <= 16384, "GZ_WINDOW fuera de rango");
+
+// ----------------- Constantes DEFLATE -----------------------
+static const uint16_t MIN_MATCH = 3;
+static const uint16_t MAX_MATCH = 258;
+static const uint16_t SYM_EOB   = 256;
+
+/** Longitud base de los símbolos 257..285 y sus bits extra. */
+static const uint16_t LEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t  LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                       3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+/** Distancia base de los códigos 0..27 (hasta 16384) y sus bits extra. */
+static const uint16_t DIST_BASE[28] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                       257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                       8193, 12289};
+static const uint8_t  DIST_EXTRA[28] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12};
+
+/** CRC-32 (polinomio reflejado 0xEDB88320) de 4 en 4 bits: tabla de 64 bytes. */
+static const uint32_t CRC_NIBBLE[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+// ----------------- Salida -----------------------
+
+static void flushOut(GzStream& z) {
+  if (!z.outLen) return;
+  z.sink(z.out, z.outLen, z.ctx);
+  z.outBytes += z.outLen;
+  z.outLen = 0;
+}
+
+static inline void putByte(GzStream& z, uint8_t b) {
+  z.out[z.outLen++] = (char)b;
+  if (z.outLen == GZ_OUT_CHUNK) flushOut(z);
+}
+
+/**
+ * \brief Añade \p n bits (≤ 16) empezando por el menos significativo.
+ */
+static inline void putBits(GzStream& z, uint32_t v, uint8_t n) {
+  z.bitBuf |= v << z.bitCount;
+  z.bitCount += n;
+  while (z.bitCount >= 8) {
+    putByte(z, (uint8_t)z.bitBuf);
+    z.bitBuf >>= 8;
+    z.bitCount -= 8;
+  }
+}
+
+/**
+ * \brief Los códigos Huffman van del bit más significativo al menos.
+ */
+static inline void putCode(GzStream& z, uint16_t code, uint8_t len) {
+  uint32_t r = code;
+  r = ((r & 0x5555) << 1) | ((r >> 1) & 0x5555);
+  r = ((r & 0x3333) << 2) | ((r >> 2) & 0x3333);
+  r = ((r & 0x0F0F) << 4) | ((r >> 4) & 0x0F0F);
+  r = ((r & 0x00FF) << 8) | ((r >> 8) & 0x00FF);
+  putBits(z, r >> (16 - len), len);
+}
+
+/**
+ * \brief Símbolo literal/longitud con el código fijo de RFC 1951 §3.2.6.
+ */
+static void putSym(GzStream& z, uint16_t sym) {
+  if (sym < 144)      putCode(z, (uint16_t)(0x30 + sym), 8);
+  else if (sym < 256) putCode(z, (uint16_t)(0x190 + sym - 144), 9);
+  else if (sym < 280) putCode(z, (uint16_t)(sym - 256), 7);
+  else                putCode(z, (uint16_t)(0xC0 + sym - 280), 8);
+}
+
+static void putMatch(GzStream& z, uint16_t len, uint16_t dist) {
+  uint8_t i = 28;
+  while (LEN_BASE[i] > len) i--;
+  putSym(z, (uint16_t)(257 + i));
+  if (LEN_EXTRA[i]) putBits(z, len - LEN_BASE[i], LEN_EXTRA[i]);
+
+  uint8_t d = 27;
+  while (DIST_BASE[d] > dist) d--;
+  putCode(z, d, 5);
+  if (DIST_EXTRA[d]) putBits(z, dist - DIST_BASE[d], DIST_EXTRA[d]);
+}
+
+// ----------------- LZ77 -----------------------
+
+static inline uint16_t hash3(const uint8_t* p) {
+  uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  return (uint16_t)((uint32_t)(v * 2654435761UL) >> (32 - GZ_HASH_BITS));
+}
+
+static inline void insert(GzStream& z, uint16_t i) {
+  uint16_t h = hash3(&z.win[i]);
+  z.prev[i & (GZ_WINDOW - 1)] = z.head[h];
+  z.head[h] = (uint16_t)(i + 1);
+}
+
+/**
+ * \brief Descarta la mitad antigua de la ventana y reajusta las posiciones.
+ */
+static void slide(GzStream& z) {
+  memmove(z.win, z.win + GZ_WINDOW, GZ_WINDOW);
+  z.pos -= GZ_WINDOW;
+  z.end -= GZ_WINDOW;
+  for (uint16_t i = 0; i < (1 << GZ_HASH_BITS); i++) z.head[i] = z.head[i] > GZ_WINDOW ? z.head[i] - GZ_WINDOW : 0;
+  for (uint16_t i = 0; i < GZ_WINDOW; i++) z.prev[i] = z.prev[i] > GZ_WINDOW ? z.prev[i] - GZ_WINDOW : 0;
+}
+
+/**
+ * \brief Mejor coincidencia anterior para la posición actual (voraz, cadena acotada).
+ */
+static uint16_t longestMatch(const GzStream& z, uint16_t maxLen, uint16_t* dist) {
+  const uint8_t* cur = &z.win[z.pos];
+  uint16_t best = 0;
+  uint16_t cand = z.head[hash3(cur)];
+  for (uint8_t chain = GZ_MAX_CHAIN; cand && chain; chain--) {
+    uint16_t p = cand - 1;
+    if (z.pos - p > GZ_WINDOW) break;
+    const uint8_t* ref = &z.win[p];
+    if (ref[best] == cur[best] && ref[0] == cur[0]) {
+      uint16_t n = 0;
+      while (n < maxLen && ref[n] == cur[n]) n++;
+      if (n > best) {
+        best  = n;
+        *dist = (uint16_t)(z.pos - p);
+        if (n == maxLen) break;
+      }
+    }
+    uint16_t next = z.prev[p & (GZ_WINDOW - 1)];
+    if (next >= cand) break;   // entrada reescrita: fin de la cadena
+    cand = next;
+  }
+  return best;
+}
+
+/**
+ * \brief Codifica lo que haya en la ventana; sin \p flush deja MAX_MATCH bytes
+ *        sin codificar para que las coincidencias no se corten en un trozo.
+ */
+static void deflate(GzStream& z, bool flush) {
+  while (z.pos < z.end) {
+    uint16_t avail = (uint16_t)(z.end - z.pos);
+    if (!flush && avail < MAX_MATCH) break;
+    uint16_t dist = 0, len = 0;
+    if (avail >= MIN_MATCH) len = longestMatch(z, avail < MAX_MATCH ? avail : MAX_MATCH, &dist);
+
+    if (len >= MIN_MATCH) {
+      putMatch(z, len, dist);
+      for (uint16_t i = 0; i < len; i++, z.pos++) {
+        if (z.end - z.pos >= MIN_MATCH) insert(z, z.pos);
+      }
+    } else {
+      putSym(z, z.win[z.pos]);
+      if (avail >= MIN_MATCH) insert(z, z.pos);
+      z.pos++;
+    }
+  }
+}
+
+// ----------------- Accept-Encoding -----------------------
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t';
+}
+
+/** Compara sin distinguir mayúsculas el token [p, end) con \p name (en minúsculas). */
+static bool tokenIs(const char* p, const char* end, const char* name) {
+  for (; p < end && *name; p++, name++) {
+    char c = *p;
+    if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+    if (c != *name) return false;
+  }
+  return p == end && !*name;
+}
+
+/**
+ * \brief true si los parámetros [p, end) de una codificación llevan q=0 (q=0.000).
+ */
+static bool qIsZero(const char* p, const char* end) {
+  while (p < end) {
+    while (p < end && (isSpace(*p) || *p == ';')) p++;
+    if (end - p >= 2 && (p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+      p += 2;
+      if (p >= end || *p != '0') return false;
+      for (p++; p < end && (*p == '0' || *p == '.'); p++) {}
+      while (p < end && isSpace(*p)) p++;
+      return p == end || *p == ';';
+    }
+    while (p < end && *p != ';') p++;
+  }
+  return false;
+}
+
+/**
+ * \brief true si `Accept-Encoding` admite gzip: por nombre o con `*`, sin q=0.
+ * \details Una entrada `gzip` explícita manda sobre `*` (RFC 9110, 12.5.3).
+ */
+static bool acceptsGzip(const char* header) {
+  int8_t gzip = -1, any = -1;               // -1 ausente, 0 rechazado, 1 admitido
+  for (const char* p = header; *p;) {
+    while (isSpace(*p) || *p == ',') p++;
+    const char* name = p;
+    while (*p && *p != ',' && *p != ';' && !isSpace(*p)) p++;
+    const char* nameEnd = p;
+    while (*p && *p != ',') p++;
+    int8_t ok = qIsZero(nameEnd, p) ? 0 : 1;
+    if (tokenIs(name, nameEnd, "gzip") || tokenIs(name, nameEnd, "x-gzip")) gzip = ok;
+    else if (tokenIs(name, nameEnd, "*")) any = ok;
+  }
+  return gzip >= 0 ? gzip == 1 : any == 1;
+}
+
+// ----------------- API -----------------------
+
+bool GZ_worthIt(const char* acceptEncoding, size_t len) {
+  if (!acceptEncoding || !acceptsGzip(acceptEncoding)) return false;
+  return len == 0 || len >= GZ_MIN_BYTES;
+}
+
+void GZ_begin(GzStream& z, GzSink sink, void* ctx) {
+  memset(z.head, 0, sizeof(z.head));
+  memset(z.prev, 0, sizeof(z.prev));
+  z.outLen = 0;
+  z.pos = z.end = 0;
+  z.bitBuf = 0;
+  z.bitCount = 0;
+  z.crc = 0xFFFFFFFFUL;
+  z.inBytes = z.outBytes = 0;
+  z.sink = sink;
+  z.ctx = ctx;
+
+  // ID1 ID2 CM=deflate FLG=0 MTIME=0 XFL=0 OS=255 (desconocido)
+  static const uint8_t HEADER[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  for (uint8_t b : HEADER) putByte(z, b);
+  putBits(z, 0, 1);   // BFINAL = 0: un único bloque fijo hasta GZ_finish()
+  putBits(z, 1, 2);   // BTYPE = 01 (Huffman fijo)
+}
+
+void GZ_write(GzStream& z, const void* data, size_t len) {
+  const uint8_t* in = (const uint8_t*)data;
+  z.inBytes += len;
+  while (len) {
+    if (z.end == 2 * GZ_WINDOW) slide(z);
+    size_t n = 2 * GZ_WINDOW - z.end;
+    if (n > len) n = len;
+    for (size_t i = 0; i < n; i++) {
+      z.crc ^= in[i];
+      z.crc = (z.crc >> 4) ^ CRC_NIBBLE[z.crc & 15];
+      z.crc = (z.crc >> 4) ^ CRC_NIBBLE[z.crc & 15];
+    }
+    memcpy(&z.win[z.end], in, n);
+    z.end += n;
+    in += n;
+    len -= n;
+    deflate(z, false);
+  }
+}
+
+void GZ_finish(GzStream& z) {
+  deflate(z, true);
+  putSym(z, SYM_EOB);
+  putBits(z, 1, 1);   // bloque final vacío
+  putBits(z, 1, 2);
+  putSym(z, SYM_EOB);
+  if (z.bitCount) putBits(z, 0, 8 - z.bitCount);
+
+  uint32_t crc = ~z.crc;
+  for (uint8_t i = 0; i < 4; i++) putByte(z, (uint8_t)(crc >> (8 * i)));
+  for (uint8_t i = 0; i < 4; i++) putByte(z, (uint8_t)(z.inBytes >> (8 * i)));
+  flushOut(z);
+}
+
+void GZ_sink(const char* data, size_t len, void* ctx) {
+  GZ_write(*static_cast<GzStream*>(ctx), data, len);
+}
@@ -12,11 +12,185 @@
  * @note Se recomienda mantener la longitud de los mensajes inferior a 32 caracteres
  *       para evitar recortes.
  *
+ * Con `-DDISPLAY_OLED` se compila en su lugar el SSD1306 por SPI1:
+ * - El contenido se dibuja en framebuffer.h y cada tramo cambiado se envía
+ *   con sus 6 bytes de comando (D/C a nivel bajo, bloqueante) seguidos de los
+ *   datos por DMA (`transferAsync`), que leen de la copia mostrada del
+ *   framebuffer: se puede seguir dibujando mientras tanto.
+ * - LCD_tick() no espera nunca: si el DMA sigue ocupado vuelve enseguida.
+ * - Métricas: bytes por el bus, bytes por actualización y tiempo de dibujo.
+ *
  * @author Verónica Lechón Rodríguez
  * @date 23/07/2025
  */
 
 #include "lcd_utils.h"
+
+#if defined(DISPLAY_OLED)
+
+#include <SPI.h>
+#include "framebuffer.h"
+#include "metrics.h"
+#include "minimap.h"
+
+// Pines del SSD1306 (SPI1)
+#define OLED_SCK  10
+#define OLED_MOSI 11
+#define OLED_CS   13
+#define OLED_DC   14
+#define OLED_RST  15
+
+static const uint32_t OLED_SPI_HZ   = 8000000;   // máx. 10 MHz en el SSD1306
+static const uint32_t MAP_REDRAW_MS = 1000;
+
+/** Arranque del SSD1306: 128x64, bomba de carga interna, direccionamiento horizontal. */
+static const uint8_t OLED_INIT[] = {
+  0xAE,         // apagada
+  0xD5, 0x80,   // reloj
+  0xA8, 0x3F,   // multiplex 64
+  0xD3, 0x00,   // sin desplazamiento
+  0x40,         // línea de inicio 0
+  0x8D, 0x14,   // bomba de carga
+  0x20, 0x00,   // direccionamiento horizontal
+  0xA1, 0xC8,   // espejo horizontal y vertical (columna 0 a la izquierda, página 0 arriba)
+  0xDA, 0x12,   // pines COM
+  0x81, 0xCF,   // contraste
+  0xD9, 0xF1,   // precarga
+  0xDB, 0x40,   // VCOMH
+  0xA4, 0xA6,   // muestra la RAM, sin invertir
+  0xAF          // encendida
+};
+
+METRIC_COUNTER(m_dispBytes, "display_bus_bytes_total", "Bytes enviados a la pantalla (comandos y datos)");
+METRIC_HISTOGRAM(m_dispUpdateBytes, "display_update_bytes", "Bytes por actualización de la pantalla",
+                 16, 64, 256, 1030);
+METRIC_HISTOGRAM(m_dispRenderUs, "display_render_us", "Tiempo de dibujo del minimapa (us)",
+                 50, 100, 250, 500, 1000);
+
+// ----------------- Estado interno -----------------------
+static const SPISettings s_spi(OLED_SPI_HZ, MSBFIRST, SPI_MODE0);
+static bool     s_dmaBusy     = false;
+static uint32_t s_updateBytes = 0;
+static bool     s_hasFix      = false;
+static uint32_t s_fixMs       = 0;
+static uint32_t s_drawMs      = 0;
+
+static void oledCommands(const uint8_t* cmd, size_t len) {
+  SPI1.beginTransaction(s_spi);
+  digitalWrite(OLED_CS, LOW);
+  digitalWrite(OLED_DC, LOW);
+  SPI1.transfer(cmd, nullptr, len);
+  digitalWrite(OLED_CS, HIGH);
+  SPI1.endTransaction();
+}
+
+/**
+ * \brief Envía los comandos del siguiente tramo y lanza sus datos por DMA.
+ * \return false si no queda nada (y cierra la actualización en las métricas).
+ */
+static bool startSegment() {
+  FbSegment seg;
+  if (!FB_nextSegment(seg)) {
+    if (s_updateBytes) {
+      m_dispBytes.inc(s_updateBytes);
+      m_dispUpdateBytes.observe((float)s_updateBytes);
+      s_updateBytes = 0;
+    }
+    return false;
+  }
+  SPI1.beginTransaction(s_spi);
+  digitalWrite(OLED_CS, LOW);
+  digitalWrite(OLED_DC, LOW);
+  SPI1.transfer(seg.cmd, nullptr, FB_CMD_LEN);
+  digitalWrite(OLED_DC, HIGH);
+  SPI1.transferAsync(seg.data, nullptr, seg.dataLen);
+  s_dmaBusy      = true;
+  s_updateBytes += FB_CMD_LEN + seg.dataLen;
+  return true;
+}
+
+/**
+ * \brief Cierra el tramo en curso si el DMA ha terminado.
+ * \return false si sigue ocupado.
+ */
+static bool finishSegment() {
+  if (!s_dmaBusy) return true;
+  if (!SPI1.finishedAsync()) return false;
+  digitalWrite(OLED_CS, HIGH);
+  SPI1.endTransaction();
+  s_dmaBusy = false;
+  return true;
+}
+
+/**
+ * \brief Envía todo lo pendiente esperando a cada tramo.
+ */
+static void flushNow() {
+  do {
+    while (!finishSegment()) {}
+  } while (startSegment());
+}
+
+static void drawMap() {
+  uint32_t t0 = micros();
+  MAP_render(s_hasFix ? (millis() - s_fixMs) / 1000 : MAP_AGE_UNKNOWN);
+  m_dispRenderUs.observe((float)(micros() - t0));
+  s_drawMs = millis();
+}
+
+/**
+ * @brief Configuración de SPI1 y arranque del SSD1306.
+ */
+void confLCD() {
+  SPI1.setSCK(OLED_SCK);
+  SPI1.setTX(OLED_MOSI);
+  SPI1.begin();
+  pinMode(OLED_CS, OUTPUT);
+  pinMode(OLED_DC, OUTPUT);
+  pinMode(OLED_RST, OUTPUT);
+  digitalWrite(OLED_CS, HIGH);
+  digitalWrite(OLED_RST, LOW);
+  delayMicroseconds(10);
+  digitalWrite(OLED_RST, HIGH);
+  delayMicroseconds(10);
+  oledCommands(OLED_INIT, sizeof(OLED_INIT));
+
+  FB_begin();
+  MAP_begin();
+  drawMap();
+  flushNow();
+}
+
+/**
+ * @brief Muestra un mensaje en las dos primeras líneas del OLED y lo envía.
+ */
+void showLCDMessage(const String &message) {
+  FB_fillRect(0, 0, FB_WIDTH, 2 * FB_CHAR_H, false);
+  const char* s = message.c_str();
+  s += FB_text(0, 0, s);
+  if (*s == '\n') s++;
+  FB_text(0, FB_CHAR_H, s);
+  flushNow();
+}
+
+void LCD_setBasePosition(double lat, double lon) {
+  if (MAP_setOrigin(lat, lon)) drawMap();
+}
+
+void LCD_addTrackPoint(double lat, double lon) {
+  MAP_addFix(lat, lon);
+  s_hasFix = true;
+  s_fixMs  = millis();
+  drawMap();
+}
+
+void LCD_tick() {
+  if (!finishSegment() || startSegment()) return;
+  if (millis() - s_drawMs >= MAP_REDRAW_MS) drawMap();
+}
+
+#else
+
 #include <Wire.h>
 #include <hd44780.h>
 #include <hd44780ioClass/hd44780_I2Cexp.h>
@@ -69,4 +243,10 @@ void showLCDMessage(const String &message) {
     lcd.setCursor(0, 1);
     lcd.print(message.substring(LCD_COLUMNS, LCD_COLUMNS * 2));
   }
-}
\ No newline at end of file
+}
+
+void LCD_setBasePosition(double, double) {}
+void LCD_addTrackPoint(double, double) {}
+void LCD_tick() {}
+
+#endif
@@ -0,0 +1,121 @@
+/** @file live_feed.cpp
+ * @brief Implementación del formato de la difusión multicast y del seguimiento del oyente.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "live_feed.h"
+#include <math.h>
+
+static const uint8_t LF_MAGIC0 = 'L';
+static const uint8_t LF_MAGIC1 = 'F';
+
+// ----------------- Utilidades -----------------------
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get16(const uint8_t* p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static long clampRound(float v, long lo, long hi) {
+  if (!(v == v)) return 0;   // NaN
+  long r = lroundf(v);
+  return r < lo ? lo : r > hi ? hi : r;
+}
+
+// ----------------- Formato -----------------------
+size_t LF_encode(const LiveFix& fix, uint8_t* out, size_t outSize) {
+  if (outSize < LF_DATAGRAM_LEN) return 0;
+  out[0] = LF_MAGIC0;
+  out[1] = LF_MAGIC1;
+  out[2] = LF_VERSION;
+  out[3] = fix.flags;
+  put32(out + 4, fix.seq);
+  put16(out + 8, fix.bootId);
+  put32(out + 10, fix.sendMs);
+  put32(out + 14, (uint32_t)(int32_t)lround(fix.lat * 1e7));
+  put32(out + 18, (uint32_t)(int32_t)lround(fix.lon * 1e7));
+  put32(out + 22, fix.hhmmss);
+  put16(out + 26, fix.holdMs);
+  out[28] = (uint8_t)clampRound(-fix.rssi, 0, 255);
+  out[29] = (uint8_t)(int8_t)clampRound(fix.snr * 4.0f, -128, 127);
+  return LF_DATAGRAM_LEN;
+}
+
+bool LF_decode(const uint8_t* buf, size_t len, LiveFix& out) {
+  if (len != LF_DATAGRAM_LEN || buf[0] != LF_MAGIC0 || buf[1] != LF_MAGIC1 || buf[2] != LF_VERSION)
+    return false;
+  out.flags  = buf[3];
+  out.seq    = get32(buf + 4);
+  out.bootId = get16(buf + 8);
+  out.sendMs = get32(buf + 10);
+  out.lat    = (int32_t)get32(buf + 14) * 1e-7;
+  out.lon    = (int32_t)get32(buf + 18) * 1e-7;
+  out.hhmmss = get32(buf + 22);
+  out.holdMs = get16(buf + 26);
+  out.rssi   = -(float)buf[28];
+  out.snr    = (int8_t)buf[29] / 4.0f;
+  return true;
+}
+
+// ----------------- Seguimiento del oyente -----------------------
+void LF_trackBegin(LfTracker& t) {
+  t = LfTracker{};
+}
+
+LfEvent LF_track(LfTracker& t, const LiveFix& fix, uint32_t recvMs) {
+  LfEvent ev{LF_NEW, 0, 0};
+  int32_t owd = (int32_t)(recvMs - fix.sendMs);
+
+  if (!t.started || fix.bootId != t.bootId) {
+    ev.kind = t.started ? LF_RESTART : LF_NEW;
+    if (t.started) t.restarts++;
+    t.started  = true;
+    t.bootId   = fix.bootId;
+    t.first    = fix.seq;
+    t.highest  = fix.seq;
+    t.window   = 1;
+    t.minOwdMs = owd;
+    t.received++;
+    return ev;
+  }
+
+  // Diferencia con signo: seq puede dar la vuelta
+  int32_t d = (int32_t)(fix.seq - t.highest);
+  if (d > 0) {
+    t.window  = (uint32_t)d >= LF_WINDOW ? 1 : (t.window << d) | 1;
+    t.highest = fix.seq;
+    ev.gap    = (uint32_t)d - 1;
+    t.lost   += ev.gap;
+  } else if (t.highest - fix.seq >= LF_WINDOW) {
+    ev.kind = LF_STALE;
+    return ev;
+  } else if (t.window >> (t.highest - fix.seq) & 1) {
+    ev.kind = LF_DUPLICATE;
+    t.duplicates++;
+    return ev;
+  } else {
+    ev.kind   = LF_LATE;
+    t.window |= (uint64_t)1 << (t.highest - fix.seq);
+    // Anteriores al primero no se contaron como perdidos
+    if ((int32_t)(fix.seq - t.first) > 0) t.lost--;
+    t.late++;
+  }
+
+  t.received++;
+  if (owd < t.minOwdMs) t.minOwdMs = owd;
+  ev.jitterMs = (uint32_t)(owd - t.minOwdMs);
+  return ev;
+}
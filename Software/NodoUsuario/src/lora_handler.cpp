@@ -6,6 +6,17 @@
 * - Arranca la recepción continua
 * - Atiende la ISR de “paquete recibido”
 * - Expone la última estampa GNSS válida decodificada desde un payload binario de 13 B.
+* - Guarda la última trama de salud del collar (16 B, health_frame.h).
+* - Guarda la última alerta de valla del collar (15 B, geofence.h).
+* - Mide el error de frecuencia de cada trama aceptada (freq_track.h) y puede
+*   recibir las subidas a 62,5 kHz; las bajadas siguen a 125 kHz.
+* - Entrega cada trama recibida al gancho de reenvío, si lo hay.
+* - Con `-DREPLAY_MODE` procesa tramas grabadas (LORA_injectFrame()) en lugar
+*   de las de la radio; con `-DREPLAY_RECORD` escribe cada trama en el formato
+*   de las trazas (replay_trace.h).
+* - Envía comandos, asistencia GNSS y la valla de casa al collar con preámbulo largo (wake-on-radio,
+*   ver wake_radio.h, gnss_aiding.h y geofence.h)
+*   respetando el duty-cycle del 1 % de la banda.
 *
 * @author Verónica Lechón Rodríguez
 * @date 23/07/2025
@@ -14,6 +25,14 @@
 #include <RadioLib.h>
 #include <string.h>
 #include "lora_handler.h"
+#include "hot_path.h"
+#include "metrics.h"
+#include "rx_decoder.h"
+#include "channel_probe.h"
+#include "wake_radio.h"
+#if defined(REPLAY_MODE) || defined(REPLAY_RECORD)
+  #include "replay_trace.h"
+#endif
 
 // --- Pines RP2040 (SPI0 = SPI) ---
 #define LORA_SCK        18
@@ -27,7 +46,25 @@
 #define LORA_RX_ENABLE  26
 
 // Longitud máxima que procesamos (por seguridad)
-static const int LORA_MAX_READ = 64;
+static const size_t LORA_MAX_READ = 64;
+// Preámbulo normal (uplinks del collar) y duty-cycle de la sub-banda (ETSI EN 300 220)
+static const uint16_t LORA_PREAMBLE   = 8;
+static const float    LORA_DUTY_CYCLE = 0.01f;
+
+// --------- Métricas ----------
+METRIC_COUNTER_L(m_rxAccepted, "lora_rx_frames_total", "Tramas LoRa recibidas por resultado", "result=\"accepted\"");
+METRIC_COUNTER_L(m_rxRejected, "lora_rx_frames_total", "Tramas LoRa recibidas por resultado", "result=\"rejected\"");
+METRIC_COUNTER_L(m_rxError,    "lora_rx_frames_total", "Tramas LoRa recibidas por resultado", "result=\"error\"");
+METRIC_COUNTER_L(m_rxHealth,   "lora_rx_frames_total", "Tramas LoRa recibidas por resultado", "result=\"health\"");
+METRIC_COUNTER_L(m_rxGeo,      "lora_rx_frames_total", "Tramas LoRa recibidas por resultado", "result=\"geo_alert\"");
+METRIC_HISTOGRAM(m_rxRssi, "lora_rx_rssi_dbm", "RSSI de las tramas recibidas (dBm)",
+                 -120, -110, -100, -90, -80, -70);
+METRIC_GAUGE(m_rxSnr, "lora_rx_snr_db", "SNR de la última trama recibida (dB)");
+METRIC_GAUGE(m_rxFreqErr, "lora_rx_freq_error_hz", "Error de frecuencia de la última trama recibida (Hz)");
+METRIC_GAUGE(m_ulBw, "lora_uplink_bandwidth_khz", "Ancho de banda de recepción de las subidas (kHz)");
+METRIC_COUNTER(m_cmdTx, "lora_cmd_tx_total", "Comandos enviados al collar (wake-on-radio)");
+METRIC_COUNTER(m_aidTx, "lora_aid_tx_total", "Tramas de asistencia GNSS enviadas al collar");
+METRIC_COUNTER(m_fenceTx, "lora_fence_tx_total", "Tramas de valla enviadas al collar");
 
 // Instancia RadioLib (SX1262 sobre SPI0)
 // Nota: Module(SS, DIO1, RST, BUSY, spi, spiSettings)
@@ -41,15 +78,86 @@ static GpsInfo s_lastGps = {0,0,0,false};
 /** Métricas RF del último paquete recibido. */
 static float   s_lastRssi = 0.0f;
 static float   s_lastSnr  = 0.0f;
+static float   s_lastFreqErr = 0.0f;
+/** Error de frecuencia de la última trama aceptada del collar, su SNR e instante (0 = ninguna). */
+static float    s_collarFreqErr = 0.0f;
+static float    s_collarSnr     = 0.0f;
+static uint32_t s_collarFreqMs  = 0;
+/** Ancho de banda de las subidas y cambio pendiente del fin de la bajada en curso. */
+static float    s_ulBwKHz       = LORA_BW_KHZ;
+static float    s_pendingUlBw   = 0.0f;
+/** Ciclo de CPU en que saltó la ISR (sólo con perfilado, HOT_PROFILE). */
+static volatile uint32_t s_rxIsrCycles = 0;
+/** Instante (µs) de la ISR: fin de la recepción (`tmst` del reenvío). */
+static volatile uint32_t s_rxIsrUs = 0;
+/** Destino de cada trama recibida (reenvío; nullptr = ninguno). */
+static void (*s_rxHook)(const LoraRxFrame& frame) = nullptr;
+/** Comando en el aire (DIO1 indica fin de TX en lugar de paquete recibido). */
+static bool     s_cmdTxActive  = false;
+static uint8_t  s_cmdSeq       = 0;
+static uint32_t s_cmdNextMs    = 0;     // siguiente envío permitido (duty-cycle)
+/** Ajuste de escucha del collar (el preámbulo se dimensiona para él). */
+static uint8_t  s_collarPreset = WOR_SNIFF_PRESET;
+static int16_t  s_pendingPreset = -1;   // se aplica cuando termina el envío de SET_SNIFF
+/** Tipo de la bajada en curso (para la métrica al terminar). */
+enum DownlinkKind : uint8_t { DL_COMMAND, DL_AIDING, DL_FENCE };
+static DownlinkKind s_dlKind   = DL_COMMAND;
+static uint32_t s_lastCmdMs    = 0;
+/** Frecuencia de trabajo e instante (ms) de la última posición aceptada. */
+static float    s_freqMHz      = 868.0f;
+static uint32_t s_lastRxMs     = 0;
+/** Última trama de salud del collar e instante (ms) de llegada (0 = ninguna). */
+static HealthFrame s_lastHealth{};
+static uint32_t    s_lastHealthMs = 0;
+/** Última alerta de valla e instante (ms) de llegada (0 = ninguna). */
+static GeoAlert    s_lastGeo{};
+static uint32_t    s_lastGeoMs = 0;
+// Muestras de RSSI instantáneo por visita de canal y separación entre ellas
+#if defined(REPLAY_MODE)
+/** Trama grabada pendiente de LORA_rxTick() (sustituye a la de la radio). */
+static bool    s_injected = false;
+static uint8_t s_injBuf[LORA_MAX_READ];
+static size_t  s_injLen   = 0;
+static float   s_injRssi  = 0.0f, s_injSnr = 0.0f, s_injFreqErr = 0.0f;
+METRIC_COUNTER(m_rxReplayIgnored, "lora_rx_replay_ignored_total", "Tramas de la radio descartadas en modo reproducción");
+#endif
+
+METRIC_COUNTER_L(m_probeYieldBusy,  "lora_probe_yield_total", "Visitas de sondeo cedidas a una trama", "reason=\"busy\"");
+METRIC_COUNTER_L(m_probeYieldRx,    "lora_probe_yield_total", "Visitas de sondeo cedidas a una trama", "reason=\"aborted\"");
+
+/** IRQ de trama en curso: habilitados en el SX126x pero sin llevarlos a DIO1. */
+static const uint32_t LORA_RX_ACTIVITY_IRQ = RADIOLIB_SX126X_IRQ_PREAMBLE_DETECTED | RADIOLIB_SX126X_IRQ_HEADER_VALID;
 
 // En ESP8266/ESP32 se fija el atributo de ISR; en RP2040 no es necesario.
 #if defined(ESP8266) || defined(ESP32)
   ICACHE_RAM_ATTR
 #endif
-static void onPacketISR() {
+static void HOT_FUNC(onPacketISR)() {
+  HOT_PROF_SCOPE(HOT_SLOT_LORA_ISR);
+  s_rxIsrCycles = HOT_CYCLES();
+  s_rxIsrUs = micros();
   s_rxFlag = true;
 }
 
+/**
+ * \brief Recepción continua; sólo RX_DONE va a DIO1, pero quedan habilitados
+ *        los IRQ de preámbulo y cabecera para LORA_probeChannel().
+ */
+static int16_t startRx() {
+  return radio.startReceive(RADIOLIB_SX126X_RX_TIMEOUT_INF,
+                            RADIOLIB_IRQ_RX_DEFAULT_FLAGS | (1UL << RADIOLIB_IRQ_PREAMBLE_DETECTED) |
+                              (1UL << RADIOLIB_IRQ_HEADER_VALID),
+                            RADIOLIB_IRQ_RX_DEFAULT_MASK, 0);
+}
+
+/**
+ * \brief Ancho de banda \p kHz con su SF (WOR_uplinkSF()): SF8 en el estrecho (radio en reposo).
+ */
+static bool useModulation(float kHz) {
+  return radio.setBandwidth(kHz) == RADIOLIB_ERR_NONE &&
+         radio.setSpreadingFactor(WOR_uplinkSF(kHz)) == RADIOLIB_ERR_NONE;
+}
+
 /**
  * \brief Inicializa el SX1262 con la configuración LoRa indicada.
  */
@@ -66,8 +174,10 @@ bool LORA_begin(float freqMHz) {
 
   // begin(freq, BW[kHz], SF, CR, syncWord, power[dBm], preamble, tcxo, useRegLDO=false)
   // Ajustes: BW=125 kHz, SF=9, CR=4/7, syncWord=0x12 (privado), 14 dBm, preámbulo 8
-  int st = radio.begin(freqMHz, 125.0, 9, 7, 0x12, 14, 8, 0, false);
+  int st = radio.begin(freqMHz, LORA_BW_KHZ, LORA_SF, LORA_CR_DEN, LORA_SYNC_WORD, 14, 8, 0, false);
   if (st != RADIOLIB_ERR_NONE) return false;
+  s_freqMHz = freqMHz;
+  PRB_begin();
 
   // Control de RF switch (enable RX/TX)
   radio.setRfSwitchPins(LORA_RX_ENABLE, LORA_TX_ENABLE);
@@ -81,45 +191,156 @@ bool LORA_begin(float freqMHz) {
  */
 bool LORA_startRx() {
   radio.setPacketReceivedAction(onPacketISR);
-  return radio.startReceive() == RADIOLIB_ERR_NONE;
+  m_ulBw.set(s_ulBwKHz);
+  return startRx() == RADIOLIB_ERR_NONE;
 }
 
 /**
  * \brief Debe llamarse con frecuencia desde loop() para procesar paquetes.
  */
-void LORA_rxTick() {
+void HOT_FUNC(LORA_rxTick)() {
   // Salida rápida si no hay evento de recepción
   if (!s_rxFlag) return;
 
+  // Fin de un comando: vuelve al preámbulo normal y a recepción continua
+  if (s_cmdTxActive) {
+    s_rxFlag = false;
+    s_cmdTxActive = false;
+    radio.finishTransmit();
+    radio.setPreambleLength(LORA_PREAMBLE);
+    if (s_pendingPreset >= 0) {
+      s_collarPreset  = (uint8_t)s_pendingPreset;
+      s_pendingPreset = -1;
+    }
+    if (s_pendingUlBw > 0.0f) {
+      s_ulBwKHz     = s_pendingUlBw;
+      s_pendingUlBw = 0.0f;
+      m_ulBw.set(s_ulBwKHz);
+    }
+    if (s_ulBwKHz != LORA_BW_KHZ) useModulation(s_ulBwKHz);
+    if (s_dlKind == DL_AIDING)     m_aidTx.inc();
+    else if (s_dlKind == DL_FENCE) m_fenceTx.inc();
+    else                           m_cmdTx.inc();
+    startRx();
+    return;
+  }
+  HOT_record(HOT_SLOT_ISR_SERVICE, HOT_CYCLES() - s_rxIsrCycles);
+  HOT_PROF_SCOPE(HOT_SLOT_RX_TICK);
+
   // Clear del flag (race mínimo; suficiente para este caso)
   s_rxFlag = false;
 
-  // Determina longitud de paquete
-  int16_t len = radio.getPacketLength();
-  if (len <= 0) len = LORA_MAX_READ;
-  if (len > LORA_MAX_READ) len = LORA_MAX_READ;
-
+  size_t len;
   uint8_t buf[LORA_MAX_READ];
-  int st = radio.readData(buf, len);
+  int st;
+#if defined(REPLAY_MODE)
+  // Sólo cuentan las tramas grabadas: lo que llegue por la radio se descarta
+  if (!s_injected) {
+    startRx();
+    m_rxReplayIgnored.inc();
+    return;
+  }
+  s_injected = false;
+  len = s_injLen;
+  memcpy(buf, s_injBuf, len);
+  st = RADIOLIB_ERR_NONE;
+#else
+  // Determina longitud de paquete (saneada: no se confía en el valor del registro)
+  len = RX_clampLength((int32_t)radio.getPacketLength(), LORA_MAX_READ);
+  st  = (len > 0) ? radio.readData(buf, len) : RADIOLIB_ERR_PACKET_TOO_LONG;
+#endif
 
   if (st == RADIOLIB_ERR_NONE) {
     // Métricas del paquete actual
+#if defined(REPLAY_MODE)
+    s_lastRssi    = s_injRssi;
+    s_lastSnr     = s_injSnr;
+    s_lastFreqErr = s_injFreqErr;
+#else
     s_lastRssi = radio.getRSSI();  // dBm
     s_lastSnr  = radio.getSNR();   // dB
+    s_lastFreqErr = radio.getFrequencyError();
+#endif
+#if defined(REPLAY_RECORD)
+    RplFrame rec;
+    rec.rssi = s_lastRssi; rec.snr = s_lastSnr; rec.freqErrHz = s_lastFreqErr;
+    rec.len  = len;
+    memcpy(rec.data, buf, len);
+    char line[RPL_MAX_LINE];
+    if (RPL_formatFrame(millis(), rec, line, sizeof(line))) {
+      Serial.print("RPL ");
+      Serial.println(line);
+    }
+#endif
+    m_rxRssi.observe(s_lastRssi);
+    m_rxSnr.set(s_lastSnr);
+    m_rxFreqErr.set(s_lastFreqErr);
+
+    // Reenvío: copia de tamaño fijo a su cola, no retrasa el rearme de la recepción
+    if (s_rxHook) s_rxHook(LoraRxFrame{buf, len, s_lastRssi, s_lastSnr, s_lastFreqErr, s_rxIsrUs});
 
-    // Filtra sólo el payload GNSS de 13B con fix=1
-    if (len == 13 && buf[0] == 1) {
-      GpsInfo gi{};
-      if (GPS_parsePayload(buf, 13, gi) && gi.valid) {
-        s_lastGps = gi;
-      }
-      // Si falla parse, preserva s_lastGps anterior
+    // Sólo el payload GNSS de 13B con fix=1 actualiza la última estampa;
+    // otros tamaños/formatos se ignoran sin tocar s_lastGps
+    GpsInfo gi{};
+    HealthFrame hf;
+    GeoAlert ga;
+    RxResult r = RX_decodeFrame(buf, len, gi, &hf, &ga);
+    if (r == RX_POSITION) {
+      s_lastGps = gi;
+      s_lastRxMs = millis();
+      m_rxAccepted.inc();
+    } else if (r == RX_GEO_ALERT) {
+      // La alerta lleva la posición del cruce: cuenta también como posición
+      s_lastGeo   = ga;
+      s_lastGeoMs = millis();
+      s_lastGps   = ga.fix;
+      s_lastRxMs  = s_lastGeoMs;
+      m_rxGeo.inc();
+    } else if (r == RX_HEALTH) {
+      s_lastHealth   = hf;
+      s_lastHealthMs = millis();
+      m_rxHealth.inc();
+    } else {
+      m_rxRejected.inc();
     }
-    // Otros tamaños/formatos se ignoran sin tocar s_lastGps
+    // Sólo las tramas del collar cuentan para su error de frecuencia
+    if (r != RX_BAD_LENGTH && r != RX_BAD_FORMAT) {
+      s_collarFreqErr = s_lastFreqErr;
+      s_collarSnr     = s_lastSnr;
+      s_collarFreqMs  = millis();
+    }
+  } else {
+    m_rxError.inc();
   }
 
   // Rearma la recepción continuamente
-  radio.startReceive();
+  startRx();
+}
+
+#if defined(REPLAY_MODE)
+/**
+ * \brief Deja una trama grabada para LORA_rxTick(), como si acabara de recibirse.
+ */
+bool LORA_injectFrame(const uint8_t* data, size_t len, float rssi, float snr, float freqErrHz) {
+  if (s_rxFlag || s_cmdTxActive || len == 0 || len > LORA_MAX_READ) return false;
+  memcpy(s_injBuf, data, len);
+  s_injLen      = len;
+  s_injRssi     = rssi;
+  s_injSnr      = snr;
+  s_injFreqErr  = freqErrHz;
+  s_injected    = true;
+  s_rxIsrCycles = HOT_CYCLES();   // la inyección hace de ISR
+  s_rxIsrUs     = micros();
+  s_rxFlag      = true;
+  return true;
+}
+#endif
+
+/**
+ * \brief Gancho que recibe cada trama leída sin error.
+ */
+void LORA_setRxHook(void (*hook)(const LoraRxFrame& frame)) {
+  s_rxHook = hook;
 }
 
 /**
@@ -132,3 +353,217 @@ bool LORA_lastValidGPS(GpsInfo& out, float* rssi_dBm, float* snr_dB) {
   if (snr_dB)   *snr_dB   = s_lastSnr;
   return true;
 }
+
+/**
+ * \brief Última trama de salud y su instante de llegada.
+ */
+bool LORA_lastHealth(HealthFrame& out, uint32_t* rxMs) {
+  if (s_lastHealthMs == 0) return false;
+  out = s_lastHealth;
+  if (rxMs) *rxMs = s_lastHealthMs;
+  return true;
+}
+
+/**
+ * \brief Error de frecuencia de la última trama aceptada del collar.
+ */
+bool LORA_lastFreqError(float& errHz, float& snrDb, uint32_t& rxMs) {
+  if (s_collarFreqMs == 0) return false;
+  errHz = s_collarFreqErr;
+  snrDb = s_collarSnr;
+  rxMs  = s_collarFreqMs;
+  return true;
+}
+
+/**
+ * \brief Ancho de banda de recepción: inmediato en recepción, al terminar si hay bajada.
+ */
+bool LORA_setUplinkBandwidth(float kHz) {
+  if (kHz != LORA_BW_KHZ && kHz != WOR_NARROW_BW_KHZ) return false;
+  if (s_cmdTxActive) {
+    s_pendingUlBw = kHz;
+    return true;
+  }
+  if (kHz == s_ulBwKHz) return true;
+  radio.standby();
+  bool ok = useModulation(kHz);
+  if (!ok) useModulation(s_ulBwKHz);
+  if (ok) s_ulBwKHz = kHz;
+  s_rxFlag = false;
+  startRx();
+  m_ulBw.set(s_ulBwKHz);
+  return ok;
+}
+
+float LORA_uplinkBandwidth() {
+  return s_ulBwKHz;
+}
+
+/**
+ * \brief Última alerta de valla y su instante de llegada.
+ */
+bool LORA_lastGeoAlert(GeoAlert& out, uint32_t* rxMs) {
+  if (s_lastGeoMs == 0) return false;
+  out = s_lastGeo;
+  if (rxMs) *rxMs = s_lastGeoMs;
+  return true;
+}
+
+/**
+ * \brief Lanza una trama de bajada con un preámbulo que cubre el ciclo de escucha del collar.
+ * \details Asíncrono: LORA_rxTick() detecta el fin y vuelve a recepción. Durante
+ *          el envío (hasta ~2 s) no se reciben posiciones.
+ */
+static bool startDownlink(const uint8_t* buf, size_t len) {
+  uint16_t preamble = WOR_preambleSymbols(s_collarPreset);
+  radio.standby();
+  if (s_ulBwKHz != LORA_BW_KHZ) useModulation(LORA_BW_KHZ);   // el collar escucha a SF9/125 kHz
+  radio.setPreambleLength(preamble);
+  s_rxFlag = false;
+  if (radio.startTransmit(buf, len) != RADIOLIB_ERR_NONE) {
+    radio.setPreambleLength(LORA_PREAMBLE);
+    if (s_ulBwKHz != LORA_BW_KHZ) useModulation(s_ulBwKHz);
+    startRx();
+    return false;
+  }
+  s_cmdTxActive = true;
+  s_dlKind      = DL_COMMAND;
+  s_lastCmdMs   = millis();
+
+  // Tiempo de silencio obligatorio tras la emisión: T_aire · (1/DC − 1)
+  float airMs = WOR_airtimeMs(len, preamble);
+  s_cmdNextMs = millis() + (uint32_t)(airMs / LORA_DUTY_CYCLE);
+  return true;
+}
+
+/**
+ * \brief Serializa el comando y lo envía como trama de bajada.
+ */
+bool LORA_sendCommand(WorCmd cmd, uint16_t param, uint8_t* seqOut) {
+  if (LORA_commandWaitMs() > 0) return false;
+
+  WorCommand wc = {cmd, ++s_cmdSeq, param};
+  uint8_t buf[WOR_FRAME_LEN];
+  size_t len = WOR_buildCommand(wc, buf, sizeof(buf));
+  if (!startDownlink(buf, len)) return false;
+
+  if (cmd == WOR_CMD_SET_SNIFF && param < WOR_presetCount()) s_pendingPreset = (int16_t)param;
+  if (cmd == WOR_CMD_SET_UL_BW) s_pendingUlBw = param ? WOR_NARROW_BW_KHZ : (float)LORA_BW_KHZ;
+  if (seqOut) *seqOut = wc.seq;
+  return true;
+}
+
+/**
+ * \brief Serializa la asistencia y la envía como trama de bajada.
+ */
+bool LORA_sendAiding(const AidData& aid) {
+  if (LORA_commandWaitMs() > 0) return false;
+
+  uint8_t buf[AID_FRAME_LEN];
+  size_t len = AID_buildFrame(aid, buf, sizeof(buf));
+  if (!len || !startDownlink(buf, len)) return false;
+  s_dlKind = DL_AIDING;
+  return true;
+}
+
+/**
+ * \brief Serializa la valla y la envía como trama de bajada.
+ */
+bool LORA_sendFence(const GeoFence& fence) {
+  if (LORA_commandWaitMs() > 0) return false;
+
+  uint8_t buf[GEO_FENCE_MAX_LEN];
+  size_t len = GEO_buildFence(fence, buf, sizeof(buf));
+  if (!len || !startDownlink(buf, len)) return false;
+  s_dlKind = DL_FENCE;
+  return true;
+}
+
+/**
+ * \brief Tiempo hasta poder enviar otro comando (envío en curso o duty-cycle).
+ */
+uint32_t LORA_commandWaitMs() {
+  int32_t left = (int32_t)(s_cmdNextMs - millis());
+  if (left > 0) return (uint32_t)left;
+  return s_cmdTxActive ? 1 : 0;
+}
+
+/**
+ * \brief Ajuste de escucha que la base supone en el collar.
+ */
+uint8_t LORA_collarSniffPreset() {
+  return s_collarPreset;
+}
+
+/**
+ * \brief Instante (millis) de la última posición aceptada (0 = ninguna).
+ */
+uint32_t LORA_lastRxMs() {
+  return s_lastRxMs;
+}
+
+/**
+ * \brief Instante (millis) del último comando enviado (0 = ninguno).
+ */
+uint32_t LORA_lastCommandMs() {
+  return s_lastCmdMs;
+}
+
+/**
+ * \brief Frecuencia de trabajo (MHz).
+ */
+float LORA_frequency() {
+  return s_freqMHz;
+}
+
+// ----------------- Sondeo de canal -----------------------
+static bool  prbActivity()      { return (radio.getIrqFlags() & LORA_RX_ACTIVITY_IRQ) != 0; }
+static void  prbClearActivity() { radio.clearIrqFlags(LORA_RX_ACTIVITY_IRQ); }
+static bool  prbPending()       { return s_rxFlag; }
+static float prbRssi()          { return radio.getRSSI(false); }
+static void  prbDelayUs(uint32_t us) { delayMicroseconds(us); }
+
+/**
+ * \brief Standby, frecuencia y recepción. Fuera del canal de trabajo la ISR se
+ *        desengancha: lo que se reciba ahí no es del collar y no debe levantar s_rxFlag.
+ */
+static bool prbTune(float freqMHz) {
+  radio.standby();
+  if (freqMHz == s_freqMHz) radio.setPacketReceivedAction(onPacketISR);
+  else                      radio.clearPacketReceivedAction();
+  return radio.setFrequency(freqMHz) == RADIOLIB_ERR_NONE && startRx() == RADIOLIB_ERR_NONE;
+}
+
+/**
+ * \brief CAD con la ISR desenganchada: su fin (DIO1) no se confunde con una trama.
+ */
+static int8_t prbCad() {
+  radio.clearPacketReceivedAction();
+  int16_t st = radio.scanChannel();
+  radio.setPacketReceivedAction(onPacketISR);
+  if (st == RADIOLIB_LORA_DETECTED) return 1;
+  if (st == RADIOLIB_CHANNEL_FREE)  return 0;
+  return -1;
+}
+
+static const ProbeRadio PROBE_RADIO = {prbActivity, prbClearActivity, prbPending, prbTune,
+                                       prbRssi, prbCad, prbDelayUs};
+
+/**
+ * \brief Visita un canal: RSSI instantáneo (mediana de 8 muestras) y CAD.
+ * \details La secuencia está en channel_probe: cede el turno si entra una trama
+ *          y nunca borra s_rxFlag. Duración típica ~20 ms a SF9.
+ */
+bool LORA_probeChannel(float freqMHz, float* rssiDbm, bool* busy) {
+  if (s_cmdTxActive) return false;               // envío en curso
+
+  float rssi = 0.0f;
+  bool  cad  = false;
+  ProbeResult r = PRB_visit(PROBE_RADIO, s_freqMHz, freqMHz, millis(), rssi, cad);
+  if (r == PRB_SKIPPED_BUSY) m_probeYieldBusy.inc();
+  else if (r == PRB_ABORTED_RX) m_probeYieldRx.inc();
+  if (r != PRB_DONE) return false;
+  if (rssiDbm) *rssiDbm = rssi;
+  if (busy) *busy = cad;
+  return true;
+}
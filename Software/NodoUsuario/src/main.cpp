@@ -2,10 +2,41 @@
  * @brief Programa principal del nodo de usuario (receptor LoRa).
  *
  * Implementa el flujo principal del nodo receptor:
- * - Inicializa los periféricos: LCD, WiFi, servidor web y módulo LoRa.
+ * - Inicializa los periféricos: LoRa primero (recibe durante el resto del
+ *   arranque), LCD, WiFi y servidor web; la duración de cada fase se registra
+ *   con boot_timeline y se vuelca al terminar setup().
  * - Recibe los payloads GNSS del nodo mascota vía LoRa.
  * - Decodifica las coordenadas y las muestra en la interfaz web.
  * - Gestiona la conectividad WiFi y el portal de configuración.
+ * - Con receptor GNSS propio, envía al collar hora y posición aproximadas
+ *   (asistencia GNSS) cuando deja de recibir posiciones y corrige las
+ *   posiciones del collar con su propio error (dgnss).
+ * - Supervisa la latencia de cada tarea de loop() con un watchdog hardware
+ *   (supervisor); los bloqueos quedan en `/stall.log`.
+ * - Guarda las últimas tramas de salud del collar (health_frame) y las expone
+ *   en `/health` y como gauges `collar_*` en `/metrics`.
+ * - Aprende dónde y a qué velocidad suele moverse la mascota a cada hora y
+ *   marca las posiciones fuera de lo habitual al recibirlas (movement_model);
+ *   lo aprendido se guarda en `/movement.bin` y las alertas salen en
+ *   `/anomalies`.
+ * - Envía al collar la valla de casa (`/fence`, guardada en `/fence.bin`); el
+ *   collar la evalúa en cada fix y avisa enseguida al salir y al volver
+ *   (geofence).
+ * - Sigue el error de frecuencia del collar en cada trama, le envía
+ *   correcciones y, si se pide con `/cmd?c=bw&v=62`, recibe sus subidas a
+ *   SF8/62,5 kHz mientras el error lo permita (freq_track).
+ * - Evalúa en cada posición del collar y cada segundo las reglas de alerta
+ *   escritas en `/rules` (guardadas en `/rules.txt`), compiladas a bytecode
+ *   (rule_engine).
+ * - Difunde cada posición aceptada del collar en la LAN como un datagrama
+ *   UDP multicast con número de secuencia (live_feed), sin coste por oyente.
+ * - Comprime con gzip las respuestas dinámicas grandes (`/metrics`, `/health`,
+ *   `/anomalies`, páginas generadas) si el navegador lo acepta (http_gzip).
+ * - Con `-DREPLAY_MODE` recibe las tramas de una traza grabada en
+ *   `/replay_rx.txt` con sus tiempos, en lugar de las de la radio, para medir
+ *   CPU y latencias con la misma carga en cada versión (replay_trace).
+ * - Con `-DPKT_FWD_MODE` reenvía además cada trama recibida a un servidor de
+ *   red o backend por el protocolo UDP de Semtech (pkt_forwarder).
  *
  * Este firmware actúa como interfaz de usuario, mostrando la ubicación
  * recibida y ofreciendo opciones de configuración a través del navegador.
@@ -18,6 +49,7 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <LittleFS.h>
+#include <WiFiUdp.h>
 #include "hardware/watchdog.h"
 
 #include "wifi_manager.h"
@@ -25,6 +57,25 @@
 #include "html_pages.h"
 #include "lora_handler.h"
 #include "gps_handler.h"
+#include "hot_path.h"
+#include "wifi_power.h"
+#include "metrics.h"
+#include "channel_survey.h"
+#include "boot_timeline.h"
+#include "supervisor.h"
+#include "dgnss.h"
+#include "movement_model.h"
+#include "http_gzip.h"
+#include "geofence.h"
+#include "freq_track.h"
+#include "rule_engine.h"
+#include "live_feed.h"
+#if defined(PKT_FWD_MODE)
+  #include "pkt_forwarder.h"
+#endif
+#if defined(REPLAY_MODE)
+  #include "replay_trace.h"
+#endif
 
 #define CONFIG_FILE "/wifi.config"
 
@@ -32,25 +83,701 @@ WebServer server(80);
 bool pendingReset = false;
 unsigned long pendingResetTime = 0;
 static const float FREQ_LORA = 868.0;
+/** Latencia añadida máxima por el ahorro WiFi con clientes activos (ms). */
+static const uint16_t WIFI_LATENCY_BUDGET_MS = 150;
+/** Receptor GNSS de la base (asistencia al collar). */
+static const uint32_t GPS_BAUD = 9600;
+/**
+ * Silencio del collar que se interpreta como adquisición en curso: AID_SILENCE_PERIODS
+ * periodos medidos (SURVEY_periodMs(); en las horas tranquilas el collar envía
+ * cada 60-300 s) y nunca menos de AID_SILENCE_MS.
+ */
+static const uint32_t AID_SILENCE_MS      = 60000UL;
+static const uint8_t  AID_SILENCE_PERIODS = 3;
+/** Separación mínima entre asistencias automáticas (ms). */
+static const uint32_t AID_MIN_GAP_MS = 300000UL;
 
-void setup() {
+METRIC_COUNTER(m_httpRequests, "http_requests_total", "Peticiones HTTP atendidas");
+METRIC_HISTOGRAM(m_httpDuration, "http_request_duration_ms", "Tiempo en el manejador HTTP (ms)",
+                 1, 5, 20, 100, 500, 2000);
+METRIC_COUNTER_L(m_gzipIn,  "http_gzip_bytes_total", "Bytes de respuestas dinámicas comprimidas con gzip", "stage=\"in\"");
+METRIC_COUNTER_L(m_gzipOut, "http_gzip_bytes_total", "Bytes de respuestas dinámicas comprimidas con gzip", "stage=\"out\"");
+METRIC_COUNTER_L(m_dgpsCorrected,   "dgps_fixes_total", "Posiciones del collar por corrección diferencial", "result=\"corrected\"");
+METRIC_COUNTER_L(m_dgpsUncorrected, "dgps_fixes_total", "Posiciones del collar por corrección diferencial", "result=\"uncorrected\"");
+METRIC_GAUGE(m_dgpsBaseError, "dgps_base_error_m", "Error de posición de la base frente a su referencia (m)");
+METRIC_GAUGE(m_dgpsSurvey, "dgps_survey_samples", "Fixes promediados para la referencia de la base (survey-in)");
+
+/** Espera máxima al error de la base de la misma época antes de dar la posición sin corregir. */
+static const uint32_t DGPS_WAIT_MS = 2500;
+
+// ----------------- Salud del collar -----------------
+METRIC_COUNTER_L(m_movLocation, "movement_anomalies_total", "Posiciones del collar marcadas como anómalas", "kind=\"location\"");
+METRIC_COUNTER_L(m_movSpeed,    "movement_anomalies_total", "Posiciones del collar marcadas como anómalas", "kind=\"speed\"");
+METRIC_GAUGE(m_movHourSamples, "movement_hour_samples", "Fixes aprendidos para la hora UTC actual");
+METRIC_COUNTER_L(m_geoBreach, "geofence_alerts_total", "Alertas de valla recibidas del collar", "state=\"breach\"");
+METRIC_COUNTER_L(m_geoReturn, "geofence_alerts_total", "Alertas de valla recibidas del collar", "state=\"return\"");
+METRIC_GAUGE(m_freqErr, "collar_freq_error_hz", "Error de frecuencia filtrado del collar frente a la base (Hz)");
+METRIC_GAUGE(m_freqStd, "collar_freq_error_std_hz", "Desviación típica del error de frecuencia del collar (Hz)");
+METRIC_COUNTER(m_freqCorr, "collar_freq_corrections_total", "Correcciones de frecuencia enviadas al collar");
+METRIC_COUNTER(m_narrowFallback, "lora_narrow_fallbacks_total", "Vueltas a 125 kHz por silencio o error excesivo");
+METRIC_COUNTER(m_ruleAlerts, "rule_alerts_total", "Avisos de las reglas de alerta");
+METRIC_HISTOGRAM(m_ruleEvalUs, "rule_eval_us", "Tiempo en evaluar todas las reglas (us)",
+                 10, 20, 50, 100, 200, 500);
+METRIC_COUNTER_L(m_feedSent,   "feed_datagrams_total", "Posiciones difundidas por UDP multicast", "result=\"sent\"");
+METRIC_COUNTER_L(m_feedFailed, "feed_datagrams_total", "Posiciones difundidas por UDP multicast", "result=\"failed\"");
+METRIC_GAUGE(m_colUptime,   "collar_uptime_minutes", "Minutos desde el arranque del collar (última trama de salud)");
+METRIC_GAUGE(m_colResets,   "collar_boot_count", "Arranques registrados por el collar (módulo 256)");
+METRIC_GAUGE(m_colReason,   "collar_reset_reason", "Causa del último reinicio (0 power_on, 1 watchdog, 2 software, 3 otra)");
+METRIC_GAUGE(m_colTemp,     "collar_temperature_celsius", "Temperatura del die del RP2040 del collar (°C)");
+METRIC_GAUGE(m_colTtffLast, "collar_ttff_last_seconds", "Último tiempo hasta el fix del collar (s)");
+METRIC_GAUGE(m_colTtffP90,  "collar_ttff_p90_seconds", "p90 del tiempo hasta el fix del collar (s)");
+METRIC_GAUGE(m_colTxFail,   "collar_tx_failures", "Transmisiones fallidas del collar desde su arranque (módulo 256)");
+METRIC_GAUGE(m_colTxError,  "collar_last_tx_error", "Último código de error RadioLib de TX en el collar");
+METRIC_GAUGE(m_colLoopMax,  "collar_loop_max_ms", "loop() más lento del collar en el último intervalo (ms)");
+METRIC_GAUGE(m_colGpsHwm,   "collar_gps_rx_hwm_bytes", "Máximo de bytes pendientes en el UART GNSS del collar");
+METRIC_GAUGE(m_colHeapMin,  "collar_heap_min_free_kb", "Mínimo de heap libre del collar (KiB)");
+METRIC_COUNTER(m_colLost,   "collar_health_frames_lost_total", "Tramas de salud perdidas (huecos en la secuencia)");
+
+/** Tramas de salud guardadas en RAM para `/health` (la más antigua se descarta). */
+static const uint8_t HEALTH_HISTORY = 16;
+
+struct HealthEntry {
+  uint32_t    rxMs;
+  HealthFrame frame;
+};
+static HealthEntry s_health[HEALTH_HISTORY];
+static uint8_t     s_healthHead  = 0;
+static uint8_t     s_healthCount = 0;
+
+/** Modelo de movimiento en LittleFS y fixes entre guardados (desgaste de la flash). */
+static const char*    MOVEMENT_FILE       = "/movement.bin";
+static const uint16_t MOVEMENT_SAVE_FIXES = 60;
+/** Alertas guardadas en RAM para `/anomalies`. */
+static const uint8_t  ANOMALY_HISTORY     = 16;
+
+struct AnomalyEntry {
+  uint32_t rxMs;
+  GpsInfo  fix;
+  MovScore score;
+};
+static AnomalyEntry s_anomalies[ANOMALY_HISTORY];
+static uint8_t      s_anomalyHead  = 0;
+static uint8_t      s_anomalyCount = 0;
+
+/** Valla de casa en LittleFS (la propia trama de bajada) y envío pendiente al collar. */
+static const char* FENCE_FILE     = "/fence.bin";
+static GeoFence    s_fence{};
+static bool        s_fenceSend    = false;
+/** Estado según la última alerta del collar. */
+static bool        s_geoOutside   = false;
+
+/** Subidas a 62,5 kHz pedidas por el usuario y orden de volver a 125 kHz pendiente. */
+static bool        s_narrowWanted = false;
+static bool        s_wideNeeded   = false;
+/** Periodo más largo que se puede pedir al collar (dos envíos al día). */
+static const uint16_t COLLAR_PERIOD_MAX_S   = 43200;
+/** Subidas perdidas a 62,5 kHz (según el intervalo medido) antes de volver a 125 kHz. */
+static const uint8_t  NARROW_SILENCE_FRAMES = 12;
+static const uint32_t NARROW_SILENCE_MIN_MS = 120000UL;
+
+/** Reglas de alerta en LittleFS, separación entre evaluaciones sin fix nuevo y datos del último fix. */
+static const char*    RULES_FILE     = "/rules.txt";
+static const size_t   RULES_MAX_SRC  = 4096;
+static const uint32_t RULES_PERIOD_MS = 1000;
+static uint32_t s_fixMs      = 0;   // 0 = sin posición del collar
+static GpsInfo  s_fix{};
+static float    s_fixRssi    = NAN, s_fixSnr = NAN;
+static MovScore s_fixScore{0, 0, -1.0f, -1.0f, -1.0f};
+
+/** Difusión multicast de las posiciones: socket, secuencia y arranque (aleatorio). */
+static WiFiUDP  s_feedUdp;
+static uint32_t s_feedSeq  = 0;
+static uint16_t s_feedBoot = 0;
+
+/**
+ * \brief Registra una ruta anotando la actividad HTTP antes de atenderla.
+ * \details Punto único para el gestor de energía WiFi (WPM_noteRequest()) y las
+ *          métricas HTTP (nº de peticiones y duración del manejador).
+ */
+static void route(const char* uri, HTTPMethod method, std::function<void()> handler) {
+  server.on(uri, method, [handler]() {
+    uint32_t t0 = millis();
+    WPM_noteRequest();
+    m_httpRequests.inc();
+    handler();
+    m_httpDuration.observe((float)(millis() - t0));
+  });
+}
+
+/** Buffer de salida de /metrics: agrupa líneas en trozos HTTP de hasta 512 B. */
+struct MetricsChunk {
+  char   buf[512];
+  size_t len;
+};
+
+/** Compresor de respuestas (el WebServer atiende un cliente cada vez: basta uno). */
+static GzStream s_gz;
+
+/**
+ * \brief Sumidero del compresor: cada trozo comprimido sale como un trozo HTTP.
+ */
+static void gzipSink(const char* data, size_t len, void*) {
+  server.sendContent(data, len);
+}
+
+/**
+ * \brief true si el cliente acepta gzip y \p len (0 = desconocido) lo justifica.
+ */
+static bool wantsGzip(size_t len) {
+  return GZ_worthIt(server.header("Accept-Encoding").c_str(), len);
+}
+
+/**
+ * \brief Cabeceras de una respuesta comprimida en streaming; luego GZ_write() y endGzip().
+ */
+static void beginGzip(int code, const char* type) {
+  server.sendHeader("Content-Encoding", "gzip");
+  server.sendHeader("Vary", "Accept-Encoding");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(code, type, "");
+  GZ_begin(s_gz, gzipSink, nullptr);
+}
+
+static void endGzip() {
+  GZ_finish(s_gz);
+  server.sendContent("");
+  m_gzipIn.inc(s_gz.inBytes);
+  m_gzipOut.inc(s_gz.outBytes);
+}
+
+/**
+ * \brief Envía una respuesta generada, comprimida si el cliente y el tamaño lo permiten.
+ */
+static void sendDynamic(int code, const char* type, const String& body) {
+  if (!wantsGzip(body.length())) {
+    server.sendHeader("Vary", "Accept-Encoding");   // las cachés no deben servir esta a quien acepta gzip
+    server.send(code, type, body);
+    return;
+  }
+  beginGzip(code, type);
+  GZ_write(s_gz, body.c_str(), body.length());
+  endGzip();
+}
+
+/**
+ * \brief Sink de METRICS_render(): acumula y envía por trozos (chunked).
+ */
+static void metricsSink(const char* data, size_t len, void* ctx) {
+  MetricsChunk* c = static_cast<MetricsChunk*>(ctx);
+  if (c->len + len > sizeof(c->buf)) {
+    server.sendContent(c->buf, c->len);
+    c->len = 0;
+  }
+  memcpy(&c->buf[c->len], data, len);
+  c->len += len;
+}
+
+/**
+ * \brief Atiende la radio y anota el hito de la primera posición recibida.
+ * \details Se llama desde loop() y, durante el arranque, desde las esperas del
+ *          WiFi (WIFI_setIdleHook()), de modo que se recibe mientras se asocia.
+ */
+static void serviceRadio() {
+  SUP_SCOPE(SUP_TASK_RADIO);
+  LORA_rxTick();
+  GpsInfo gi;
+  if (LORA_lastValidGPS(gi, nullptr, nullptr) && BOOT_event("first_rx")) {
+    Serial.print("[BOOT] Primera RX a los ");
+    Serial.print(BOOT_eventMs("first_rx"));
+    Serial.println(" ms");
+  }
+}
+
+#if defined(REPLAY_MODE)
+/** Traza de tramas grabadas y el registro leído que espera su momento. */
+static const char* REPLAY_FILE = "/replay_rx.txt";
+static File        s_replay;
+static bool        s_replayPending = false;
+static uint32_t    s_replayT       = 0;
+static RplFrame    s_replayFrame;
+
+/**
+ * \brief Abre la traza y empieza la primera pasada.
+ */
+static void beginReplay() {
+  s_replay = LittleFS.open(REPLAY_FILE, "r");
+  if (!s_replay) {
+    Serial.print("[RPL] Sin traza "); Serial.println(REPLAY_FILE);
+    return;
+  }
+  Serial.print("[RPL] Reproduciendo "); Serial.print(REPLAY_FILE);
+  Serial.print(" ("); Serial.print((unsigned long)s_replay.size()); Serial.println(" B)");
+  RPL_begin(millis());
+}
+
+/**
+ * \brief Lee el siguiente registro válido; al final de la traza informa de la
+ *        pasada (retrasos y perfilado) y vuelve a empezar.
+ */
+static bool nextReplayRecord() {
+  char line[RPL_MAX_LINE];
+  for (uint8_t tries = 0; tries < 16; tries++) {   // acota el trabajo por loop()
+    if (!s_replay.available()) {
+      RplStats st = RPL_rewind(millis());
+      Serial.print("[RPL] Pasada "); Serial.print(st.passes);
+      Serial.print(": "); Serial.print(st.records);
+      Serial.print(" tramas, retraso max "); Serial.print(st.lateMaxMs);
+      Serial.print(" ms, medio "); Serial.print(st.records ? (float)st.lateSumMs / st.records : 0.0f, 1);
+      Serial.println(" ms");
+      HOT_report(Serial, true);
+      if (st.records == 0) {
+        Serial.println("[RPL] La traza no tiene tramas validas");
+        s_replay.close();
+        return false;
+      }
+      s_replay.seek(0);
+    }
+    size_t n = s_replay.readBytesUntil('\n', line, sizeof(line) - 1);
+    RplRecord rec;
+    if (RPL_parseLine(line, n, rec) && RPL_parseFrame(rec.text, rec.len, s_replayFrame)) {
+      s_replayT = rec.tMs;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Entrega a la ruta de recepción las tramas grabadas que ya tocan.
+ */
+static void serviceReplay() {
+  if (!s_replay) return;
+  if (!s_replayPending) s_replayPending = nextReplayRecord();
+  if (!s_replayPending || !RPL_due(s_replayT, millis())) return;
+  const RplFrame& f = s_replayFrame;
+  if (!LORA_injectFrame(f.data, f.len, f.rssi, f.snr, f.freqErrHz)) return;
+  RPL_delivered(s_replayT, millis());
+  s_replayPending = false;
+}
+#endif
+
+/**
+ * \brief Gancho de las esperas largas del WiFi: alimenta el watchdog y atiende la radio.
+ */
+static void idleService() {
+  SUP_feed();
+  serviceRadio();
+}
+
+/**
+ * \brief Última posición del collar, corregida con el error de la base si lo hay.
+ * \return true si hay posición; \p corrected indica si se aplicó la corrección.
+ */
+static bool collarFix(GpsInfo& out, bool* corrected, float* rssi, float* snr) {
+  GpsInfo raw;
+  if (!LORA_lastValidGPS(raw, rssi, snr) || !raw.valid) return false;
+  bool ok = DGPS_correct(raw, out);
+  if (corrected) *corrected = ok;
+  return true;
+}
+
+/**
+ * \brief Pasa los fixes nuevos de la base a la corrección diferencial.
+ */
+static void serviceDgps() {
+  static uint32_t lastBase = 0xFFFFFFFFUL;
+  if (!GPS_hasFix()) return;
+  GpsInfo base = GPS_getInfo();
+  if (base.hhmmss == lastBase) return;
+  lastBase = base.hhmmss;
+  DGPS_addBaseFix(base);
+  LCD_setBasePosition(base.lat, base.lon);
+  m_dgpsBaseError.set(DGPS_lastBaseErrorM());
+  m_dgpsSurvey.set((float)DGPS_surveySamples());
+}
+
+/**
+ * \brief Guarda cada trama de salud nueva, actualiza los gauges y avisa de reinicios.
+ */
+static void serviceHealth() {
+  static uint32_t seenMs = 0;
+  HealthFrame h;
+  uint32_t rxMs;
+  if (!LORA_lastHealth(h, &rxMs) || rxMs == seenMs) return;
+  seenMs = rxMs;
+
+  if (s_healthCount > 0) {
+    const HealthFrame& prev = s_health[(s_healthHead + HEALTH_HISTORY - 1) % HEALTH_HISTORY].frame;
+    bool rebooted = h.uptimeMin < prev.uptimeMin || h.resetCount != prev.resetCount;
+    if (rebooted) {
+      Serial.print("[HLT] El collar se ha reiniciado: ");
+      Serial.println(HLT_resetName(h.resetReason));
+    } else {
+      uint8_t gap = (uint8_t)(h.seq - prev.seq - 1);
+      if (gap) m_colLost.inc(gap);
+    }
+  }
+  s_health[s_healthHead] = {rxMs, h};
+  s_healthHead = (s_healthHead + 1) % HEALTH_HISTORY;
+  if (s_healthCount < HEALTH_HISTORY) s_healthCount++;
+
+  m_colUptime.set((float)h.uptimeMin);
+  m_colResets.set(h.resetCount);
+  m_colReason.set(h.resetReason);
+  m_colTemp.set(h.tempC);
+  m_colTtffLast.set(h.ttffLastS);
+  m_colTtffP90.set(h.ttffP90S);
+  m_colTxFail.set(h.txFailures);
+  m_colTxError.set(h.lastTxError);
+  m_colLoopMax.set(h.loopMaxMs);
+  m_colGpsHwm.set(h.gpsRxHwm);
+  m_colHeapMin.set(h.minFreeHeapKb);
+
+  Serial.print("[HLT] seq="); Serial.print(h.seq);
+  Serial.print(" uptime_min="); Serial.print(h.uptimeMin);
+  Serial.print(" temp="); Serial.print(h.tempC);
+  Serial.print("C tx_fallos="); Serial.print(h.txFailures);
+  Serial.print(" loop_max_ms="); Serial.println(h.loopMaxMs);
+}
+
+/**
+ * \brief Restaura el modelo de movimiento guardado (o empieza vacío).
+ */
+static void loadMovement() {
+  MOV_begin();
+  File f = LittleFS.open(MOVEMENT_FILE, "r");
+  if (!f) return;
+  uint8_t* buf = (uint8_t*)malloc(sizeof(MovState));
+  bool ok = buf && f.size() == sizeof(MovState) &&
+            (size_t)f.read(buf, sizeof(MovState)) == sizeof(MovState) &&
+            MOV_load(buf, sizeof(MovState));
+  free(buf);
+  f.close();
+  Serial.println(ok ? "[MOV] Modelo restaurado" : "[MOV] Modelo guardado no valido: se empieza de cero");
+}
+
+/**
+ * \brief Evalúa cada posición nueva del collar, anota las anómalas y guarda el modelo.
+ */
+static void serviceMovement(const GpsInfo& gi) {
+  static uint16_t sinceSave = 0;
+  MovScore sc = MOV_observe(gi);
+  s_fixScore = sc;
+  m_movHourSamples.set((float)MOV_hourSamples(sc.hour));
+
+  if (sc.flags) {
+    if (sc.flags & MOV_FLAG_LOCATION) m_movLocation.inc();
+    if (sc.flags & MOV_FLAG_SPEED) m_movSpeed.inc();
+    s_anomalies[s_anomalyHead] = {(uint32_t)millis(), gi, sc};
+    s_anomalyHead = (s_anomalyHead + 1) % ANOMALY_HISTORY;
+    if (s_anomalyCount < ANOMALY_HISTORY) s_anomalyCount++;
+    Serial.print("[MOV] Anomalia");
+    if (sc.flags & MOV_FLAG_LOCATION) { Serial.print(" zona="); Serial.print(sc.locFrac, 4); }
+    if (sc.flags & MOV_FLAG_SPEED) {
+      Serial.print(" velocidad="); Serial.print(sc.speedMps, 1);
+      Serial.print("m/s cola="); Serial.print(sc.speedTail, 4);
+    }
+    Serial.print(" hora="); Serial.println(sc.hour);
+  }
+
+  if (++sinceSave < MOVEMENT_SAVE_FIXES) return;
+  sinceSave = 0;
+  File f = LittleFS.open(MOVEMENT_FILE, "w");
+  if (!f) return;
+  f.write((const uint8_t*)&MOV_state(), sizeof(MovState));
+  f.close();
+}
+
+/**
+ * \brief Restaura la valla guardada y la deja pendiente de envío.
+ * \details El collar guarda su copia, pero reenviarla al arrancar la base
+ *          cubre una bajada perdida mientras se cambiaba.
+ */
+static void loadFence() {
+  File f = LittleFS.open(FENCE_FILE, "r");
+  if (!f) return;
+  uint8_t buf[GEO_FENCE_MAX_LEN];
+  size_t len = f.read(buf, sizeof(buf));
+  f.close();
+  if (!GEO_parseFence(buf, len, s_fence)) {
+    Serial.println("[GEO] Valla guardada no valida");
+    return;
+  }
+  s_fenceSend = s_fence.count > 0;
+}
+
+/**
+ * \brief Guarda la valla y la deja pendiente de envío al collar.
+ */
+static bool saveFence(const GeoFence& fence) {
+  uint8_t buf[GEO_FENCE_MAX_LEN];
+  size_t len = GEO_buildFence(fence, buf, sizeof(buf));
+  File f = LittleFS.open(FENCE_FILE, "w");
+  if (!len || !f) return false;
+  bool ok = f.write(buf, len) == len;
+  f.close();
+  s_fence      = fence;
+  s_fenceSend  = true;
+  s_geoOutside = false;
+  SURVEY_noteAlert(false);
+  return ok;
+}
+
+/**
+ * \brief Envía la valla pendiente en cuanto el duty-cycle lo permite y atiende
+ *        las alertas del collar.
+ */
+static void serviceFence() {
+  if (s_fenceSend && LORA_commandWaitMs() == 0 && LORA_sendFence(s_fence)) {
+    s_fenceSend = false;
+    Serial.print("[GEO] Valla enviada id="); Serial.print(s_fence.id);
+    Serial.print(" vertices="); Serial.println(s_fence.count);
+  }
+
+  static uint32_t seenMs = 0;
+  GeoAlert a;
+  uint32_t rxMs;
+  if (!LORA_lastGeoAlert(a, &rxMs) || rxMs == seenMs) return;
+  seenMs = rxMs;
+  s_geoOutside = a.outside;
+  SURVEY_noteAlert(a.outside);
+  (a.outside ? m_geoBreach : m_geoReturn).inc();
+  Serial.print(a.outside ? "[GEO] SALIDA de la valla" : "[GEO] Vuelta a la valla");
+  Serial.print(" id="); Serial.print(a.fenceId);
+  Serial.print(" hhmmss="); Serial.print(a.fix.hhmmss);
+  Serial.print(" lat="); Serial.print(a.fix.lat, 6);
+  Serial.print(" lon="); Serial.println(a.fix.lon, 6);
+}
+
+/**
+ * \brief Periodo más corto (s) que deja las posiciones del collar dentro del
+ *        duty-cycle del 1 % con el ancho de banda de subida pedido.
+ */
+static uint16_t minCollarPeriodS() {
+  // Posición de 13 B con el preámbulo normal de 8 símbolos
+  float airMs = WOR_airtimeMs(13, 8) * (s_narrowWanted ? LORA_BW_KHZ / WOR_NARROW_BW_KHZ : 1.0f);
+  return (uint16_t)ceilf(airMs / (1000.0f * HLT_DUTY_CYCLE));
+}
+
+/**
+ * \brief Sigue el error de frecuencia del collar y gestiona el modo de 62,5 kHz.
+ * \details Cada trama nueva alimenta freq_track. Con el duty-cycle libre, por
+ *          orden: repite la vuelta a 125 kHz hasta oír al collar, envía la
+ *          corrección pendiente o, si se pidió, pasa a 62,5 kHz. A 62,5 kHz,
+ *          un silencio de NARROW_SILENCE_FRAMES subidas (collar reiniciado o
+ *          bajada perdida) o un error que ya no cabe devuelven la base a 125 kHz.
+ */
+static void serviceFreq() {
+  static uint32_t seenMs     = 0;
+  static uint32_t intervalMs = 0;
+  static uint32_t heardMs    = 0;   // última subida o paso a 62,5 kHz
+  static bool     wasNarrow  = false;
+  float err, snr;
+  uint32_t rxMs;
+  if (LORA_lastFreqError(err, snr, rxMs) && rxMs != seenMs) {
+    if (seenMs) intervalMs = rxMs - seenMs;
+    seenMs       = rxMs;
+    heardMs      = rxMs;
+    s_wideNeeded = false;   // se oye al collar: ambos usan el mismo ancho de banda
+    FRQ_observe(err, snr);
+    m_freqErr.set(FRQ_state().meanHz);
+    m_freqStd.set(FRQ_stdHz());
+  }
+
+  uint32_t now = millis();
+  bool narrow = LORA_uplinkBandwidth() != LORA_BW_KHZ;
+  if (narrow && !wasNarrow) heardMs = now;
+  wasNarrow = narrow;
+  uint32_t silenceMs = max(NARROW_SILENCE_MIN_MS, NARROW_SILENCE_FRAMES * intervalMs);
+  if (narrow && (now - heardMs >= silenceMs ||
+                 (FRQ_isLocked() && !FRQ_bandwidthOk(WOR_NARROW_BW_KHZ)))) {
+    LORA_setUplinkBandwidth(LORA_BW_KHZ);
+    FRQ_begin();
+    s_wideNeeded = true;
+    m_narrowFallback.inc();
+    Serial.println("[FRQ] Sin subidas o error excesivo a 62,5 kHz: la base vuelve a 125 kHz");
+  }
+
+  if (LORA_commandWaitMs() > 0) return;
+  int16_t corr = FRQ_correctionHz();
+  if (s_wideNeeded) {
+    LORA_sendCommand(WOR_CMD_SET_UL_BW, 0);
+  } else if (corr) {
+    if (!LORA_sendCommand(WOR_CMD_FREQ_CORR, (uint16_t)corr)) return;
+    FRQ_noteCorrection(corr);
+    m_freqCorr.inc();
+    Serial.print("[FRQ] Corrección enviada al collar: "); Serial.print(corr); Serial.println(" Hz");
+  } else if (s_narrowWanted && !narrow && FRQ_bandwidthOk(WOR_NARROW_BW_KHZ)) {
+    if (LORA_sendCommand(WOR_CMD_SET_UL_BW, 1)) Serial.println("[FRQ] Subidas a 62,5 kHz");
+  }
+}
+
+/**
+ * \brief Envía asistencia GNSS al collar si lleva varios periodos sin enviar posiciones.
+ * \details El collar sólo transmite con fix, así que el silencio indica un
+ *          arranque o una pérdida del fix (o que está fuera de alcance: de ahí
+ *          la separación mínima, para no gastar duty-cycle en vano).
+ */
+static void serviceAiding() {
+  static uint32_t lastAidMs = 0;
+  static bool     sent      = false;
+  uint32_t now = millis();
+  uint32_t lastRx = LORA_lastRxMs();
+  uint32_t silenceMs = max(AID_SILENCE_MS, AID_SILENCE_PERIODS * SURVEY_periodMs());
+  bool silent = lastRx == 0 || now - lastRx >= silenceMs;
+  if (!silent || (sent && now - lastAidMs < AID_MIN_GAP_MS)) return;
+  if (LORA_commandWaitMs() > 0) return;
+
+  AidData aid;
+  if (!GPS_aidingData(aid) || !LORA_sendAiding(aid)) return;
+  lastAidMs = now;
+  sent      = true;
+  Serial.print("[AID] Asistencia enviada utc="); Serial.println(aid.utc);
+}
+
+/**
+ * \brief Difunde una posición aceptada al grupo LF_GROUP por la interfaz activa.
+ * \details Un solo datagrama por fix, haya los oyentes que haya; sin WiFi se
+ *          pierde (el oyente lo ve como un hueco en la secuencia).
+ */
+static void sendFeed(const GpsInfo& gi, bool corrected, float rssi, float snr) {
+  if (LF_PORT == 0) return;
+  LiveFix fix;
+  fix.seq    = s_feedSeq++;
+  fix.bootId = s_feedBoot;
+  fix.flags  = (corrected ? LF_FLAG_DGPS : 0) | (s_fixScore.flags ? LF_FLAG_ANOMALY : 0) |
+               (s_geoOutside ? LF_FLAG_OUTSIDE : 0);
+  fix.sendMs = millis();
+  fix.lat    = gi.lat;
+  fix.lon    = gi.lon;
+  fix.hhmmss = gi.hhmmss;
+  uint32_t hold = fix.sendMs - LORA_lastRxMs();
+  fix.holdMs = hold > 0xFFFF ? 0xFFFF : (uint16_t)hold;
+  fix.rssi   = rssi;
+  fix.snr    = snr;
+
+  uint8_t buf[LF_DATAGRAM_LEN];
+  LF_encode(fix, buf, sizeof(buf));
+  IPAddress group, iface = WiFi.status() == WL_CONNECTED ? WiFi.localIP() : WiFi.softAPIP();
+  bool ok = group.fromString(LF_GROUP) &&
+            s_feedUdp.beginPacketMulticast(group, LF_PORT, iface) &&
+            s_feedUdp.write(buf, sizeof(buf)) == sizeof(buf) &&
+            s_feedUdp.endPacket();
+  (ok ? m_feedSent : m_feedFailed).inc();
+}
+
+/**
+ * \brief Compila las reglas guardadas (sin fichero, sin reglas).
+ */
+static void loadRules() {
+  RUL_begin();
+  File f = LittleFS.open(RULES_FILE, "r");
+  if (!f) return;
+  String src = f.readString();
+  f.close();
+  RuleError err;
+  if (!RUL_compile(src.c_str(), err)) {
+    Serial.print("[REGLA] Reglas guardadas no validas: ");
+    Serial.print(err.line); Serial.print(":"); Serial.print(err.col);
+    Serial.print(" "); Serial.println(err.msg);
+    return;
+  }
+  Serial.print("[REGLA] Reglas cargadas: "); Serial.println(RUL_count());
+}
+
+/**
+ * \brief Evalúa las reglas con cada posición nueva del collar y cada RULES_PERIOD_MS.
+ * \details Las variables sin dato (sin posición, sin fix en la base, sin valla
+ *          o sin trama de salud) van como NaN: sus comparaciones son falsas.
+ */
+static void serviceRules(bool newFix) {
+  static uint32_t lastMs = 0;
+  uint32_t now = millis();
+  if (RUL_count() == 0 || (!newFix && now - lastMs < RULES_PERIOD_MS)) return;
+  lastMs = now;
+
+  float vars[RUL_VAR_COUNT];
+  for (float& v : vars) v = NAN;
+  if (s_fixMs) {
+    if (GPS_hasFix()) {
+      GpsInfo base = GPS_getInfo();
+      vars[RUL_VAR_DISTANCE] = (float)GPS_distanceM(base.lat, base.lon, s_fix.lat, s_fix.lon);
+    }
+    if (s_fixScore.speedMps >= 0.0f) vars[RUL_VAR_SPEED] = s_fixScore.speedMps * 3.6f;
+    vars[RUL_VAR_FIX_AGE] = (float)((now - s_fixMs) / 1000UL);
+    vars[RUL_VAR_RSSI]    = s_fixRssi;
+    vars[RUL_VAR_SNR]     = s_fixSnr;
+    vars[RUL_VAR_HOUR]    = (float)(s_fix.hhmmss / 10000UL);
+    vars[RUL_VAR_ANOMALY] = s_fixScore.flags ? 1.0f : 0.0f;
+  }
+  if (s_fence.count > 0) vars[RUL_VAR_OUTSIDE] = s_geoOutside ? 1.0f : 0.0f;
+  if (s_healthCount > 0) {
+    const HealthFrame& h = s_health[(s_healthHead + HEALTH_HISTORY - 1) % HEALTH_HISTORY].frame;
+    vars[RUL_VAR_TEMP]        = h.tempC;
+    vars[RUL_VAR_TX_FAILURES] = h.txFailures;
+  }
+
+  uint8_t fired[RUL_MAX_RULES];
+  size_t n;
+  uint32_t t0 = micros();
+  {
+    HOT_PROF_SCOPE(HOT_SLOT_RULES);
+    n = RUL_evaluate(vars, now / 1000UL, fired, RUL_MAX_RULES);
+  }
+  m_ruleEvalUs.observe((float)(micros() - t0));
+  for (size_t i = 0; i < n; i++) {
+    const char* name = RUL_info(fired[i]).name;
+    m_ruleAlerts.inc();
+    Serial.print("[REGLA] Aviso: "); Serial.println(name);
+    showLCDMessage("ALERTA:\n" + String(name));
+  }
+}
 
+void setup() {
+  SUP_begin();   // antes de que ninguna tarea pise el registro del arranque anterior
+  BOOT_event("setup");
+  BootPhase phase = BOOT_start("serial");
   Serial.begin(115200);
   Serial.println("Iniciando...");
+  BOOT_end(phase);
 
+  phase = BOOT_start("littlefs");
   if (!LittleFS.begin()) {
     showLCDMessage("Error al montar FS");
     return;
   }
-  
+  BOOT_end(phase);
+
+  // GNSS de la base: sólo se usa para asistir al collar (sin receptor no hay envíos)
+  phase = BOOT_start("gps");
+  GPS_begin(GPS_BAUD);
+  DGPS_begin();
+  loadMovement();
+  loadFence();
+  loadRules();
+  BOOT_end(phase);
+
   // ------------ Pantalla LCD -------------------------
+  // El pulso de habilitación del LCD se solapa con el arranque de la radio
   pinMode(21, OUTPUT);
   digitalWrite(21, LOW);
-  delay(10);               // un breve retardo
-  digitalWrite(21, HIGH);  // habilita
+  uint32_t lcdPulse = millis();
+
+  // --------------------- LoRa ------------------------
+  // Antes que el WiFi: recibe mientras la estación se asocia o el AP espera clientes
+  phase = BOOT_start("lora");
+  LORA_begin(FREQ_LORA);
+  LORA_startRx();
+  SURVEY_begin();
+  FRQ_begin();
+  BOOT_end(phase);
 
+  phase = BOOT_start("lcd");
+  while (millis() - lcdPulse < 10) {}   // un breve retardo (resto del pulso)
+  digitalWrite(21, HIGH);               // habilita
   confLCD();
   showLCDMessage("Cargando WiFi...");
+  BOOT_end(phase);
 
   String ssid, pwd;
   bool conectado;
@@ -59,7 +786,10 @@ void setup() {
 
 // Si hay configuración guardada, intenta conectar
 // Si falla o no hay, lanza modo AP para configuración
+ phase = BOOT_start("wifi");
+ WIFI_setIdleHook(idleService);
  conectado = initWiFiConnection(ssid, pwd);
+ BOOT_end(phase);
  
 /*  if (loadWiFiConf(ssid, pwd)) {
     conectado = tryConnectWiFi(ssid, pwd);
@@ -77,42 +807,48 @@ void setup() {
     showLCDMessage("Acceda a http://" + WiFi.softAPIP().toString());
   }*/
 
-  // --------------------- LoRa ------------------------
-  LORA_begin(868.0);
-  LORA_startRx();
+  // Ahorro de energía WiFi según clientes activos
+  WPM_begin(WIFI_LATENCY_BUDGET_MS);
+  s_feedBoot = (uint16_t)rp2040.hwrand32();
+
+#if defined(PKT_FWD_MODE)
+  // EUI a partir de la MAC: con el WiFi ya arrancado
+  Serial.println(PF_begin() ? "[FWD] Reenvio UDP a " PFWD_HOST : "[FWD] Sin servidor (PFWD_HOST)");
+#endif
 
   // ------------- CARGA DE PÁGINAS WEB --------------
+  phase = BOOT_start("http");
 
-  server.on("/", HTTP_GET, []() {
+  route("/", HTTP_GET, []() {
     File file = LittleFS.open("/index.html", "r");
     server.streamFile(file, "text/html");
     file.close();
   });
 
-  server.on("/wifimanager", HTTP_GET, []() {
+  route("/wifimanager", HTTP_GET, []() {
     String html = generateScanNetworksHTML();
-    server.send(200, "text/html", html);
+    sendDynamic(200, "text/html", html);
   });
   
-  server.on("/savedcredentials", HTTP_GET, []() {
+  route("/savedcredentials", HTTP_GET, []() {
     String html = generateCredentialsSavedHTML();
-    server.send(200, "text/html", html);
+    sendDynamic(200, "text/html", html);
   });
 
-  server.on("/coords", HTTP_GET, []() {
+  route("/coords", HTTP_GET, []() {
     String html = generateCoordsHTML();
-    server.send(200, "text/html", html);
+    sendDynamic(200, "text/html", html);
   });
 
-  server.on("/style.css", HTTP_GET, []() {
+  route("/style.css", HTTP_GET, []() {
     File file = LittleFS.open("/style.css", "r");
     server.streamFile(file, "text/css");
     file.close();
   });
 
-  server.on("/coords.txt", HTTP_GET, []() {
-  GpsInfo gi; float rssi=0, snr=0;
-  if (LORA_lastValidGPS(gi, &rssi, &snr) && gi.valid) {
+  route("/coords.txt", HTTP_GET, []() {
+  GpsInfo gi;
+  if (collarFix(gi, nullptr, nullptr, nullptr)) {
     String qs = "lat=" + String(gi.lat, 6) + "&lon=" + String(gi.lon, 6) + "&z=18";
     server.send(200, "text/plain", qs);
   } else {
@@ -121,29 +857,303 @@ void setup() {
 });
 
 
+  // Registro de bloqueos detectados por el watchdog del supervisor
+  route("/stall.log", HTTP_GET, []() {
+    File file = LittleFS.open("/stall.log", "r");
+    if (!file) {
+      server.send(200, "text/plain", "");
+      return;
+    }
+    server.streamFile(file, "text/plain");
+    file.close();
+  });
+
+  // Últimas tramas de salud del collar (CSV, la más reciente al final)
+  route("/health", HTTP_GET, []() {
+    String out = "edad_s,seq,uptime_min,reinicio,arranques,ttff_ultimo_s,ttff_p90_s,"
+                 "tx_fallos,ultimo_error,temp_c,loop_max_ms,gps_rx_hwm,heap_min_kb\n";
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < s_healthCount; i++) {
+      const HealthEntry& e = s_health[(s_healthHead + HEALTH_HISTORY - s_healthCount + i) % HEALTH_HISTORY];
+      const HealthFrame& h = e.frame;
+      char line[96];
+      snprintf(line, sizeof(line), "%lu,%u,%lu,%s,%u,%u,%u,%u,%d,%d,%u,%u,%u\n",
+               (unsigned long)((now - e.rxMs) / 1000UL), h.seq, (unsigned long)h.uptimeMin,
+               HLT_resetName(h.resetReason), h.resetCount, h.ttffLastS, h.ttffP90S,
+               h.txFailures, h.lastTxError, h.tempC, h.loopMaxMs, h.gpsRxHwm, h.minFreeHeapKb);
+      out += line;
+    }
+    sendDynamic(200, "text/csv", out);
+  });
+
+  // Últimas posiciones anómalas del collar (CSV, la más reciente al final)
+  route("/anomalies", HTTP_GET, []() {
+    String out = "edad_s,hhmmss,lat,lon,tipo,hora,zona_frac,velocidad_mps,velocidad_cola\n";
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < s_anomalyCount; i++) {
+      const AnomalyEntry& e = s_anomalies[(s_anomalyHead + ANOMALY_HISTORY - s_anomalyCount + i) % ANOMALY_HISTORY];
+      const MovScore& sc = e.score;
+      const char* kind = sc.flags == (MOV_FLAG_LOCATION | MOV_FLAG_SPEED) ? "zona+velocidad"
+                       : (sc.flags & MOV_FLAG_LOCATION) ? "zona" : "velocidad";
+      char line[128];
+      snprintf(line, sizeof(line), "%lu,%06lu,%.6f,%.6f,%s,%u,%.4f,%.1f,%.4f\n",
+               (unsigned long)((now - e.rxMs) / 1000UL), (unsigned long)e.fix.hhmmss,
+               e.fix.lat, e.fix.lon, kind, sc.hour, sc.locFrac, sc.speedMps, sc.speedTail);
+      out += line;
+    }
+    sendDynamic(200, "text/csv", out);
+  });
+
+  // Métricas en formato de texto de Prometheus (generadas en streaming)
+  route("/metrics", HTTP_GET, []() {
+    if (wantsGzip(0)) {
+      beginGzip(200, "text/plain; version=0.0.4");
+      METRICS_render(GZ_sink, &s_gz);
+      endGzip();
+      return;
+    }
+    MetricsChunk chunk;
+    chunk.len = 0;
+    server.sendHeader("Vary", "Accept-Encoding");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+    METRICS_render(metricsSink, &chunk);
+    if (chunk.len) server.sendContent(chunk.buf, chunk.len);
+    server.sendContent("");
+  });
+
+  // Valla de casa: GET la muestra (metros desde el primer vértice);
+  // POST pts=lat,lon;lat,lon;... (3..8 vértices, vacío = sin valla) la guarda y la envía
+  route("/fence", HTTP_GET, []() {
+    String out = "id=" + String(s_fence.id) + " vertices=" + String(s_fence.count) +
+                 " origen=" + String(s_fence.lat0 / 100000.0, 5) + "," + String(s_fence.lon0 / 100000.0, 5) +
+                 " estado=" + (s_geoOutside ? "fuera" : "dentro") +
+                 (s_fenceSend ? " (envio pendiente)" : "") + "\neste_m,norte_m\n";
+    for (uint8_t i = 0; i < s_fence.count; i++) {
+      out += String(s_fence.east[i]) + "," + String(s_fence.north[i]) + "\n";
+    }
+    server.send(200, "text/plain", out);
+  });
+
+  route("/fence", HTTP_POST, []() {
+    String pts = server.arg("pts");
+    double lat[GEO_MAX_VERTICES + 1], lon[GEO_MAX_VERTICES + 1];
+    uint8_t n = 0;
+    const char* p = pts.c_str();
+    while (*p && n <= GEO_MAX_VERTICES) {
+      char* end;
+      lat[n] = strtod(p, &end);
+      if (end == p || *end != ',') break;
+      p = end + 1;
+      lon[n] = strtod(p, &end);
+      if (end == p) break;
+      n++;
+      p = (*end == ';') ? end + 1 : end;
+      if (end == p && *p) break;   // separador no válido
+    }
+    GeoFence fence{};
+    fence.id = (uint8_t)(s_fence.id + 1);
+    if (*p || (n > 0 && !GEO_fenceFromPoints(fence.id, lat, lon, n, fence))) {
+      server.send(400, "text/plain", "Valla no valida (3 a 8 vertices lat,lon separados por ';' a menos de 32 km)");
+      return;
+    }
+    if (!saveFence(fence)) {
+      server.send(500, "text/plain", "No se pudo guardar la valla");
+      return;
+    }
+    server.send(200, "text/plain", "OK id=" + String(fence.id) + " vertices=" + String(fence.count) +
+                " espera_ms=" + String(LORA_commandWaitMs()));
+  });
+
+  // Reglas de alerta: GET edita y muestra su estado; POST src=... las compila y las guarda
+  route("/rules", HTTP_GET, []() {
+    String src;
+    File f = LittleFS.open(RULES_FILE, "r");
+    if (f) {
+      src = f.readString();
+      f.close();
+    }
+    String status = String(RUL_count()) + " reglas";
+    sendDynamic(200, "text/html", generateRulesHTML(src, status, millis() / 1000UL));
+  });
+
+  route("/rules", HTTP_POST, []() {
+    String src = server.arg("src");
+    src.replace("\r", "");
+    if (src.length() > RULES_MAX_SRC) {
+      sendDynamic(413, "text/html", generateRulesHTML(src, "Texto demasiado largo", millis() / 1000UL));
+      return;
+    }
+    RuleError err;
+    if (!RUL_compile(src.c_str(), err)) {
+      String status = "Error en la línea " + String(err.line) + ", columna " + String(err.col) +
+                      ": " + err.msg + " (se mantienen las reglas anteriores)";
+      sendDynamic(400, "text/html", generateRulesHTML(src, status, millis() / 1000UL));
+      return;
+    }
+    File f = LittleFS.open(RULES_FILE, "w");
+    bool saved = f && f.print(src) == src.length();
+    if (f) f.close();
+    String status = String(RUL_count()) + " reglas compiladas" + (saved ? "" : " (no se pudieron guardar)");
+    sendDynamic(saved ? 200 : 500, "text/html", generateRulesHTML(src, status, millis() / 1000UL));
+  });
+
+  // Comando al collar (wake-on-radio): c=ping|period|sniff|bw|aid, v=valor (bw: 62 o 125)
+  route("/cmd", HTTP_POST, []() {
+    String c = server.arg("c");
+    uint16_t v = (uint16_t)server.arg("v").toInt();
+    WorCmd cmd;
+    if      (c == "ping")   cmd = WOR_CMD_PING;
+    else if (c == "period") {
+      long    want = server.arg("v").toInt();
+      uint16_t minS = minCollarPeriodS();
+      if (want < minS || want > COLLAR_PERIOD_MAX_S || 86400L % want != 0) {
+        server.send(400, "text/plain", "Periodo: divisor de 86400 entre " + String(minS) + " y " +
+                    String(COLLAR_PERIOD_MAX_S) + " s (duty-cycle del 1 %)");
+        return;
+      }
+      cmd = WOR_CMD_SET_PERIOD;
+    }
+    else if (c == "sniff")  cmd = WOR_CMD_SET_SNIFF;
+    else if (c == "bw") {
+      if (v != 62 && v != LORA_BW_KHZ) {
+        server.send(400, "text/plain", "Ancho de banda: 62 o 125");
+        return;
+      }
+      if (v == 62 && !FRQ_bandwidthOk(WOR_NARROW_BW_KHZ)) {
+        server.send(409, "text/plain", "Error de frecuencia sin seguir o excesivo: " +
+                    String(FRQ_state().meanHz, 0) + " Hz");
+        return;
+      }
+      s_narrowWanted = v == 62;
+      cmd = WOR_CMD_SET_UL_BW;
+      v   = s_narrowWanted ? 1 : 0;
+    }
+    else if (c == "aid") {
+      AidData aid;
+      if (!GPS_aidingData(aid)) {
+        server.send(503, "text/plain", "Sin fix GNSS en la base");
+      } else if (!LORA_sendAiding(aid)) {
+        server.send(429, "text/plain", "Espere " + String(LORA_commandWaitMs()) + " ms");
+      } else {
+        server.send(200, "text/plain", "OK utc=" + String(aid.utc));
+      }
+      return;
+    }
+    else {
+      server.send(400, "text/plain", "Comando desconocido");
+      return;
+    }
+    uint8_t seq = 0;
+    uint8_t preset = LORA_collarSniffPreset();
+    if (!LORA_sendCommand(cmd, v, &seq)) {
+      server.send(429, "text/plain", "Espere " + String(LORA_commandWaitMs()) + " ms");
+      return;
+    }
+    server.send(200, "text/plain", "OK seq=" + String(seq) + " latencia_ms=" +
+                String(WOR_commandLatencyMs(preset), 0));
+  });
+
   // Gestiona el POST tras realizar el submit en el formulario
-  server.on("/submit", HTTP_POST, handleFormSubmit);
+  route("/submit", HTTP_POST, handleFormSubmit);
+  static const char* HEADERS[] = {"Accept-Encoding"};
+  server.collectHeaders(HEADERS, 1);
   server.begin();
+  BOOT_end(phase);
+
+  BOOT_event("ready");
+  BOOT_report(Serial);
+#if defined(REPLAY_MODE)
+  beginReplay();
+#endif
 
+  SUP_arm();
+  if (SUP_stalledLastBoot()) SUP_report(Serial);
 }
 
 void loop() {
-  server.handleClient(); // Maneja las peticiones de los clientes
+  HOT_loopMark();
+  SUP_feed();
+  {
+    HOT_PROF_SCOPE(HOT_SLOT_HTTP);
+    SUP_SCOPE(SUP_TASK_HTTP);
+    server.handleClient(); // Maneja las peticiones de los clientes
+  }
 
-  LORA_rxTick();
+#if defined(REPLAY_MODE)
+  serviceReplay();
+#endif
+  serviceRadio();
+  serviceHealth();
+
+  // Sondeo de canales en los huecos entre uplinks
+  {
+    SUP_SCOPE(SUP_TASK_SURVEY);
+    SURVEY_tick();
+  }
+
+  {
+    SUP_SCOPE(SUP_TASK_GNSS);
+    GPS_update();
+    serviceDgps();
+    serviceAiding();
+  }
+  serviceFence();
+  serviceFreq();
+
+  {
+    SUP_SCOPE(SUP_TASK_WIFI);
+    // Reevaluación del canal del AP cuando no hay clientes
+    WIFI_apTick();
 
+    // Modo de ahorro WiFi (se informa en cada cambio)
+    static WpmMode lastMode = WPM_mode();
+    WPM_tick();
+    if (WPM_mode() != lastMode) {
+      lastMode = WPM_mode();
+      WPM_report(Serial);
+    }
+
+#if defined(PKT_FWD_MODE)
+    // Reenvío de las tramas encoladas por LORA_rxTick()
+    PF_tick();
+#endif
+  }
+
+  // Posición nueva del collar: se espera (poco) al error de la base de su época
   static uint32_t lastPrint = 0;
   GpsInfo gi; float rssi, snr;
-  if (LORA_lastValidGPS(gi, &rssi, &snr) && gi.hhmmss != lastPrint) {
+  bool corrected = false, newFix = false;
+  if (collarFix(gi, &corrected, &rssi, &snr) && gi.hhmmss != lastPrint &&
+      (corrected || !DGPS_hasReference() || millis() - LORA_lastRxMs() > DGPS_WAIT_MS)) {
     lastPrint = gi.hhmmss;
+    newFix    = true;
+    if (DGPS_hasReference()) (corrected ? m_dgpsCorrected : m_dgpsUncorrected).inc();
     Serial.print("[RX] hhmmss="); Serial.print(gi.hhmmss);
     Serial.print(" lat="); Serial.print(gi.lat, 6);
     Serial.print(" lon="); Serial.print(gi.lon, 6);
     Serial.print(" RSSI="); Serial.print(rssi);
     Serial.print("dBm SNR="); Serial.print(snr);
-    Serial.println("dB");
+    Serial.println(corrected ? "dB DGPS" : "dB");
+    serviceMovement(gi);
+    sendFeed(gi, corrected, rssi, snr);
+    LCD_addTrackPoint(gi.lat, gi.lon);
+    s_fix     = gi;
+    s_fixMs   = millis();
+    s_fixRssi = rssi;
+    s_fixSnr  = snr;
   }
+  serviceRules(newFix);
+  LCD_tick();
   
+#if defined(HOT_PROFILE)
+  static uint32_t lastProf = 0;
+  if (millis() - lastProf > 30000UL) {
+    lastProf = millis();
+    HOT_report(Serial, true);
+  }
+#endif
+
   if (pendingReset && millis() - pendingResetTime > 5000) {  
   watchdog_reboot(0, 0, 0);
   }
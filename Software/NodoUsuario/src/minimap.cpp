@@ -0,0 +1,187 @@
+/** @file minimap.cpp
+ * @brief Implementación del minimapa del collar.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "minimap.h"
+#include "framebuffer.h"
+#include "payload_codec.h"
+#include <math.h>
+#include <stdio.h>
+
+static const int    MAP_HALF      = MAP_SIZE / 2 - 1;   // píxeles del centro al borde interior
+static const int    MAP_CX        = MAP_X + MAP_SIZE / 2;
+static const int    MAP_CY        = MAP_Y + MAP_SIZE / 2;
+
+// ----------------- Estado interno -----------------------
+static bool    s_hasOrigin = false;
+static double  s_lat0 = 0.0, s_lon0 = 0.0;
+static double  s_lat[MAP_TRAIL], s_lon[MAP_TRAIL];
+static uint8_t s_head  = 0;   // siguiente hueco
+static uint8_t s_count = 0;
+
+void MAP_begin() {
+  s_hasOrigin = false;
+  s_head      = 0;
+  s_count     = 0;
+}
+
+bool MAP_setOrigin(double lat, double lon) {
+  if (s_hasOrigin) {
+    double e, n;
+    GPS_localEN(s_lat0, s_lon0, lat, lon, e, n);
+    if (e * e + n * n <= (double)MAP_ORIGIN_MOVE_M * MAP_ORIGIN_MOVE_M) return false;
+  }
+  s_hasOrigin = true;
+  s_lat0      = lat;
+  s_lon0      = lon;
+  return true;
+}
+
+bool MAP_hasOrigin() {
+  return s_hasOrigin;
+}
+
+void MAP_addFix(double lat, double lon) {
+  s_lat[s_head] = lat;
+  s_lon[s_head] = lon;
+  s_head = (uint8_t)((s_head + 1) % MAP_TRAIL);
+  if (s_count < MAP_TRAIL) s_count++;
+}
+
+uint8_t MAP_count() {
+  return s_count;
+}
+
+/** \brief Índice del i-ésimo punto del rastro (0 = el más antiguo). */
+static uint8_t at(uint8_t i) {
+  return (uint8_t)((s_head + MAP_TRAIL - s_count + i) % MAP_TRAIL);
+}
+
+/**
+ * \brief Centro del mapa: la base o, sin ella, la última posición.
+ */
+static bool center(double& lat, double& lon) {
+  if (s_hasOrigin) {
+    lat = s_lat0;
+    lon = s_lon0;
+    return true;
+  }
+  if (s_count == 0) return false;
+  uint8_t last = at(s_count - 1);
+  lat = s_lat[last];
+  lon = s_lon[last];
+  return true;
+}
+
+uint32_t MAP_radiusM() {
+  double lat0, lon0, maxM = 0.0;
+  if (!center(lat0, lon0)) return MAP_RADII_M[0];
+  for (uint8_t i = 0; i < s_count; i++) {
+    double e, n;
+    GPS_localEN(lat0, lon0, s_lat[at(i)], s_lon[at(i)], e, n);
+    if (fabs(e) > maxM) maxM = fabs(e);
+    if (fabs(n) > maxM) maxM = fabs(n);
+  }
+  for (uint8_t r = 0; r < MAP_RADII; r++)
+    if (maxM <= MAP_RADII_M[r]) return MAP_RADII_M[r];
+  return MAP_RADII_M[MAP_RADII - 1];
+}
+
+/**
+ * \brief Proyección sin recortar (con la escala \p radiusM).
+ */
+static bool pixelOf(double lat, double lon, uint32_t radiusM, int& x, int& y) {
+  double lat0, lon0, e, n;
+  if (!center(lat0, lon0)) return false;
+  GPS_localEN(lat0, lon0, lat, lon, e, n);
+  double k = (double)MAP_HALF / radiusM;
+  // Fuera de ±4 cuadros se satura: sólo se usa para recortar rectas
+  if (e * k >  4 * MAP_SIZE) e =  4.0 * MAP_SIZE / k;
+  if (e * k < -4 * MAP_SIZE) e = -4.0 * MAP_SIZE / k;
+  if (n * k >  4 * MAP_SIZE) n =  4.0 * MAP_SIZE / k;
+  if (n * k < -4 * MAP_SIZE) n = -4.0 * MAP_SIZE / k;
+  x = MAP_CX + (int)lround(e * k);
+  y = MAP_CY - (int)lround(n * k);
+  return true;
+}
+
+bool MAP_project(double lat, double lon, int& x, int& y) {
+  if (!pixelOf(lat, lon, MAP_radiusM(), x, y)) return false;
+  return x > MAP_X && x < MAP_X + MAP_SIZE - 1 && y > MAP_Y && y < MAP_Y + MAP_SIZE - 1;
+}
+
+static void formatDistance(double m, char* buf, size_t size) {
+  if (m < 1000.0) snprintf(buf, size, "%uM", (unsigned)lround(m));
+  else if (m < 10000.0) snprintf(buf, size, "%.1fKM", m / 1000.0);
+  else snprintf(buf, size, "%uKM", (unsigned)lround(m / 1000.0));
+}
+
+static void formatAge(uint32_t s, char* buf, size_t size) {
+  if (s == MAP_AGE_UNKNOWN) snprintf(buf, size, "HACE --");
+  else if (s < 100) snprintf(buf, size, "HACE %luS", (unsigned long)s);
+  else if (s < 6000) snprintf(buf, size, "HACE %luMIN", (unsigned long)(s / 60));
+  else snprintf(buf, size, "HACE %luH", (unsigned long)(s / 3600));
+}
+
+/**
+ * \brief Cuadro, flecha del norte, base, rastro y textos de la derecha.
+ */
+void MAP_render(uint32_t ageS) {
+  FB_resetClip();
+  FB_fillRect(MAP_X, MAP_Y, FB_WIDTH - MAP_X, MAP_SIZE, false);
+  FB_rect(MAP_X, MAP_Y, MAP_SIZE, MAP_SIZE);
+
+  // Flecha del norte en la esquina superior izquierda
+  FB_text(MAP_X + 2, MAP_Y + 2, "N");
+  FB_line(MAP_X + 10, MAP_Y + 2, MAP_X + 10, MAP_Y + 8);
+  FB_line(MAP_X + 10, MAP_Y + 2, MAP_X + 8, MAP_Y + 4);
+  FB_line(MAP_X + 10, MAP_Y + 2, MAP_X + 12, MAP_Y + 4);
+
+  char buf[16];
+  if (s_count == 0) {
+    FB_text(MAP_PANEL_X, MAP_Y, "SIN DATOS");
+    return;
+  }
+
+  uint32_t radius = MAP_radiusM();
+  FB_setClip(MAP_X + 1, MAP_Y + 1, MAP_SIZE - 2, MAP_SIZE - 2);
+  if (s_hasOrigin) {
+    FB_line(MAP_CX - 2, MAP_CY, MAP_CX + 2, MAP_CY);
+    FB_line(MAP_CX, MAP_CY - 2, MAP_CX, MAP_CY + 2);
+  }
+  int px = 0, py = 0;
+  for (uint8_t i = 0; i < s_count; i++) {
+    int x, y;
+    pixelOf(s_lat[at(i)], s_lon[at(i)], radius, x, y);
+    if (i > 0) FB_line(px, py, x, y);
+    px = x;
+    py = y;
+  }
+  FB_fillRect(px - 1, py - 1, 3, 3, true);
+  FB_resetClip();
+
+  char dist[10];
+  formatDistance(radius, dist, sizeof(dist));
+  snprintf(buf, sizeof(buf), "R %s", dist);
+  FB_text(MAP_PANEL_X, MAP_Y, buf);
+
+  if (s_hasOrigin) {
+    uint8_t last = at(s_count - 1);
+    double e, n;
+    GPS_localEN(s_lat0, s_lon0, s_lat[last], s_lon[last], e, n);
+    formatDistance(sqrt(e * e + n * n), dist, sizeof(dist));
+    snprintf(buf, sizeof(buf), "D %s", dist);
+    FB_text(MAP_PANEL_X, MAP_Y + FB_CHAR_H, buf);
+    double brg = atan2(e, n) * 180.0 / M_PI;
+    if (brg < 0) brg += 360.0;
+    snprintf(buf, sizeof(buf), "RUMBO %03u", (unsigned)lround(brg) % 360);
+    FB_text(MAP_PANEL_X, MAP_Y + 2 * FB_CHAR_H, buf);
+  } else {
+    FB_text(MAP_PANEL_X, MAP_Y + FB_CHAR_H, "SIN BASE");
+  }
+  formatAge(ageS, buf, sizeof(buf));
+  FB_text(MAP_PANEL_X, MAP_Y + 3 * FB_CHAR_H, buf);
+}
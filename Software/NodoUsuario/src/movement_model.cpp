@@ -0,0 +1,200 @@
+/** @file movement_model.cpp
+ * @brief Implementación del modelo de zona y velocidad por hora (count-min + histogramas).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "movement_model.h"
+#include <math.h>
+#include <string.h>
+
+// ----------------- Configuración -----------------------
+static const uint32_t MOV_MAGIC = 0x4D4F5631;   // "MOV1"
+static const double   DEG2RAD   = M_PI / 180.0;
+/** Límites superiores de las clases de velocidad (m/s); la última es abierta. */
+static const float SPEED_EDGES[MOV_SPEED_BINS - 1] = {0.3f, 0.7f, 1.2f, 2.0f, 3.0f, 4.5f, 6.5f, 9.0f, 13.0f};
+
+// ----------------- Estado interno -----------------------
+static MovState s_st;
+static bool     s_prevValid = false;
+static double   s_prevLat   = 0.0;
+static double   s_prevLon   = 0.0;
+static uint32_t s_prevSod   = 0;
+
+/**
+ * \brief FNV-1a de 32 bits.
+ */
+static uint32_t fnv1a(const uint8_t* p, size_t len) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+/**
+ * \brief Suma de control de todo lo que sigue a la cabecera.
+ */
+static uint32_t stateChecksum(const MovState& st) {
+  const uint8_t* body = (const uint8_t*)&st.cms;
+  return fnv1a(body, sizeof(MovState) - offsetof(MovState, cms));
+}
+
+void MOV_begin() {
+  memset(&s_st, 0, sizeof(s_st));
+  s_st.magic = MOV_MAGIC;
+  s_prevValid = false;
+}
+
+/**
+ * \brief Mezclador de splitmix64 sobre (fila, columna, hora).
+ */
+static uint64_t cellHash(int32_t row, int32_t col, uint8_t hour) {
+  uint64_t x = ((uint64_t)(uint32_t)row << 32) | (uint32_t)col;
+  x ^= (uint64_t)(hour + 1) * 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * \brief Índices de las MOV_DEPTH filas por doble hash (h1 + i·h2).
+ */
+static void cellIndex(int32_t row, int32_t col, uint8_t hour, uint16_t idx[MOV_DEPTH]) {
+  uint64_t h = cellHash(row, col, hour);
+  uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 32) | 1U;
+  for (uint8_t d = 0; d < MOV_DEPTH; d++) idx[d] = (uint16_t)((h1 + d * h2) & (MOV_WIDTH - 1));
+}
+
+/**
+ * \brief Estimación count-min de una celda (mínimo de las filas).
+ */
+static uint16_t cellCount(int32_t row, int32_t col, uint8_t hour) {
+  uint16_t idx[MOV_DEPTH];
+  cellIndex(row, col, hour, idx);
+  uint16_t m = 0xFFFF;
+  for (uint8_t d = 0; d < MOV_DEPTH; d++) {
+    if (s_st.cms[d][idx[d]] < m) m = s_st.cms[d][idx[d]];
+  }
+  return m;
+}
+
+/**
+ * \brief Celda del fix: filas de MOV_CELL_DEG en latitud y columnas de igual
+ *        longitud en metros (escaladas con el coseno de la fila).
+ */
+static void cellOf(const GpsInfo& fix, int32_t& row, int32_t& col) {
+  row = (int32_t)floor(fix.lat / MOV_CELL_DEG);
+  double cosLat = cos((row + 0.5) * MOV_CELL_DEG * DEG2RAD);
+  col = (int32_t)floor(fix.lon * cosLat / MOV_CELL_DEG);
+}
+
+/**
+ * \brief Divide a la mitad el sketch y los totales de zona de todas las horas.
+ */
+static void halveLocation() {
+  for (uint8_t d = 0; d < MOV_DEPTH; d++) {
+    for (uint16_t w = 0; w < MOV_WIDTH; w++) s_st.cms[d][w] >>= 1;
+  }
+  for (uint8_t h = 0; h < MOV_HOURS; h++) s_st.locTotal[h] >>= 1;
+}
+
+static uint8_t speedBin(float mps) {
+  uint8_t b = 0;
+  while (b < MOV_SPEED_BINS - 1 && mps >= SPEED_EDGES[b]) b++;
+  return b;
+}
+
+/**
+ * \brief Velocidad desde el fix anterior (−1 si no hay o el hueco es excesivo).
+ */
+static float speedFromPrev(const GpsInfo& fix, uint32_t sod) {
+  if (!s_prevValid) return -1.0f;
+  uint32_t dt = (sod + 86400UL - s_prevSod) % 86400UL;
+  if (dt == 0 || dt > MOV_MAX_GAP_S) return -1.0f;
+  return (float)(GPS_distanceM(s_prevLat, s_prevLon, fix.lat, fix.lon) / dt);
+}
+
+/**
+ * \brief Evaluación (zona 3×3 y cola de la velocidad) y después aprendizaje.
+ */
+MovScore MOV_observe(const GpsInfo& fix) {
+  uint32_t sod = GPS_hhmmssToSod(fix.hhmmss);
+  uint8_t hour = (uint8_t)((sod / 3600UL) % MOV_HOURS);
+
+  MovScore r;
+  r.flags = 0;
+  r.hour = hour;
+  r.locFrac = -1.0f;
+  r.speedMps = speedFromPrev(fix, sod);
+  r.speedTail = -1.0f;
+
+  // ---- Zona: la celda y sus 8 vecinas ----
+  int32_t row, col;
+  cellOf(fix, row, col);
+  if (s_st.locTotal[hour] >= MOV_WARMUP) {
+    uint32_t near = 0;
+    for (int8_t dr = -1; dr <= 1; dr++) {
+      for (int8_t dc = -1; dc <= 1; dc++) near += cellCount(row + dr, col + dc, hour);
+    }
+    r.locFrac = (float)near / s_st.locTotal[hour];
+    if (r.locFrac < MOV_LOC_MIN_FRAC) r.flags |= MOV_FLAG_LOCATION;
+  }
+
+  // ---- Velocidad: probabilidad de la clase del fix y las superiores ----
+  uint8_t bin = 0;
+  if (r.speedMps >= 0.0f) {
+    bin = speedBin(r.speedMps);
+    if (s_st.speedTotal[hour] >= MOV_WARMUP) {
+      uint32_t tail = 0;
+      for (uint8_t b = bin; b < MOV_SPEED_BINS; b++) tail += s_st.speed[hour][b];
+      r.speedTail = (float)tail / s_st.speedTotal[hour];
+      if (r.speedMps >= MOV_SPEED_MIN_MPS && r.speedTail < MOV_SPEED_MIN_FRAC) r.flags |= MOV_FLAG_SPEED;
+    }
+  }
+
+  // ---- Aprendizaje ----
+  uint16_t idx[MOV_DEPTH];
+  cellIndex(row, col, hour, idx);
+  for (uint8_t d = 0; d < MOV_DEPTH; d++) {
+    if (s_st.cms[d][idx[d]] < 0xFFFF) s_st.cms[d][idx[d]]++;
+  }
+  if (++s_st.locTotal[hour] >= MOV_HALVE_AT) halveLocation();
+
+  if (r.speedMps >= 0.0f) {
+    s_st.speed[hour][bin]++;
+    if (++s_st.speedTotal[hour] >= MOV_HALVE_AT) {
+      for (uint8_t b = 0; b < MOV_SPEED_BINS; b++) s_st.speed[hour][b] >>= 1;
+      s_st.speedTotal[hour] >>= 1;
+    }
+  }
+
+  s_prevValid = true;
+  s_prevLat = fix.lat;
+  s_prevLon = fix.lon;
+  s_prevSod = sod;
+  return r;
+}
+
+const MovState& MOV_state() {
+  s_st.checksum = stateChecksum(s_st);
+  return s_st;
+}
+
+/**
+ * \brief Copia el estado si la marca y la suma de control son las esperadas.
+ */
+bool MOV_load(const void* data, size_t len) {
+  MOV_begin();
+  if (!data || len != sizeof(MovState)) return false;
+  const MovState* in = (const MovState*)data;
+  if (in->magic != MOV_MAGIC || in->checksum != stateChecksum(*in)) return false;
+  memcpy(&s_st, in, sizeof(s_st));
+  return true;
+}
+
+uint32_t MOV_hourSamples(uint8_t hour) {
+  return hour < MOV_HOURS ? s_st.locTotal[hour] : 0;
+}
@@ -0,0 +1,143 @@
+/** @file pkt_forwarder.cpp
+ * @brief Implementación del packet forwarder de un canal sobre WiFiUDP.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "pkt_forwarder.h"
+
+#if defined(PKT_FWD_MODE)
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "gps_handler.h"
+#include "lora_handler.h"
+#include "metrics.h"
+#include "semtech_udp.h"
+
+// ----------------- Configuración -----------------------
+static const uint32_t PF_RESOLVE_RETRY_MS = 10000UL;   // DNS fallido: siguiente intento
+static const uint32_t PF_UTC_REFRESH_MS   = 10000UL;   // hora UTC del GNSS de la base
+static const size_t   PF_RX_MAX           = 16;        // las confirmaciones ocupan 4 B
+
+// ----------------- Métricas -----------------------------
+METRIC_COUNTER_L(m_fwdQueued,    "pfwd_frames_total", "Tramas en el reenvío UDP por resultado", "result=\"queued\"");
+METRIC_COUNTER_L(m_fwdForwarded, "pfwd_frames_total", "Tramas en el reenvío UDP por resultado", "result=\"forwarded\"");
+METRIC_COUNTER_L(m_fwdDropped,   "pfwd_frames_total", "Tramas en el reenvío UDP por resultado", "result=\"dropped\"");
+METRIC_COUNTER(m_fwdRetries, "pfwd_push_retries_total", "PUSH_DATA reenviados por falta de PUSH_ACK");
+METRIC_COUNTER(m_fwdDownlinks, "pfwd_downlinks_ignored_total", "PULL_RESP del servidor (bajadas no soportadas)");
+METRIC_GAUGE(m_fwdQueue, "pfwd_queue_frames", "Tramas pendientes de confirmación del servidor");
+METRIC_GAUGE(m_fwdOnline, "pfwd_server_online", "1 si el último PUSH_DATA se confirmó");
+
+// ----------------- Estado interno -----------------------
+static WiFiUDP   s_udp;
+static IPAddress s_server;
+static bool      s_started   = false;
+static bool      s_udpOpen   = false;
+static bool      s_resolved  = false;
+static uint32_t  s_resolveMs = 0;
+static uint32_t  s_utc       = 0;     // última hora UTC de la base y su instante
+static uint32_t  s_utcMs     = 0;
+static uint32_t  s_utcPollMs = 0;
+static SudpStats s_reported;          // contadores ya volcados a las métricas
+static uint8_t   s_datagram[SUDP_DATAGRAM_MAX];
+
+/**
+ * \brief Copia la trama a la cola con sus metadatos (se llama desde LORA_rxTick()).
+ */
+static void onFrame(const LoraRxFrame& f) {
+  SudpRxMeta meta;
+  meta.tmstUs  = f.rxUs;
+  meta.utc     = s_utc ? s_utc + (millis() - s_utcMs) / 1000UL : 0;
+  meta.freqMHz = LORA_frequency();
+  meta.sf      = LORA_SF;
+  meta.bwKHz   = LORA_BW_KHZ;
+  meta.crDen   = LORA_CR_DEN;
+  meta.rssi    = f.rssi;
+  meta.snr     = f.snr;
+  SUDP_enqueue(f.data, f.len, meta, millis());
+}
+
+/**
+ * \brief EUI del flag o, si no, MAC[0..2] FF FE MAC[3..5].
+ */
+static void gatewayEui(uint8_t eui[8]) {
+#if defined(PFWD_GATEWAY_EUI)
+  uint64_t v = PFWD_GATEWAY_EUI;
+  for (int i = 7; i >= 0; i--, v >>= 8) eui[i] = (uint8_t)v;
+#else
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  eui[0] = mac[0]; eui[1] = mac[1]; eui[2] = mac[2];
+  eui[3] = 0xFF;   eui[4] = 0xFE;
+  eui[5] = mac[3]; eui[6] = mac[4]; eui[7] = mac[5];
+#endif
+}
+
+bool PF_begin() {
+  if (PFWD_HOST[0] == '\0') return false;
+  uint8_t eui[8];
+  gatewayEui(eui);
+  SUDP_begin(eui, (uint16_t)rp2040.hwrand32());
+  s_reported = SudpStats{};
+  LORA_setRxHook(onFrame);
+  s_started = true;
+  return true;
+}
+
+/**
+ * \brief Vuelca a las métricas lo acumulado desde la última llamada.
+ */
+static void updateMetrics() {
+  const SudpStats& st = SUDP_stats();
+  m_fwdQueued.inc(st.rxFrames - s_reported.rxFrames);
+  m_fwdForwarded.inc(st.fwdFrames - s_reported.fwdFrames);
+  m_fwdDropped.inc(st.dropped - s_reported.dropped);
+  m_fwdRetries.inc(st.retries - s_reported.retries);
+  m_fwdDownlinks.inc(st.downlinks - s_reported.downlinks);
+  s_reported = st;
+  m_fwdQueue.set((float)SUDP_pending());
+  m_fwdOnline.set(SUDP_online() ? 1 : 0);
+}
+
+/**
+ * \brief Hora UTC, socket y DNS bajo demanda; confirmaciones y un datagrama por llamada.
+ */
+void PF_tick() {
+  if (!s_started) return;
+  uint32_t now = millis();
+
+  if (now - s_utcPollMs >= PF_UTC_REFRESH_MS) {
+    s_utcPollMs = now;
+    AidData aid;
+    if (GPS_aidingData(aid)) {
+      s_utc   = aid.utc;
+      s_utcMs = now;
+    }
+  }
+  updateMetrics();
+
+  // Sin salida a la red (AP de configuración o estación caída): la cola espera
+  if (WiFi.status() != WL_CONNECTED) return;
+  if (!s_udpOpen) s_udpOpen = s_udp.begin(PFWD_PORT) == 1;
+  if (!s_resolved) {
+    if (s_resolveMs && now - s_resolveMs < PF_RESOLVE_RETRY_MS) return;
+    s_resolveMs = now;
+    s_resolved  = WiFi.hostByName(PFWD_HOST, s_server) == 1;
+    if (!s_resolved) return;
+  }
+
+  uint8_t in[PF_RX_MAX];
+  while (s_udp.parsePacket() > 0) {
+    int n = s_udp.read(in, sizeof(in));
+    if (n > 0 && s_udp.remoteIP() == s_server) SUDP_receive(in, (size_t)n, now);
+  }
+
+  size_t len = SUDP_poll(now, s_datagram, sizeof(s_datagram));
+  if (len && s_udp.beginPacket(s_server, PFWD_PORT)) {
+    s_udp.write(s_datagram, len);
+    s_udp.endPacket();
+  }
+}
+
+#endif   // PKT_FWD_MODE
@@ -0,0 +1,484 @@
+/** @file rule_engine.cpp
+ * @brief Compilador (descenso recursivo) e intérprete de pila de las reglas de alerta.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "rule_engine.h"
+#include "hot_path.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const VAR_NAMES[RUL_VAR_COUNT] = {
+  "distancia", "velocidad", "edad_fix", "fuera", "rssi", "snr", "hora", "temp", "fallos_tx", "anomalia"
+};
+
+struct RuleUnit {
+  const char* name;
+  float       factor;
+};
+static const RuleUnit UNITS[] = {{"s", 1.0f}, {"min", 60.0f}, {"h", 3600.0f}, {"m", 1.0f}, {"km", 1000.0f}};
+
+// ----------------- Estado interno -----------------------
+static RuleInfo s_rules[RUL_MAX_RULES];
+static uint8_t  s_code[RUL_CODE_POOL];
+static uint8_t  s_count = 0;
+/** Resultado de la compilación en curso: sólo se copia si todo el texto compila. */
+static RuleInfo s_newRules[RUL_MAX_RULES];
+static uint8_t  s_newCode[RUL_CODE_POOL];
+
+void RUL_begin() {
+  s_count = 0;
+}
+
+const char* RUL_varName(RuleVar v) {
+  return v < RUL_VAR_COUNT ? VAR_NAMES[v] : "?";
+}
+
+// ----------------- Compilador -----------------------
+
+/**
+ * \brief Estado del análisis de una línea.
+ */
+struct RuleParser {
+  const char* p;
+  const char* err;       ///< Primer error (nullptr si ninguno).
+  const char* errAt;
+  uint8_t*    code;
+  uint8_t     len;
+  uint8_t     depth;     ///< Profundidad de pila tras lo emitido.
+  uint8_t     paren;
+};
+
+static bool fail(RuleParser& ps, const char* msg) {
+  if (!ps.err) {
+    ps.err   = msg;
+    ps.errAt = ps.p;
+  }
+  return false;
+}
+
+static bool isIdentStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool isIdentChar(char c) {
+  return isIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+static bool atLineEnd(const RuleParser& ps) {
+  return *ps.p == '\0' || *ps.p == '\n';
+}
+
+/**
+ * \brief Salta blancos y el comentario hasta el final de la línea.
+ */
+static void skipSpace(RuleParser& ps) {
+  while (*ps.p == ' ' || *ps.p == '\t' || *ps.p == '\r') ps.p++;
+  if (*ps.p == '#')
+    while (!atLineEnd(ps)) ps.p++;
+}
+
+/**
+ * \brief Longitud del identificador que empieza en \p s (0 si no hay).
+ */
+static size_t identLen(const char* s) {
+  if (!isIdentStart(*s)) return 0;
+  size_t n = 1;
+  while (isIdentChar(s[n])) n++;
+  return n;
+}
+
+/**
+ * \brief Consume \p word si es el identificador completo que viene.
+ */
+static bool acceptWord(RuleParser& ps, const char* word) {
+  skipSpace(ps);
+  size_t n = identLen(ps.p);
+  if (n != strlen(word) || strncmp(ps.p, word, n) != 0) return false;
+  ps.p += n;
+  return true;
+}
+
+/**
+ * \brief Consume el operador \p op (sin confundir `<` con `<=` ni `!` con `!=`).
+ */
+static bool acceptOp(RuleParser& ps, const char* op) {
+  skipSpace(ps);
+  size_t n = strlen(op);
+  if (strncmp(ps.p, op, n) != 0) return false;
+  if (n == 1 && (op[0] == '<' || op[0] == '>' || op[0] == '!') && ps.p[1] == '=') return false;
+  ps.p += n;
+  return true;
+}
+
+static bool emit(RuleParser& ps, uint8_t b) {
+  if (ps.len >= RUL_MAX_CODE) return fail(ps, "regla demasiado larga");
+  ps.code[ps.len++] = b;
+  return true;
+}
+
+static bool pushed(RuleParser& ps) {
+  if (++ps.depth > RUL_STACK) return fail(ps, "expresion demasiado compleja");
+  return true;
+}
+
+/**
+ * \brief Constante con la codificación más corta que la representa exacta.
+ */
+static bool emitConst(RuleParser& ps, float v) {
+  if (v == floorf(v) && v >= -128.0f && v <= 127.0f) {
+    return emit(ps, RUL_OP_I8) && emit(ps, (uint8_t)(int8_t)v) && pushed(ps);
+  }
+  uint8_t b[4];
+  if (v == floorf(v) && v >= -32768.0f && v <= 32767.0f) {
+    int16_t i = (int16_t)v;
+    memcpy(b, &i, 2);
+    return emit(ps, RUL_OP_I16) && emit(ps, b[0]) && emit(ps, b[1]) && pushed(ps);
+  }
+  memcpy(b, &v, 4);
+  return emit(ps, RUL_OP_F32) && emit(ps, b[0]) && emit(ps, b[1]) && emit(ps, b[2]) &&
+         emit(ps, b[3]) && pushed(ps);
+}
+
+/**
+ * \brief Palabras reservadas (no pueden ser una unidad tras un número).
+ */
+static bool isKeyword(const char* s, size_t n) {
+  static const char* const WORDS[] = {"y", "o", "no", "durante"};
+  for (const char* w : WORDS)
+    if (strlen(w) == n && strncmp(s, w, n) == 0) return true;
+  return false;
+}
+
+/**
+ * \brief Número con unidad opcional (pegada o tras un espacio), ya convertido a segundos o metros.
+ */
+static bool parseNumber(RuleParser& ps, float& out) {
+  skipSpace(ps);
+  if (!((*ps.p >= '0' && *ps.p <= '9') || *ps.p == '.')) return fail(ps, "se esperaba un numero");
+  char* end;
+  double v = strtod(ps.p, &end);
+  if (end == ps.p) return fail(ps, "se esperaba un numero");
+  ps.p = end;
+  const char* afterNumber = ps.p;
+  skipSpace(ps);
+  size_t n = identLen(ps.p);
+  if (isKeyword(ps.p, n)) {
+    ps.p = afterNumber;
+  } else if (n) {
+    size_t u = 0;
+    while (u < sizeof(UNITS) / sizeof(UNITS[0]) &&
+           !(strlen(UNITS[u].name) == n && strncmp(ps.p, UNITS[u].name, n) == 0)) u++;
+    if (u == sizeof(UNITS) / sizeof(UNITS[0])) return fail(ps, "unidad desconocida (s, min, h, m, km)");
+    v *= UNITS[u].factor;
+    ps.p += n;
+  }
+  if (!(fabs(v) < 1e9)) return fail(ps, "numero fuera de rango");
+  out = (float)v;
+  return true;
+}
+
+static bool parseOr(RuleParser& ps);
+
+static bool parsePrimary(RuleParser& ps) {
+  skipSpace(ps);
+  if (acceptOp(ps, "(")) {
+    if (++ps.paren > RUL_MAX_PAREN) return fail(ps, "demasiados parentesis anidados");
+    if (!parseOr(ps)) return false;
+    if (!acceptOp(ps, ")")) return fail(ps, "falta ')'");
+    ps.paren--;
+    return true;
+  }
+  size_t n = identLen(ps.p);
+  if (n) {
+    for (uint8_t v = 0; v < RUL_VAR_COUNT; v++) {
+      if (strlen(VAR_NAMES[v]) == n && strncmp(ps.p, VAR_NAMES[v], n) == 0) {
+        ps.p += n;
+        return emit(ps, RUL_OP_LOAD) && emit(ps, v) && pushed(ps);
+      }
+    }
+    return fail(ps, "variable desconocida");
+  }
+  float v;
+  return parseNumber(ps, v) && emitConst(ps, v);
+}
+
+/**
+ * \brief Emite `n` veces el operador unario `op` tras su operando.
+ */
+static bool emitRepeated(RuleParser& ps, uint8_t op, uint8_t n) {
+  while (n--)
+    if (!emit(ps, op)) return false;
+  return true;
+}
+
+/**
+ * \brief Signo; delante de un número se pliega en la constante (`rssi < -110`).
+ *
+ * Los signos seguidos se cuentan en un bucle en vez de recursión, para que
+ * una regla como `- - - ... x` no agote la pila; pasado RUL_MAX_CODE no
+ * cabrían en el bytecode de todos modos.
+ */
+static bool parseUnary(RuleParser& ps) {
+  uint8_t negs = 0;
+  while (acceptOp(ps, "-")) {
+    if (++negs > RUL_MAX_CODE) return fail(ps, "demasiados operadores unarios seguidos");
+    skipSpace(ps);
+    float v;
+    if ((*ps.p >= '0' && *ps.p <= '9') || *ps.p == '.')
+      return parseNumber(ps, v) && emitConst(ps, -v) && emitRepeated(ps, RUL_OP_NEG, negs - 1);
+  }
+  return parsePrimary(ps) && emitRepeated(ps, RUL_OP_NEG, negs);
+}
+
+static bool parseMul(RuleParser& ps) {
+  if (!parseUnary(ps)) return false;
+  for (;;) {
+    uint8_t op;
+    if (acceptOp(ps, "*")) op = RUL_OP_MUL;
+    else if (acceptOp(ps, "/")) op = RUL_OP_DIV;
+    else return true;
+    if (!parseUnary(ps) || !emit(ps, op)) return false;
+    ps.depth--;
+  }
+}
+
+static bool parseAdd(RuleParser& ps) {
+  if (!parseMul(ps)) return false;
+  for (;;) {
+    uint8_t op;
+    if (acceptOp(ps, "+")) op = RUL_OP_ADD;
+    else if (acceptOp(ps, "-")) op = RUL_OP_SUB;
+    else return true;
+    if (!parseMul(ps) || !emit(ps, op)) return false;
+    ps.depth--;
+  }
+}
+
+/**
+ * \brief Una comparación como mucho (`a < b < c` no tiene sentido aquí).
+ */
+static bool parseCmp(RuleParser& ps) {
+  if (!parseAdd(ps)) return false;
+  static const struct { const char* text; uint8_t op; } CMPS[] = {
+    {"<=", RUL_OP_LE}, {">=", RUL_OP_GE}, {"==", RUL_OP_EQ}, {"!=", RUL_OP_NE},
+    {"<", RUL_OP_LT}, {">", RUL_OP_GT}
+  };
+  for (const auto& c : CMPS) {
+    if (!acceptOp(ps, c.text)) continue;
+    if (!parseAdd(ps) || !emit(ps, c.op)) return false;
+    ps.depth--;
+    return true;
+  }
+  return true;
+}
+
+static bool parseNot(RuleParser& ps) {
+  uint8_t nots = 0;
+  while (acceptOp(ps, "!") || acceptWord(ps, "no"))
+    if (++nots > RUL_MAX_CODE) return fail(ps, "demasiados operadores unarios seguidos");
+  return parseCmp(ps) && emitRepeated(ps, RUL_OP_NOT, nots);
+}
+
+static bool parseAnd(RuleParser& ps) {
+  if (!parseNot(ps)) return false;
+  while (acceptOp(ps, "&&") || acceptWord(ps, "y")) {
+    if (!parseNot(ps) || !emit(ps, RUL_OP_AND)) return false;
+    ps.depth--;
+  }
+  return true;
+}
+
+static bool parseOr(RuleParser& ps) {
+  if (!parseAnd(ps)) return false;
+  while (acceptOp(ps, "||") || acceptWord(ps, "o")) {
+    if (!parseAnd(ps) || !emit(ps, RUL_OP_OR)) return false;
+    ps.depth--;
+  }
+  return true;
+}
+
+/**
+ * \brief `nombre: expresión [durante N]` en s_newRules[count].
+ */
+static bool parseRule(RuleParser& ps, uint8_t count, uint16_t& used) {
+  if (count >= RUL_MAX_RULES) return fail(ps, "demasiadas reglas");
+  RuleInfo& r = s_newRules[count];
+  memset(&r, 0, sizeof(r));
+  size_t n = identLen(ps.p);
+  if (!n) return fail(ps, "se esperaba el nombre de la regla");
+  if (n >= RUL_NAME_LEN) return fail(ps, "nombre demasiado largo");
+  memcpy(r.name, ps.p, n);
+  for (uint8_t i = 0; i < count; i++)
+    if (strcmp(s_newRules[i].name, r.name) == 0) return fail(ps, "nombre repetido");
+  ps.p += n;
+  if (!acceptOp(ps, ":")) return fail(ps, "falta ':' tras el nombre");
+
+  uint8_t code[RUL_MAX_CODE];
+  ps.code  = code;
+  ps.len   = 0;
+  ps.depth = 0;
+  ps.paren = 0;
+  if (!parseOr(ps)) return false;
+  if (acceptWord(ps, "durante")) {
+    float hold;
+    if (!parseNumber(ps, hold)) return false;
+    r.holdS = (uint32_t)lroundf(hold);
+  }
+  skipSpace(ps);
+  if (!atLineEnd(ps)) return fail(ps, "texto inesperado");
+  if (used + ps.len > RUL_CODE_POOL) return fail(ps, "sin espacio para mas reglas");
+  memcpy(&s_newCode[used], code, ps.len);
+  r.codeOff = used;
+  r.codeLen = ps.len;
+  used += ps.len;
+  return true;
+}
+
+/**
+ * \brief Línea a línea; al terminar conserva el estado de las reglas que no cambian.
+ */
+bool RUL_compile(const char* src, RuleError& err) {
+  err = RuleError{0, 0, nullptr};
+  uint8_t  count = 0;
+  uint16_t used  = 0;
+  uint16_t line  = 1;
+  const char* p  = src ? src : "";
+  while (*p) {
+    RuleParser ps{};
+    ps.p = p;
+    skipSpace(ps);
+    if (!atLineEnd(ps)) {
+      if (!parseRule(ps, count, used)) {
+        err.line = line;
+        size_t col = (size_t)(ps.errAt - p) + 1;
+        err.col  = col < RUL_COL_MAX ? (uint16_t)col : RUL_COL_MAX;
+        err.msg  = ps.err;
+        return false;
+      }
+      count++;
+    }
+    while (!atLineEnd(ps)) ps.p++;
+    p = *ps.p ? ps.p + 1 : ps.p;
+    line++;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    RuleInfo& r = s_newRules[i];
+    for (uint8_t j = 0; j < s_count; j++) {
+      const RuleInfo& o = s_rules[j];
+      if (strcmp(o.name, r.name) != 0 || o.holdS != r.holdS || o.codeLen != r.codeLen ||
+          memcmp(&s_code[o.codeOff], &s_newCode[r.codeOff], r.codeLen) != 0) continue;
+      r.active    = o.active;
+      r.pending   = o.pending;
+      r.sinceS    = o.sinceS;
+      r.fires     = o.fires;
+      r.lastFireS = o.lastFireS;
+    }
+  }
+  memcpy(s_rules, s_newRules, count * sizeof(RuleInfo));
+  memcpy(s_code, s_newCode, used);
+  s_count = count;
+  return true;
+}
+
+uint8_t RUL_count() {
+  return s_count;
+}
+
+const RuleInfo& RUL_info(uint8_t i) {
+  return s_rules[i < s_count ? i : 0];
+}
+
+const uint8_t* RUL_code(uint8_t i) {
+  return &s_code[RUL_info(i).codeOff];
+}
+
+// ----------------- Intérprete -----------------------
+
+static inline bool truthy(float v) {
+  return v != 0.0f && !isnan(v);
+}
+
+/**
+ * \brief Ejecuta un bytecode generado por RUL_compile() (pila y longitud ya acotadas).
+ */
+static float HOT_FUNC(run)(const uint8_t* c, uint8_t len, const float* vars) {
+  float   st[RUL_STACK];
+  uint8_t sp = 0, pc = 0;
+  while (pc < len) {
+    switch (c[pc++]) {
+      case RUL_OP_LOAD: st[sp++] = vars[c[pc++]]; break;
+      case RUL_OP_I8:   st[sp++] = (float)(int8_t)c[pc++]; break;
+      case RUL_OP_I16: {
+        int16_t v;
+        memcpy(&v, &c[pc], 2);
+        pc += 2;
+        st[sp++] = (float)v;
+        break;
+      }
+      case RUL_OP_F32: {
+        float v;
+        memcpy(&v, &c[pc], 4);
+        pc += 4;
+        st[sp++] = v;
+        break;
+      }
+      case RUL_OP_NEG: st[sp - 1] = -st[sp - 1]; break;
+      case RUL_OP_NOT: st[sp - 1] = truthy(st[sp - 1]) ? 0.0f : 1.0f; break;
+      default: {
+        float b = st[--sp], a = st[sp - 1];
+        float r;
+        switch (c[pc - 1]) {
+          case RUL_OP_ADD: r = a + b; break;
+          case RUL_OP_SUB: r = a - b; break;
+          case RUL_OP_MUL: r = a * b; break;
+          case RUL_OP_DIV: r = a / b; break;
+          case RUL_OP_LT:  r = a < b; break;
+          case RUL_OP_LE:  r = a <= b; break;
+          case RUL_OP_GT:  r = a > b; break;
+          case RUL_OP_GE:  r = a >= b; break;
+          case RUL_OP_EQ:  r = a == b; break;
+          case RUL_OP_NE:  r = a != b && !isnan(a) && !isnan(b); break;   // NaN: falso también aquí
+          case RUL_OP_AND: r = truthy(a) && truthy(b); break;
+          default:         r = truthy(a) || truthy(b); break;             // RUL_OP_OR
+        }
+        st[sp - 1] = r;
+      }
+    }
+  }
+  return sp ? st[0] : NAN;
+}
+
+float RUL_value(uint8_t i, const float vars[RUL_VAR_COUNT]) {
+  if (i >= s_count) return NAN;
+  return run(&s_code[s_rules[i].codeOff], s_rules[i].codeLen, vars);
+}
+
+size_t HOT_FUNC(RUL_evaluate)(const float vars[RUL_VAR_COUNT], uint32_t nowS, uint8_t* fired, size_t maxFired) {
+  size_t n = 0;
+  for (uint8_t i = 0; i < s_count; i++) {
+    RuleInfo& r = s_rules[i];
+    if (!truthy(run(&s_code[r.codeOff], r.codeLen, vars))) {
+      r.active  = false;
+      r.pending = false;
+      continue;
+    }
+    if (r.active) continue;
+    if (!r.pending) {
+      r.pending = true;
+      r.sinceS  = nowS;
+    }
+    if (nowS - r.sinceS < r.holdS) continue;
+    r.active    = true;
+    r.pending   = false;
+    r.fires++;
+    r.lastFireS = nowS;
+    if (fired && n < maxFired) fired[n] = i;
+    n++;
+  }
+  return n;
+}
@@ -0,0 +1,37 @@
+/** @file rx_decoder.cpp
+ * @brief Implementación de la validación y decodificación de tramas LoRa recibidas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "rx_decoder.h"
+
+/**
+ * \brief Longitudes ≤0 se descartan; mayores que el buffer se recortan.
+ */
+size_t RX_clampLength(int32_t reported, size_t maxLen) {
+  if (reported <= 0) return 0;
+  if ((size_t)reported > maxLen) return maxLen;
+  return (size_t)reported;
+}
+
+/**
+ * \brief Payload GNSS de 13 B con fix=1 y posición/hora en rango, trama de salud
+ *        o alerta de valla.
+ */
+RxResult RX_decodeFrame(const uint8_t* buf, size_t len, GpsInfo& out, HealthFrame* health, GeoAlert* alert) {
+  if (buf && health && len == HLT_FRAME_LEN) {
+    return HLT_parseFrame(buf, len, *health) ? RX_HEALTH : RX_BAD_FORMAT;
+  }
+  if (buf && alert && len == GEO_ALERT_LEN) {
+    return GEO_parseAlert(buf, len, *alert) ? RX_GEO_ALERT : RX_BAD_FORMAT;
+  }
+  if (!buf || len != 13) return RX_BAD_LENGTH;
+  if (buf[0] != 1) return RX_BAD_FORMAT;
+
+  GpsInfo gi{};
+  if (!GPS_parsePayload(buf, len, gi) || !GPS_isPlausible(gi)) return RX_BAD_FORMAT;
+  out = gi;
+  return RX_POSITION;
+}
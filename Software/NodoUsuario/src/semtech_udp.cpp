@@ -0,0 +1,275 @@
+/** @file semtech_udp.cpp
+ * @brief Implementación del protocolo UDP de Semtech: cola, lotes, reintentos y JSON.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "semtech_udp.h"
+#include "gnss_aiding.h"
+#include <stdio.h>
+#include <string.h>
+
+// ----------------- Formato -----------------------
+static const size_t SUDP_HEADER_LEN  = 12;    // versión + token + tipo + EUI
+static const size_t SUDP_ACK_LEN     = 4;
+static const size_t SUDP_RXPK_MAX    = 320;   // una `rxpk` con una trama de 64 B
+static const char   SUDP_RXPK_OPEN[] = "{\"rxpk\":[";
+static const char   SUDP_RXPK_CLOSE[] = "]}";
+
+/**
+ * \brief Trama en cola con sus metadatos e instante de llegada.
+ */
+struct SudpSlot {
+  SudpRxMeta meta;
+  uint32_t   queuedMs;
+  uint8_t    len;
+  uint8_t    data[SUDP_MAX_FRAME];
+};
+
+// ----------------- Estado interno -----------------------
+static SudpSlot  s_queue[SUDP_QUEUE_LEN];
+static size_t    s_head      = 0;
+static size_t    s_count     = 0;
+static size_t    s_inflight  = 0;       // tramas del lote en vuelo (desde s_head)
+static bool      s_waiting   = false;   // PUSH_DATA sin confirmar
+static uint16_t  s_pushToken = 0;
+static uint16_t  s_token     = 0;
+static uint32_t  s_sentMs    = 0;
+static uint32_t  s_retryMs   = SUDP_ACK_TIMEOUT_MS;
+static bool      s_online    = false;
+static bool      s_pullSent  = false;
+static uint32_t  s_lastPullMs = 0;
+static uint32_t  s_lastStatMs = 0;
+static uint32_t  s_lastUtc   = 0;       // última hora conocida y su instante
+static uint32_t  s_lastUtcMs = 0;
+static uint8_t   s_eui[8];
+static SudpStats s_stats;
+static SudpStats s_statBase;            // contadores al emitir el último `stat`
+
+/**
+ * \brief Cabecera común: versión, token (little-endian) y tipo; EUI si \p withEui.
+ */
+static size_t writeHeader(uint8_t* out, uint16_t token, SudpType type, bool withEui) {
+  out[0] = SUDP_VERSION;
+  out[1] = (uint8_t)(token & 0xFF);
+  out[2] = (uint8_t)(token >> 8);
+  out[3] = type;
+  if (!withEui) return SUDP_ACK_LEN;
+  memcpy(&out[4], s_eui, sizeof(s_eui));
+  return SUDP_HEADER_LEN;
+}
+
+void SUDP_begin(const uint8_t eui[8], uint16_t seed) {
+  memcpy(s_eui, eui, sizeof(s_eui));
+  s_head = s_count = s_inflight = 0;
+  s_waiting    = false;
+  s_token      = seed;
+  s_retryMs    = SUDP_ACK_TIMEOUT_MS;
+  s_online     = false;
+  s_pullSent   = false;
+  s_lastStatMs = 0;
+  s_lastUtc    = 0;
+  s_stats      = SudpStats{};
+  s_statBase   = SudpStats{};
+}
+
+/**
+ * \brief Copia de tamaño fijo en la cola; si está llena, descarta la más antigua.
+ */
+bool SUDP_enqueue(const uint8_t* data, size_t len, const SudpRxMeta& meta, uint32_t nowMs) {
+  if (!data || len == 0 || len > SUDP_MAX_FRAME) return false;
+  bool room = s_count < SUDP_QUEUE_LEN;
+  if (!room) {
+    s_head = (s_head + 1) % SUDP_QUEUE_LEN;
+    s_count--;
+    if (s_inflight) s_inflight--;
+    s_stats.dropped++;
+  }
+  SudpSlot& s = s_queue[(s_head + s_count) % SUDP_QUEUE_LEN];
+  s.meta     = meta;
+  s.queuedMs = nowMs;
+  s.len      = (uint8_t)len;
+  memcpy(s.data, data, len);
+  s_count++;
+  s_stats.rxFrames++;
+  if (meta.utc) {
+    s_lastUtc   = meta.utc;
+    s_lastUtcMs = nowMs;
+  }
+  return room;
+}
+
+/**
+ * \brief Tabla estándar (RFC 4648) con relleno '='.
+ */
+size_t SUDP_base64(const uint8_t* in, size_t len, char* out, size_t outSize) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t need = (len + 2) / 3 * 4;
+  if (!out || need + 1 > outSize) return 0;
+  size_t o = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < len) v |= in[i + 2];
+    out[o++] = ALPHABET[(v >> 18) & 0x3F];
+    out[o++] = ALPHABET[(v >> 12) & 0x3F];
+    out[o++] = i + 1 < len ? ALPHABET[(v >> 6) & 0x3F] : '=';
+    out[o++] = i + 2 < len ? ALPHABET[v & 0x3F] : '=';
+  }
+  out[o] = '\0';
+  return o;
+}
+
+/**
+ * \brief Un objeto `rxpk` (sin `time` si no hay hora).
+ */
+static size_t formatRxpk(const SudpSlot& s, char* out, size_t outSize) {
+  char b64[(SUDP_MAX_FRAME + 2) / 3 * 4 + 1];
+  SUDP_base64(s.data, s.len, b64, sizeof(b64));
+  const SudpRxMeta& m = s.meta;
+
+  char timeField[40] = "";
+  if (m.utc) {
+    AidDate d = AID_dateFromUtc(m.utc);
+    snprintf(timeField, sizeof(timeField), "\"time\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\",",
+             d.year, d.month, d.day, d.hour, d.minute, d.second);
+  }
+  int n = snprintf(out, outSize,
+                   "{\"tmst\":%lu,%s\"chan\":0,\"rfch\":0,\"freq\":%.6f,\"stat\":1,\"modu\":\"LORA\","
+                   "\"datr\":\"SF%uBW%u\",\"codr\":\"4/%u\",\"rssi\":%d,\"lsnr\":%.1f,\"size\":%u,\"data\":\"%s\"}",
+                   (unsigned long)m.tmstUs, timeField, (double)m.freqMHz, m.sf, m.bwKHz, m.crDen,
+                   (int)(m.rssi < 0 ? m.rssi - 0.5f : m.rssi + 0.5f), (double)m.snr, s.len, b64);
+  return (n > 0 && (size_t)n < outSize) ? (size_t)n : 0;
+}
+
+/**
+ * \brief PUSH_DATA con tantas tramas desde la cabeza de la cola como quepan.
+ */
+static size_t buildBatch(uint32_t nowMs, uint8_t* out, size_t outSize) {
+  if (outSize < SUDP_HEADER_LEN + sizeof(SUDP_RXPK_OPEN) + sizeof(SUDP_RXPK_CLOSE)) return 0;
+  uint16_t token = ++s_token;
+  size_t pos = writeHeader(out, token, SUDP_PUSH_DATA, true);
+  memcpy(&out[pos], SUDP_RXPK_OPEN, sizeof(SUDP_RXPK_OPEN) - 1);
+  pos += sizeof(SUDP_RXPK_OPEN) - 1;
+
+  size_t n = 0;
+  char rxpk[SUDP_RXPK_MAX];
+  while (n < s_count && n < SUDP_BATCH_MAX) {
+    size_t len = formatRxpk(s_queue[(s_head + n) % SUDP_QUEUE_LEN], rxpk, sizeof(rxpk));
+    size_t sep = n ? 1 : 0;
+    if (!len || pos + sep + len + sizeof(SUDP_RXPK_CLOSE) - 1 > outSize) break;
+    if (sep) out[pos++] = ',';
+    memcpy(&out[pos], rxpk, len);
+    pos += len;
+    n++;
+  }
+  if (n == 0) return 0;
+  memcpy(&out[pos], SUDP_RXPK_CLOSE, sizeof(SUDP_RXPK_CLOSE) - 1);
+  pos += sizeof(SUDP_RXPK_CLOSE) - 1;
+
+  s_inflight  = n;
+  s_pushToken = token;
+  s_waiting   = true;
+  s_sentMs    = nowMs;
+  s_stats.pushSent++;
+  return pos;
+}
+
+/**
+ * \brief PUSH_DATA con el objeto `stat` del último intervalo.
+ */
+static size_t buildStat(uint32_t nowMs, uint8_t* out, size_t outSize) {
+  size_t pos = writeHeader(out, ++s_token, SUDP_PUSH_DATA, true);
+  char timeField[40] = "";
+  if (s_lastUtc) {
+    AidDate d = AID_dateFromUtc(s_lastUtc + (nowMs - s_lastUtcMs) / 1000UL);
+    snprintf(timeField, sizeof(timeField), "\"time\":\"%04u-%02u-%02u %02u:%02u:%02u GMT\",",
+             d.year, d.month, d.day, d.hour, d.minute, d.second);
+  }
+  uint32_t rx   = s_stats.rxFrames - s_statBase.rxFrames;
+  uint32_t fw   = s_stats.fwdFrames - s_statBase.fwdFrames;
+  uint32_t sent = s_stats.pushSent - s_statBase.pushSent;
+  uint32_t ack  = s_stats.pushAcked - s_statBase.pushAcked;
+  uint32_t dn   = s_stats.downlinks - s_statBase.downlinks;
+  float ackr = sent ? 100.0f * ack / sent : 0.0f;
+  int n = snprintf((char*)&out[pos], outSize - pos,
+                   "{\"stat\":{%s\"rxnb\":%lu,\"rxok\":%lu,\"rxfw\":%lu,\"ackr\":%.1f,\"dwnb\":%lu,\"txnb\":0}}",
+                   timeField, (unsigned long)rx, (unsigned long)rx, (unsigned long)fw, (double)ackr,
+                   (unsigned long)dn);
+  if (n <= 0 || pos + (size_t)n >= outSize) return 0;
+  s_statBase = s_stats;
+  return pos + (size_t)n;
+}
+
+/**
+ * \brief Reintento, lote nuevo, keepalive o estadística (uno por llamada).
+ */
+size_t SUDP_poll(uint32_t nowMs, uint8_t* out, size_t outSize) {
+  if (!out || outSize < SUDP_HEADER_LEN) return 0;
+
+  if (s_waiting && nowMs - s_sentMs >= s_retryMs) {
+    // Sin PUSH_ACK: se rehace el lote desde la cabeza (puede traer tramas nuevas)
+    s_online  = false;
+    s_waiting = false;
+    s_inflight = 0;
+    s_retryMs = s_retryMs * 2 > SUDP_RETRY_MAX_MS ? SUDP_RETRY_MAX_MS : s_retryMs * 2;
+    s_stats.retries++;
+    if (s_count) return buildBatch(nowMs, out, outSize);
+  }
+
+  if (!s_waiting && s_count &&
+      (s_count >= SUDP_BATCH_MAX || nowMs - s_queue[s_head].queuedMs >= SUDP_BATCH_WINDOW_MS)) {
+    size_t len = buildBatch(nowMs, out, outSize);
+    if (len) return len;
+  }
+
+  if (!s_pullSent || nowMs - s_lastPullMs >= SUDP_KEEPALIVE_MS) {
+    s_pullSent   = true;
+    s_lastPullMs = nowMs;
+    return writeHeader(out, ++s_token, SUDP_PULL_DATA, true);
+  }
+
+  if (nowMs - s_lastStatMs >= SUDP_STAT_MS) {
+    s_lastStatMs = nowMs;
+    return buildStat(nowMs, out, outSize);
+  }
+  return 0;
+}
+
+/**
+ * \brief Confirmaciones y bajadas; el resto de tipos sólo se identifica.
+ */
+SudpType SUDP_receive(const uint8_t* buf, size_t len, uint32_t) {
+  if (!buf || len < SUDP_ACK_LEN || buf[0] != SUDP_VERSION || buf[3] > SUDP_TX_ACK) return SUDP_INVALID;
+  SudpType type = (SudpType)buf[3];
+  uint16_t token = (uint16_t)(buf[1] | (buf[2] << 8));
+
+  if (type == SUDP_PUSH_ACK && s_waiting && token == s_pushToken) {
+    s_head  = (s_head + s_inflight) % SUDP_QUEUE_LEN;
+    s_count -= s_inflight;
+    s_stats.fwdFrames += s_inflight;
+    s_stats.pushAcked++;
+    s_inflight = 0;
+    s_waiting  = false;
+    s_online   = true;
+    s_retryMs  = SUDP_ACK_TIMEOUT_MS;
+  } else if (type == SUDP_PULL_ACK) {
+    s_stats.pullAcked++;
+  } else if (type == SUDP_PULL_RESP) {
+    s_stats.downlinks++;
+  }
+  return type;
+}
+
+size_t SUDP_pending() {
+  return s_count;
+}
+
+bool SUDP_online() {
+  return s_online;
+}
+
+const SudpStats& SUDP_stats() {
+  return s_stats;
+}
@@ -0,0 +1,318 @@
+/** @file supervisor.cpp
+ * @brief Implementación del supervisor de latencia y del registro de bloqueos.
+ *
+ * Registros scratch del watchdog (el SDK sólo usa los 4..7):
+ * - scratch[0]: `SUP_TAG_MAGIC | tarea` de la tarea más interna abierta
+ *   (`SUP_TAG_IDLE` entre tareas).
+ * - scratch[1]: millis() de entrada en esa tarea.
+ * - scratch[2]: millis() de la última alimentación del watchdog.
+ *
+ * El presupuesto se compara con el tiempo propio de la tarea (sin las tareas
+ * anidadas, que tienen el suyo). Un exceso se anota en `/stall.log` con una
+ * copia de la traza al salir de la tarea más externa, fuera de cualquier
+ * tarea, y como mucho una línea cada SUP_VIOL_LOG_GAP_MS (las demás se cuentan
+ * en la siguiente línea).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "supervisor.h"
+#include "metrics.h"
+#include <LittleFS.h>
+#include "hardware/watchdog.h"
+
+// ----------------- Configuración -----------------------
+static const char*    STALL_LOG      = "/stall.log";
+static const char*    STALL_LOG_OLD  = "/stall.old";
+static const size_t   STALL_LOG_MAX  = 4096;       // se rota al superarlo
+static const uint8_t  SUP_TRACE_LEN  = 16;
+static const uint32_t SUP_TAG_MAGIC  = 0x5A7C0000UL;
+static const uint32_t SUP_TAG_IDLE   = SUP_TAG_MAGIC | 0xFFU;
+static const uint32_t SUP_TRACE_MAGIC = 0x7EACE5A7UL;
+static const uint8_t  SUP_MAX_DEPTH  = 8;
+static const uint32_t SUP_VIOL_LOG_GAP_MS = 60000UL;   // desgaste de la flash
+
+/** Presupuesto de latencia por tarea (ms). */
+static const uint16_t SUP_BUDGET_MS[SUP_TASK_COUNT] = {500, 50, 100, 200, 20, 3000};
+static const char*    SUP_NAMES[SUP_TASK_COUNT]     = {"http", "radio", "survey", "wifi", "gnss", "scan"};
+
+// ----------------- Métricas -----------------------------
+METRIC_COUNTER_L(m_violHttp,   "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"http\"");
+METRIC_COUNTER_L(m_violRadio,  "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"radio\"");
+METRIC_COUNTER_L(m_violSurvey, "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"survey\"");
+METRIC_COUNTER_L(m_violWifi,   "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"wifi\"");
+METRIC_COUNTER_L(m_violGnss,   "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"gnss\"");
+METRIC_COUNTER_L(m_violScan,   "sup_budget_violations_total", "Ejecuciones por encima del presupuesto por tarea", "task=\"scan\"");
+METRIC_GAUGE_L(m_maxHttp,   "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"http\"");
+METRIC_GAUGE_L(m_maxRadio,  "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"radio\"");
+METRIC_GAUGE_L(m_maxSurvey, "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"survey\"");
+METRIC_GAUGE_L(m_maxWifi,   "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"wifi\"");
+METRIC_GAUGE_L(m_maxGnss,   "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"gnss\"");
+METRIC_GAUGE_L(m_maxScan,   "sup_task_max_ms", "Duración máxima observada por tarea (ms)", "task=\"scan\"");
+METRIC_GAUGE(m_stalled, "sup_watchdog_reset", "1 si el último reinicio lo provocó el watchdog del supervisor");
+METRIC_GAUGE(m_stallEntries, "sup_stall_log_entries", "Bloqueos y excesos de presupuesto registrados en /stall.log");
+METRIC_COUNTER(m_violDropped, "sup_budget_log_skipped_total", "Excesos de presupuesto no escritos en /stall.log (límite de ritmo)");
+
+static MetricCounter* const VIOL_COUNTERS[SUP_TASK_COUNT] = {&m_violHttp, &m_violRadio, &m_violSurvey, &m_violWifi, &m_violGnss, &m_violScan};
+static MetricGauge*   const MAX_GAUGES[SUP_TASK_COUNT]    = {&m_maxHttp, &m_maxRadio, &m_maxSurvey, &m_maxWifi, &m_maxGnss, &m_maxScan};
+
+// ----------------- Estado interno -----------------------
+/** Tramo cerrado de una tarea. */
+struct SupSpan {
+  uint8_t  task;
+  uint8_t  depth;     // nivel de anidamiento (0 = desde loop())
+  uint16_t durMs;     // saturado a 65535
+  uint32_t startMs;
+};
+
+/** Traza circular; vive en RAM no inicializada para sobrevivir al reset. */
+struct SupTrace {
+  uint32_t magic;
+  uint32_t head;
+  SupSpan  spans[SUP_TRACE_LEN];
+};
+static SupTrace __uninitialized_ram(s_trace);
+
+static uint32_t s_violations[SUP_TASK_COUNT];
+static uint32_t s_maxMs[SUP_TASK_COUNT];
+static uint32_t s_childMs[SUP_MAX_DEPTH + 1];   // tiempo de las tareas anidadas por nivel
+static uint8_t  s_depth = 0;
+static bool     s_armed = false;
+static uint32_t s_entries = 0;
+
+/** Exceso pendiente de escribir (el primero desde la última línea). */
+struct SupViolation {
+  bool     pending;
+  uint8_t  task;
+  uint32_t startMs;
+  uint32_t durMs;
+  uint32_t skipped;    // excesos posteriores sin línea propia
+  uint32_t lastLogMs;
+  SupTrace trace;
+};
+static SupViolation s_viol;
+
+// Registro recuperado en SUP_begin()
+static bool     s_stalled = false;
+static uint32_t s_stallTag, s_stallStartMs, s_stallFeedMs;
+static SupTrace s_stallTrace;
+
+/**
+ * \brief Nombre de la tarea codificada en un tag de scratch.
+ */
+static const char* tagName(uint32_t tag) {
+  uint8_t t = tag & 0xFFU;
+  return t < SUP_TASK_COUNT ? SUP_NAMES[t] : "loop";
+}
+
+/**
+ * \brief Copia el registro del arranque anterior antes de que setup() lo pise.
+ */
+void SUP_begin() {
+  s_stalled = watchdog_enable_caused_reboot() &&
+              (watchdog_hw->scratch[0] & 0xFFFF0000UL) == SUP_TAG_MAGIC;
+  if (s_stalled) {
+    s_stallTag     = watchdog_hw->scratch[0];
+    s_stallStartMs = watchdog_hw->scratch[1];
+    s_stallFeedMs  = watchdog_hw->scratch[2];
+    s_stallTrace   = s_trace;
+  }
+  m_stalled.set(s_stalled ? 1 : 0);
+
+  s_trace.magic = SUP_TRACE_MAGIC;
+  s_trace.head  = 0;
+  memset(s_trace.spans, 0, sizeof(s_trace.spans));
+  watchdog_hw->scratch[0] = SUP_TAG_IDLE;
+  watchdog_hw->scratch[1] = 0;
+  watchdog_hw->scratch[2] = 0;
+}
+
+/**
+ * \brief Abre `/stall.log` para añadir, rotándolo si ha crecido demasiado.
+ */
+static File openStallLog() {
+  File f = LittleFS.open(STALL_LOG, "r");
+  if (f && f.size() > STALL_LOG_MAX) {
+    f.close();
+    LittleFS.remove(STALL_LOG_OLD);
+    LittleFS.rename(STALL_LOG, STALL_LOG_OLD);
+  } else if (f) {
+    f.close();
+  }
+  return LittleFS.open(STALL_LOG, "a");
+}
+
+/**
+ * \brief Escribe `traza=...` (más antigua primero) y cierra la línea.
+ */
+static void printTrace(File& f, const SupTrace& trace) {
+  f.print("traza=");
+  if (trace.magic == SUP_TRACE_MAGIC) {
+    const char* sep = "";
+    for (uint8_t i = 0; i < SUP_TRACE_LEN; i++) {
+      const SupSpan& sp = trace.spans[(trace.head + i) % SUP_TRACE_LEN];
+      if (sp.task >= SUP_TASK_COUNT || sp.startMs == 0) continue;
+      f.printf("%s%s@%lu+%u", sep, SUP_NAMES[sp.task], (unsigned long)sp.startMs, (unsigned)sp.durMs);
+      sep = ",";
+    }
+  }
+  f.print('\n');
+}
+
+/**
+ * \brief Una línea `STALL ...` con la tarea colgada y la traza del arranque anterior.
+ */
+static void appendStallLog() {
+  File f = openStallLog();
+  if (!f) return;
+  f.printf("STALL task=%s entrada_ms=%lu ultimo_feed_ms=%lu ", tagName(s_stallTag),
+           (unsigned long)s_stallStartMs, (unsigned long)s_stallFeedMs);
+  printTrace(f, s_stallTrace);
+  f.close();
+}
+
+/**
+ * \brief Una línea `BUDGET ...` con el exceso pendiente y la traza en ese momento.
+ */
+static void appendViolationLog() {
+  File f = openStallLog();
+  if (!f) return;
+  f.printf("BUDGET task=%s entrada_ms=%lu dur_ms=%lu presup_ms=%u omitidos=%lu ",
+           SUP_NAMES[s_viol.task], (unsigned long)s_viol.startMs, (unsigned long)s_viol.durMs,
+           (unsigned)SUP_BUDGET_MS[s_viol.task], (unsigned long)s_viol.skipped);
+  printTrace(f, s_viol.trace);
+  f.close();
+  m_stallEntries.set((float)++s_entries);
+}
+
+/**
+ * \brief Cuenta las entradas del registro (una por línea).
+ */
+static uint32_t countStallEntries() {
+  File f = LittleFS.open(STALL_LOG, "r");
+  if (!f) return 0;
+  uint32_t n = 0;
+  while (f.available()) {
+    if (f.read() == '\n') n++;
+  }
+  f.close();
+  return n;
+}
+
+/**
+ * \brief Vuelca el registro recuperado y arranca el watchdog.
+ */
+void SUP_arm() {
+  if (s_stalled) appendStallLog();
+  s_entries = countStallEntries();
+  m_stallEntries.set((float)s_entries);
+
+  watchdog_hw->scratch[2] = millis();
+  watchdog_enable(SUP_WATCHDOG_MS, true);   // en pausa con el depurador
+  s_armed = true;
+}
+
+/**
+ * \brief Alimenta el watchdog y anota el instante.
+ */
+void SUP_feed() {
+  if (!s_armed) return;
+  watchdog_update();
+  watchdog_hw->scratch[2] = millis();
+}
+
+/**
+ * \brief Anota la tarea en scratch (sobrevive al reset) y devuelve la anterior.
+ */
+SupMark SUP_enter(SupTask task) {
+  SupMark prev = {watchdog_hw->scratch[0], watchdog_hw->scratch[1]};
+  watchdog_hw->scratch[0] = SUP_TAG_MAGIC | task;
+  watchdog_hw->scratch[1] = millis();
+  s_depth++;
+  if (s_depth <= SUP_MAX_DEPTH) s_childMs[s_depth] = 0;
+  return prev;
+}
+
+/**
+ * \brief Restaura la marca previa, añade el tramo a la traza y comprueba el presupuesto.
+ */
+void SUP_exit(SupTask task, uint32_t startMs, const SupMark& prev) {
+  uint32_t dur = millis() - startMs;
+  watchdog_hw->scratch[0] = prev.tag;
+  watchdog_hw->scratch[1] = prev.startMs;
+  uint32_t self = dur;
+  if (s_depth && s_depth <= SUP_MAX_DEPTH && s_childMs[s_depth] < dur) self = dur - s_childMs[s_depth];
+  if (s_depth) s_depth--;
+  if (s_depth && s_depth <= SUP_MAX_DEPTH) s_childMs[s_depth] += dur;
+
+  SupSpan& sp = s_trace.spans[s_trace.head];
+  sp.task    = task;
+  sp.depth   = s_depth;
+  sp.durMs   = dur > 0xFFFFU ? 0xFFFFU : (uint16_t)dur;
+  sp.startMs = startMs;
+  s_trace.head = (s_trace.head + 1) % SUP_TRACE_LEN;
+
+  if (task >= SUP_TASK_COUNT) return;
+  if (dur > s_maxMs[task]) {
+    s_maxMs[task] = dur;
+    MAX_GAUGES[task]->set((float)dur);
+  }
+  if (self > SUP_BUDGET_MS[task]) {
+    s_violations[task]++;
+    VIOL_COUNTERS[task]->inc();
+    if (!s_viol.pending && (s_viol.lastLogMs == 0 || millis() - s_viol.lastLogMs >= SUP_VIOL_LOG_GAP_MS)) {
+      s_viol.pending = true;
+      s_viol.task    = task;
+      s_viol.startMs = startMs;
+      s_viol.durMs   = self;
+      s_viol.trace   = s_trace;
+    } else {
+      s_viol.skipped++;
+      m_violDropped.inc();
+    }
+  }
+  // Fuera de cualquier tarea: la escritura en flash no cuenta en ningún presupuesto
+  if (s_depth == 0 && s_viol.pending && s_armed) {
+    appendViolationLog();
+    s_viol.pending   = false;
+    s_viol.skipped   = 0;
+    s_viol.lastLogMs = millis();
+    if (s_viol.lastLogMs == 0) s_viol.lastLogMs = 1;
+  }
+}
+
+/**
+ * \brief Contador de violaciones de \p task.
+ */
+uint32_t SUP_violations(SupTask task) {
+  return task < SUP_TASK_COUNT ? s_violations[task] : 0;
+}
+
+/**
+ * \brief Resultado de la comprobación hecha en SUP_begin().
+ */
+bool SUP_stalledLastBoot() {
+  return s_stalled;
+}
+
+/**
+ * \brief Una línea por tarea y, si lo hubo, el bloqueo del arranque anterior.
+ */
+void SUP_report(Stream& port) {
+  port.println("[SUP] tarea   presup_ms  violaciones  max_ms");
+  for (uint8_t i = 0; i < SUP_TASK_COUNT; i++) {
+    char line[64];
+    snprintf(line, sizeof(line), "[SUP] %-7s %9u %12lu %7lu", SUP_NAMES[i],
+             (unsigned)SUP_BUDGET_MS[i], (unsigned long)s_violations[i],
+             (unsigned long)s_maxMs[i]);
+    port.println(line);
+  }
+  if (s_stalled) {
+    port.print("[SUP] reinicio por watchdog en la tarea ");
+    port.print(tagName(s_stallTag));
+    port.print(" (entrada ");
+    port.print(s_stallStartMs);
+    port.println(" ms, ver /stall.log)");
+  }
+}
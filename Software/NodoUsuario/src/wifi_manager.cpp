@@ -24,11 +24,60 @@
 #include "lcd_utils.h"
 #include "html_pages.h"
 #include "hardware/watchdog.h"
+#include "metrics.h"
+#include "supervisor.h"
 
 #define CONFIG_FILE "/wifi.config"
 #define AP_SSID     "WiFiConfig"
 #define AP_PASS     "12345678"
 
+// Selección de canal del AP
+static const int           WIFI_SCAN_MAX      = 24;        // redes guardadas en caché
+static const unsigned long AP_SCAN_MAX_AGE    = 30000UL;   // reutiliza escaneos < 30 s
+static const unsigned long AP_REEVAL_PERIOD   = 600000UL;  // reevaluación cada 10 min
+static const uint8_t       AP_CHANNEL_MAX     = 13;        // canales EU 2.4 GHz
+
+/** Entrada de la caché de escaneo. */
+struct WiFiScanEntry {
+  String  ssid;
+  int32_t rssi;
+  uint8_t channel;
+};
+
+static WiFiScanEntry s_scan[WIFI_SCAN_MAX];
+static int           s_scanCount  = 0;
+static unsigned long s_scanTime   = 0;
+static bool          s_scanValid  = false;
+static uint8_t       s_apChannel  = 0;
+static unsigned long s_apEvalTime = 0;
+static void        (*s_idleHook)() = nullptr;
+
+// Métricas
+METRIC_COUNTER(m_connectAttempts, "wifi_connect_attempts_total", "Intentos de conexión en modo STA");
+METRIC_COUNTER(m_connectFailures, "wifi_connect_failures_total", "Intentos STA fallidos (timeout)");
+METRIC_COUNTER(m_apChannelChanges, "wifi_ap_channel_changes_total", "Cambios de canal del AP por reevaluación");
+METRIC_COUNTER(m_fsWrites, "fs_writes_total", "Escrituras de ficheros de configuración en LittleFS");
+
+// =================== Esperas ===================
+
+/**
+ * @brief Gancho que se ejecuta durante las esperas de conexión (nullptr = ninguno).
+ */
+void WIFI_setIdleHook(void (*hook)()) {
+  s_idleHook = hook;
+}
+
+/**
+ * @brief Espera \p ms atendiendo el gancho de inactividad cada milisegundo.
+ */
+static void waitIdle(unsigned long ms) {
+  unsigned long t0 = millis();
+  do {
+    if (s_idleHook) s_idleHook();
+    delay(1);
+  } while (millis() - t0 < ms);
+}
+
 // =================== Persistencia de credenciales ===================
 
 /**
@@ -38,6 +87,7 @@
 bool saveWiFiConf(const String &ssid, const String &pwd) {
   File file = LittleFS.open(CONFIG_FILE, "w");
   if (!file) return false;
+  m_fsWrites.inc();
   file.println(ssid);
   file.println(pwd);
   file.close();
@@ -74,7 +124,7 @@ bool initWiFiConnection(String &ssid, String &pwd) {
       return true;
     } else {
       showLCDMessage("Fallo de WiFi. Intente de nuevo.");
-      delay(3000);
+      waitIdle(3000);
     }
   }
 
@@ -95,15 +145,15 @@ bool initWiFiConnection(String &ssid, String &pwd) {
       associated = true;
       break;
     }
-    delay(250);
+    waitIdle(250);
   }
 
   if (associated) {
     showLCDMessage("Acceda a http://" + WiFi.softAPIP().toString());
-    delay(1200);
+    waitIdle(1200);
   } else {
     showLCDMessage("AP listo: WiFiConfig");
-    delay(1200);
+    waitIdle(1200);
   }
   return false;
 }
@@ -112,40 +162,157 @@ bool initWiFiConnection(String &ssid, String &pwd) {
  * @brief Intento de conexión STA con timeout.
  */
 bool tryConnectWiFi(const String &ssid, const String &pwd) {
+  s_apChannel = 0;
   WiFi.disconnect(true);
   WiFi.softAPdisconnect(true);
-  delay(150);
+  waitIdle(150);
   WiFi.mode(WIFI_OFF);
-  delay(150);
+  waitIdle(150);
   WiFi.mode(WIFI_STA);
-  delay(150);
+  waitIdle(150);
 
+  m_connectAttempts.inc();
   WiFi.begin(ssid.c_str(), pwd.c_str());
 
   unsigned long start = millis();
   while (WiFi.status() != WL_CONNECTED && millis() - start < 15000UL) {
     showLCDMessage("Conectando...");
-    delay(500);
+    waitIdle(500);
+  }
+
+  bool ok = (WiFi.status() == WL_CONNECTED);
+  if (!ok) m_connectFailures.inc();
+  return ok;
+}
+
+// =================== Canal del AP ===================
+
+/**
+ * @brief Escanea (bloqueante) y copia el resultado a la caché.
+ */
+static void scanNow() {
+  SUP_SCOPE(SUP_TASK_SCAN);   // presupuesto propio: el de wifi/http no lo incluye
+  int n = WiFi.scanNetworks();
+  if (n < 0) n = 0;
+  if (n > WIFI_SCAN_MAX) n = WIFI_SCAN_MAX;
+  for (int i = 0; i < n; i++) {
+    s_scan[i].ssid    = WiFi.SSID(i);
+    s_scan[i].rssi    = WiFi.RSSI(i);
+    s_scan[i].channel = (uint8_t)WiFi.channel(i);
+  }
+  s_scanCount = n;
+  s_scanTime  = millis();
+  s_scanValid = true;
+}
+
+/**
+ * @brief Devuelve la caché si es reciente; si no, reescanea.
+ */
+int WIFI_scanCached(unsigned long maxAgeMs) {
+  if (!s_scanValid || millis() - s_scanTime > maxAgeMs) scanNow();
+  return s_scanCount;
+}
+
+/**
+ * @brief SSID de la entrada i (cadena vacía fuera de rango).
+ */
+String WIFI_scanSSID(int i) {
+  if (i < 0 || i >= s_scanCount) return String();
+  return s_scan[i].ssid;
+}
+
+/**
+ * @brief Carga por canal: peso = RSSI+100 (1..70), atenuado 1/5 por canal de separación.
+ */
+static void channelLoad(uint32_t load[AP_CHANNEL_MAX + 1]) {
+  for (uint8_t c = 0; c <= AP_CHANNEL_MAX; c++) load[c] = 0;
+  for (int i = 0; i < s_scanCount; i++) {
+    int ch = s_scan[i].channel;
+    if (ch < 1 || ch > AP_CHANNEL_MAX) continue;   // 5 GHz o desconocido
+    int32_t w = constrain(s_scan[i].rssi + 100, 1, 70);
+    for (int c = 1; c <= AP_CHANNEL_MAX; c++) {
+      int d = abs(c - ch);
+      if (d < 5) load[c] += (uint32_t)(w * (5 - d));
+    }
   }
+}
 
-  return (WiFi.status() == WL_CONNECTED);
+/**
+ * @brief Canal de menor carga; recorre 1, 6, 11 primero para desempatar a su favor.
+ */
+uint8_t WIFI_pickApChannel(uint32_t* load) {
+  uint32_t l[AP_CHANNEL_MAX + 1];
+  channelLoad(l);
+
+  // Preferencia por los canales sin solape (1, 6, 11) en caso de empate
+  static const uint8_t ORDER[AP_CHANNEL_MAX] = {1, 6, 11, 2, 3, 4, 5, 7, 8, 9, 10, 12, 13};
+  uint8_t best = ORDER[0];
+  for (uint8_t i = 1; i < AP_CHANNEL_MAX; i++) {
+    if (l[ORDER[i]] < l[best]) best = ORDER[i];
+  }
+  if (load) *load = l[best];
+  return best;
 }
 
 /**
- * @brief Levanta AP con SSID/clave fijos (prototipo).
+ * @brief Canal del AP activo (0 en modo STA).
+ */
+uint8_t WIFI_apChannel() {
+  return s_apChannel;
+}
+
+/**
+ * @brief Reescaneo periódico sin clientes y cambio de canal con histéresis.
+ */
+void WIFI_apTick() {
+  if (s_apChannel == 0) return;
+  if (millis() - s_apEvalTime < AP_REEVAL_PERIOD) return;
+  s_apEvalTime = millis();
+
+  // Nunca se cambia de canal con clientes asociados
+  if (WiFi.softAPgetStationNum() > 0) return;
+
+  scanNow();
+  uint32_t l[AP_CHANNEL_MAX + 1];
+  channelLoad(l);
+  uint32_t bestLoad;
+  uint8_t best = WIFI_pickApChannel(&bestLoad);
+
+  // Histéresis: el canal nuevo debe tener al menos un 25 % menos de carga
+  if (best != s_apChannel && bestLoad * 4 < l[s_apChannel] * 3) {
+    Serial.print("[WiFi] AP canal "); Serial.print(s_apChannel);
+    Serial.print(" -> ");             Serial.println(best);
+    s_apChannel = best;
+    m_apChannelChanges.inc();
+    WiFi.softAP(AP_SSID, AP_PASS, s_apChannel);
+  }
+}
+
+/**
+ * @brief Levanta AP con SSID/clave fijos (prototipo) en el canal menos ocupado.
  */
 void startWiFiAP() {
   WiFi.disconnect(true);
   WiFi.softAPdisconnect(true);
-  delay(150);
+  waitIdle(150);
   WiFi.mode(WIFI_OFF);
-  delay(150);
+  waitIdle(150);
+
+  // Sondeo de ocupación antes de fijar el canal (el escaneo queda en caché para el portal)
+  WiFi.mode(WIFI_STA);
+  WIFI_scanCached(AP_SCAN_MAX_AGE);
+  uint32_t load = 0;
+  s_apChannel  = WIFI_pickApChannel(&load);
+  s_apEvalTime = millis();
+  Serial.print("[WiFi] AP canal "); Serial.print(s_apChannel);
+  Serial.print(" (carga ");         Serial.print(load);
+  Serial.println(")");
 
   WiFi.mode(WIFI_AP);
-  WiFi.softAP(AP_SSID, AP_PASS);
+  WiFi.softAP(AP_SSID, AP_PASS, s_apChannel);
 
   showLCDMessage("Conectese a WiFiConfig");
-  delay(3000);
+  waitIdle(3000);
 }
 
 // =================== Formulario ===================
@@ -0,0 +1,202 @@
+/** @file wifi_power.cpp
+ * @brief Implementación del gestor de ahorro de energía WiFi (CYW43).
+ *
+ * Política:
+ * - Sin clientes en la ventana de actividad → modo de mayor ahorro (PM1).
+ * - Con clientes → el modo más ahorrador cuya latencia añadida estimada cabe en
+ *   el presupuesto.
+ * - Con varios clientes o tráfico intenso → sin ahorro.
+ * - Se sube de modo al instante y se baja tras un tiempo mínimo de permanencia.
+ *
+ * @note Las latencias por modo son estimaciones de peor caso con beacon de
+ *       102,4 ms y DTIM=3; en modo AP el firmware del CYW43 ahorra menos que en STA.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "wifi_power.h"
+#include <WebServer.h>
+#include <pico/cyw43_arch.h>
+#include "metrics.h"
+
+extern WebServer server;
+
+// ----------------- Configuración -----------------------
+static const unsigned long WPM_ACTIVE_WINDOW = 10000UL; // cliente "activo" si pidió algo en 10 s
+static const unsigned long WPM_RATE_WINDOW   = 2000UL;  // ventana de medida de la tasa
+static const uint16_t      WPM_BUSY_REQS     = 4;       // ≥4 peticiones/2 s → tráfico intenso
+static const uint8_t       WPM_BUSY_VIEWERS  = 2;       // ≥2 clientes → sin ahorro
+static const unsigned long WPM_MIN_DWELL     = 3000UL;  // permanencia mínima antes de bajar
+static const uint8_t       WPM_MAX_CLIENTS   = 8;
+
+/** Latencia añadida estimada (peor caso, ms) por modo. */
+static const uint16_t WPM_ADDED_LATENCY[WPM_MODE_COUNT] = {0, 110, 310};
+static const char* const WPM_NAMES[WPM_MODE_COUNT] = {"performance", "balanced", "powersave"};
+
+// ----------------- Métricas ----------------------------
+METRIC_GAUGE(m_mode, "wifi_pm_mode", "Modo de ahorro WiFi (0=performance, 1=balanced, 2=powersave)");
+METRIC_GAUGE(m_viewers, "wifi_pm_active_clients", "Clientes HTTP activos en la ventana de actividad");
+METRIC_GAUGE_L(m_perfSec, "wifi_pm_mode_seconds", "Tiempo acumulado en cada modo de ahorro WiFi", "mode=\"performance\"");
+METRIC_GAUGE_L(m_balSec,  "wifi_pm_mode_seconds", "Tiempo acumulado en cada modo de ahorro WiFi", "mode=\"balanced\"");
+METRIC_GAUGE_L(m_saveSec, "wifi_pm_mode_seconds", "Tiempo acumulado en cada modo de ahorro WiFi", "mode=\"powersave\"");
+
+struct WpmClient {
+  uint32_t ip;
+  unsigned long lastSeen;
+};
+
+// ----------------- Estado interno -----------------------
+static WpmClient     s_clients[WPM_MAX_CLIENTS];
+static uint16_t      s_budgetMs    = 150;
+static WpmMode       s_mode        = WPM_PERFORMANCE;
+static bool          s_started     = false;
+static unsigned long s_modeSince   = 0;
+static uint32_t      s_modeMs[WPM_MODE_COUNT];
+static unsigned long s_rateStart   = 0;
+static uint16_t      s_rateCount   = 0;
+static uint16_t      s_lastRate    = 0;
+
+/**
+ * \brief Traduce el modo al valor de cyw43_wifi_pm().
+ */
+static uint32_t pmValue(WpmMode mode) {
+  switch (mode) {
+    case WPM_PERFORMANCE: return CYW43_NONE_PM;
+    case WPM_BALANCED:    return CYW43_PERFORMANCE_PM;
+    default:              return CYW43_AGGRESSIVE_PM;
+  }
+}
+
+/**
+ * \brief Aplica el modo al chip y cierra el tramo de tiempo del modo anterior.
+ */
+static void applyMode(WpmMode mode) {
+  unsigned long now = millis();
+  if (s_started) s_modeMs[s_mode] += now - s_modeSince;
+  s_mode      = mode;
+  s_modeSince = now;
+  s_started   = true;
+  cyw43_wifi_pm(&cyw43_state, pmValue(mode));
+  m_mode.set((float)mode);
+}
+
+/**
+ * \brief Modo más ahorrador que respeta el presupuesto de latencia.
+ */
+static WpmMode budgetMode() {
+  for (int m = WPM_MODE_COUNT - 1; m > WPM_PERFORMANCE; m--) {
+    if (WPM_ADDED_LATENCY[m] <= s_budgetMs) return (WpmMode)m;
+  }
+  return WPM_PERFORMANCE;
+}
+
+/**
+ * \brief Arranca en el modo de mayor ahorro (aún no hay clientes).
+ */
+void WPM_begin(uint16_t latencyBudgetMs) {
+  s_budgetMs = latencyBudgetMs;
+  memset(s_clients, 0, sizeof(s_clients));
+  memset(s_modeMs, 0, sizeof(s_modeMs));
+  s_started = false;
+  applyMode(WPM_POWERSAVE);
+}
+
+/**
+ * \brief Actualiza la tabla de clientes (reutiliza la entrada más antigua si está llena).
+ */
+void WPM_noteRequest() {
+  unsigned long now = millis();
+  uint32_t ip = (uint32_t)server.client().remoteIP();
+
+  uint8_t slot = 0;
+  for (uint8_t i = 0; i < WPM_MAX_CLIENTS; i++) {
+    if (s_clients[i].ip == ip) { slot = i; break; }
+    if (s_clients[i].lastSeen < s_clients[slot].lastSeen) slot = i;
+  }
+  s_clients[slot].ip = ip;
+  s_clients[slot].lastSeen = now;
+  s_rateCount++;
+
+  // Una petición con el chip en ahorro: sube de modo sin esperar al tick
+  if (s_mode > budgetMode()) applyMode(budgetMode());
+}
+
+/**
+ * \brief Clientes con actividad dentro de WPM_ACTIVE_WINDOW.
+ */
+uint8_t WPM_activeViewers() {
+  unsigned long now = millis();
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < WPM_MAX_CLIENTS; i++) {
+    if (s_clients[i].lastSeen != 0 && now - s_clients[i].lastSeen < WPM_ACTIVE_WINDOW) n++;
+  }
+  return n;
+}
+
+/**
+ * \brief Decide el modo objetivo y lo aplica (subida inmediata, bajada con permanencia).
+ */
+void WPM_tick() {
+  if (!s_started) return;
+  unsigned long now = millis();
+
+  if (now - s_rateStart >= WPM_RATE_WINDOW) {
+    s_lastRate  = s_rateCount;
+    s_rateCount = 0;
+    s_rateStart = now;
+  }
+
+  uint8_t viewers = WPM_activeViewers();
+  m_viewers.set(viewers);
+  m_perfSec.set(WPM_timeInMode(WPM_PERFORMANCE) / 1000.0f);
+  m_balSec.set(WPM_timeInMode(WPM_BALANCED) / 1000.0f);
+  m_saveSec.set(WPM_timeInMode(WPM_POWERSAVE) / 1000.0f);
+
+  WpmMode target;
+  if (viewers == 0) {
+    target = WPM_POWERSAVE;
+  } else if (viewers >= WPM_BUSY_VIEWERS || s_lastRate >= WPM_BUSY_REQS) {
+    target = WPM_PERFORMANCE;
+  } else {
+    target = budgetMode();
+  }
+
+  if (target < s_mode) {
+    applyMode(target);
+  } else if (target > s_mode && now - s_modeSince >= WPM_MIN_DWELL) {
+    applyMode(target);
+  }
+}
+
+/**
+ * \brief Modo actual.
+ */
+WpmMode WPM_mode() {
+  return s_mode;
+}
+
+/**
+ * \brief Tiempo acumulado en el modo (incluye el tramo en curso).
+ */
+uint32_t WPM_timeInMode(WpmMode mode) {
+  uint32_t t = s_modeMs[mode];
+  if (s_started && mode == s_mode) t += millis() - s_modeSince;
+  return t;
+}
+
+/**
+ * \brief Resumen en una línea para la consola serie.
+ */
+void WPM_report(Stream& port) {
+  port.print("[WPM] modo=");     port.print(WPM_NAMES[s_mode]);
+  port.print(" clientes=");      port.print(WPM_activeViewers());
+  port.print(" presupuesto_ms="); port.print(s_budgetMs);
+  for (uint8_t m = 0; m < WPM_MODE_COUNT; m++) {
+    port.print(' ');
+    port.print(WPM_NAMES[m]);
+    port.print("_ms=");
+    port.print(WPM_timeInMode((WpmMode)m));
+  }
+  port.println();
+}
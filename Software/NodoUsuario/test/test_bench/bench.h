@@ -0,0 +1,123 @@
+/** @file bench.h
+ * @brief Micro-benchmarks mínimos para el entorno nativo (ns por operación).
+ *
+ * Cada medida se repite en bloques cortos y se queda con el mejor (menos ruido
+ * del sistema operativo). Los tiempos absolutos dependen de la máquina, así que
+ * cada benchmark se expresa en unidades de un bucle de calibración (aritmética
+ * entera encadenada) medido en el mismo proceso, intercalado con sus bloques:
+ * una CPU más lenta o cargada alarga ambos por igual. La línea base es ese
+ * cociente y el test falla si lo supera por más del factor de tolerancia.
+ *
+ * La tolerancia por defecto es 1.5; se ajusta con la variable de entorno
+ * `BENCH_TOLERANCE` (p.ej. `BENCH_TOLERANCE=3 pio test -e native` en CI compartida).
+ *
+ * @note Las líneas base salen de un PC de desarrollo (-O2, x86-64); sirven para
+ *       detectar regresiones groseras, no para comparar compiladores.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <unity.h>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const int      BENCH_RUNS       = 5;
+static const uint32_t BENCH_BLOCKS     = 1000;
+static const uint32_t BENCH_UNIT_BLOCK = 256;   // unidades por bloque de calibración
+
+/** Evita que el compilador elimine el cuerpo medido. */
+static volatile uint32_t g_benchSink = 0;
+
+/**
+ * \brief Factor de tolerancia sobre la línea base (`BENCH_TOLERANCE`, por defecto 1.5).
+ */
+static inline double BENCH_tolerance() {
+  const char* env = getenv("BENCH_TOLERANCE");
+  double t = env ? atof(env) : 0.0;
+  return t > 0.0 ? t : 1.5;
+}
+
+/** Unidad de calibración (ns) medida junto a la última BENCH_nsPerOp(). */
+static double g_benchUnitNs = 0.0;
+
+/**
+ * \brief ns de un bloque vacío: lo que cuesta leer el reloj (se resta de cada bloque).
+ * \details En una VM el reloj puede pasar a una llamada al sistema y costar más
+ *          que un bloque entero de las operaciones más cortas.
+ */
+static inline double BENCH_clockNs() {
+  auto t0 = std::chrono::steady_clock::now();
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+/**
+ * \brief ns de \p n unidades de calibración (4 pasos de xorshift dependientes), reloj incluido.
+ */
+static inline double BENCH_unitBlockNs(uint32_t n) {
+  static uint32_t x = 2463534242u;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < n; i++) {
+    x ^= i;
+    for (int k = 0; k < 4; k++) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+    }
+    g_benchSink += x;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+/**
+ * \brief Ejecuta \p fn \p iters veces en cada una de BENCH_RUNS repeticiones y
+ *        devuelve el mejor ns/op.
+ * \details Cada repetición se mide en BENCH_BLOCKS bloques cortos (microsegundos)
+ *          y cuenta el mejor: un bloque interrumpido por el planificador de un
+ *          runner cargado se descarta en lugar de inflar la media. Antes de cada
+ *          bloque se mide otro de calibración y uno vacío, de modo que la unidad
+ *          (g_benchUnitNs) y el coste del reloj, que se resta de ambos, salen de
+ *          los mismos instantes que la medida.
+ */
+template <typename F>
+static double BENCH_nsPerOp(F&& fn, uint32_t iters) {
+  for (uint32_t i = 0; i < iters / 10; i++) fn(i);   // calentamiento
+
+  uint32_t block = iters / BENCH_BLOCKS ? iters / BENCH_BLOCKS : 1;
+  double best = 1e300, bestUnit = 1e300, bestClock = 1e300;
+  for (int r = 0; r < BENCH_RUNS; r++) {
+    for (uint32_t i0 = 0; i0 + block <= iters; i0 += block) {
+      double clk = BENCH_clockNs();
+      if (clk < bestClock) bestClock = clk;
+      double unit = BENCH_unitBlockNs(BENCH_UNIT_BLOCK);
+      if (unit < bestUnit) bestUnit = unit;
+      auto t0 = std::chrono::steady_clock::now();
+      for (uint32_t i = i0; i < i0 + block; i++) fn(i);
+      auto t1 = std::chrono::steady_clock::now();
+      double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+      if (ns < best) best = ns;
+    }
+  }
+  g_benchUnitNs = (bestUnit > bestClock ? bestUnit - bestClock : bestUnit) / BENCH_UNIT_BLOCK;
+  return (best > bestClock ? best - bestClock : 0.0) / block;
+}
+
+/**
+ * \brief Imprime la medida y falla si supera `baselineUnits * tolerancia`
+ *        unidades de calibración.
+ */
+static inline void BENCH_check(const char* name, double ns, double baselineUnits) {
+  double unitNs = g_benchUnitNs;
+  double units  = ns / unitNs;
+  double limit  = baselineUnits * BENCH_tolerance();
+  char msg[160];
+  snprintf(msg, sizeof(msg), "[BENCH] %s: %.1f ns/op = %.2f u (unidad %.1f ns, base %.2f u, límite %.2f u)",
+           name, ns, units, unitNs, baselineUnits, limit);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE_MESSAGE(units <= limit, msg);
+}
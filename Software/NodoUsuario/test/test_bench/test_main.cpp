@@ -0,0 +1,179 @@
+/** @file test_main.cpp
+ * @brief Micro-benchmarks de la ruta de recepción (saneado + decodificación)
+ *        del trabajo por fix en la base (corrección diferencial, modelo de movimiento
+ *        y 50 reglas de alerta) y de la compresión gzip de una respuesta `/metrics` típica.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "bench.h"
+#include <string.h>
+#include "rx_decoder.h"
+#include "dgnss.h"
+#include "movement_model.h"
+#include "http_gzip.h"
+#include "rule_engine.h"
+
+// Líneas base (unidades de calibración de bench.h por operación, -O2, x86-64 de desarrollo)
+static const double BASE_DECODE_U    = 1.2;
+static const double BASE_REJECT_U    = 0.6;
+static const double BASE_DGPS_U      = 8.0;
+static const double BASE_MOV_U       = 16.0;
+static const double BASE_GZIP_U      = 7000.0;    // por respuesta de ~4,8 KB
+static const double BASE_RULES_U     = 110.0;     // 50 reglas (~560 B de bytecode)
+static const uint32_t ITERS          = 1000000;
+
+void setUp() {}
+void tearDown() {}
+
+static void bench_decode_position() {
+  GpsInfo gi{};
+  gi.lat = 40.41678; gi.lon = -3.70379; gi.hhmmss = 120000; gi.valid = true;
+  // Varias tramas fijas en lugar de tocar un byte en cada vuelta: esa escritura,
+  // releída enseguida en palabras de 4, no se reenvía y medía el bloqueo
+  uint8_t frames[8][13];
+  for (uint8_t k = 0; k < 8; k++) {
+    gi.hhmmss = 120000 + k;
+    GPS_buildBinaryPayload(gi, frames[k], sizeof(frames[k]));
+  }
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    size_t len = RX_clampLength(13, sizeof(frames[0]));
+    GpsInfo out{};
+    g_benchSink += (RX_decodeFrame(frames[i & 7], len, out) == RX_POSITION) ? out.hhmmss : 0;
+  }, ITERS);
+  BENCH_check("RX_decodeFrame (posición)", ns, BASE_DECODE_U);
+}
+
+static void bench_reject_garbage() {
+  uint8_t buf[64];
+  memset(buf, 0xA5, sizeof(buf));
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    size_t len = RX_clampLength((int32_t)(i & 0x7F), sizeof(buf));
+    GpsInfo out{};
+    g_benchSink += (uint32_t)RX_decodeFrame(buf, len, out);
+  }, ITERS);
+  BENCH_check("RX_decodeFrame (descarte)", ns, BASE_REJECT_U);
+}
+
+/** Peor caso realista: buffer lleno y la época del collar 30 s por detrás. */
+static void bench_dgps_correct() {
+  DGPS_begin();
+  DGPS_setReference(40.41678, -3.70379);
+  for (uint32_t t = 0; t < 64; t++) {
+    GpsInfo b{};
+    b.lat = 40.41678 + t * 1e-6; b.lon = -3.70379; b.valid = true;
+    b.hhmmss = 120000 + (t / 60) * 100 + t % 60;
+    DGPS_addBaseFix(b);
+  }
+  GpsInfo c{};
+  c.lat = 40.42; c.lon = -3.70; c.hhmmss = 120033; c.valid = true;
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    c.lon = -3.70 + (i & 7) * 1e-6;
+    GpsInfo out;
+    g_benchSink += DGPS_correct(c, out) ? 1u : 0u;
+  }, ITERS);
+  BENCH_check("DGPS_correct (30 épocas atrás)", ns, BASE_DGPS_U);
+}
+
+/** Modelo con todas las horas evaluando (tras el calentamiento) y fixes cada 30 s. */
+static void bench_movement_observe() {
+  MOV_begin();
+  GpsInfo g{};
+  g.lat = 40.41678; g.lon = -3.70379; g.valid = true;
+  for (uint32_t i = 0; i < 24u * MOV_WARMUP; i++) {
+    uint32_t sod = (i * 60) % 86400;
+    g.hhmmss = (sod / 3600) * 10000 + ((sod / 60) % 60) * 100;
+    MOV_observe(g);
+  }
+
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    uint32_t sod = (i * 30) % 86400;
+    g.hhmmss = (sod / 3600) * 10000 + ((sod / 60) % 60) * 100 + sod % 60;
+    g.lat = 40.41678 + (i & 15) * 1e-4;
+    g_benchSink += MOV_observe(g).flags;
+  }, ITERS);
+  BENCH_check("MOV_observe (zona 3x3 + velocidad)", ns, BASE_MOV_U);
+}
+
+static void countSink(const char*, size_t len, void*) { g_benchSink += (uint32_t)len; }
+
+/** Respuesta `/metrics` de 40 familias (~4,8 KB) en trozos de 128 B, como METRICS_render(). */
+static void bench_gzip_response() {
+  static char text[6000];
+  size_t len = 0;
+  for (int i = 0; i < 40; i++) {
+    len += snprintf(text + len, sizeof(text) - len,
+                    "# HELP lora_metric_%d Descripcion de la metrica numero %d\n# TYPE lora_metric_%d gauge\n"
+                    "lora_metric_%d{channel=\"%d\"} %d.%03d\n", i, i, i, i, i % 8, i * 37 % 1000, i * 91 % 1000);
+  }
+  static GzStream z;
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    text[len - 2] = (char)('0' + i % 10);
+    GZ_begin(z, countSink, nullptr);
+    for (size_t off = 0; off < len; off += 128) GZ_write(z, text + off, len - off < 128 ? len - off : 128);
+    GZ_finish(z);
+  }, 2000);
+  printf("[BENCH] gzip /metrics: %u -> %u bytes (%u ahorrados)\n", (unsigned)z.inBytes,
+         (unsigned)z.outBytes, (unsigned)(z.inBytes - z.outBytes));
+  BENCH_check("gzip (respuesta /metrics)", ns, BASE_GZIP_U);
+}
+
+/** 50 reglas variadas (comparaciones, conjunciones, aritmética y `durante`) evaluadas en cada fix. */
+static void bench_rules_50() {
+  static char src[4096];
+  size_t len = 0;
+  static const char* const FORMS[] = {
+    "distancia > %d",
+    "fuera == 1 y edad_fix < %d",
+    "edad_fix > %d min durante 30s",
+    "velocidad > %d.5 o anomalia",
+    "rssi < -%d y snr < 0 || fallos_tx > 3",
+    "(distancia - 100) * 2 / 3 >= %d y hora >= 22",
+    "temp > %d durante 2 min",
+    "no fuera y distancia > %d km",
+  };
+  for (int i = 0; i < 50; i++) {
+    len += snprintf(src + len, sizeof(src) - len, "r%d: ", i);
+    len += snprintf(src + len, sizeof(src) - len, FORMS[i % 8], 10 + i * 7);
+    src[len++] = '\n';
+  }
+  src[len] = '\0';
+  RUL_begin();
+  RuleError err;
+  TEST_ASSERT_TRUE_MESSAGE(RUL_compile(src, err), err.msg);
+
+  size_t bytes = 0, ops = 0;
+  for (uint8_t r = 0; r < RUL_count(); r++) {
+    const uint8_t* c = RUL_code(r);
+    for (uint8_t pc = 0; pc < RUL_info(r).codeLen; ops++) {
+      uint8_t op = c[pc++];
+      pc += op == RUL_OP_LOAD || op == RUL_OP_I8 ? 1 : op == RUL_OP_I16 ? 2 : op == RUL_OP_F32 ? 4 : 0;
+    }
+    bytes += RUL_info(r).codeLen;
+  }
+
+  float vars[RUL_VAR_COUNT] = {350.0f, 4.0f, 12.0f, 0.0f, -95.0f, 6.5f, 14.0f, 31.0f, 0.0f, 0.0f};
+  double ns = BENCH_nsPerOp([&](uint32_t i) {
+    vars[RUL_VAR_DISTANCE] = (float)(i & 1023);
+    vars[RUL_VAR_FIX_AGE]  = (float)(i & 63);
+    g_benchSink += (uint32_t)RUL_evaluate(vars, i, nullptr, 0);
+  }, ITERS / 10);
+  printf("[BENCH] reglas: %u reglas, %u B de bytecode, %u operaciones por evaluacion\n",
+         RUL_count(), (unsigned)bytes, (unsigned)ops);
+  BENCH_check("RUL_evaluate (50 reglas)", ns, BASE_RULES_U);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(bench_decode_position);
+  RUN_TEST(bench_reject_garbage);
+  RUN_TEST(bench_dgps_correct);
+  RUN_TEST(bench_movement_observe);
+  RUN_TEST(bench_gzip_response);
+  RUN_TEST(bench_rules_50);
+  return UNITY_END();
+}
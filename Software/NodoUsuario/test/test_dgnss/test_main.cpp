@@ -0,0 +1,152 @@
+/** @file test_main.cpp
+ * @brief Tests de la corrección diferencial y reproducción de un par de trazas.
+ *
+ * El par de trazas (base fija y collar en movimiento, 1 Hz, 30 min) se genera de
+ * forma determinista con un error común tipo paseo aleatorio (ionosfera/reloj)
+ * más ruido independiente en cada receptor; el test informa del RMS con y sin
+ * corrección.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "dgnss.h"
+
+static const double REF_LAT = 40.4168, REF_LON = -3.7038;
+static const double M_PER_DEG = 111320.0;
+
+void setUp() { DGPS_begin(); }
+void tearDown() {}
+
+// ----------------- Generador determinista -----------------
+static uint32_t s_rng = 12345;
+
+static double uniform() {
+  s_rng = s_rng * 1664525UL + 1013904223UL;
+  return ((s_rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static GpsInfo fix(double lat, double lon, uint32_t sod) {
+  GpsInfo g{};
+  g.lat = lat; g.lon = lon; g.valid = true;
+  g.hhmmss = (sod / 3600) * 10000 + ((sod / 60) % 60) * 100 + sod % 60;
+  return g;
+}
+
+static double distM(double lat1, double lon1, double lat2, double lon2) {
+  double dy = (lat1 - lat2) * M_PER_DEG;
+  double dx = (lon1 - lon2) * M_PER_DEG * cos(lat1 * M_PI / 180.0);
+  return sqrt(dx * dx + dy * dy);
+}
+
+/** Sin referencia no se corrige; el survey-in converge a la media. */
+static void test_survey_in() {
+  GpsInfo out;
+  TEST_ASSERT_FALSE(DGPS_correct(fix(REF_LAT, REF_LON, 100), out));
+  s_rng = 1;
+  for (uint32_t i = 0; i < DGPS_SURVEY_SAMPLES; i++) {
+    DGPS_addBaseFix(fix(REF_LAT + gauss(3.0) / M_PER_DEG, REF_LON + gauss(3.0) / M_PER_DEG, i));
+  }
+  TEST_ASSERT_TRUE(DGPS_hasReference());
+  TEST_ASSERT_EQUAL_UINT32(DGPS_SURVEY_SAMPLES, DGPS_surveySamples());
+
+  // El error de la base es ahora su desviación frente a la media estimada (< 1 m)
+  DGPS_addBaseFix(fix(REF_LAT, REF_LON, 1000));
+  TEST_ASSERT_TRUE(DGPS_lastBaseErrorM() < 1.0f);
+}
+
+/** Época exacta, interpolada, demasiado lejana y cruce de medianoche. */
+static void test_epoch_alignment() {
+  DGPS_setReference(REF_LAT, REF_LON);
+  const double e1 = 2.0 / M_PER_DEG, e3 = 4.0 / M_PER_DEG;
+  DGPS_addBaseFix(fix(REF_LAT + e1, REF_LON, 86399));
+  DGPS_addBaseFix(fix(REF_LAT + e3, REF_LON, 1));   // falta la época 0
+
+  GpsInfo out;
+  TEST_ASSERT_TRUE(DGPS_correct(fix(REF_LAT + 0.01, REF_LON, 86399), out));
+  TEST_ASSERT_FLOAT_WITHIN(1e-7, REF_LAT + 0.01 - e1, out.lat);
+
+  TEST_ASSERT_TRUE(DGPS_correct(fix(REF_LAT + 0.01, REF_LON, 0), out));
+  TEST_ASSERT_FLOAT_WITHIN(1e-7, REF_LAT + 0.01 - (e1 + e3) / 2, out.lat);
+
+  TEST_ASSERT_FALSE(DGPS_correct(fix(REF_LAT, REF_LON, 10), out));
+  TEST_ASSERT_FALSE(DGPS_correct(fix(REF_LAT, REF_LON, 86000), out));
+  TEST_ASSERT_EQUAL_FLOAT(REF_LAT, out.lat);   // sin corrección: copia
+}
+
+/** Épocas repetidas o fixes no válidos no entran en el buffer. */
+static void test_ignores_invalid() {
+  DGPS_setReference(REF_LAT, REF_LON);
+  GpsInfo bad = fix(95.0, 0.0, 5);
+  DGPS_addBaseFix(bad);
+  GpsInfo out;
+  TEST_ASSERT_FALSE(DGPS_correct(fix(REF_LAT, REF_LON, 5), out));
+
+  DGPS_addBaseFix(fix(REF_LAT + 1.0 / M_PER_DEG, REF_LON, 5));
+  DGPS_addBaseFix(fix(REF_LAT + 9.0 / M_PER_DEG, REF_LON, 5));   // repetida: se ignora
+  TEST_ASSERT_TRUE(DGPS_correct(fix(REF_LAT, REF_LON, 5), out));
+  TEST_ASSERT_FLOAT_WITHIN(0.05, -1.0, (out.lat - REF_LAT) * M_PER_DEG);
+}
+
+/** Reproducción del par de trazas: el RMS corregido debe bajar al menos a la mitad. */
+static void test_replay_pair() {
+  DGPS_setReference(REF_LAT, REF_LON);
+  s_rng = 2026;
+
+  const uint32_t T0 = 43000, N = 1800;
+  double cLat = 0, cLon = 0;           // error común (m), paseo aleatorio con deriva
+  double sumRaw = 0, sumCorr = 0;
+  uint32_t n = 0, uncorrected = 0;
+
+  for (uint32_t t = 0; t < N; t++) {
+    cLat = 0.995 * cLat + gauss(0.35) + 0.01;
+    cLon = 0.995 * cLon + gauss(0.35);
+    uint32_t sod = T0 + t;
+
+    // La base pierde un 5 % de las épocas (se interpolan)
+    if (uniform() > 0.05) {
+      DGPS_addBaseFix(fix(REF_LAT + (cLat + gauss(0.5)) / M_PER_DEG,
+                          REF_LON + (cLon + gauss(0.5)) / (M_PER_DEG * cos(REF_LAT * M_PI / 180.0)), sod));
+    }
+
+    // Collar: círculo de 300 m, un fix cada 10 s que llega 1 s después
+    if (t % 10 == 9) {
+      uint32_t ep = sod - 1;
+      double ang  = 2.0 * M_PI * ep / 900.0;
+      double tLat = REF_LAT + 300.0 * sin(ang) / M_PER_DEG;
+      double tLon = REF_LON + 300.0 * cos(ang) / (M_PER_DEG * cos(REF_LAT * M_PI / 180.0));
+      // El error común de la época del collar es el de hace 1 s (aprox. el actual)
+      GpsInfo meas = fix(tLat + (cLat + gauss(0.5)) / M_PER_DEG,
+                         tLon + (cLon + gauss(0.5)) / (M_PER_DEG * cos(REF_LAT * M_PI / 180.0)), ep);
+      GpsInfo corr;
+      if (!DGPS_correct(meas, corr)) { uncorrected++; continue; }
+      double eRaw  = distM(meas.lat, meas.lon, tLat, tLon);
+      double eCorr = distM(corr.lat, corr.lon, tLat, tLon);
+      sumRaw  += eRaw * eRaw;
+      sumCorr += eCorr * eCorr;
+      n++;
+    }
+  }
+
+  double rmsRaw = sqrt(sumRaw / n), rmsCorr = sqrt(sumCorr / n);
+  printf("[DGPS] %lu fixes, RMS sin corrección %.2f m, con corrección %.2f m (%lu sin época)\n",
+         (unsigned long)n, rmsRaw, rmsCorr, (unsigned long)uncorrected);
+  TEST_ASSERT_TRUE(n > 170);
+  TEST_ASSERT_TRUE(rmsCorr < 0.5 * rmsRaw);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_survey_in);
+  RUN_TEST(test_epoch_alignment);
+  RUN_TEST(test_ignores_invalid);
+  RUN_TEST(test_replay_pair);
+  return UNITY_END();
+}
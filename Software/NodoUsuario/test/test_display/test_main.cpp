@@ -0,0 +1,260 @@
+/** @file test_main.cpp
+ * @brief Tests del framebuffer con envío parcial y del minimapa.
+ *
+ * Un panel simulado (GDDRAM de un SSD1306 que interpreta las ventanas 0x21 /
+ * 0x22 y escribe en direccionamiento horizontal) recibe los tramos de
+ * FB_nextSegment() y debe quedar igual que la copia de dibujo.
+ *
+ * La simulación sigue a un collar que se aleja y vuelve (un fix cada 10 s,
+ * el mapa se redibuja cada segundo) y compara los bytes por el bus del envío
+ * parcial con los de refrescar la pantalla entera. Se informa además del
+ * tiempo de dibujo y comparación por fotograma en el host y del tiempo de
+ * bus a 8 MHz (SPI) y 400 kHz (I²C, 9 bits por byte).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "framebuffer.h"
+#include "minimap.h"
+
+static const double BASE_LAT = 40.4168, BASE_LON = -3.7038;
+static const double M_PER_DEG = 111319.5;
+static const size_t FULL_FRAME_BYTES = FB_CMD_LEN + FB_BYTES;
+
+// ----------------- Panel simulado -----------------
+static uint8_t s_gddram[FB_BYTES];
+
+/**
+ * \brief Aplica todos los tramos pendientes al panel.
+ * \return Bytes por el bus (comandos y datos).
+ */
+static size_t pushToPanel(size_t* segments = nullptr) {
+  size_t bytes = 0, n = 0;
+  FbSegment seg;
+  while (FB_nextSegment(seg)) {
+    n++;
+    bytes += FB_CMD_LEN + seg.dataLen;
+    uint8_t c0 = seg.cmd[1], c1 = seg.cmd[2], p0 = seg.cmd[4], p1 = seg.cmd[5];
+    uint8_t col = c0, page = p0;
+    for (uint16_t i = 0; i < seg.dataLen; i++) {
+      s_gddram[page * FB_WIDTH + col] = seg.data[i];
+      if (col++ == c1) {
+        col = c0;
+        page = page == p1 ? p0 : page + 1;
+      }
+    }
+  }
+  if (segments) *segments = n;
+  return bytes;
+}
+
+static bool panelMatches() {
+  return memcmp(s_gddram, FB_pixels(), FB_BYTES) == 0;
+}
+
+static void fixAt(double eastM, double northM) {
+  MAP_addFix(BASE_LAT + northM / M_PER_DEG,
+             BASE_LON + eastM / (M_PER_DEG * cos(BASE_LAT * M_PI / 180.0)));
+}
+
+void setUp() {
+  FB_begin();
+  MAP_begin();
+  memset(s_gddram, 0xA5, sizeof(s_gddram));   // contenido desconocido al arrancar
+}
+void tearDown() {}
+
+// ----------------- Tests -----------------
+
+static void test_full_push_then_nothing() {
+  size_t n;
+  TEST_ASSERT_EQUAL_UINT32(FULL_FRAME_BYTES, pushToPanel(&n));
+  TEST_ASSERT_EQUAL_UINT32(1, n);   // 8 páginas enteras en una ventana
+  TEST_ASSERT_TRUE(panelMatches());
+  TEST_ASSERT_EQUAL_UINT32(0, pushToPanel());
+
+  // Redibujar lo mismo no genera tráfico
+  FB_fillRect(0, 0, FB_WIDTH, FB_HEIGHT, false);
+  TEST_ASSERT_TRUE(FB_isDirty());
+  TEST_ASSERT_EQUAL_UINT32(0, pushToPanel());
+  TEST_ASSERT_FALSE(FB_isDirty());
+}
+
+static void test_partial_segments() {
+  pushToPanel();
+  FB_pixel(10, 20, true);
+  FbSegment seg;
+  TEST_ASSERT_TRUE(FB_nextSegment(seg));
+  const uint8_t cmd[FB_CMD_LEN] = {0x21, 10, 10, 0x22, 2, 2};
+  TEST_ASSERT_EQUAL_MEMORY(cmd, seg.cmd, FB_CMD_LEN);
+  TEST_ASSERT_EQUAL_UINT16(1, seg.dataLen);
+  TEST_ASSERT_EQUAL_HEX8(0x10, seg.data[0]);
+  TEST_ASSERT_FALSE(FB_nextSegment(seg));
+
+  // Dos píxeles en la misma página: un tramo de la primera a la última columna
+  FB_pixel(3, 0, true);
+  FB_pixel(40, 7, true);
+  FB_pixel(10, 20, false);
+  size_t n;
+  TEST_ASSERT_EQUAL_UINT32(2 * FB_CMD_LEN + 38 + 1, pushToPanel(&n));
+  TEST_ASSERT_EQUAL_UINT32(2, n);
+  TEST_ASSERT_TRUE(panelMatches());
+
+  // Páginas enteras seguidas: una ventana; una parcial en medio las separa
+  FB_fillRect(0, 8, FB_WIDTH, 16, true);
+  FB_fillRect(0, 40, FB_WIDTH, 16, true);
+  FB_pixel(5, 33, true);
+  TEST_ASSERT_EQUAL_UINT32(3 * FB_CMD_LEN + 4 * FB_WIDTH + 1, pushToPanel(&n));
+  TEST_ASSERT_EQUAL_UINT32(3, n);
+  TEST_ASSERT_TRUE(panelMatches());
+
+  // Tras reiniciar el panel, todo otra vez
+  FB_invalidate();
+  TEST_ASSERT_EQUAL_UINT32(FULL_FRAME_BYTES, pushToPanel());
+}
+
+static void test_primitives() {
+  FB_fillRect(2, 5, 4, 6, true);   // filas 5..10: cruza dos páginas
+  TEST_ASSERT_EQUAL_HEX8(0xE0, FB_pixels()[2]);
+  TEST_ASSERT_EQUAL_HEX8(0x07, FB_pixels()[FB_WIDTH + 5]);
+  TEST_ASSERT_FALSE(FB_getPixel(6, 5));
+
+  FB_begin();
+  FB_line(0, 0, 7, 3);
+  TEST_ASSERT_TRUE(FB_getPixel(0, 0));
+  TEST_ASSERT_TRUE(FB_getPixel(7, 3));
+  int on = 0;
+  for (int x = 0; x < 8; x++)
+    for (int y = 0; y < 8; y++) on += FB_getPixel(x, y);
+  TEST_ASSERT_EQUAL_INT(8, on);   // un píxel por columna
+
+  // Recorte
+  FB_begin();
+  FB_setClip(10, 10, 5, 5);
+  FB_fillRect(0, 0, FB_WIDTH, FB_HEIGHT, true);
+  TEST_ASSERT_TRUE(FB_getPixel(10, 10));
+  TEST_ASSERT_TRUE(FB_getPixel(14, 14));
+  TEST_ASSERT_FALSE(FB_getPixel(15, 14));
+  TEST_ASSERT_FALSE(FB_getPixel(9, 10));
+  FB_resetClip();
+
+  // Texto alineado y desalineado dibujan lo mismo; minúsculas como mayúsculas
+  FB_begin();
+  TEST_ASSERT_EQUAL_UINT32(2, FB_text(0, 8, "Ab\nxx"));
+  FB_text(20, 13, "AB");
+  for (int c = 0; c < 12; c++)
+    for (int r = 0; r < 8; r++) TEST_ASSERT_EQUAL(FB_getPixel(c, 8 + r), FB_getPixel(20 + c, 13 + r));
+  const uint8_t A[5] = {0x7E, 0x09, 0x09, 0x09, 0x7E};
+  TEST_ASSERT_EQUAL_MEMORY(A, &FB_pixels()[FB_WIDTH], 5);
+  // '$', '\' y '^' tienen glifo propio, no el de '?'
+  FB_begin();
+  FB_text(0, 0, "?$\\^");
+  const uint8_t* row = FB_pixels();
+  for (int g = 1; g < 4; g++) TEST_ASSERT_TRUE(memcmp(row, row + 6 * g, 5) != 0);
+  const uint8_t DOLLAR[5] = {0x24, 0x2A, 0x7F, 0x2A, 0x12};
+  TEST_ASSERT_EQUAL_MEMORY(DOLLAR, row + 6, 5);
+  // Se corta en el borde derecho
+  TEST_ASSERT_EQUAL_UINT32(21, FB_text(0, 0, "0123456789012345678901234"));
+}
+
+static void test_minimap_projection() {
+  TEST_ASSERT_TRUE(MAP_setOrigin(BASE_LAT, BASE_LON));
+  TEST_ASSERT_FALSE(MAP_setOrigin(BASE_LAT + 10 / M_PER_DEG, BASE_LON));   // ruido de la base
+  fixAt(0, 40);
+  TEST_ASSERT_EQUAL_UINT32(50, MAP_radiusM());
+  int x, y;
+  TEST_ASSERT_TRUE(MAP_project(BASE_LAT, BASE_LON, x, y));
+  TEST_ASSERT_EQUAL_INT(MAP_X + MAP_SIZE / 2, x);
+  TEST_ASSERT_EQUAL_INT(MAP_Y + MAP_SIZE / 2, y);
+  // Norte arriba, este a la derecha
+  double nLat = BASE_LAT + 40 / M_PER_DEG;
+  TEST_ASSERT_TRUE(MAP_project(nLat, BASE_LON, x, y));
+  TEST_ASSERT_EQUAL_INT(MAP_X + MAP_SIZE / 2, x);
+  TEST_ASSERT_EQUAL_INT(MAP_Y + MAP_SIZE / 2 - 18, y);   // 40/50 · 23 px
+  fixAt(-300, -10);
+  TEST_ASSERT_EQUAL_UINT32(500, MAP_radiusM());
+  TEST_ASSERT_TRUE(MAP_project(BASE_LAT, BASE_LON - 300 / (M_PER_DEG * cos(BASE_LAT * M_PI / 180.0)), x, y));
+  TEST_ASSERT_TRUE(x < MAP_X + MAP_SIZE / 2 - 10);
+
+  MAP_render(12);
+  TEST_ASSERT_TRUE(FB_getPixel(MAP_X + MAP_SIZE / 2, MAP_Y + MAP_SIZE / 2));   // base
+  TEST_ASSERT_TRUE(FB_getPixel(MAP_X, MAP_Y));                                  // borde
+  TEST_ASSERT_FALSE(FB_getPixel(0, 0));                                         // mensajes intactos
+
+  // Sin base: centrado en la última posición
+  MAP_begin();
+  fixAt(1000, 0);
+  TEST_ASSERT_FALSE(MAP_hasOrigin());
+  TEST_ASSERT_EQUAL_UINT32(25, MAP_radiusM());
+  // Más allá de la última escala se recorta
+  MAP_setOrigin(BASE_LAT, BASE_LON);
+  fixAt(80000, 0);
+  TEST_ASSERT_EQUAL_UINT32(50000, MAP_radiusM());
+  TEST_ASSERT_FALSE(MAP_project(BASE_LAT, BASE_LON + 80000 / (M_PER_DEG * cos(BASE_LAT * M_PI / 180.0)), x, y));
+}
+
+/**
+ * \brief Un paseo de 20 min con refresco cada segundo: bytes por fotograma y tiempo.
+ */
+static void test_partial_update_simulation() {
+  const int SECONDS = 1200, FIX_EVERY_S = 10;
+  FB_text(0, 0, "CONECTADO IP:");
+  FB_text(0, 8, "192.168.4.1");
+  MAP_setOrigin(BASE_LAT, BASE_LON);
+  MAP_render(MAP_AGE_UNKNOWN);
+  pushToPanel();
+
+  size_t fixBytes = 0, tickBytes = 0, maxBytes = 0;
+  int fixFrames = 0, tickFrames = 0;
+  double renderUs = 0, diffUs = 0;
+  uint32_t lastFix = 0;
+  for (int t = 1; t <= SECONDS; t++) {
+    bool fix = t % FIX_EVERY_S == 0;
+    if (fix) {
+      // Se aleja en espiral hasta ~600 m y vuelve
+      double r = 600.0 * sin(M_PI * t / SECONDS), a = t / 90.0;
+      fixAt(r * sin(a), r * cos(a));
+      lastFix = (uint32_t)t;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    MAP_render((uint32_t)t - lastFix);
+    auto t1 = std::chrono::steady_clock::now();
+    size_t bytes = pushToPanel();
+    auto t2 = std::chrono::steady_clock::now();
+    renderUs += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    diffUs   += std::chrono::duration<double, std::micro>(t2 - t1).count();
+    TEST_ASSERT_TRUE(panelMatches());
+    if (bytes > maxBytes) maxBytes = bytes;
+    if (fix) { fixBytes += bytes; fixFrames++; }
+    else { tickBytes += bytes; tickFrames++; }
+  }
+
+  double meanFix = (double)fixBytes / fixFrames, meanTick = (double)tickBytes / tickFrames;
+  double meanAll = (double)(fixBytes + tickBytes) / SECONDS;
+  printf("[FB] pantalla entera: %u B por fotograma\n", (unsigned)FULL_FRAME_BYTES);
+  printf("[FB] parcial: %.0f B con fix nuevo, %.0f B sin el (antiguedad), max %u B, media %.0f B (%.1f %%)\n",
+         meanFix, meanTick, (unsigned)maxBytes, meanAll, 100.0 * meanAll / FULL_FRAME_BYTES);
+  printf("[FB] bus medio: %.0f us a 8 MHz SPI, %.1f ms a 400 kHz I2C (entera: %.0f us / %.1f ms)\n",
+         meanAll * 8 / 8.0, meanAll * 9 / 400.0, FULL_FRAME_BYTES * 8 / 8.0, FULL_FRAME_BYTES * 9 / 400.0);
+  printf("[FB] host: %.2f us dibujo + %.2f us comparacion por fotograma\n",
+         renderUs / SECONDS, diffUs / SECONDS);
+
+  TEST_ASSERT_TRUE(meanAll < 0.1 * FULL_FRAME_BYTES);
+  TEST_ASSERT_TRUE(meanFix < 0.5 * FULL_FRAME_BYTES);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_push_then_nothing);
+  RUN_TEST(test_partial_segments);
+  RUN_TEST(test_primitives);
+  RUN_TEST(test_minimap_projection);
+  RUN_TEST(test_partial_update_simulation);
+  return UNITY_END();
+}
@@ -0,0 +1,207 @@
+/** @file test_main.cpp
+ * @brief Tests del seguimiento del error de frecuencia y simulación del modo de 62,5 kHz.
+ *
+ * La simulación recorre un día de subidas cada 10 s para 200 parejas
+ * base/collar con cristales de ±15 ppm, una deriva térmica diaria de ±3 ppm
+ * y ruido de 200 Hz en la medida. Una trama se recibe si el desvío cabe en el
+ * 25 % del ancho de banda. Se compara:
+ * - 62,5 kHz fijo sin seguimiento.
+ * - Seguimiento: empieza a 125 kHz, corrige el collar, pasa a 62,5 kHz cuando
+ *   FRQ_bandwidthOk() lo permite y vuelve a 125 kHz tras 12 tramas perdidas.
+ *   Cada bajada se pierde con un 10 % de probabilidad y respeta ≥200 s de
+ *   silencio (duty-cycle).
+ * Se informa además de la sensibilidad y el aire de cada modo.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "freq_track.h"
+#include "wake_radio.h"
+
+static const double F_HZ = 868.0e6;
+
+void setUp() { FRQ_begin(); }
+void tearDown() {}
+
+// ----------------- Generador determinista -----------------
+static uint32_t s_rng = 2024;
+
+static double uniform() {
+  s_rng = s_rng * 1664525UL + 1013904223UL;
+  return ((s_rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+// ----------------- Tests -----------------
+
+static void test_lock_and_correction() {
+  for (int i = 0; i < FRQ_LOCK_SAMPLES - 1; i++) {
+    TEST_ASSERT_TRUE(FRQ_observe((float)(8000 + gauss(200)), 5.0f));
+    TEST_ASSERT_EQUAL_INT16(0, FRQ_correctionHz());   // aún sin enganche
+  }
+  TEST_ASSERT_TRUE(FRQ_observe((float)(8000 + gauss(200)), 5.0f));
+  TEST_ASSERT_TRUE(FRQ_isLocked());
+  int16_t c = FRQ_correctionHz();
+  TEST_ASSERT_INT32_WITHIN(400, -8000, c);
+
+  // Tras corregir, el residuo previsto es ~0 y hay que volver a enganchar
+  FRQ_noteCorrection(c);
+  TEST_ASSERT_FALSE(FRQ_isLocked());
+  TEST_ASSERT_TRUE(fabsf(FRQ_state().meanHz) < 400.0f);
+  for (int i = 0; i < 10; i++) TEST_ASSERT_TRUE(FRQ_observe((float)(8000 + c + gauss(200)), 5.0f));
+  TEST_ASSERT_EQUAL_INT16(0, FRQ_correctionHz());
+}
+
+static void test_outliers_and_reacquire() {
+  for (int i = 0; i < 10; i++) FRQ_observe((float)(-3000 + gauss(150)), 0.0f);
+  float before = FRQ_state().meanHz;
+
+  // Uno aislado no mueve la media
+  TEST_ASSERT_FALSE(FRQ_observe(20000.0f, 0.0f));
+  TEST_ASSERT_EQUAL_FLOAT(before, FRQ_state().meanHz);
+  TEST_ASSERT_TRUE(FRQ_observe(-3000.0f, 0.0f));
+
+  // Varios seguidos (corrección perdida o reinicio): se readquiere
+  TEST_ASSERT_FALSE(FRQ_observe(12000.0f, 0.0f));
+  TEST_ASSERT_FALSE(FRQ_observe(12100.0f, 0.0f));
+  TEST_ASSERT_TRUE(FRQ_observe(11900.0f, 0.0f));
+  TEST_ASSERT_EQUAL_FLOAT(11900.0f, FRQ_state().meanHz);
+  TEST_ASSERT_FALSE(FRQ_isLocked());
+
+  // SNR baja o valor no finito: fuera
+  TEST_ASSERT_FALSE(FRQ_observe(11900.0f, -18.0f));
+  TEST_ASSERT_FALSE(FRQ_observe(NAN, 5.0f));
+  TEST_ASSERT_EQUAL_UINT16(1, FRQ_state().samples);
+}
+
+static void test_bandwidth_gate() {
+  TEST_ASSERT_FALSE(FRQ_bandwidthOk(125.0f));   // sin enganche
+  for (int i = 0; i < 10; i++) FRQ_observe((float)(14000 + gauss(200)), 5.0f);
+  TEST_ASSERT_TRUE(FRQ_bandwidthOk(125.0f));
+  TEST_ASSERT_FALSE(FRQ_bandwidthOk(WOR_NARROW_BW_KHZ));
+  FRQ_noteCorrection(FRQ_correctionHz());
+  for (int i = 0; i < 10; i++) FRQ_observe((float)(gauss(200)), 5.0f);
+  TEST_ASSERT_TRUE(FRQ_bandwidthOk(WOR_NARROW_BW_KHZ));
+  TEST_ASSERT_EQUAL_INT16(0, FRQ_correctionHz());
+}
+
+static void test_link_budget() {
+  // Misma fórmula que wake_radio para la modulación actual
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, WOR_airtimeMs(13, 8), FRQ_airtimeMs(13, 9, 125.0f, 7, 8));
+  // Mitad de ancho de banda: +3 dB con el mismo SF y el doble de aire
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 3.01f,
+                           FRQ_sensitivityDbm(9, 125.0f) - FRQ_sensitivityDbm(9, WOR_NARROW_BW_KHZ));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f * FRQ_airtimeMs(13, 9, 125.0f, 7, 8),
+                           FRQ_airtimeMs(13, 9, WOR_NARROW_BW_KHZ, 7, 8));
+  // Modo estrecho del enlace: SF8 a 62,5 kHz, el mismo aire que SF9/125 kHz y +0,5 dB
+  TEST_ASSERT_EQUAL_UINT8(WOR_NARROW_SF, WOR_uplinkSF(WOR_NARROW_BW_KHZ));
+  TEST_ASSERT_EQUAL_UINT8(9, WOR_uplinkSF(125.0f));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, FRQ_airtimeMs(13, WOR_NARROW_SF, WOR_NARROW_BW_KHZ, 7, 8),
+                           WOR_uplinkAirtimeMs(13, 8, WOR_NARROW_BW_KHZ));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, WOR_airtimeMs(13, 8), WOR_uplinkAirtimeMs(13, 8, WOR_NARROW_BW_KHZ));
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.51f,
+                           FRQ_sensitivityDbm(9, 125.0f) - FRQ_sensitivityDbm(8, WOR_NARROW_BW_KHZ));
+  // Símbolo ≥ 16 ms: optimización de baja tasa (SF12 a 125 kHz)
+  TEST_ASSERT_TRUE(FRQ_airtimeMs(13, 12, 125.0f, 7, 8) > 16 * FRQ_airtimeMs(13, 8, 125.0f, 7, 8) / 2);
+
+  printf("[FRQ] modo          sensibilidad  aire 13 B\n");
+  const struct { uint8_t sf; float bw; } modes[] = {{9, 125.0f}, {9, 62.5f}, {8, 62.5f}, {10, 125.0f}};
+  for (const auto& m : modes) {
+    printf("[FRQ] SF%-2u %5.1f kHz  %6.1f dBm    %6.1f ms\n", m.sf, (double)m.bw,
+           (double)FRQ_sensitivityDbm(m.sf, m.bw), (double)FRQ_airtimeMs(13, m.sf, m.bw, 7, 8));
+  }
+}
+
+/**
+ * \brief Un día de subidas por pareja: recepción a 62,5 kHz con y sin seguimiento.
+ */
+static void test_narrow_mode_simulation() {
+  const int PAIRS = 200, FRAMES = 8640, PERIOD_S = 10, SILENCE_FRAMES = 12;
+  const double PPM = 15.0, DRIFT_PPM = 3.0, NOISE_HZ = 200.0, DL_LOSS = 0.1;
+  const uint32_t DL_GAP_S = 200;
+  long fixedOk = 0, trackedOk = 0, narrowFrames = 0, total = 0, corrections = 0;
+
+  for (int p = 0; p < PAIRS; p++) {
+    FRQ_begin();
+    double staticHz = ((uniform() * 2 - 1) - (uniform() * 2 - 1)) * PPM * 1e-6 * F_HZ;
+    double phase = uniform() * 2 * M_PI;
+    double collarCorr = 0;
+    float baseBw = 125.0f, collarBw = 125.0f;
+    bool wideNeeded = false;   // la base ha vuelto a 125 kHz y debe ordenárselo al collar
+    int missed = 0;
+    long lastDl = -1000000;
+
+    for (int k = 0; k < FRAMES; k++) {
+      long t = (long)k * PERIOD_S;
+      double drift = DRIFT_PPM * 1e-6 * F_HZ * sin(2 * M_PI * t / 86400.0 + phase);
+      double raw = staticHz + drift;
+      total++;
+      if (fabs(raw) <= 0.25 * 62500.0) fixedOk++;
+
+      double off = raw + collarCorr;
+      bool rx = baseBw == collarBw && fabs(off) <= 0.25 * baseBw * 1000.0;
+      if (collarBw < 125.0f) narrowFrames++;
+      if (rx) {
+        trackedOk++;
+        missed = 0;
+        wideNeeded = false;
+        FRQ_observe((float)(off + gauss(NOISE_HZ)), 5.0f);
+      } else if (++missed >= SILENCE_FRAMES && baseBw < 125.0f) {
+        baseBw = 125.0f;
+        wideNeeded = true;
+        FRQ_begin();
+      }
+
+      // Bajadas (siempre a 125 kHz, que el collar escucha en cualquier modo)
+      if (t - lastDl < (long)DL_GAP_S) continue;
+      bool delivered = uniform() >= DL_LOSS;
+      int16_t c = FRQ_correctionHz();
+      if (wideNeeded) {
+        lastDl = t;
+        if (delivered) collarBw = 125.0f;
+      } else if (c) {
+        lastDl = t;
+        corrections++;
+        FRQ_noteCorrection(c);
+        if (delivered) collarCorr += c;
+      } else if (baseBw == 125.0f && FRQ_bandwidthOk(WOR_NARROW_BW_KHZ)) {
+        lastDl = t;
+        baseBw = WOR_NARROW_BW_KHZ;   // la base cambia al terminar la bajada
+        if (delivered) collarBw = WOR_NARROW_BW_KHZ;
+      }
+    }
+  }
+
+  double fixedPct = 100.0 * fixedOk / total, trackedPct = 100.0 * trackedOk / total;
+  double narrowPct = 100.0 * narrowFrames / total;
+  printf("[FRQ] 62,5 kHz sin seguimiento: %.1f %% de tramas recibidas\n", fixedPct);
+  printf("[FRQ] con seguimiento: %.2f %% recibidas, %.1f %% del tiempo a 62,5 kHz, %.1f correcciones/dia\n",
+         trackedPct, narrowPct, (double)corrections / PAIRS);
+  printf("[FRQ] a igual SF: %+.1f dB de sensibilidad (%.1fx aire); a igual alcance SF8/62,5 frente a "
+         "SF9/125: %+.1f dB y %+.0f %% de aire\n",
+         (double)(FRQ_sensitivityDbm(9, 125.0f) - FRQ_sensitivityDbm(9, 62.5f)),
+         (double)(FRQ_airtimeMs(13, 9, 62.5f, 7, 8) / FRQ_airtimeMs(13, 9, 125.0f, 7, 8)),
+         (double)(FRQ_sensitivityDbm(9, 125.0f) - FRQ_sensitivityDbm(8, 62.5f)),
+         100.0 * (FRQ_airtimeMs(13, 8, 62.5f, 7, 8) / FRQ_airtimeMs(13, 9, 125.0f, 7, 8) - 1.0));
+
+  TEST_ASSERT_TRUE(fixedPct < 90.0);
+  TEST_ASSERT_TRUE(trackedPct > 99.0);
+  TEST_ASSERT_TRUE(narrowPct > 95.0);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lock_and_correction);
+  RUN_TEST(test_outliers_and_reacquire);
+  RUN_TEST(test_bandwidth_gate);
+  RUN_TEST(test_link_budget);
+  RUN_TEST(test_narrow_mode_simulation);
+  return UNITY_END();
+}
@@ -0,0 +1,237 @@
+/** @file test_main.cpp
+ * @brief Tests del compresor gzip en streaming de las respuestas HTTP.
+ *
+ * La salida se descomprime con un inflador mínimo de bloques Huffman fijos
+ * (lo único que emite http_gzip) que comprueba también el CRC-32 y el tamaño de
+ * la cola gzip. Se informa de la ratio sobre respuestas típicas de la base.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "http_gzip.h"
+
+static GzStream s_gz;
+
+void setUp() {}
+void tearDown() {}
+
+// ----------------- Captura de la salida -----------------
+
+struct Capture {
+  std::vector<uint8_t> bytes;
+  size_t chunks = 0;
+  size_t maxChunk = 0;
+};
+
+static void captureSink(const char* data, size_t len, void* ctx) {
+  Capture* c = static_cast<Capture*>(ctx);
+  c->bytes.insert(c->bytes.end(), (const uint8_t*)data, (const uint8_t*)data + len);
+  c->chunks++;
+  if (len > c->maxChunk) c->maxChunk = len;
+}
+
+static Capture compress(const std::string& text, size_t piece) {
+  Capture c;
+  GZ_begin(s_gz, captureSink, &c);
+  for (size_t i = 0; i < text.size(); i += piece) {
+    GZ_write(s_gz, text.data() + i, text.size() - i < piece ? text.size() - i : piece);
+  }
+  GZ_finish(s_gz);
+  return c;
+}
+
+// ----------------- Inflador de referencia (sólo Huffman fijo) -----------------
+
+struct BitReader {
+  const std::vector<uint8_t>& in;
+  size_t pos;
+  uint8_t bit = 0;
+  bool bad = false;
+  uint32_t bits(uint8_t n) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      if (pos >= in.size()) { bad = true; return 0; }
+      v |= (uint32_t)((in[pos] >> bit) & 1) << i;
+      if (++bit == 8) { bit = 0; pos++; }
+    }
+    return v;
+  }
+  uint32_t code(uint8_t n) {   // Huffman: del bit más significativo al menos
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < n; i++) v = (v << 1) | bits(1);
+    return v;
+  }
+};
+
+static uint32_t crc32(const std::string& s) {
+  uint32_t c = 0xFFFFFFFFUL;
+  for (unsigned char ch : s) {
+    c ^= ch;
+    for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0xEDB88320UL & (0U - (c & 1)));
+  }
+  return ~c;
+}
+
+static bool inflate(const std::vector<uint8_t>& gz, std::string& out) {
+  static const uint16_t LB[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const uint8_t LE[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const uint16_t DB[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                  513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  if (gz.size() < 18 || gz[0] != 0x1F || gz[1] != 0x8B || gz[2] != 8 || gz[3] != 0) return false;
+  BitReader br{gz, 10};
+  out.clear();
+  bool last = false;
+  while (!last) {
+    last = br.bits(1);
+    if (br.bits(2) != 1) return false;
+    for (;;) {
+      uint32_t c = br.code(7), sym;
+      if (c <= 23) sym = 256 + c;
+      else {
+        c = (c << 1) | br.bits(1);
+        if (c >= 0x30 && c <= 0xBF) sym = c - 0x30;
+        else if (c >= 0xC0 && c <= 0xC7) sym = 280 + c - 0xC0;
+        else sym = 144 + ((c << 1) | br.bits(1)) - 0x190;
+      }
+      if (br.bad || sym > 285) return false;
+      if (sym < 256) { out += (char)sym; continue; }
+      if (sym == 256) break;
+      uint32_t len = LB[sym - 257] + br.bits(LE[sym - 257]);
+      uint32_t d = br.code(5);
+      if (d >= 30) return false;
+      uint32_t dist = DB[d] + br.bits(d < 4 ? 0 : (uint8_t)(d / 2 - 1));
+      if (dist > out.size()) return false;
+      for (uint32_t i = 0; i < len; i++) out += out[out.size() - dist];
+    }
+  }
+  size_t t = br.pos + (br.bit ? 1 : 0);
+  if (gz.size() != t + 8) return false;
+  uint32_t crc = 0, isize = 0;
+  for (int i = 0; i < 4; i++) crc |= (uint32_t)gz[t + i] << (8 * i);
+  for (int i = 0; i < 4; i++) isize |= (uint32_t)gz[t + 4 + i] << (8 * i);
+  return crc == crc32(out) && isize == out.size();
+}
+
+// ----------------- Respuestas típicas -----------------
+
+static std::string metricsText() {
+  std::string s;
+  char line[160];
+  for (int i = 0; i < 40; i++) {
+    snprintf(line, sizeof(line),
+             "# HELP lora_metric_%d Descripcion de la metrica numero %d\n# TYPE lora_metric_%d gauge\n"
+             "lora_metric_%d{channel=\"%d\"} %d.%03d\n", i, i, i, i, i % 8, i * 37 % 1000, i * 91 % 1000);
+    s += line;
+  }
+  return s;
+}
+
+static std::string healthCsv() {
+  std::string s = "edad_s,seq,uptime_min,reinicio,arranques,ttff_ultimo_s,ttff_p90_s,"
+                  "tx_fallos,ultimo_error,temp_c,loop_max_ms,gps_rx_hwm,heap_min_kb\n";
+  char line[96];
+  for (int i = 0; i < 16; i++) {
+    snprintf(line, sizeof(line), "%d,%d,%d,power_on,3,%d,%d,0,0,%d,%d,%d,180\n",
+             (16 - i) * 300, 100 + i, 1000 + 5 * i, 20 + i % 7, 31, 27 + i % 3, 12 + i % 5, 40 + i);
+    s += line;
+  }
+  return s;
+}
+
+static std::string pseudoRandom(size_t n) {
+  std::string s;
+  uint32_t x = 99;
+  for (size_t i = 0; i < n; i++) {
+    x = x * 1664525UL + 1013904223UL;
+    s += (char)(x >> 24);
+  }
+  return s;
+}
+
+// ----------------- Tests -----------------
+
+static void check_roundtrip(const std::string& text, size_t piece) {
+  Capture c = compress(text, piece);
+  std::string back;
+  TEST_ASSERT_TRUE(inflate(c.bytes, back));
+  TEST_ASSERT_TRUE(back == text);
+  TEST_ASSERT_EQUAL_UINT32(c.bytes.size(), s_gz.outBytes);
+  TEST_ASSERT_EQUAL_UINT32(text.size(), s_gz.inBytes);
+  TEST_ASSERT_LESS_OR_EQUAL(GZ_OUT_CHUNK, c.maxChunk);
+}
+
+static void test_roundtrip_small() {
+  check_roundtrip("", 1);
+  check_roundtrip("a", 1);
+  check_roundtrip("abcabcabcabcabc", 4);
+  check_roundtrip(std::string(1000, 'x'), 7);
+}
+
+static void test_roundtrip_across_windows() {
+  // Varias ventanas, trozos impares (cortes en mitad de coincidencias)
+  std::string big;
+  while (big.size() < 12 * GZ_WINDOW) big += metricsText();
+  check_roundtrip(big, 333);
+  check_roundtrip(big, 1);
+  check_roundtrip(healthCsv() + pseudoRandom(5000) + healthCsv(), 512);
+}
+
+static void test_incompressible_bounded() {
+  std::string r = pseudoRandom(8000);
+  Capture c = compress(r, 256);
+  // Peor caso del código fijo: 9 bits por byte más cabecera y cola
+  TEST_ASSERT_LESS_OR_EQUAL(r.size() * 9 / 8 + 32, c.bytes.size());
+}
+
+static void test_worth_it() {
+  TEST_ASSERT_FALSE(GZ_worthIt(nullptr, 4000));
+  TEST_ASSERT_FALSE(GZ_worthIt("identity", 4000));
+  TEST_ASSERT_FALSE(GZ_worthIt("gzip, deflate", GZ_MIN_BYTES - 1));
+  TEST_ASSERT_TRUE(GZ_worthIt("gzip, deflate, br", GZ_MIN_BYTES));
+  TEST_ASSERT_TRUE(GZ_worthIt("deflate, gzip", 0));   // tamaño desconocido (streaming)
+  TEST_ASSERT_FALSE(GZ_worthIt("x-compress", 0));      // "gzip" sólo como subcadena no cuenta
+  TEST_ASSERT_FALSE(GZ_worthIt("gzipx", 0));
+
+  // q-valores: q=0 rechaza la codificación
+  TEST_ASSERT_FALSE(GZ_worthIt("gzip;q=0", 0));
+  TEST_ASSERT_FALSE(GZ_worthIt("deflate, gzip ; q=0.000", 0));
+  TEST_ASSERT_FALSE(GZ_worthIt("br;q=1.0, GZIP;Q=0.0", 0));
+  TEST_ASSERT_TRUE(GZ_worthIt("gzip;q=0.5, identity;q=0", 0));
+  TEST_ASSERT_TRUE(GZ_worthIt("gzip;q=0.001", 0));
+  TEST_ASSERT_TRUE(GZ_worthIt("x-gzip", 0));
+  TEST_ASSERT_TRUE(GZ_worthIt("*", 0));
+  TEST_ASSERT_FALSE(GZ_worthIt("*;q=0", 0));
+  TEST_ASSERT_TRUE(GZ_worthIt("gzip, *;q=0", 0));      // la entrada explícita manda sobre *
+  TEST_ASSERT_FALSE(GZ_worthIt("*, gzip;q=0", 0));
+}
+
+static void test_typical_ratios() {
+  const struct { const char* name; std::string text; double minRatio; } cases[] = {
+    {"/metrics", metricsText(), 3.0},
+    {"/health", healthCsv(), 1.5},
+  };
+  for (const auto& k : cases) {
+    Capture c = compress(k.text, 512);
+    printf("[GZIP] %s: %u -> %u bytes (%.1fx, %u trozos)\n", k.name, (unsigned)k.text.size(),
+           (unsigned)c.bytes.size(), (double)k.text.size() / c.bytes.size(), (unsigned)c.chunks);
+    TEST_ASSERT_TRUE((double)k.text.size() / c.bytes.size() >= k.minRatio);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip_small);
+  RUN_TEST(test_roundtrip_across_windows);
+  RUN_TEST(test_incompressible_bounded);
+  RUN_TEST(test_worth_it);
+  RUN_TEST(test_typical_ratios);
+  return UNITY_END();
+}
@@ -0,0 +1,164 @@
+/** @file test_main.cpp
+ * @brief Tests del formato de la difusión multicast y del seguimiento del oyente.
+ *
+ * La última prueba simula un canal con pérdidas, duplicados y desorden y
+ * comprueba que los contadores del oyente cuadran con lo que hizo el canal.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "live_feed.h"
+
+static LfTracker s_t;
+
+void setUp() { LF_trackBegin(s_t); }
+void tearDown() {}
+
+static LiveFix fix(uint32_t seq, uint32_t sendMs, uint16_t bootId = 0x1234) {
+  LiveFix f{};
+  f.seq = seq; f.bootId = bootId; f.sendMs = sendMs;
+  f.lat = 40.4168123; f.lon = -3.7038456; f.hhmmss = 211507;
+  f.flags = LF_FLAG_DGPS | LF_FLAG_OUTSIDE; f.holdMs = 2480;
+  f.rssi = -117.4f; f.snr = -7.25f;
+  return f;
+}
+
+// ----------------- Tests -----------------
+
+static void test_roundtrip() {
+  uint8_t buf[LF_DATAGRAM_LEN + 4];
+  LiveFix in = fix(0xA1B2C3D4, 123456789);
+  TEST_ASSERT_EQUAL_UINT32(LF_DATAGRAM_LEN, LF_encode(in, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_UINT32(0, LF_encode(in, buf, LF_DATAGRAM_LEN - 1));
+  TEST_ASSERT_EQUAL_UINT8('L', buf[0]);
+  TEST_ASSERT_EQUAL_UINT8(0xD4, buf[4]);   // little-endian
+
+  LiveFix out;
+  TEST_ASSERT_TRUE(LF_decode(buf, LF_DATAGRAM_LEN, out));
+  TEST_ASSERT_EQUAL_UINT32(in.seq, out.seq);
+  TEST_ASSERT_EQUAL_UINT16(in.bootId, out.bootId);
+  TEST_ASSERT_EQUAL_UINT32(in.sendMs, out.sendMs);
+  TEST_ASSERT_EQUAL_UINT8(in.flags, out.flags);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-7, in.lat, out.lat);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-7, in.lon, out.lon);
+  TEST_ASSERT_EQUAL_UINT32(in.hhmmss, out.hhmmss);
+  TEST_ASSERT_EQUAL_UINT16(in.holdMs, out.holdMs);
+  TEST_ASSERT_EQUAL_FLOAT(-117.0f, out.rssi);
+  TEST_ASSERT_EQUAL_FLOAT(-7.25f, out.snr);
+
+  // Saturación de RSSI y SNR
+  in.rssi = -300.0f; in.snr = 40.0f;
+  LF_encode(in, buf, sizeof(buf));
+  LF_decode(buf, LF_DATAGRAM_LEN, out);
+  TEST_ASSERT_EQUAL_FLOAT(-255.0f, out.rssi);
+  TEST_ASSERT_EQUAL_FLOAT(31.75f, out.snr);
+}
+
+static void test_rejects_foreign() {
+  uint8_t buf[LF_DATAGRAM_LEN];
+  LF_encode(fix(1, 0), buf, sizeof(buf));
+  LiveFix out;
+  TEST_ASSERT_FALSE(LF_decode(buf, LF_DATAGRAM_LEN - 1, out));
+  buf[2] = LF_VERSION + 1;
+  TEST_ASSERT_FALSE(LF_decode(buf, LF_DATAGRAM_LEN, out));
+  buf[2] = LF_VERSION;
+  buf[0] = 'X';
+  TEST_ASSERT_FALSE(LF_decode(buf, LF_DATAGRAM_LEN, out));
+}
+
+static void test_sequence_events() {
+  TEST_ASSERT_EQUAL(LF_NEW, LF_track(s_t, fix(10, 1000), 5000).kind);
+  LfEvent ev = LF_track(s_t, fix(13, 2000), 6030);   // 11 y 12 perdidos, 30 ms más de retardo
+  TEST_ASSERT_EQUAL(LF_NEW, ev.kind);
+  TEST_ASSERT_EQUAL_UINT32(2, ev.gap);
+  TEST_ASSERT_EQUAL_UINT32(30, ev.jitterMs);
+  TEST_ASSERT_EQUAL_UINT32(2, s_t.lost);
+
+  TEST_ASSERT_EQUAL(LF_LATE, LF_track(s_t, fix(11, 1500), 5600).kind);
+  TEST_ASSERT_EQUAL_UINT32(1, s_t.lost);
+  TEST_ASSERT_EQUAL(LF_DUPLICATE, LF_track(s_t, fix(11, 1500), 5601).kind);
+  TEST_ASSERT_EQUAL(LF_DUPLICATE, LF_track(s_t, fix(13, 2000), 6031).kind);
+  TEST_ASSERT_EQUAL(LF_STALE, LF_track(s_t, fix(13 - LF_WINDOW, 0), 6032).kind);
+  TEST_ASSERT_EQUAL_UINT32(3, s_t.received);
+  TEST_ASSERT_EQUAL_UINT32(2, s_t.duplicates);
+
+  // Reinicio de la base: seq vuelve a empezar sin contar huecos
+  TEST_ASSERT_EQUAL(LF_RESTART, LF_track(s_t, fix(0, 50, 0x9999), 7000).kind);
+  TEST_ASSERT_EQUAL(LF_NEW, LF_track(s_t, fix(1, 1050, 0x9999), 8000).kind);
+  TEST_ASSERT_EQUAL_UINT32(1, s_t.restarts);
+  TEST_ASSERT_EQUAL_UINT32(1, s_t.lost);
+
+  // Vuelta del contador
+  LF_trackBegin(s_t);
+  LF_track(s_t, fix(0xFFFFFFFE, 0), 0);
+  ev = LF_track(s_t, fix(1, 0), 0);
+  TEST_ASSERT_EQUAL(LF_NEW, ev.kind);
+  TEST_ASSERT_EQUAL_UINT32(2, ev.gap);
+  TEST_ASSERT_EQUAL(LF_LATE, LF_track(s_t, fix(0xFFFFFFFF, 0), 0).kind);
+  TEST_ASSERT_EQUAL_UINT32(1, s_t.lost);
+
+  // Desorden justo al empezar: lo anterior al primer seq no cuenta como perdido
+  LF_trackBegin(s_t);
+  LF_track(s_t, fix(10, 0), 0);
+  TEST_ASSERT_EQUAL(LF_LATE, LF_track(s_t, fix(9, 0), 0).kind);
+  TEST_ASSERT_EQUAL_UINT32(0, s_t.lost);
+  TEST_ASSERT_EQUAL(LF_NEW, LF_track(s_t, fix(12, 0), 0).kind);
+  TEST_ASSERT_EQUAL(LF_LATE, LF_track(s_t, fix(8, 0), 0).kind);
+  TEST_ASSERT_EQUAL(LF_LATE, LF_track(s_t, fix(11, 0), 0).kind);
+  TEST_ASSERT_EQUAL_UINT32(0, s_t.lost);
+  TEST_ASSERT_EQUAL_UINT32(3, s_t.late);
+}
+
+/**
+ * Canal simulado: 2000 datagramas con un 5 % de pérdidas, un 2 % de
+ * duplicados y un 5 % retrasados hasta 8 posiciones.
+ */
+static void test_lossy_channel() {
+  srand(7);
+  const uint32_t N = 2000;
+  struct Pending { uint32_t seq; int delay; };
+  Pending held[64];
+  int heldCount = 0;
+  uint32_t dropped = 0, dups = 0, delayed = 0;
+
+  auto deliver = [&](uint32_t seq) {
+    LF_track(s_t, fix(seq, seq * 1000), seq * 1000 + 40 + (uint32_t)(rand() % 20));
+  };
+  for (uint32_t seq = 0; seq < N; seq++) {
+    int r = rand() % 100;
+    if (seq > 0 && seq < N - 1 && r < 5) { dropped++; continue; }
+    if (seq > 0 && seq < N - 10 && r < 10) { held[heldCount++] = {seq, 1 + rand() % 8}; delayed++; }
+    else {
+      deliver(seq);
+      if (r >= 98) { deliver(seq); dups++; }
+    }
+    for (int i = 0; i < heldCount;) {
+      if (--held[i].delay == 0) { deliver(held[i].seq); held[i] = held[--heldCount]; }
+      else i++;
+    }
+  }
+  printf("[FEED] canal: %u enviados, %u perdidos, %u duplicados, %u retrasados\n",
+         (unsigned)N, (unsigned)dropped, (unsigned)dups, (unsigned)delayed);
+  printf("[FEED] oyente: %u recibidos, %u perdidos, %u duplicados, %u tarde\n",
+         (unsigned)s_t.received, (unsigned)s_t.lost, (unsigned)s_t.duplicates, (unsigned)s_t.late);
+  TEST_ASSERT_EQUAL_UINT32(0, heldCount);
+  TEST_ASSERT_EQUAL_UINT32(N - dropped, s_t.received);
+  TEST_ASSERT_EQUAL_UINT32(dropped, s_t.lost);
+  TEST_ASSERT_EQUAL_UINT32(dups, s_t.duplicates);
+  TEST_ASSERT_TRUE(s_t.late > 0 && s_t.late <= delayed);
+  TEST_ASSERT_EQUAL_INT32(40, s_t.minOwdMs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip);
+  RUN_TEST(test_rejects_foreign);
+  RUN_TEST(test_sequence_events);
+  RUN_TEST(test_lossy_channel);
+  return UNITY_END();
+}
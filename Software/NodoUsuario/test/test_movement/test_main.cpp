@@ -0,0 +1,173 @@
+/** @file test_main.cpp
+ * @brief Tests del modelo de movimiento sobre una rutina sintética de varios días.
+ *
+ * Rutina (un fix por minuto): en casa con ruido de ~15 m salvo de 7:00 a 9:00,
+ * cuando da vueltas a ~1,4 m/s a un parque a 1,5 km. Se comprueba que lo
+ * habitual no se marca, que estar en el parque de madrugada o correr a 15 m/s
+ * sí, y que el estado guardado se restaura tal cual.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "movement_model.h"
+
+static const double HOME_LAT = 40.4168, HOME_LON = -3.7038;
+static const double PARK_LAT = 40.4303, PARK_LON = -3.7038;   // 1,5 km al norte
+static const double M_PER_DEG = 111320.0;
+static const uint8_t DAYS = 5;
+
+void setUp() { MOV_begin(); }
+void tearDown() {}
+
+// ----------------- Generador determinista -----------------
+static uint32_t s_rng = 4242;
+
+static double uniform() {
+  s_rng = s_rng * 1664525UL + 1013904223UL;
+  return ((s_rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static GpsInfo fix(double lat, double lon, uint32_t sod) {
+  GpsInfo g{};
+  g.lat = lat; g.lon = lon; g.valid = true;
+  g.hhmmss = (sod / 3600) * 10000 + ((sod / 60) % 60) * 100 + sod % 60;
+  return g;
+}
+
+/** Desplaza \p east / \p north metros desde (lat, lon). */
+static GpsInfo offset(double lat, double lon, double east, double north, uint32_t sod) {
+  return fix(lat + north / M_PER_DEG, lon + east / (M_PER_DEG * cos(lat * M_PI / 180.0)), sod);
+}
+
+/** Fix de la rutina en el segundo del día \p sod. */
+static GpsInfo routine(uint32_t sod) {
+  uint32_t hour = sod / 3600;
+  if (hour == 7 || hour == 8) {
+    double ang = 2.0 * M_PI * (sod % 900) / 900.0;   // círculo de 200 m en 15 min
+    return offset(PARK_LAT, PARK_LON, 200.0 * cos(ang) + gauss(5), 200.0 * sin(ang) + gauss(5), sod);
+  }
+  return offset(HOME_LAT, HOME_LON, gauss(15), gauss(15), sod);
+}
+
+static uint32_t learnDays(uint8_t days) {
+  uint32_t flagged = 0;
+  for (uint8_t d = 0; d < days; d++) {
+    for (uint32_t sod = 0; sod < 86400; sod += 60) {
+      if (MOV_observe(routine(sod)).flags) flagged++;
+    }
+  }
+  return flagged;
+}
+
+// ----------------- Tests -----------------
+
+static void test_warmup_never_flags() {
+  for (uint16_t i = 0; i < MOV_WARMUP; i++) {
+    // Saltos de kilómetros entre fixes seguidos: nada se marca sin datos
+    GpsInfo g = offset(HOME_LAT, HOME_LON, (i % 2) * 5000.0, 0, 3 * 3600 + i * 30);
+    MovScore sc = MOV_observe(g);
+    TEST_ASSERT_EQUAL_UINT8(0, sc.flags);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, sc.locFrac);
+  }
+  TEST_ASSERT_EQUAL_UINT32(MOV_WARMUP, MOV_hourSamples(3));
+}
+
+static void test_routine_is_quiet() {
+  learnDays(2);
+  // Los días siguientes casi no deberían producir alertas: sólo los saltos
+  // casa-parque de 1,5 km en un minuto (2 al día) y algún fix suelto
+  uint32_t flagged = learnDays(DAYS - 2);
+  printf("[MOV] %u alertas en %u fixes de rutina\n", (unsigned)flagged, (unsigned)(DAYS - 2) * 1440u);
+  TEST_ASSERT_LESS_THAN(15, (int)flagged);
+}
+
+static void test_park_at_night_flags_location() {
+  learnDays(DAYS);
+  MovScore sc = MOV_observe(offset(HOME_LAT, HOME_LON, 10, -5, 3 * 3600));
+  TEST_ASSERT_EQUAL_UINT8(0, sc.flags);
+  TEST_ASSERT_TRUE(sc.locFrac > 0.5f);
+
+  MOV_begin();
+  learnDays(DAYS);
+  sc = MOV_observe(fix(PARK_LAT, PARK_LON, 3 * 3600 + 60));
+  TEST_ASSERT_TRUE(sc.flags & MOV_FLAG_LOCATION);
+  TEST_ASSERT_EQUAL_UINT8(3, sc.hour);
+
+  // El parque a primera hora es lo normal
+  sc = MOV_observe(offset(PARK_LAT, PARK_LON, 200, 0, 7 * 3600 + 1800));
+  TEST_ASSERT_FALSE(sc.flags & MOV_FLAG_LOCATION);
+}
+
+static void test_sprint_flags_speed() {
+  learnDays(DAYS);
+  uint32_t t = 4 * 3600;
+  MOV_observe(fix(HOME_LAT, HOME_LON, t));
+  MovScore sc = MOV_observe(offset(HOME_LAT, HOME_LON, 0, 900, t + 60));   // 15 m/s
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 15.0f, sc.speedMps);
+  TEST_ASSERT_TRUE(sc.flags & MOV_FLAG_SPEED);
+
+  // Paseo a 1,4 m/s en la hora del parque: normal
+  t = 7 * 3600 + 600;
+  MOV_observe(routine(t));
+  sc = MOV_observe(routine(t + 60));
+  TEST_ASSERT_FALSE(sc.flags & MOV_FLAG_SPEED);
+}
+
+static void test_gap_skips_speed() {
+  MOV_observe(fix(HOME_LAT, HOME_LON, 1000));
+  MovScore sc = MOV_observe(offset(HOME_LAT, HOME_LON, 0, 900, 1000 + MOV_MAX_GAP_S + 1));
+  TEST_ASSERT_EQUAL_FLOAT(-1.0f, sc.speedMps);
+  // Cruce de medianoche: 60 s
+  MOV_observe(fix(HOME_LAT, HOME_LON, 86370));
+  sc = MOV_observe(offset(HOME_LAT, HOME_LON, 0, 60, 30));
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, sc.speedMps);
+}
+
+static void test_forgetting_bounds_counts() {
+  for (uint32_t i = 0; i < 2u * MOV_HALVE_AT; i++) MOV_observe(fix(HOME_LAT, HOME_LON, 5 * 3600 + i % 3600));
+  TEST_ASSERT_LESS_THAN(MOV_HALVE_AT, (int)MOV_hourSamples(5));
+  TEST_ASSERT_GREATER_THAN(MOV_HALVE_AT / 4, (int)MOV_hourSamples(5));
+}
+
+static void test_save_load_roundtrip() {
+  learnDays(2);
+  static MovState saved;
+  memcpy(&saved, &MOV_state(), sizeof(saved));
+
+  GpsInfo probe = fix(PARK_LAT, PARK_LON, 2 * 3600 + 600);
+  TEST_ASSERT_TRUE(MOV_load(&saved, sizeof(saved)));
+  MovScore a = MOV_observe(probe);
+  TEST_ASSERT_TRUE(MOV_load(&saved, sizeof(saved)));
+  TEST_ASSERT_EQUAL_MEMORY(&saved.cms, &MOV_state().cms, sizeof(saved) - offsetof(MovState, cms));
+  MovScore b = MOV_observe(probe);
+  TEST_ASSERT_EQUAL_UINT8(a.flags, b.flags);
+  TEST_ASSERT_EQUAL_FLOAT(a.locFrac, b.locFrac);
+  TEST_ASSERT_TRUE(a.flags & MOV_FLAG_LOCATION);
+
+  // Corrupto o de otro tamaño: se rechaza y el modelo queda vacío
+  saved.locTotal[2] ^= 1;
+  TEST_ASSERT_FALSE(MOV_load(&saved, sizeof(saved)));
+  TEST_ASSERT_EQUAL_UINT32(0, MOV_hourSamples(2));
+  TEST_ASSERT_FALSE(MOV_load(&saved, sizeof(saved) - 1));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_warmup_never_flags);
+  RUN_TEST(test_routine_is_quiet);
+  RUN_TEST(test_park_at_night_flags_location);
+  RUN_TEST(test_sprint_flags_speed);
+  RUN_TEST(test_gap_skips_speed);
+  RUN_TEST(test_forgetting_bounds_counts);
+  RUN_TEST(test_save_load_roundtrip);
+  return UNITY_END();
+}
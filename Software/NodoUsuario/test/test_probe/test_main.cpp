@@ -0,0 +1,207 @@
+/** @file test_main.cpp
+ * @brief Tests de la visita de sondeo de canal con una radio simulada.
+ *
+ * La radio simulada recibe una trama sólo si ha estado escuchando en su canal
+ * sin interrupción desde el principio del preámbulo hasta el final; cualquier
+ * resintonización o CAD entre medias la pierde, como el SX1262 al pasar por
+ * standby.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "channel_probe.h"
+
+static const float WORK_MHZ  = 868.0f;
+static const float OTHER_MHZ = 868.3f;
+
+// ----------------- Radio simulada -----------------------
+struct SimFrame {
+  float    freqMHz;
+  uint32_t startUs, endUs;
+  bool     done, delivered;
+};
+
+static uint32_t s_nowUs;
+static float    s_freq;
+static bool     s_rx;
+static uint32_t s_rxSinceUs;
+static bool     s_pending;        // aviso de trama (ISR)
+static bool     s_falsePreamble;  // IRQ de preámbulo sin trama
+static SimFrame s_frame;
+static bool     s_cadBusy;
+static uint8_t  s_rssiIdx;
+static uint32_t s_tunes, s_cads;
+
+/** Cierra la trama si ya terminó: se recibe si se escuchó entera. */
+static void settle() {
+  if (s_frame.done || s_nowUs < s_frame.endUs) return;
+  s_frame.done = true;
+  if (s_rx && s_freq == s_frame.freqMHz && s_rxSinceUs <= s_frame.startUs) {
+    s_frame.delivered = true;
+    s_pending = true;
+  }
+}
+
+static void simAdvance(uint32_t us) {
+  s_nowUs += us;
+  settle();
+}
+
+static bool simActivity() {
+  settle();
+  bool inFlight = !s_frame.done && s_frame.startUs <= s_nowUs && s_rx &&
+                  s_freq == s_frame.freqMHz && s_rxSinceUs <= s_frame.startUs;
+  return s_falsePreamble || inFlight;
+}
+static void  simClearActivity() { s_falsePreamble = false; }
+static bool  simPending() { settle(); return s_pending; }
+static bool  simTune(float freqMHz) {
+  settle();
+  s_tunes++;
+  s_freq = freqMHz;
+  s_rx = true;
+  s_falsePreamble = false;              // startReceive() borra los IRQ
+  simAdvance(200);
+  s_rxSinceUs = s_nowUs;
+  return true;
+}
+static float simRssi() {
+  settle();
+  static const float SAMPLES[PRB_RSSI_SAMPLES] = {-120, -118, -90, -121, -119, -117, -122, -116};
+  return SAMPLES[s_rssiIdx++ % PRB_RSSI_SAMPLES] + (s_freq == WORK_MHZ ? 0.0f : -3.0f);
+}
+static int8_t simCad() {
+  settle();
+  s_cads++;
+  s_rx = false;                         // standby + CAD
+  simAdvance(4000);
+  return s_cadBusy ? 1 : 0;
+}
+static void simDelayUs(uint32_t us) { simAdvance(us); }
+
+static const ProbeRadio SIM = {simActivity, simClearActivity, simPending, simTune,
+                               simRssi, simCad, simDelayUs};
+
+/** Trama del collar (~200 ms, SF9) que empieza en \p startUs. */
+static void scheduleFrame(uint32_t startUs) {
+  s_frame = {WORK_MHZ, startUs, (uint32_t)(startUs + 200000UL), false, false};
+}
+
+void setUp() {
+  PRB_begin();
+  s_nowUs = 1000000UL;
+  s_freq = WORK_MHZ;
+  s_rx = true;
+  s_rxSinceUs = 0;
+  s_pending = false;
+  s_falsePreamble = false;
+  s_frame = {WORK_MHZ, 0xFFFFFFF0UL, 0xFFFFFFFFUL, true, false};
+  s_cadBusy = false;
+  s_rssiIdx = 0;
+  s_tunes = s_cads = 0;
+}
+void tearDown() {}
+
+static ProbeResult visit(float freqMHz, float& rssi, bool& busy) {
+  return PRB_visit(SIM, WORK_MHZ, freqMHz, s_nowUs / 1000UL, rssi, busy);
+}
+
+// ----------------- Tests -----------------
+
+static void test_free_channel() {
+  float rssi = 0;
+  bool  busy = true;
+  TEST_ASSERT_EQUAL_UINT8(PRB_DONE, visit(WORK_MHZ, rssi, busy));
+  TEST_ASSERT_EQUAL_FLOAT(-118.0f, rssi);          // mediana: descarta el pico de -90
+  TEST_ASSERT_FALSE(busy);
+  TEST_ASSERT_TRUE(s_rx);
+  TEST_ASSERT_EQUAL_FLOAT(WORK_MHZ, s_freq);
+
+  s_cadBusy = true;
+  uint32_t t0 = s_nowUs;
+  TEST_ASSERT_EQUAL_UINT8(PRB_DONE, visit(OTHER_MHZ, rssi, busy));
+  TEST_ASSERT_EQUAL_FLOAT(-121.0f, rssi);
+  TEST_ASSERT_TRUE(busy);
+  TEST_ASSERT_TRUE(s_rx);
+  TEST_ASSERT_EQUAL_FLOAT(WORK_MHZ, s_freq);
+  TEST_ASSERT_TRUE(s_nowUs - t0 < 15000UL);         // fuera del canal de trabajo < 15 ms
+  TEST_ASSERT_FALSE(s_pending);
+}
+
+static void test_frame_in_flight_is_not_touched() {
+  scheduleFrame(s_nowUs - 2000UL);                 // preámbulo ya detectado
+  float rssi;
+  bool  busy;
+  TEST_ASSERT_EQUAL_UINT8(PRB_SKIPPED_BUSY, visit(OTHER_MHZ, rssi, busy));
+  TEST_ASSERT_EQUAL_UINT32(0, s_tunes);
+  TEST_ASSERT_EQUAL_UINT32(0, s_cads);
+  simAdvance(250000UL);
+  TEST_ASSERT_TRUE(s_frame.delivered);
+  TEST_ASSERT_TRUE(s_pending);
+}
+
+static void test_frame_during_sampling_is_delivered() {
+  scheduleFrame(s_nowUs + 1000UL);                 // empieza mientras se mide el RSSI
+  float rssi;
+  bool  busy;
+  TEST_ASSERT_EQUAL_UINT8(PRB_ABORTED_RX, visit(WORK_MHZ, rssi, busy));
+  TEST_ASSERT_EQUAL_UINT32(0, s_cads);
+  TEST_ASSERT_TRUE(s_rx);
+  simAdvance(250000UL);
+  TEST_ASSERT_TRUE(s_frame.delivered);
+  TEST_ASSERT_TRUE(s_pending);
+
+  // Sin la comprobación, la CAD la habría cortado: la simulación lo detecta
+  setUp();
+  scheduleFrame(s_nowUs + 1000UL);
+  simCad();
+  simTune(WORK_MHZ);
+  simAdvance(250000UL);
+  TEST_ASSERT_FALSE(s_frame.delivered);
+}
+
+static void test_pending_frame_is_kept() {
+  scheduleFrame(s_nowUs - 210000UL);               // terminó y aún no se ha leído
+  float rssi;
+  bool  busy;
+  TEST_ASSERT_EQUAL_UINT8(PRB_SKIPPED_BUSY, visit(WORK_MHZ, rssi, busy));
+  TEST_ASSERT_TRUE(s_frame.delivered);
+  TEST_ASSERT_TRUE(s_pending);
+  TEST_ASSERT_EQUAL_UINT32(0, s_tunes);
+
+  // Una visita completa tampoco borra un aviso que llegue después
+  s_pending = false;
+  TEST_ASSERT_EQUAL_UINT8(PRB_DONE, visit(WORK_MHZ, rssi, busy));
+  s_pending = true;
+  TEST_ASSERT_EQUAL_UINT8(PRB_SKIPPED_BUSY, visit(OTHER_MHZ, rssi, busy));
+  TEST_ASSERT_TRUE(s_pending);
+}
+
+static void test_false_preamble_expires() {
+  s_falsePreamble = true;
+  float rssi;
+  bool  busy;
+  for (uint32_t t = 0; t < PRB_STALE_MS; t += 1000) {
+    TEST_ASSERT_EQUAL_UINT8(PRB_SKIPPED_BUSY, visit(WORK_MHZ, rssi, busy));
+    TEST_ASSERT_TRUE(s_falsePreamble);
+    simAdvance(1000000UL);
+  }
+  // Más de PRB_STALE_MS: se borra, y la visita siguiente mide
+  TEST_ASSERT_EQUAL_UINT8(PRB_SKIPPED_BUSY, visit(WORK_MHZ, rssi, busy));
+  TEST_ASSERT_FALSE(s_falsePreamble);
+  simAdvance(1000000UL);
+  TEST_ASSERT_EQUAL_UINT8(PRB_DONE, visit(WORK_MHZ, rssi, busy));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_free_channel);
+  RUN_TEST(test_frame_in_flight_is_not_touched);
+  RUN_TEST(test_frame_during_sampling_is_delivered);
+  RUN_TEST(test_pending_frame_is_kept);
+  RUN_TEST(test_false_preamble_expires);
+  return UNITY_END();
+}
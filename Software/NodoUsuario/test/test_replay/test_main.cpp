@@ -0,0 +1,121 @@
+/** @file test_main.cpp
+ * @brief Tests del formato y del ritmo de las trazas de reproducción.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "replay_trace.h"
+
+void setUp() { RPL_begin(0); }
+void tearDown() {}
+
+static bool parse(const char* line, RplRecord& r) {
+  return RPL_parseLine(line, strlen(line), r);
+}
+
+// ----------------- Tests -----------------
+
+static void test_parse_line() {
+  RplRecord r;
+  TEST_ASSERT_TRUE(parse("1500 $GPRMC,211507.00,A,4024.99,N,00342.23,W,0.1,,181026,,,A*7C\r", r));
+  TEST_ASSERT_EQUAL_UINT32(1500, r.tMs);
+  TEST_ASSERT_EQUAL_UINT32(strlen("$GPRMC,211507.00,A,4024.99,N,00342.23,W,0.1,,181026,,,A*7C"), r.len);
+  TEST_ASSERT_EQUAL_MEMORY("$GPRMC", r.text, 6);
+
+  TEST_ASSERT_TRUE(parse("  0\t-97.5 6.25 -812 0102  ", r));
+  TEST_ASSERT_EQUAL_UINT32(0, r.tMs);
+  TEST_ASSERT_EQUAL_UINT32(strlen("-97.5 6.25 -812 0102"), r.len);
+
+  TEST_ASSERT_FALSE(parse("", r));
+  TEST_ASSERT_FALSE(parse("   \r", r));
+  TEST_ASSERT_FALSE(parse("# collar en el parque, 18/10/2026", r));
+  TEST_ASSERT_FALSE(parse("$GPGGA,sin,instante", r));
+  TEST_ASSERT_FALSE(parse("120", r));
+  TEST_ASSERT_FALSE(parse("12a $GPGGA", r));
+}
+
+static void test_frame_roundtrip() {
+  RplFrame in{};
+  in.rssi = -117.5f; in.snr = -8.25f; in.freqErrHz = -1234.0f;
+  for (size_t i = 0; i < 13; i++) in.data[i] = (uint8_t)(0xF0 + i * 7);
+  in.len = 13;
+
+  char line[RPL_MAX_LINE];
+  size_t n = RPL_formatFrame(98765, in, line, sizeof(line));
+  printf("[RPL] %s\n", line);
+  TEST_ASSERT_EQUAL_UINT32(strlen(line), n);
+  RplRecord r;
+  TEST_ASSERT_TRUE(RPL_parseLine(line, n, r));
+  TEST_ASSERT_EQUAL_UINT32(98765, r.tMs);
+  RplFrame out{};
+  TEST_ASSERT_TRUE(RPL_parseFrame(r.text, r.len, out));
+  TEST_ASSERT_EQUAL_FLOAT(in.rssi, out.rssi);
+  TEST_ASSERT_EQUAL_FLOAT(in.snr, out.snr);
+  TEST_ASSERT_EQUAL_FLOAT(in.freqErrHz, out.freqErrHz);
+  TEST_ASSERT_EQUAL_UINT32(in.len, out.len);
+  TEST_ASSERT_EQUAL_MEMORY(in.data, out.data, in.len);
+
+  // La trama más larga cabe en una línea
+  in.len = RPL_MAX_FRAME;
+  TEST_ASSERT_TRUE(RPL_formatFrame(0xFFFFFFFF, in, line, sizeof(line)) > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, RPL_formatFrame(0, in, line, 40));
+
+  static const char* const BAD[] = {
+    "-97 6", "-97 6 0", "-97 6 0 0", "-97 6 0 0G", "x 6 0 00", "-97 6.5.1 0 00",
+  };
+  for (const char* b : BAD) TEST_ASSERT_TRUE_MESSAGE(!RPL_parseFrame(b, strlen(b), out), b);
+  char tooLong[RPL_MAX_LINE] = "-97 6 0 ";
+  for (size_t i = 0; i <= RPL_MAX_FRAME; i++) strcat(tooLong, "AB");
+  TEST_ASSERT_FALSE(RPL_parseFrame(tooLong, strlen(tooLong), out));
+}
+
+/**
+ * Reproduce una traza de collar (NMEA por épocas de 1 s, ráfagas de 3
+ * sentencias) con un loop() de 5 ms y un bloqueo de 320 ms en la segunda pasada.
+ */
+static void test_pacing_and_passes() {
+  struct Rec { uint32_t t; };
+  Rec trace[30];
+  for (int i = 0; i < 30; i++) trace[i].t = 73000 + (uint32_t)(i / 3) * 1000 + (uint32_t)(i % 3) * 40;
+
+  uint32_t now = 5000;
+  RPL_begin(now);
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t passStart = now;
+    for (int i = 0; i < 30;) {
+      if (RPL_due(trace[i].t, now)) {
+        // Nunca antes de su instante grabado
+        TEST_ASSERT_TRUE(now - passStart >= trace[i].t - trace[0].t);
+        RPL_delivered(trace[i].t, now);
+        i++;
+        continue;
+      }
+      now += (pass == 1 && now - passStart == 3995) ? 320 : 5;   // justo antes de la 5.ª época
+    }
+    RplStats s = RPL_rewind(now);
+    printf("[RPL] pasada %u: %u registros, retraso max %u ms, medio %.1f ms\n", (unsigned)s.passes,
+           (unsigned)s.records, (unsigned)s.lateMaxMs, (double)s.lateSumMs / s.records);
+    TEST_ASSERT_EQUAL_UINT32(pass + 1, s.passes);
+    TEST_ASSERT_EQUAL_UINT32(30, s.records);
+    if (pass == 0) TEST_ASSERT_TRUE(s.lateMaxMs < 5);
+    else TEST_ASSERT_TRUE(s.lateMaxMs > 300 && s.lateMaxMs < 330);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, RPL_stats().records);
+  TEST_ASSERT_EQUAL_UINT32(2, RPL_stats().passes);
+
+  // Un instante anterior al primero (traza desordenada) sale enseguida
+  RPL_due(1000, now);
+  TEST_ASSERT_TRUE(RPL_due(500, now));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_line);
+  RUN_TEST(test_frame_roundtrip);
+  RUN_TEST(test_pacing_and_passes);
+  return UNITY_END();
+}
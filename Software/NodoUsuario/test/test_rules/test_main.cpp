@@ -0,0 +1,210 @@
+/** @file test_main.cpp
+ * @brief Tests del compilador y del intérprete de reglas de alerta.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "rule_engine.h"
+
+static float s_vars[RUL_VAR_COUNT];
+
+void setUp() {
+  RUL_begin();
+  for (auto& v : s_vars) v = NAN;
+}
+void tearDown() {}
+
+static bool compiles(const char* src) {
+  RuleError err;
+  bool ok = RUL_compile(src, err);
+  if (!ok) printf("[RUL] %s -> %u:%u %s\n", src, err.line, err.col, err.msg);
+  return ok;
+}
+
+// ----------------- Tests -----------------
+
+static void test_bytecode() {
+  TEST_ASSERT_TRUE(compiles("lejos: distancia > 500\n"
+                            "senal: rssi < -110   # débil\n"
+                            "media: snr * 0.5 >= 1"));
+  TEST_ASSERT_EQUAL_UINT8(3, RUL_count());
+  TEST_ASSERT_EQUAL_STRING("lejos", RUL_info(0).name);
+
+  const uint8_t lejos[] = {RUL_OP_LOAD, RUL_VAR_DISTANCE, RUL_OP_I16, 0xF4, 0x01, RUL_OP_GT};
+  TEST_ASSERT_EQUAL_UINT8(sizeof(lejos), RUL_info(0).codeLen);
+  TEST_ASSERT_EQUAL_MEMORY(lejos, RUL_code(0), sizeof(lejos));
+  // El signo se pliega en la constante
+  const uint8_t senal[] = {RUL_OP_LOAD, RUL_VAR_RSSI, RUL_OP_I8, (uint8_t)(int8_t)-110, RUL_OP_LT};
+  TEST_ASSERT_EQUAL_UINT8(sizeof(senal), RUL_info(1).codeLen);
+  TEST_ASSERT_EQUAL_MEMORY(senal, RUL_code(1), sizeof(senal));
+  TEST_ASSERT_EQUAL_UINT8(RUL_OP_F32, RUL_code(2)[2]);
+  TEST_ASSERT_EQUAL_UINT8(11, RUL_info(2).codeLen);
+}
+
+static void test_values_and_precedence() {
+  TEST_ASSERT_TRUE(compiles("a: 1 + 2 * 3 == 7 y no (2 > 3) o 0\n"
+                            "b: 10 min + 1.5km\n"
+                            "c: -(2 - 5) * 2 / 4\n"
+                            "d: 1 || 0 && 0\n"
+                            "e: !1 == 0\n"
+                            "f: temp - -3"));
+  s_vars[RUL_VAR_TEMP] = 40.0f;
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(0, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(2100.0f, RUL_value(1, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(1.5f, RUL_value(2, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(3, s_vars));   // && antes que ||
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(4, s_vars));   // ! por debajo de ==: !(1 == 0)
+  TEST_ASSERT_EQUAL_FLOAT(43.0f, RUL_value(5, s_vars));
+}
+
+static void test_missing_data() {
+  TEST_ASSERT_TRUE(compiles("a: distancia > 5\nb: distancia != 5\nc: no distancia > 5\nd: distancia * 0 == 0"));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, RUL_value(0, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, RUL_value(1, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(2, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, RUL_value(3, s_vars));
+  uint8_t fired[4];
+  TEST_ASSERT_EQUAL_UINT32(1, RUL_evaluate(s_vars, 0, fired, 4));
+  TEST_ASSERT_EQUAL_UINT8(2, fired[0]);
+}
+
+static void test_errors() {
+  static const struct { const char* src; uint16_t line, col; const char* msg; } CASES[] = {
+    {"x: distancia >", 1, 15, "se esperaba un numero"},
+    {"x: foo > 1", 1, 4, "variable desconocida"},
+    {"a: 1\n# otra\na: 2", 3, 1, "nombre repetido"},
+    {"x 5", 1, 3, "falta ':' tras el nombre"},
+    {"x: 1 2", 1, 6, "texto inesperado"},
+    {"x: 5 parsecs", 1, 6, "unidad desconocida (s, min, h, m, km)"},
+    {"x: (1 + 2", 1, 10, "falta ')'"},
+    {"x: 1 < 2 < 3", 1, 10, "texto inesperado"},
+    {"x: (((((((((1)))))))))", 1, 13, "demasiados parentesis anidados"},
+    {"x: 1+(1+(1+(1+(1+(1+(1+(1+1)))))))", 1, 28, "expresion demasiado compleja"},
+    {"nombre_demasiado_largo: 1", 1, 1, "nombre demasiado largo"},
+    {": 1", 1, 1, "se esperaba el nombre de la regla"},
+  };
+  TEST_ASSERT_TRUE(compiles("ok: 1"));
+  for (const auto& c : CASES) {
+    RuleError err;
+    TEST_ASSERT_FALSE(RUL_compile(c.src, err));
+    printf("[RUL] error %u:%u %s\n", err.line, err.col, err.msg);
+    TEST_ASSERT_EQUAL_UINT16(c.line, err.line);
+    TEST_ASSERT_EQUAL_UINT16(c.col, err.col);
+    TEST_ASSERT_EQUAL_STRING(c.msg, err.msg);
+  }
+  // Un error no toca las reglas anteriores
+  TEST_ASSERT_EQUAL_UINT8(1, RUL_count());
+  TEST_ASSERT_EQUAL_STRING("ok", RUL_info(0).name);
+
+  // Longitud máxima por regla: 13 comparaciones de 5 bytes + 12 Y
+  char src[512] = "x: 1";
+  for (int i = 0; i < 13; i++) strcat(src, " y rssi > 1");
+  RuleError err;
+  TEST_ASSERT_FALSE(RUL_compile(src, err));
+  TEST_ASSERT_EQUAL_STRING("regla demasiado larga", err.msg);
+
+  // Unarios repetidos: sin recursión, ni con el cuerpo entero de un POST /rules
+  static char deep[4200];
+  static const char* const REPEATS[] = {"!", "- ", "no "};
+  for (const char* rep : REPEATS) {
+    strcpy(deep, "x: ");
+    while (strlen(deep) + strlen(rep) + 2 < 4096) strcat(deep, rep);
+    strcat(deep, "1");
+    TEST_ASSERT_FALSE(RUL_compile(deep, err));
+    TEST_ASSERT_EQUAL_STRING("demasiados operadores unarios seguidos", err.msg);
+  }
+
+  // Columna de una línea muy larga: se satura en RUL_COL_MAX en lugar de dar la vuelta
+  static char wide[70010];
+  static const size_t WIDTHS[] = {65000, 70000};
+  for (size_t n : WIDTHS) {
+    memset(wide, ' ', sizeof(wide));
+    memcpy(wide, "x:", 2);
+    memcpy(&wide[n], "1 2", 4);
+    TEST_ASSERT_FALSE(RUL_compile(wide, err));
+    TEST_ASSERT_EQUAL_STRING("texto inesperado", err.msg);
+    TEST_ASSERT_EQUAL_UINT16(n < RUL_COL_MAX ? n + 3 : RUL_COL_MAX, err.col);
+  }
+  TEST_ASSERT_TRUE(compiles("a: !!3\nb: - - 2\nc: no no no 0\nd: - -rssi"));
+  s_vars[RUL_VAR_RSSI] = -90.0f;
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(0, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, RUL_value(1, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, RUL_value(2, s_vars));
+  TEST_ASSERT_EQUAL_FLOAT(-90.0f, RUL_value(3, s_vars));
+}
+
+static void test_edges_and_hold() {
+  TEST_ASSERT_TRUE(compiles("sin_fix: edad_fix > 10min durante 30s\nfuera: fuera == 1"));
+  TEST_ASSERT_EQUAL_UINT32(30, RUL_info(0).holdS);
+  uint8_t fired[2];
+  s_vars[RUL_VAR_OUTSIDE] = 0;
+  for (uint32_t t = 0; t < 700; t++) {
+    s_vars[RUL_VAR_FIX_AGE] = (float)t;
+    size_t n = RUL_evaluate(s_vars, t, fired, 2);
+    // 601 s es el primero por encima de 600; salta 30 s después, una sola vez
+    TEST_ASSERT_EQUAL_UINT32(t == 631 ? 1 : 0, n);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, RUL_info(0).fires);
+  TEST_ASSERT_TRUE(RUL_info(0).active);
+
+  // Llega un fix: se rearma y vuelve a saltar tras otros 10 min + 30 s
+  s_vars[RUL_VAR_FIX_AGE] = 0;
+  TEST_ASSERT_EQUAL_UINT32(0, RUL_evaluate(s_vars, 700, fired, 2));
+  TEST_ASSERT_FALSE(RUL_info(0).active);
+
+  // Flanco: la salida de la valla salta una vez aunque siga fuera
+  s_vars[RUL_VAR_OUTSIDE] = 1;
+  TEST_ASSERT_EQUAL_UINT32(1, RUL_evaluate(s_vars, 701, fired, 2));
+  TEST_ASSERT_EQUAL_UINT8(1, fired[0]);
+  TEST_ASSERT_EQUAL_UINT32(0, RUL_evaluate(s_vars, 702, fired, 2));
+
+  // Recompilar sin cambios conserva el estado; cambiar la regla lo reinicia
+  TEST_ASSERT_TRUE(compiles("fuera: fuera == 1\nsin_fix: edad_fix > 10min durante 30s"));
+  TEST_ASSERT_TRUE(RUL_info(0).active);
+  TEST_ASSERT_EQUAL_UINT32(1, RUL_info(1).fires);
+  TEST_ASSERT_EQUAL_UINT32(0, RUL_evaluate(s_vars, 703, fired, 2));
+  TEST_ASSERT_TRUE(compiles("fuera: fuera == 1 durante 5s"));
+  TEST_ASSERT_FALSE(RUL_info(0).active);
+  TEST_ASSERT_EQUAL_UINT32(0, RUL_evaluate(s_vars, 704, fired, 2));
+  TEST_ASSERT_EQUAL_UINT32(1, RUL_evaluate(s_vars, 709, nullptr, 0));
+}
+
+static void test_capacity() {
+  static char src[RUL_MAX_RULES * 40 + 64];
+  src[0] = '\0';
+  for (int i = 0; i < RUL_MAX_RULES; i++) {
+    char line[40];
+    snprintf(line, sizeof(line), "r%d: distancia > %d y snr > -5\n", i, 100 + i);
+    strcat(src, line);
+  }
+  TEST_ASSERT_TRUE(compiles(src));
+  TEST_ASSERT_EQUAL_UINT8(RUL_MAX_RULES, RUL_count());
+  strcat(src, "otra: 1\n");
+  RuleError err;
+  TEST_ASSERT_FALSE(RUL_compile(src, err));
+  TEST_ASSERT_EQUAL_STRING("demasiadas reglas", err.msg);
+  TEST_ASSERT_EQUAL_UINT16(RUL_MAX_RULES + 1, err.line);
+
+  size_t total = 0;
+  for (uint8_t i = 0; i < RUL_count(); i++) total += RUL_info(i).codeLen;
+  printf("[RUL] %u reglas: %u B de bytecode (%.1f B por regla) y %u B de estado\n",
+         RUL_count(), (unsigned)total, (double)total / RUL_count(),
+         (unsigned)(RUL_count() * sizeof(RuleInfo)));
+  TEST_ASSERT_TRUE(total <= RUL_CODE_POOL);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bytecode);
+  RUN_TEST(test_values_and_precedence);
+  RUN_TEST(test_missing_data);
+  RUN_TEST(test_errors);
+  RUN_TEST(test_edges_and_hold);
+  RUN_TEST(test_capacity);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/** @file test_main.cpp
+ * @brief Tests del saneado de longitud y la decodificación de tramas recibidas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "rx_decoder.h"
+
+void setUp() {}
+void tearDown() {}
+
+static size_t makeFrame(uint8_t* buf, double lat, double lon, uint32_t hhmmss) {
+  GpsInfo gi{};
+  gi.lat = lat; gi.lon = lon; gi.hhmmss = hhmmss; gi.valid = true;
+  return GPS_buildBinaryPayload(gi, buf, 13);
+}
+
+/** Longitudes negativas (códigos de error) y cero se descartan; las largas se recortan. */
+static void test_clamp_length() {
+  TEST_ASSERT_EQUAL_UINT32(0, RX_clampLength(-1, 64));
+  TEST_ASSERT_EQUAL_UINT32(0, RX_clampLength(0, 64));
+  TEST_ASSERT_EQUAL_UINT32(13, RX_clampLength(13, 64));
+  TEST_ASSERT_EQUAL_UINT32(64, RX_clampLength(64, 64));
+  TEST_ASSERT_EQUAL_UINT32(64, RX_clampLength(255, 64));
+  TEST_ASSERT_EQUAL_UINT32(64, RX_clampLength(INT32_MAX, 64));
+}
+
+/** Trama de posición válida. */
+static void test_decode_position() {
+  uint8_t buf[13];
+  TEST_ASSERT_EQUAL_UINT32(13, makeFrame(buf, 40.41678, -3.70379, 211507));
+
+  GpsInfo out{};
+  TEST_ASSERT_EQUAL_UINT8(RX_POSITION, RX_decodeFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_TRUE(out.valid);
+  TEST_ASSERT_EQUAL_UINT32(211507, out.hhmmss);
+  TEST_ASSERT_DOUBLE_WITHIN(0.000005, 40.41678, out.lat);
+  TEST_ASSERT_DOUBLE_WITHIN(0.000005, -3.70379, out.lon);
+}
+
+/** Longitudes distintas de 13 o buffer nulo. */
+static void test_decode_bad_length() {
+  uint8_t buf[32] = {1};
+  GpsInfo out{};
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, 0, out));
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, 12, out));
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, 14, out));
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(nullptr, 13, out));
+  TEST_ASSERT_FALSE(out.valid);
+}
+
+/** 13 B con fix≠1: formato inválido y la salida no se modifica. */
+static void test_decode_bad_format() {
+  uint8_t buf[13];
+  makeFrame(buf, 40.0, -3.0, 120000);
+  GpsInfo out{};
+  out.hhmmss = 42;
+
+  const uint8_t flags[] = {0x00, 0x02, 0xFF};
+  for (uint8_t flag : flags) {
+    buf[0] = flag;
+    TEST_ASSERT_EQUAL_UINT8(RX_BAD_FORMAT, RX_decodeFrame(buf, sizeof(buf), out));
+  }
+  TEST_ASSERT_EQUAL_UINT32(42, out.hhmmss);
+  TEST_ASSERT_FALSE(out.valid);
+}
+
+/** 13 B con fix=1 pero latitud fuera de rango: formato inválido. */
+static void test_decode_out_of_range() {
+  uint8_t buf[13];
+  makeFrame(buf, 40.0, -3.0, 120000);
+  int32_t lat = 9000001;   // 90.00001°
+  memcpy(&buf[5], &lat, 4);
+
+  GpsInfo out{};
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_FORMAT, RX_decodeFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_FALSE(out.valid);
+}
+
+/** Trama de salud: sólo se acepta si se pasa dónde guardarla. */
+static void test_decode_health() {
+  HealthFrame in{};
+  in.seq = 7; in.uptimeMin = 1440; in.resetReason = HLT_RESET_SOFTWARE; in.tempC = 31;
+  uint8_t buf[HLT_FRAME_LEN];
+  TEST_ASSERT_EQUAL_UINT32(HLT_FRAME_LEN, HLT_buildFrame(in, buf, sizeof(buf)));
+
+  GpsInfo out{};
+  HealthFrame h{};
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, sizeof(buf), out));
+  TEST_ASSERT_EQUAL_UINT8(RX_HEALTH, RX_decodeFrame(buf, sizeof(buf), out, &h));
+  TEST_ASSERT_EQUAL_UINT8(7, h.seq);
+  TEST_ASSERT_EQUAL_UINT32(1440, h.uptimeMin);
+  TEST_ASSERT_EQUAL_INT32(31, h.tempC);
+  TEST_ASSERT_FALSE(out.valid);
+
+  buf[0] = 0xB1;
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_FORMAT, RX_decodeFrame(buf, sizeof(buf), out, &h));
+}
+
+/** Alerta de valla: igual que la salud, y su posición sale en el resultado. */
+static void test_decode_geo_alert() {
+  GeoAlert in{4, true, {}};
+  in.fix.lat = 40.41234; in.fix.lon = -3.70111; in.fix.hhmmss = 101502; in.fix.valid = true;
+  uint8_t buf[GEO_ALERT_LEN];
+  TEST_ASSERT_EQUAL_UINT32(GEO_ALERT_LEN, GEO_buildAlert(in, buf, sizeof(buf)));
+
+  GpsInfo out{};
+  HealthFrame h{};
+  GeoAlert a{};
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_LENGTH, RX_decodeFrame(buf, sizeof(buf), out, &h));
+  TEST_ASSERT_EQUAL_UINT8(RX_GEO_ALERT, RX_decodeFrame(buf, sizeof(buf), out, &h, &a));
+  TEST_ASSERT_EQUAL_UINT8(4, a.fenceId);
+  TEST_ASSERT_TRUE(a.outside);
+  TEST_ASSERT_EQUAL_UINT32(101502, a.fix.hhmmss);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-5, 40.41234, a.fix.lat);
+  TEST_ASSERT_FALSE(out.valid);
+
+  buf[2] = 7;   // estado desconocido
+  TEST_ASSERT_EQUAL_UINT8(RX_BAD_FORMAT, RX_decodeFrame(buf, sizeof(buf), out, &h, &a));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_clamp_length);
+  RUN_TEST(test_decode_position);
+  RUN_TEST(test_decode_bad_length);
+  RUN_TEST(test_decode_bad_format);
+  RUN_TEST(test_decode_out_of_range);
+  RUN_TEST(test_decode_health);
+  RUN_TEST(test_decode_geo_alert);
+  return UNITY_END();
+}
@@ -0,0 +1,325 @@
+/** @file test_main.cpp
+ * @brief Tests del protocolo UDP de Semtech y del reenvío frente a un servidor local.
+ *
+ * El servidor de prueba es un socket UDP en 127.0.0.1 que hace de servidor de
+ * red: confirma los PUSH_DATA y PULL_DATA y extrae las tramas de cada `rxpk`.
+ * El reloj es simulado (pasos de 10 ms); los datagramas viajan por loopback.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "semtech_udp.h"
+#include "gnss_aiding.h"
+
+#if !defined(_WIN32)
+  #include <arpa/inet.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+#endif
+
+static const uint8_t EUI[8] = {0xE4, 0x5F, 0x01, 0xFF, 0xFE, 0x12, 0x34, 0x56};
+
+void setUp() { SUDP_begin(EUI, 0x1000); }
+void tearDown() {}
+
+// ----------------- Utilidades -----------------
+static SudpRxMeta meta(uint32_t tmstUs, uint32_t utc = 0) {
+  SudpRxMeta m{};
+  m.tmstUs = tmstUs; m.utc = utc; m.freqMHz = 868.0f;
+  m.sf = 9; m.bwKHz = 125; m.crDen = 7; m.rssi = -97.4f; m.snr = 6.5f;
+  return m;
+}
+
+static int b64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+static std::vector<uint8_t> b64Decode(const std::string& s) {
+  std::vector<uint8_t> out;
+  uint32_t acc = 0;
+  int bits = 0;
+  for (char c : s) {
+    int v = b64Value(c);
+    if (v < 0) break;
+    acc = acc << 6 | (uint32_t)v;
+    bits += 6;
+    if (bits >= 8) { bits -= 8; out.push_back((uint8_t)(acc >> bits)); }
+  }
+  return out;
+}
+
+/** Tramas (`data`) de un PUSH_DATA, en orden. */
+static std::vector<std::vector<uint8_t>> framesOf(const uint8_t* dg, size_t len) {
+  std::vector<std::vector<uint8_t>> out;
+  std::string json((const char*)dg + 12, len - 12);
+  const std::string key = "\"data\":\"";
+  for (size_t p = json.find(key); p != std::string::npos; p = json.find(key, p + 1)) {
+    size_t start = p + key.size();
+    out.push_back(b64Decode(json.substr(start, json.find('"', start) - start)));
+  }
+  return out;
+}
+
+static size_t ack(const uint8_t* dg, SudpType type, uint8_t* out) {
+  out[0] = 2; out[1] = dg[1]; out[2] = dg[2]; out[3] = type;
+  return 4;
+}
+
+// ----------------- Tests del protocolo -----------------
+static void test_base64() {
+  char out[16];
+  TEST_ASSERT_EQUAL(0, SUDP_base64((const uint8_t*)"", 0, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("", out);
+  SUDP_base64((const uint8_t*)"f", 1, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("Zg==", out);
+  SUDP_base64((const uint8_t*)"fo", 2, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("Zm8=", out);
+  TEST_ASSERT_EQUAL(8, SUDP_base64((const uint8_t*)"foobar", 6, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("Zm9vYmFy", out);
+  TEST_ASSERT_EQUAL(0, SUDP_base64((const uint8_t*)"foobar", 6, out, 8));   // sin sitio para '\0'
+}
+
+/** Cabecera, metadatos y trama en el `rxpk`; no sale antes de la ventana de lote. */
+static void test_push_format() {
+  const uint8_t frame[13] = {1, 0x40, 0xE2, 0x01, 0x00, 1, 2, 3, 4, 5, 6, 7, 8};
+  uint32_t utc = AID_utcFromDate(AidDate{2026, 10, 18, 12, 0, 0});
+  TEST_ASSERT_TRUE(SUDP_enqueue(frame, sizeof(frame), meta(123456789UL, utc), 0));
+
+  uint8_t dg[SUDP_DATAGRAM_MAX];
+  size_t len = SUDP_poll(0, dg, sizeof(dg));
+  TEST_ASSERT_EQUAL(SUDP_PULL_DATA, dg[3]);                     // keepalive inicial
+  TEST_ASSERT_EQUAL(12, len);
+  TEST_ASSERT_EQUAL(0, SUDP_poll(SUDP_BATCH_WINDOW_MS - 1, dg, sizeof(dg)));
+
+  len = SUDP_poll(SUDP_BATCH_WINDOW_MS, dg, sizeof(dg));
+  TEST_ASSERT_GREATER_THAN(12, len);
+  TEST_ASSERT_EQUAL(SUDP_VERSION, dg[0]);
+  TEST_ASSERT_EQUAL(SUDP_PUSH_DATA, dg[3]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(EUI, &dg[4], 8);
+
+  std::string json((const char*)dg + 12, len - 12);
+  TEST_ASSERT_EQUAL(0, json.find("{\"rxpk\":[{"));
+  TEST_ASSERT_TRUE(json.find("\"tmst\":123456789,") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"time\":\"2026-10-18T12:00:00Z\"") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"freq\":868.000000,") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"datr\":\"SF9BW125\",\"codr\":\"4/7\"") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"rssi\":-97,\"lsnr\":6.5,\"size\":13,") != std::string::npos);
+  TEST_ASSERT_EQUAL(json.size() - 2, json.rfind("]}"));
+
+  auto frames = framesOf(dg, len);
+  TEST_ASSERT_EQUAL(1, frames.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, frames[0].data(), sizeof(frame));
+}
+
+/** Sólo el PUSH_ACK con el token del lote lo saca de la cola. */
+static void test_ack_token() {
+  const uint8_t frame[4] = {1, 2, 3, 4};
+  for (int i = 0; i < SUDP_BATCH_MAX + 2; i++) SUDP_enqueue(frame, sizeof(frame), meta(i), 0);
+
+  uint8_t dg[SUDP_DATAGRAM_MAX], reply[4];
+  size_t len = SUDP_poll(0, dg, sizeof(dg));                    // lote lleno: sale ya
+  TEST_ASSERT_EQUAL(SUDP_PUSH_DATA, dg[3]);
+  TEST_ASSERT_EQUAL(SUDP_BATCH_MAX, framesOf(dg, len).size());
+
+  uint8_t wrong[4] = {2, (uint8_t)(dg[1] + 1), dg[2], SUDP_PUSH_ACK};
+  TEST_ASSERT_EQUAL(SUDP_PUSH_ACK, SUDP_receive(wrong, 4, 10));
+  TEST_ASSERT_EQUAL(SUDP_BATCH_MAX + 2, SUDP_pending());
+  TEST_ASSERT_FALSE(SUDP_online());
+
+  SUDP_receive(reply, ack(dg, SUDP_PUSH_ACK, reply), 10);
+  TEST_ASSERT_EQUAL(2, SUDP_pending());
+  TEST_ASSERT_TRUE(SUDP_online());
+  TEST_ASSERT_EQUAL(SUDP_BATCH_MAX, SUDP_stats().fwdFrames);
+
+  const uint8_t bad[4] = {1, 0, 0, SUDP_PUSH_ACK};
+  TEST_ASSERT_EQUAL(SUDP_INVALID, SUDP_receive(bad, 4, 10));
+  TEST_ASSERT_EQUAL(SUDP_INVALID, SUDP_receive(reply, 3, 10));
+}
+
+/** Sin confirmación: reintentos con espera exponencial hasta SUDP_RETRY_MAX_MS. */
+static void test_retry_backoff() {
+  const uint8_t frame[4] = {9, 9, 9, 9};
+  SUDP_enqueue(frame, sizeof(frame), meta(0), 0);
+  uint8_t dg[SUDP_DATAGRAM_MAX];
+  SUDP_poll(0, dg, sizeof(dg));                                 // PULL_DATA
+  uint32_t t = SUDP_BATCH_WINDOW_MS;
+  TEST_ASSERT_GREATER_THAN(0, SUDP_poll(t, dg, sizeof(dg)));
+
+  uint32_t expected = SUDP_ACK_TIMEOUT_MS;
+  std::vector<uint32_t> retries;
+  for (uint32_t now = t, end = t + 200000UL; now < end; now += 10) {
+    size_t len = SUDP_poll(now, dg, sizeof(dg));
+    if (len && dg[3] == SUDP_PUSH_DATA && framesOf(dg, len).size() == 1) {
+      retries.push_back(now - t);
+      t = now;
+    }
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(6, retries.size());
+  for (uint32_t gap : retries) {
+    TEST_ASSERT_EQUAL_UINT32(expected, gap);
+    expected = expected * 2 > SUDP_RETRY_MAX_MS ? SUDP_RETRY_MAX_MS : expected * 2;
+  }
+  TEST_ASSERT_FALSE(SUDP_online());
+  TEST_ASSERT_EQUAL(1, SUDP_pending());
+  TEST_ASSERT_EQUAL(retries.size(), SUDP_stats().retries);
+}
+
+/** Cola llena: se descarta la más antigua y se cuenta. */
+static void test_overflow_drops_oldest() {
+  for (uint32_t i = 0; i < SUDP_QUEUE_LEN + 5; i++) {
+    uint8_t frame[2] = {(uint8_t)i, (uint8_t)(i >> 8)};
+    bool kept = SUDP_enqueue(frame, sizeof(frame), meta(i), 0);
+    TEST_ASSERT_EQUAL(i < SUDP_QUEUE_LEN, kept);
+  }
+  TEST_ASSERT_EQUAL(SUDP_QUEUE_LEN, SUDP_pending());
+  TEST_ASSERT_EQUAL(5, SUDP_stats().dropped);
+
+  uint8_t dg[SUDP_DATAGRAM_MAX];
+  size_t len = SUDP_poll(0, dg, sizeof(dg));
+  TEST_ASSERT_EQUAL(5, framesOf(dg, len)[0][0]);                // la 6.ª es ahora la más antigua
+  TEST_ASSERT_FALSE(SUDP_enqueue(dg, 0, meta(0), 0));
+  TEST_ASSERT_FALSE(SUDP_enqueue(dg, SUDP_MAX_FRAME + 1, meta(0), 0));
+}
+
+/** PULL_DATA periódico y objeto `stat` con los contadores del intervalo. */
+static void test_keepalive_and_stat() {
+  uint8_t dg[SUDP_DATAGRAM_MAX];
+  int pulls = 0, stats = 0;
+  std::string lastStat;
+  for (uint32_t now = 0; now <= 60100; now += 10) {
+    size_t len = SUDP_poll(now, dg, sizeof(dg));
+    if (!len) continue;
+    if (dg[3] == SUDP_PULL_DATA) pulls++;
+    if (dg[3] == SUDP_PUSH_DATA) { stats++; lastStat.assign((const char*)dg + 12, len - 12); }
+  }
+  TEST_ASSERT_EQUAL(7, pulls);                                   // 0, 10, …, 60 s
+  TEST_ASSERT_EQUAL(2, stats);                                   // tras el PULL_DATA de 30 y 60 s
+  TEST_ASSERT_EQUAL(0, lastStat.find("{\"stat\":{\"rxnb\":0,\"rxok\":0,\"rxfw\":0,"));
+}
+
+// ----------------- Servidor de red local (UDP) -----------------
+#if !defined(_WIN32)
+/**
+ * \brief Servidor de prueba: confirma y guarda las tramas si está «en línea».
+ */
+struct NsStandIn {
+  int  fd = -1;
+  bool online = true;
+  std::vector<std::vector<uint8_t>> frames;
+  size_t pushes = 0, pulls = 0, maxBatch = 0;
+
+  uint16_t open() {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in a{};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, (sockaddr*)&a, sizeof(a));
+    socklen_t al = sizeof(a);
+    getsockname(fd, (sockaddr*)&a, &al);
+    return ntohs(a.sin_port);
+  }
+
+  void service() {
+    uint8_t buf[2048], reply[4];
+    sockaddr_in from{};
+    socklen_t fl = sizeof(from);
+    ssize_t n;
+    while ((n = recvfrom(fd, buf, sizeof(buf), MSG_DONTWAIT, (sockaddr*)&from, &fl)) > 0) {
+      if (!online || n < 12) continue;                          // caído: no confirma ni guarda
+      if (buf[3] == SUDP_PUSH_DATA) {
+        auto f = framesOf(buf, (size_t)n);
+        if (f.empty()) continue;                                // `stat`
+        pushes++;
+        if (f.size() > maxBatch) maxBatch = f.size();
+        frames.insert(frames.end(), f.begin(), f.end());
+        sendto(fd, reply, ack(buf, SUDP_PUSH_ACK, reply), 0, (sockaddr*)&from, fl);
+      } else if (buf[3] == SUDP_PULL_DATA) {
+        pulls++;
+        sendto(fd, reply, ack(buf, SUDP_PULL_ACK, reply), 0, (sockaddr*)&from, fl);
+      }
+    }
+  }
+};
+
+/**
+ * \brief Ráfaga de uplinks seguidos (uno cada 200 ms, el aire de una posición a
+ *        SF9) con el servidor caído 6 s: todas las tramas llegan, en orden,
+ *        sin descartes y agrupadas en lotes. La cola (64) cubre la caída más la
+ *        espera del reintento (hasta 9,2 s → 46 tramas).
+ */
+static void test_burst_with_outage() {
+  NsStandIn ns;
+  uint16_t port = ns.open();
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in srv{};
+  srv.sin_family = AF_INET;
+  srv.sin_port = htons(port);
+  srv.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  connect(fd, (sockaddr*)&srv, sizeof(srv));
+
+  const uint32_t FRAMES = 150, GAP_MS = 200, DOWN_FROM = 2000, DOWN_TO = 8000;
+  uint32_t next = 0;
+  uint8_t dg[SUDP_DATAGRAM_MAX], in[64];
+  for (uint32_t now = 0; now < 120000UL; now += 10) {
+    ns.online = now < DOWN_FROM || now >= DOWN_TO;
+    if (next < FRAMES && now >= next * GAP_MS) {
+      uint8_t frame[13] = {1, (uint8_t)next, (uint8_t)(next >> 8)};
+      SUDP_enqueue(frame, sizeof(frame), meta(now * 1000UL), now);
+      next++;
+    }
+    size_t len = SUDP_poll(now, dg, sizeof(dg));
+    if (len) send(fd, dg, len, 0);
+    ns.service();
+    ssize_t n;
+    while ((n = recv(fd, in, sizeof(in), MSG_DONTWAIT)) > 0) SUDP_receive(in, (size_t)n, now);
+    if (next == FRAMES && SUDP_pending() == 0) break;
+  }
+  close(fd);
+  close(ns.fd);
+
+  // Con reintentos puede haber duplicados (el servidor los filtra): se cuentan las únicas
+  std::vector<uint32_t> ids;
+  for (auto& f : ns.frames) {
+    uint32_t id = f[1] | f[2] << 8;
+    if (ids.empty() || id > ids.back()) ids.push_back(id);
+  }
+  printf("[UDP] %zu tramas en %zu PUSH_DATA (lote max %zu), %lu reintentos, %zu PULL_DATA\n",
+         ns.frames.size(), ns.pushes, ns.maxBatch, (unsigned long)SUDP_stats().retries, ns.pulls);
+  TEST_ASSERT_EQUAL(FRAMES, ids.size());
+  for (uint32_t i = 0; i < FRAMES; i++) TEST_ASSERT_EQUAL(i, ids[i]);
+  TEST_ASSERT_EQUAL(0, SUDP_stats().dropped);
+  TEST_ASSERT_EQUAL(0, SUDP_pending());
+  TEST_ASSERT_TRUE(SUDP_online());
+  TEST_ASSERT_GREATER_THAN(1, ns.maxBatch);                     // la cola acumulada sale en lotes
+  TEST_ASSERT_LESS_THAN(FRAMES, ns.pushes);
+  TEST_ASSERT_GREATER_THAN(0, ns.pulls);
+}
+#else
+static void test_burst_with_outage() {
+  TEST_IGNORE_MESSAGE("Requiere sockets POSIX");
+}
+#endif
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_base64);
+  RUN_TEST(test_push_format);
+  RUN_TEST(test_ack_token);
+  RUN_TEST(test_retry_backoff);
+  RUN_TEST(test_overflow_drops_oldest);
+  RUN_TEST(test_keepalive_and_stat);
+  RUN_TEST(test_burst_with_outage);
+  return UNITY_END();
+}
@@ -0,0 +1,189 @@
+/** @file feed_listen.cpp
+ * @brief Oyente en el host de la difusión multicast de posiciones (live_feed).
+ *
+ * Se une al grupo, muestra cada posición y, cada 60 s y al salir (Ctrl+C),
+ * un resumen por base:
+ * - Entrega: recibidos, perdidos (huecos sin rellenar), tarde, duplicados y
+ *   reinicios de la base.
+ * - Retardo en la base: recepción LoRa → envío (`espera_ms` del datagrama).
+ * - Variación del retardo de la red: recepción − envío sobre el mínimo visto
+ *   (no hace falta sincronizar relojes).
+ * - Edad del fix al llegar: hora UTC del host − hora del fix (resolución de
+ *   1 s; supone el host en hora por NTP).
+ *
+ * Compilación y uso (Linux/macOS):
+ *
+ *     g++ -std=gnu++17 -O2 -I../include feed_listen.cpp ../src/live_feed.cpp -o feed_listen
+ *     ./feed_listen [-q] [grupo] [puerto] [interfaz]
+ *
+ * `-q` sólo imprime los resúmenes y los huecos; `interfaz` es la IP local por
+ * la que unirse al grupo (por defecto, la que elija el sistema).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include <algorithm>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include "live_feed.h"
+
+static const int      MAX_BASES  = 8;
+static const uint32_t SUMMARY_MS = 60000;
+
+struct Base {
+  in_addr               addr;
+  LfTracker             track;
+  std::vector<uint32_t> holdMs, jitterMs;
+  std::vector<int32_t>  ageS;
+};
+
+static volatile sig_atomic_t s_stop = 0;
+static Base s_bases[MAX_BASES];
+static int  s_baseCount = 0;
+
+static void onSignal(int) { s_stop = 1; }
+
+static uint32_t monoMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000);
+}
+
+/** \brief Edad (s) de un fix hhmmss respecto a la hora UTC del host (vuelta a medianoche incluida). */
+static int32_t fixAgeS(uint32_t hhmmss) {
+  time_t now = time(nullptr);
+  int32_t nowS = (int32_t)(now % 86400);
+  int32_t fixS = (int32_t)(hhmmss / 10000 * 3600 + hhmmss / 100 % 100 * 60 + hhmmss % 100);
+  int32_t age  = nowS - fixS;
+  if (age < -43200) age += 86400;
+  if (age > 43200) age -= 86400;
+  return age;
+}
+
+template <typename T>
+static T percentile(std::vector<T> v, double p) {
+  if (v.empty()) return 0;
+  size_t k = (size_t)(p * (v.size() - 1) + 0.5);
+  std::nth_element(v.begin(), v.begin() + k, v.end());
+  return v[k];
+}
+
+static Base* baseFor(in_addr a) {
+  for (int i = 0; i < s_baseCount; i++)
+    if (s_bases[i].addr.s_addr == a.s_addr) return &s_bases[i];
+  if (s_baseCount == MAX_BASES) return nullptr;
+  Base& b = s_bases[s_baseCount++];
+  b.addr = a;
+  LF_trackBegin(b.track);
+  return &b;
+}
+
+static void summary() {
+  for (int i = 0; i < s_baseCount; i++) {
+    const Base& b = s_bases[i];
+    const LfTracker& t = b.track;
+    uint32_t expected = t.received + t.lost;
+    printf("[FEED] %s: recibidos=%u perdidos=%u (%.2f %%) tarde=%u duplicados=%u reinicios=%u\n",
+           inet_ntoa(b.addr), t.received, t.lost, expected ? 100.0 * t.lost / expected : 0.0,
+           t.late, t.duplicates, t.restarts);
+    if (b.holdMs.empty()) continue;
+    printf("[FEED]   espera en la base ms: p50=%u p95=%u max=%u\n",
+           percentile(b.holdMs, 0.5), percentile(b.holdMs, 0.95),
+           *std::max_element(b.holdMs.begin(), b.holdMs.end()));
+    printf("[FEED]   variacion del retardo de red ms: p50=%u p95=%u max=%u\n",
+           percentile(b.jitterMs, 0.5), percentile(b.jitterMs, 0.95),
+           *std::max_element(b.jitterMs.begin(), b.jitterMs.end()));
+    printf("[FEED]   edad del fix al llegar s: p50=%d p95=%d max=%d\n",
+           percentile(b.ageS, 0.5), percentile(b.ageS, 0.95),
+           *std::max_element(b.ageS.begin(), b.ageS.end()));
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+  bool quiet = argc > 1 && strcmp(argv[1], "-q") == 0;
+  int arg = quiet ? 2 : 1;
+  const char* group = argc > arg ? argv[arg] : LF_GROUP;
+  int port          = argc > arg + 1 ? atoi(argv[arg + 1]) : LF_PORT;
+  const char* iface = argc > arg + 2 ? argv[arg + 2] : nullptr;
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) { perror("socket"); return 1; }
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#if defined(SO_REUSEPORT)
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));   // varios oyentes en el mismo host
+#endif
+  sockaddr_in local{};
+  local.sin_family      = AF_INET;
+  local.sin_port        = htons((uint16_t)port);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (sockaddr*)&local, sizeof(local)) < 0) { perror("bind"); return 1; }
+
+  ip_mreq mreq{};
+  if (inet_aton(group, &mreq.imr_multiaddr) == 0) {
+    fprintf(stderr, "grupo no valido: %s\n", group);
+    return 1;
+  }
+  mreq.imr_interface.s_addr = iface ? inet_addr(iface) : htonl(INADDR_ANY);
+  if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+    perror("IP_ADD_MEMBERSHIP");
+    return 1;
+  }
+  timeval tv{1, 0};   // despierta para los resúmenes y Ctrl+C
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  printf("[FEED] Escuchando %s:%d\n", group, port);
+  fflush(stdout);
+
+  uint32_t lastSummary = monoMs();
+  while (!s_stop) {
+    uint8_t buf[64];
+    sockaddr_in from{};
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+    uint32_t now = monoMs();
+    if (now - lastSummary >= SUMMARY_MS) {
+      lastSummary = now;
+      summary();
+    }
+    LiveFix fix;
+    if (n <= 0 || !LF_decode(buf, (size_t)n, fix)) continue;
+    Base* b = baseFor(from.sin_addr);
+    if (!b) continue;
+
+    LfEvent ev = LF_track(b->track, fix, now);
+    if (ev.kind == LF_DUPLICATE || ev.kind == LF_STALE) continue;
+    if (ev.kind == LF_RESTART) {
+      b->jitterMs.clear();   // otro reloj de la base: otro mínimo
+      printf("[FEED] %s: reinicio de la base (arranque %04x)\n", inet_ntoa(b->addr), fix.bootId);
+    }
+    if (ev.gap) printf("[FEED] %s: hueco de %u antes de seq=%u\n", inet_ntoa(b->addr), ev.gap, fix.seq);
+    int32_t age = fixAgeS(fix.hhmmss);
+    b->holdMs.push_back(fix.holdMs);
+    b->jitterMs.push_back(ev.jitterMs);
+    b->ageS.push_back(age);
+    if (!quiet) {
+      printf("seq=%u%s hhmmss=%06u lat=%.7f lon=%.7f rssi=%.0f snr=%.2f espera_ms=%u red_ms=+%u edad_s=%d%s%s%s\n",
+             fix.seq, ev.kind == LF_LATE ? " (tarde)" : "", fix.hhmmss, fix.lat, fix.lon,
+             fix.rssi, fix.snr, fix.holdMs, ev.jitterMs, age,
+             fix.flags & LF_FLAG_DGPS ? " DGPS" : "", fix.flags & LF_FLAG_ANOMALY ? " ANOMALIA" : "",
+             fix.flags & LF_FLAG_OUTSIDE ? " FUERA" : "");
+      fflush(stdout);
+    }
+  }
+  summary();
+  close(fd);
+  return 0;
+}
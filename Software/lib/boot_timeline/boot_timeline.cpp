@@ -0,0 +1,103 @@
+/** @file boot_timeline.cpp
+ * @brief Implementación del registro de la línea temporal de arranque.
+ *
+ * Tabla fija en RAM (sin memoria dinámica); las fases no cerradas se muestran
+ * como "abierta" en el informe.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "boot_timeline.h"
+
+// ----------------- Configuración -----------------------
+static const uint8_t BOOT_MAX_PHASES = 12;
+static const uint8_t BOOT_MAX_EVENTS = 6;
+
+struct BootPhaseEntry {
+  const char* name;
+  uint32_t    startUs;
+  uint32_t    endUs;     // 0 = abierta
+};
+
+struct BootEventEntry {
+  const char* name;
+  uint32_t    atUs;
+};
+
+// ----------------- Estado interno -----------------------
+static BootPhaseEntry s_phases[BOOT_MAX_PHASES];
+static uint8_t        s_nPhases = 0;
+static BootEventEntry s_events[BOOT_MAX_EVENTS];
+static uint8_t        s_nEvents = 0;
+
+/**
+ * \brief Añade la fase a la tabla con la hora de inicio.
+ */
+BootPhase BOOT_start(const char* name) {
+  if (s_nPhases >= BOOT_MAX_PHASES) return 0xFF;
+  s_phases[s_nPhases] = {name, micros(), 0};
+  return s_nPhases++;
+}
+
+/**
+ * \brief Anota la hora de fin (ignora índices no válidos o fases ya cerradas).
+ */
+void BOOT_end(BootPhase phase) {
+  if (phase >= s_nPhases || s_phases[phase].endUs != 0) return;
+  s_phases[phase].endUs = micros();
+}
+
+/**
+ * \brief Busca el hito por nombre.
+ */
+static const BootEventEntry* findEvent(const char* name) {
+  for (uint8_t i = 0; i < s_nEvents; i++) {
+    if (strcmp(s_events[i].name, name) == 0) return &s_events[i];
+  }
+  return nullptr;
+}
+
+/**
+ * \brief Registra el hito sólo la primera vez.
+ */
+bool BOOT_event(const char* name) {
+  if (s_nEvents >= BOOT_MAX_EVENTS || findEvent(name)) return false;
+  s_events[s_nEvents++] = {name, micros()};
+  return true;
+}
+
+/**
+ * \brief Instante del hito en ms desde el reset.
+ */
+uint32_t BOOT_eventMs(const char* name) {
+  const BootEventEntry* e = findEvent(name);
+  return e ? e->atUs / 1000UL : 0;
+}
+
+/**
+ * \brief Una línea por fase (`inicio..fin = duración`) y otra por hito.
+ */
+void BOOT_report(Stream& port) {
+  port.println("[BOOT] fase            inicio_ms  fin_ms  dur_ms");
+  for (uint8_t i = 0; i < s_nPhases; i++) {
+    const BootPhaseEntry& p = s_phases[i];
+    char line[64];
+    if (p.endUs) {
+      snprintf(line, sizeof(line), "[BOOT] %-16s %8lu %7lu %7lu", p.name,
+               (unsigned long)(p.startUs / 1000UL), (unsigned long)(p.endUs / 1000UL),
+               (unsigned long)((p.endUs - p.startUs) / 1000UL));
+    } else {
+      snprintf(line, sizeof(line), "[BOOT] %-16s %8lu  abierta", p.name,
+               (unsigned long)(p.startUs / 1000UL));
+    }
+    port.println(line);
+  }
+  for (uint8_t i = 0; i < s_nEvents; i++) {
+    port.print("[BOOT] hito ");
+    port.print(s_events[i].name);
+    port.print(" @ ");
+    port.print(s_events[i].atUs / 1000UL);
+    port.println(" ms");
+  }
+}
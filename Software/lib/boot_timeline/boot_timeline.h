@@ -0,0 +1,47 @@
+/** @file boot_timeline.h
+ * @brief Registro de la línea temporal de arranque (fases e hitos).
+ *
+ * Cada fase de `setup()` se abre con BOOT_start() y se cierra con BOOT_end(); las
+ * fases pueden solaparse (p.ej. la radio ya recibe mientras el WiFi se asocia).
+ * Los hitos (BOOT_event()) marcan instantes como la primera recepción o la
+ * primera transmisión y sólo se registran la primera vez.
+ *
+ * Los tiempos son relativos al reset (`micros()` del RP2040), de modo que la
+ * primera fila incluye lo que tarda el núcleo en llegar a `setup()`.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <Arduino.h>
+
+/** Índice de fase devuelto por BOOT_start() (0xFF si la tabla está llena). */
+typedef uint8_t BootPhase;
+
+/**
+ * \brief Abre una fase de arranque.
+ * \param name Nombre estático (no se copia).
+ */
+BootPhase BOOT_start(const char* name);
+
+/**
+ * \brief Cierra la fase indicada.
+ */
+void BOOT_end(BootPhase phase);
+
+/**
+ * \brief Registra un hito la primera vez que se produce (las siguientes se ignoran).
+ * \return true si es la primera vez.
+ */
+bool BOOT_event(const char* name);
+
+/**
+ * \brief Milisegundos desde el reset en que ocurrió el hito (0 si no ha ocurrido).
+ */
+uint32_t BOOT_eventMs(const char* name);
+
+/**
+ * \brief Vuelca la tabla: inicio, fin y duración de cada fase y los hitos.
+ */
+void BOOT_report(Stream& port);
@@ -0,0 +1,242 @@
+/** @file geofence.cpp
+ * @brief Implementación de la valla virtual (tramas, punto en polígono entero e histéresis).
+ *
+ * La banda de histéresis compara la distancia a cada lado con GEO_MARGIN_M
+ * sin raíces por fix: |cruz| < margen · longitud, con la longitud de cada lado
+ * calculada una vez en GEO_setFence().
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "geofence.h"
+#include <math.h>
+#include <string.h>
+
+// ----------------- Configuración -----------------------
+/** Metros por 1e-5 grados de latitud en Q16 (111 319,5 m/grado). */
+static const int64_t LAT_SCALE_Q16 = 72954;
+static const double  DEG2RAD       = 3.14159265358979323846 / 180.0;
+
+// ----------------- Estado interno -----------------------
+static GeoFence s_fence;
+static uint32_t s_edgeLen[GEO_MAX_VERTICES];   // longitud del lado i-1 → i (m)
+static bool     s_outside = false;
+static uint8_t  s_run     = 0;   // fixes seguidos al otro lado del borde
+static bool     s_announced  = false;   // estado de la última alerta (false = dentro)
+static bool     s_alerted    = false;   // ya salió alguna alerta
+static uint32_t s_lastAlertMs = 0;
+
+static uint32_t lonScaleQ16(int32_t lat0) {
+  return (uint32_t)lround((double)LAT_SCALE_Q16 * cos(lat0 * 1e-5 * DEG2RAD));
+}
+
+/**
+ * \brief Metros este/norte desde el origen; false si quedan fuera de ±32 km.
+ */
+static bool toLocal(const GeoFence& f, int32_t lat5, int32_t lon5, int32_t& east, int32_t& north) {
+  int64_t n = ((int64_t)(lat5 - f.lat0) * LAT_SCALE_Q16) >> 16;
+  int64_t e = ((int64_t)(lon5 - f.lon0) * f.lonScaleQ16) >> 16;
+  if (n < INT16_MIN || n > INT16_MAX || e < INT16_MIN || e > INT16_MAX) return false;
+  east  = (int32_t)e;
+  north = (int32_t)n;
+  return true;
+}
+
+bool GEO_fenceFromPoints(uint8_t id, const double* lat, const double* lon, uint8_t n, GeoFence& out) {
+  if (!lat || !lon || n < 3 || n > GEO_MAX_VERTICES) return false;
+  GeoFence f{};
+  f.id    = id;
+  f.count = n;
+  f.lat0  = (int32_t)lround(lat[0] * 100000.0);
+  f.lon0  = (int32_t)lround(lon[0] * 100000.0);
+  f.lonScaleQ16 = lonScaleQ16(f.lat0);
+  for (uint8_t i = 0; i < n; i++) {
+    if (!(fabs(lat[i]) <= 90.0) || !(fabs(lon[i]) <= 180.0)) return false;   // también NaN
+    int32_t e, no;
+    if (!toLocal(f, (int32_t)lround(lat[i] * 100000.0), (int32_t)lround(lon[i] * 100000.0), e, no)) return false;
+    f.east[i]  = (int16_t)e;
+    f.north[i] = (int16_t)no;
+  }
+  out = f;
+  return true;
+}
+
+size_t GEO_buildFence(const GeoFence& f, uint8_t* out, size_t outSize) {
+  size_t len = GEO_FENCE_HDR_LEN + 4 * (size_t)f.count;
+  if (!out || f.count > GEO_MAX_VERTICES || outSize < len) return 0;
+  out[0] = GEO_FENCE_TYPE;
+  out[1] = f.id;
+  out[2] = f.count;
+  memcpy(&out[3], &f.lat0, 4);
+  memcpy(&out[7], &f.lon0, 4);
+  for (uint8_t i = 0; i < f.count; i++) {
+    memcpy(&out[GEO_FENCE_HDR_LEN + 4 * i], &f.east[i], 2);
+    memcpy(&out[GEO_FENCE_HDR_LEN + 4 * i + 2], &f.north[i], 2);
+  }
+  return len;
+}
+
+/**
+ * \brief Exige tipo 0xF1, 0 o 3..8 vértices, longitud exacta y origen en rango.
+ */
+bool GEO_parseFence(const uint8_t* in, size_t len, GeoFence& out) {
+  if (!in || len < GEO_FENCE_HDR_LEN || in[0] != GEO_FENCE_TYPE) return false;
+  uint8_t n = in[2];
+  if (n > GEO_MAX_VERTICES || (n > 0 && n < 3) || len != GEO_FENCE_HDR_LEN + 4 * (size_t)n) return false;
+  GeoFence f{};
+  f.id    = in[1];
+  f.count = n;
+  memcpy(&f.lat0, &in[3], 4);
+  memcpy(&f.lon0, &in[7], 4);
+  if (f.lat0 < -9000000 || f.lat0 > 9000000 || f.lon0 < -18000000 || f.lon0 > 18000000) return false;
+  for (uint8_t i = 0; i < n; i++) {
+    memcpy(&f.east[i], &in[GEO_FENCE_HDR_LEN + 4 * i], 2);
+    memcpy(&f.north[i], &in[GEO_FENCE_HDR_LEN + 4 * i + 2], 2);
+  }
+  f.lonScaleQ16 = lonScaleQ16(f.lat0);
+  out = f;
+  return true;
+}
+
+/**
+ * \brief Regla de cruces (par-impar) con la semirrecta hacia el este, en metros locales.
+ */
+static bool containsLocal(const GeoFence& f, int32_t px, int32_t py) {
+  bool inside = false;
+  for (uint8_t i = 0, j = f.count - 1; i < f.count; j = i++) {
+    int32_t xi = f.east[i], yi = f.north[i], xj = f.east[j], yj = f.north[j];
+    if ((yi > py) == (yj > py)) continue;
+    // px < xi + (xj − xi)·(py − yi)/(yj − yi), sin dividir
+    int64_t lhs = (int64_t)(px - xi) * (yj - yi);
+    int64_t rhs = (int64_t)(xj - xi) * (py - yi);
+    if (yj > yi ? lhs < rhs : lhs > rhs) inside = !inside;
+  }
+  return inside;
+}
+
+bool GEO_contains(const GeoFence& f, int32_t lat5, int32_t lon5) {
+  if (f.count < 3) return true;   // sin valla: nunca se sale
+  int32_t px, py;
+  if (!toLocal(f, lat5, lon5, px, py)) return false;
+  return containsLocal(f, px, py);
+}
+
+/**
+ * \brief true si el punto está a menos de GEO_MARGIN_M de algún lado de la valla activa.
+ * \details Por lado: fuera del rectángulo del lado ampliado con el margen,
+ *          lejos; si la proyección cae dentro del lado, distancia a la recta
+ *          (|cruz| / longitud); si no, al vértice más cercano.
+ */
+static bool nearEdge(int32_t px, int32_t py) {
+  const int32_t m = GEO_MARGIN_M;
+  for (uint8_t i = 0, j = s_fence.count - 1; i < s_fence.count; j = i++) {
+    int32_t ax = s_fence.east[j], ay = s_fence.north[j];
+    int32_t bx = s_fence.east[i], by = s_fence.north[i];
+    if (px < (ax < bx ? ax : bx) - m || px > (ax > bx ? ax : bx) + m ||
+        py < (ay < by ? ay : by) - m || py > (ay > by ? ay : by) + m) continue;
+    int64_t dx = bx - ax, dy = by - ay, wx = px - ax, wy = py - ay;
+    int64_t t = wx * dx + wy * dy, len2 = dx * dx + dy * dy;
+    if (t <= 0) {
+      if (wx * wx + wy * wy < (int64_t)m * m) return true;
+    } else if (t >= len2) {
+      int64_t ux = px - bx, uy = py - by;
+      if (ux * ux + uy * uy < (int64_t)m * m) return true;
+    } else {
+      int64_t cross = dx * wy - dy * wx;
+      if ((cross < 0 ? -cross : cross) < (int64_t)m * s_edgeLen[i]) return true;
+    }
+  }
+  return false;
+}
+
+void GEO_setFence(const GeoFence& f) {
+  s_fence   = f;
+  s_outside = false;
+  s_run     = 0;
+  s_announced = false;
+  for (uint8_t i = 0, j = f.count ? f.count - 1 : 0; i < f.count && i < GEO_MAX_VERTICES; j = i++) {
+    double dx = f.east[i] - f.east[j], dy = f.north[i] - f.north[j];
+    s_edgeLen[i] = (uint32_t)lround(sqrt(dx * dx + dy * dy));
+  }
+}
+
+const GeoFence& GEO_fence() {
+  return s_fence;
+}
+
+/**
+ * \brief Cambia de estado tras GEO_CONFIRM_FIXES fixes seguidos al otro lado y
+ *        fuera de la banda de histéresis.
+ */
+GeoEvent GEO_update(const GpsInfo& fix) {
+  if (!fix.valid || s_fence.count == 0) return GEO_EV_NONE;
+  int32_t px, py;
+  bool inside = false, band = false;   // a más de ±32 km: fuera sin banda
+  if (toLocal(s_fence, (int32_t)lround(fix.lat * 100000.0), (int32_t)lround(fix.lon * 100000.0), px, py)) {
+    inside = containsLocal(s_fence, px, py);
+    band   = nearEdge(px, py);
+  }
+  if (inside != s_outside || band) {   // del mismo lado que el estado actual o sobre el borde
+    s_run = 0;
+    return GEO_EV_NONE;
+  }
+  if (++s_run < GEO_CONFIRM_FIXES) return GEO_EV_NONE;
+  s_run     = 0;
+  s_outside = !inside;
+  return s_outside ? GEO_EV_BREACH : GEO_EV_RETURN;
+}
+
+bool GEO_isOutside() {
+  return s_outside;
+}
+
+bool GEO_alertDue(uint32_t nowMs, bool& outside) {
+  if (!GEO_alertPending()) return false;
+  if (s_alerted && nowMs - s_lastAlertMs < GEO_ALERT_GAP_S * 1000UL) return false;
+  outside = s_outside;
+  return true;
+}
+
+bool GEO_alertPending() {
+  return s_outside != s_announced;
+}
+
+void GEO_alertSent(uint32_t nowMs) {
+  s_announced   = s_outside;
+  s_alerted     = true;
+  s_lastAlertMs = nowMs;
+}
+
+size_t GEO_buildAlert(const GeoAlert& a, uint8_t* out, size_t outSize) {
+  if (!out || outSize < GEO_ALERT_LEN || !a.fix.valid || !GPS_isPlausible(a.fix)) return 0;
+  int32_t lat = (int32_t)lround(a.fix.lat * 100000.0);
+  int32_t lon = (int32_t)lround(a.fix.lon * 100000.0);
+  out[0] = GEO_ALERT_TYPE;
+  out[1] = a.fenceId;
+  out[2] = a.outside ? 1 : 0;
+  memcpy(&out[3], &a.fix.hhmmss, 4);
+  memcpy(&out[7], &lat, 4);
+  memcpy(&out[11], &lon, 4);
+  return GEO_ALERT_LEN;
+}
+
+/**
+ * \brief Exige tipo 0xF2, 15 B, estado 0/1 y posición y hora en rango.
+ */
+bool GEO_parseAlert(const uint8_t* in, size_t len, GeoAlert& out) {
+  if (!in || len != GEO_ALERT_LEN || in[0] != GEO_ALERT_TYPE || in[2] > 1) return false;
+  int32_t lat, lon;
+  GeoAlert a{};
+  a.fenceId = in[1];
+  a.outside = in[2] == 1;
+  memcpy(&a.fix.hhmmss, &in[3], 4);
+  memcpy(&lat, &in[7], 4);
+  memcpy(&lon, &in[11], 4);
+  a.fix.lat   = lat / 100000.0;
+  a.fix.lon   = lon / 100000.0;
+  a.fix.valid = true;
+  if (!GPS_isPlausible(a.fix)) return false;
+  out = a;
+  return true;
+}
@@ -0,0 +1,172 @@
+/** @file geofence.h
+ * @brief Valla virtual de casa: trama de bajada, evaluación en el collar y alerta de salida.
+ *
+ * Si la salida de la valla sólo se detecta en la base, el aviso llega con el
+ * siguiente envío periódico (hasta un periodo entero más el tiempo en el
+ * aire). En su lugar, la base envía al collar una copia compacta del polígono
+ * y el collar comprueba cada fix (1 Hz) con aritmética entera:
+ * - El fix se pasa a 1e-5 grados (como el payload) y a metros este/norte
+ *   desde el origen de la valla con una escala Q16 (el coseno de la latitud
+ *   se calcula una sola vez al recibir la valla).
+ * - Punto en polígono por cruces con productos en 64 bits (sin divisiones).
+ * - Histéresis en distancia y en tiempo: para salir hay que estar a más de
+ *   GEO_MARGIN_M por fuera del borde, y para volver, a más de GEO_MARGIN_M por
+ *   dentro, durante GEO_CONFIRM_FIXES fixes seguidos. Los fixes dentro de la
+ *   banda no cuentan hacia ningún lado: una mascota quieta sobre el borde no
+ *   cambia de estado con el ruido del GNSS.
+ * Al salir, el collar transmite una alerta con la posición y envía cada
+ * GEO_BREACH_PERIOD_S hasta que vuelve; al volver envía otra alerta. Entre dos
+ * alertas pasan al menos GEO_ALERT_GAP_S (GEO_alertDue()), y una que ya no
+ * cambia nada respecto a la última avisada no sale.
+ *
+ * Trama de valla (bajada, little-endian):
+ * `[0xF1][id:1][n:1][lat0:4][lon0:4]` + n × `[este:2][norte:2]`
+ * - lat0/lon0: origen en 1e-5 grados; vértices en metros con signo (±32 km).
+ * - n = 0 desactiva la valla.
+ *
+ * Trama de alerta (subida, 15 B): `[0xF2][id:1][estado:1][hhmmss:4][lat:4][lon:4]`
+ * con estado 1 = fuera y 0 = de vuelta, y la posición en 1e-5 grados.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo). Ambos nodos
+ * deben compilar la misma versión.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "payload_codec.h"
+
+static const uint8_t  GEO_FENCE_TYPE      = 0xF1;
+static const uint8_t  GEO_ALERT_TYPE      = 0xF2;
+static const uint8_t  GEO_MAX_VERTICES    = 8;
+static const size_t   GEO_FENCE_HDR_LEN   = 11;
+static const size_t   GEO_FENCE_MAX_LEN   = GEO_FENCE_HDR_LEN + 4 * GEO_MAX_VERTICES;
+static const size_t   GEO_ALERT_LEN       = 15;
+/** Fixes seguidos al otro lado del borde para cambiar de estado. */
+static const uint8_t  GEO_CONFIRM_FIXES   = 2;
+/** Semianchura de la banda de histéresis alrededor del borde (m; ~2σ del ruido del GNSS). */
+static const uint8_t  GEO_MARGIN_M        = 6;
+/**
+ * Separación mínima entre alertas (s). Su aire sale del mismo 1 % que las
+ * posiciones: a SF9/125 kHz, ~0,2 % reservado para una alerta de 15 B.
+ */
+static const uint16_t GEO_ALERT_GAP_S     = 120;
+/**
+ * Periodo de envío mientras la mascota está fuera (s, divisor de 86400): el
+ * menor que deja las posiciones a SF9/125 kHz (~198 ms) dentro del 1 % de
+ * duty-cycle (SF8/62,5 kHz tiene el mismo aire). El collar lo alarga si la
+ * modulación lo exige (LoRaWAN) y con la parte reservada a las alertas (24 s a SF9/125 kHz);
+ * acorta los periodos largos (horas tranquilas, comandos).
+ */
+static const uint16_t GEO_BREACH_PERIOD_S = 20;
+
+/**
+ * \brief Polígono de la valla.
+ */
+struct GeoFence {
+  uint8_t  id;                         ///< Versión de la valla (la elige la base).
+  uint8_t  count;                      ///< Vértices (0 = sin valla).
+  int32_t  lat0;                       ///< Origen (1e-5 grados).
+  int32_t  lon0;
+  int16_t  east[GEO_MAX_VERTICES];     ///< Vértices en metros desde el origen.
+  int16_t  north[GEO_MAX_VERTICES];
+  uint32_t lonScaleQ16;                ///< Metros por 1e-5 grados de longitud (Q16); lo calcula GEO_parseFence().
+};
+
+/**
+ * \brief Cambio de estado tras un fix.
+ */
+enum GeoEvent : uint8_t {
+  GEO_EV_NONE = 0,
+  GEO_EV_BREACH,    ///< Acaba de salir (confirmado).
+  GEO_EV_RETURN     ///< Acaba de volver (confirmado).
+};
+
+/**
+ * \brief Contenido de una alerta.
+ */
+struct GeoAlert {
+  uint8_t fenceId;
+  bool    outside;   ///< true = salida, false = vuelta.
+  GpsInfo fix;
+};
+
+/**
+ * \brief Construye una valla a partir de vértices en grados (lado de la base).
+ * \details El origen es el primer vértice; falla si hay menos de 3 o más de
+ *          GEO_MAX_VERTICES vértices o alguno queda a más de 32 km.
+ */
+bool GEO_fenceFromPoints(uint8_t id, const double* lat, const double* lon, uint8_t n, GeoFence& out);
+
+/**
+ * \brief Serializa la valla.
+ * \return Longitud escrita (GEO_FENCE_HDR_LEN + 4·n) o 0 si no cabe.
+ */
+size_t GEO_buildFence(const GeoFence& f, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica una trama de valla y calcula su escala de longitud.
+ * \return true si el tipo, la longitud y el número de vértices (0 o 3..8) son válidos.
+ */
+bool GEO_parseFence(const uint8_t* in, size_t len, GeoFence& out);
+
+/**
+ * \brief true si la posición (1e-5 grados) está dentro del polígono.
+ */
+bool GEO_contains(const GeoFence& f, int32_t lat5, int32_t lon5);
+
+/**
+ * \brief Activa la valla (sin valla si count = 0) y reinicia el estado: se supone dentro.
+ * \details No olvida cuándo salió la última alerta (cuenta para el duty-cycle).
+ */
+void GEO_setFence(const GeoFence& f);
+
+/**
+ * \brief Valla activa.
+ */
+const GeoFence& GEO_fence();
+
+/**
+ * \brief Evalúa un fix válido frente a la valla activa.
+ */
+GeoEvent GEO_update(const GpsInfo& fix);
+
+/**
+ * \brief true desde una salida confirmada hasta la vuelta.
+ */
+bool GEO_isOutside();
+
+/**
+ * \brief true si hay un cambio de estado sin avisar y ya pasaron GEO_ALERT_GAP_S
+ *        desde la alerta anterior.
+ * \param nowMs   Instante actual (ms).
+ * \param outside (salida) Estado que debe llevar la alerta.
+ * \details Si la mascota vuelve al estado avisado mientras se espera, no hay
+ *          nada que avisar.
+ */
+bool GEO_alertDue(uint32_t nowMs, bool& outside);
+
+/**
+ * \brief Registra que se ha enviado (o intentado) la alerta del estado actual.
+ */
+void GEO_alertSent(uint32_t nowMs);
+
+/**
+ * \brief true si el estado actual difiere del último avisado (alerta por enviar).
+ */
+bool GEO_alertPending();
+
+/**
+ * \brief Serializa una alerta.
+ * \return GEO_ALERT_LEN si OK, 0 si el buffer no basta o la posición no es válida.
+ */
+size_t GEO_buildAlert(const GeoAlert& a, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica una alerta.
+ * \return true si el tipo, la longitud, el estado y la posición son válidos.
+ */
+bool GEO_parseAlert(const uint8_t* in, size_t len, GeoAlert& out);
@@ -0,0 +1,206 @@
+/** @file gnss_aiding.cpp
+ * @brief Implementación de la trama de ayuda GNSS y de los mensajes de inyección.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "gnss_aiding.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ----------------- Consumo del receptor (valor típico, adquisición) -----------
+static const float AID_I_ACQ_MA = 30.0f;
+static const float AID_V_GNSS   = 3.3f;
+
+// ----------------- UBX-MGA-INI --------------------------------------------
+static const uint8_t UBX_SYNC1 = 0xB5, UBX_SYNC2 = 0x62;
+static const uint8_t UBX_CLASS_MGA = 0x13, UBX_ID_MGA_INI = 0x40;
+static const uint8_t UBX_INI_TIME_LEN = 24, UBX_INI_POS_LEN = 20;
+
+/**
+ * \brief Días desde 2000-01-01 (algoritmo de calendario civil de H. Hinnant).
+ */
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  y -= m <= 2;
+  const int32_t  era = y / 400;
+  const uint32_t yoe = (uint32_t)(y - era * 400);
+  const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 730425;   // 730425 = días de 0000-03-01 a 2000-01-01
+}
+
+/**
+ * \brief Segundos desde 2000-01-01 hasta la fecha.
+ */
+uint32_t AID_utcFromDate(const AidDate& d) {
+  int32_t days = daysFromCivil(d.year, d.month, d.day);
+  return (uint32_t)days * 86400UL + d.hour * 3600UL + d.minute * 60UL + d.second;
+}
+
+/**
+ * \brief Inversa de daysFromCivil() para fechas posteriores a 2000.
+ */
+AidDate AID_dateFromUtc(uint32_t utc) {
+  AidDate out;
+  uint32_t sod = utc % 86400UL;
+  int32_t  z   = (int32_t)(utc / 86400UL) + 730425;
+  const int32_t  era = z / 146097;
+  const uint32_t doe = (uint32_t)(z - era * 146097);
+  const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp  = (5 * doy + 2) / 153;
+  const uint32_t m   = mp < 10 ? mp + 3 : mp - 9;
+  out.year   = (uint16_t)((int32_t)yoe + era * 400 + (m <= 2));
+  out.month  = (uint8_t)m;
+  out.day    = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+  out.hour   = (uint8_t)(sod / 3600);
+  out.minute = (uint8_t)((sod / 60) % 60);
+  out.second = (uint8_t)(sod % 60);
+  return out;
+}
+
+/**
+ * \brief `[0xA1][utc][lat·100][lon·100][posAcc][timeAcc]`.
+ */
+size_t AID_buildFrame(const AidData& in, uint8_t* out, size_t outSize) {
+  if (!out || outSize < AID_FRAME_LEN) return 0;
+  if (!(fabsf(in.lat) <= 90.0f) || !(fabsf(in.lon) <= 180.0f)) return 0;   // también NaN
+  int16_t lat = (int16_t)lroundf(in.lat * 100.0f);
+  int16_t lon = (int16_t)lroundf(in.lon * 100.0f);
+  out[0] = AID_FRAME_TYPE;
+  memcpy(&out[1], &in.utc, 4);
+  memcpy(&out[5], &lat, 2);
+  memcpy(&out[7], &lon, 2);
+  out[9]  = in.posAccKm;
+  out[10] = in.timeAccS;
+  return AID_FRAME_LEN;
+}
+
+/**
+ * \brief Exige tipo 0xA1, 11 B y lat/lon dentro de rango.
+ */
+bool AID_parseFrame(const uint8_t* in, size_t len, AidData& out) {
+  if (!in || len != AID_FRAME_LEN || in[0] != AID_FRAME_TYPE) return false;
+  int16_t lat, lon;
+  memcpy(&lat, &in[5], 2);
+  memcpy(&lon, &in[7], 2);
+  if (lat < -9000 || lat > 9000 || lon < -18000 || lon > 18000) return false;
+  memcpy(&out.utc, &in[1], 4);
+  out.lat      = lat / 100.0f;
+  out.lon      = lon / 100.0f;
+  out.posAccKm = in[9];
+  out.timeAccS = in[10];
+  return true;
+}
+
+/**
+ * \brief Cabecera, payload y checksum Fletcher-8 de una trama UBX.
+ */
+size_t AID_ubxFrame(uint8_t cls, uint8_t id, const uint8_t* payload, uint8_t len, uint8_t* out,
+                    size_t outSize) {
+  size_t total = 8 + (size_t)len;
+  if (!out || outSize < total) return 0;
+  out[0] = UBX_SYNC1;
+  out[1] = UBX_SYNC2;
+  out[2] = cls;
+  out[3] = id;
+  out[4] = len;
+  out[5] = 0;
+  memcpy(&out[6], payload, len);
+  uint8_t ckA = 0, ckB = 0;
+  for (size_t i = 2; i < 6 + (size_t)len; i++) {
+    ckA += out[i];
+    ckB += ckA;
+  }
+  out[6 + len] = ckA;
+  out[7 + len] = ckB;
+  return total;
+}
+
+/**
+ * \brief Añade `*CS\r\n` (XOR entre '$' y '*') a una sentencia NMEA.
+ */
+size_t AID_nmeaFinish(char* s, size_t used, size_t outSize) {
+  if (!s || used >= outSize) return 0;
+  uint8_t cs = 0;
+  for (size_t i = 1; i < used; i++) cs ^= (uint8_t)s[i];
+  int n = snprintf(s + used, outSize - used, "*%02X\r\n", cs);
+  if (n < 0 || used + (size_t)n >= outSize) return 0;
+  return used + (size_t)n;
+}
+
+#if defined(AID_PROTOCOL_MTK)
+
+/**
+ * \brief `$PMTK740,YYYY,MM,DD,hh,mm,ss*CS`.
+ */
+size_t AID_buildTimeMsg(uint32_t utc, uint8_t, uint8_t* out, size_t outSize) {
+  AidDate d = AID_dateFromUtc(utc);
+  char* s = (char*)out;
+  int n = snprintf(s, outSize, "$PMTK740,%04u,%02u,%02u,%02u,%02u,%02u", d.year, d.month,
+                   d.day, d.hour, d.minute, d.second);
+  if (n < 0 || (size_t)n >= outSize) return 0;
+  return AID_nmeaFinish(s, (size_t)n, outSize);
+}
+
+/**
+ * \brief `$PMTK741,lat,lon,alt,YYYY,MM,DD,hh,mm,ss*CS` (altitud 0 m).
+ */
+size_t AID_buildPosMsg(const AidData& aid, uint32_t utc, uint8_t* out, size_t outSize) {
+  AidDate d = AID_dateFromUtc(utc);
+  char* s = (char*)out;
+  int n = snprintf(s, outSize, "$PMTK741,%.2f,%.2f,0,%04u,%02u,%02u,%02u,%02u,%02u",
+                   (double)aid.lat, (double)aid.lon, d.year, d.month, d.day, d.hour,
+                   d.minute, d.second);
+  if (n < 0 || (size_t)n >= outSize) return 0;
+  return AID_nmeaFinish(s, (size_t)n, outSize);
+}
+
+#else
+
+/**
+ * \brief UBX-MGA-INI-TIME_UTC (tipo 0x10) sin referencia externa, leapSecs desconocido.
+ */
+size_t AID_buildTimeMsg(uint32_t utc, uint8_t timeAccS, uint8_t* out, size_t outSize) {
+  AidDate d = AID_dateFromUtc(utc);
+  uint8_t p[UBX_INI_TIME_LEN] = {0};
+  p[0] = 0x10;               // type
+  p[1] = 0x00;               // version
+  p[2] = 0x00;               // ref: hora de recepción del mensaje
+  p[3] = (uint8_t)-128;      // leapSecs desconocido
+  memcpy(&p[4], &d.year, 2);
+  p[6]  = d.month;
+  p[7]  = d.day;
+  p[8]  = d.hour;
+  p[9]  = d.minute;
+  p[10] = d.second;
+  uint16_t tAccS = timeAccS;
+  memcpy(&p[16], &tAccS, 2);
+  return AID_ubxFrame(UBX_CLASS_MGA, UBX_ID_MGA_INI, p, UBX_INI_TIME_LEN, out, outSize);
+}
+
+/**
+ * \brief UBX-MGA-INI-POS_LLH (tipo 0x01), altitud 0 y precisión en cm.
+ */
+size_t AID_buildPosMsg(const AidData& aid, uint32_t, uint8_t* out, size_t outSize) {
+  uint8_t p[UBX_INI_POS_LEN] = {0};
+  p[0] = 0x01;               // type
+  int32_t  lat    = (int32_t)lroundf(aid.lat * 1e7f);
+  int32_t  lon    = (int32_t)lroundf(aid.lon * 1e7f);
+  uint32_t accCm  = (uint32_t)aid.posAccKm * 100000UL;
+  memcpy(&p[4], &lat, 4);
+  memcpy(&p[8], &lon, 4);
+  memcpy(&p[16], &accCm, 4);
+  return AID_ubxFrame(UBX_CLASS_MGA, UBX_ID_MGA_INI, p, UBX_INI_POS_LEN, out, outSize);
+}
+
+#endif
+
+/**
+ * \brief Corriente típica de adquisición por tiempo hasta el fix.
+ */
+float AID_acquisitionEnergyMj(uint32_t ttffMs) {
+  return AID_I_ACQ_MA * AID_V_GNSS * (float)ttffMs / 1000.0f;
+}
@@ -0,0 +1,106 @@
+/** @file gnss_aiding.h
+ * @brief Asistencia GNSS base → collar: trama de ayuda y mensajes de inyección.
+ *
+ * La base, con su propio receptor GNSS, envía al collar la hora UTC y una
+ * posición aproximada en una trama de 11 B (por el mismo canal de bajada que los
+ * comandos wake-on-radio). El collar las inyecta en su receptor para acortar la
+ * adquisición tras un arranque en frío o una pérdida prolongada del fix.
+ *
+ * Trama de ayuda (little-endian): `[0xA1][utc:4][lat:2][lon:2][posAcc:1][timeAcc:1]`
+ * - utc: segundos desde 2000-01-01 00:00:00 UTC (sin segundos intercalares).
+ * - lat/lon: centésimas de grado con signo (≈1,1 km).
+ * - posAcc: incertidumbre de la posición en km; timeAcc: de la hora en s.
+ *
+ * Inyección: UBX-MGA-INI-TIME_UTC / MGA-INI-POS_LLH (u-blox M8 y posteriores)
+ * o, con `-DAID_PROTOCOL_MTK`, las sentencias PMTK740 / PMTK741 (MediaTek).
+ *
+ * @note No se transmiten efemérides: un subconjunto útil (≥4 satélites) ocupa
+ *       cientos de bytes y no cabe en el presupuesto de duty-cycle del enlace.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo). Ambos nodos
+ * deben compilar la misma versión.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t AID_FRAME_TYPE = 0xA1;
+static const size_t  AID_FRAME_LEN  = 11;
+
+/**
+ * \brief Datos de ayuda (hora y posición aproximadas).
+ */
+struct AidData {
+  uint32_t utc;        ///< Segundos desde 2000-01-01 UTC.
+  float    lat;        ///< Grados.
+  float    lon;        ///< Grados.
+  uint8_t  posAccKm;   ///< Incertidumbre de la posición (km).
+  uint8_t  timeAccS;   ///< Incertidumbre de la hora (s).
+};
+
+/**
+ * \brief Fecha y hora UTC desglosadas.
+ */
+struct AidDate {
+  uint16_t year;
+  uint8_t  month, day, hour, minute, second;
+};
+
+/**
+ * \brief Segundos desde 2000-01-01 UTC (años 2000..2099).
+ */
+uint32_t AID_utcFromDate(const AidDate& d);
+
+/**
+ * \brief Inversa de AID_utcFromDate().
+ */
+AidDate AID_dateFromUtc(uint32_t utc);
+
+/**
+ * \brief Serializa la trama de ayuda.
+ * \return AID_FRAME_LEN si OK, 0 si el buffer no basta o la posición no es válida.
+ */
+size_t AID_buildFrame(const AidData& in, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica la trama de ayuda.
+ * \return true si el tipo, la longitud y los rangos son válidos.
+ */
+bool AID_parseFrame(const uint8_t* in, size_t len, AidData& out);
+
+/**
+ * \brief Mensaje de inyección de hora para el receptor (UBX o PMTK según el build).
+ * \param utc Hora UTC actual (ya compensada con la antigüedad de la trama).
+ * \return Longitud escrita (0 si no cabe).
+ */
+size_t AID_buildTimeMsg(uint32_t utc, uint8_t timeAccS, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Mensaje de inyección de posición (UBX o PMTK según el build).
+ * \param utc Hora UTC actual (PMTK741 la exige junto a la posición).
+ * \return Longitud escrita (0 si no cabe).
+ */
+size_t AID_buildPosMsg(const AidData& aid, uint32_t utc, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Trama UBX completa (sincronismo, clase, id, longitud, payload y checksum).
+ * \return 8 + \p len, o 0 si no cabe.
+ */
+size_t AID_ubxFrame(uint8_t cls, uint8_t id, const uint8_t* payload, uint8_t len, uint8_t* out,
+                    size_t outSize);
+
+/**
+ * \brief Cierra una sentencia NMEA/PMTK de \p used caracteres (desde '$') con `*CS\r\n`.
+ * \return Longitud total, o 0 si no cabe.
+ */
+size_t AID_nmeaFinish(char* s, size_t used, size_t outSize);
+
+/**
+ * \brief Energía (mJ) consumida por el receptor GNSS durante una adquisición.
+ * \param ttffMs Tiempo hasta el primer fix.
+ */
+float AID_acquisitionEnergyMj(uint32_t ttffMs);
@@ -0,0 +1,133 @@
+/** @file health_frame.cpp
+ * @brief Implementación de la trama de salud empaquetada por bits.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "health_frame.h"
+#include <math.h>
+#include <string.h>
+
+/** Anchos de los campos, en el orden de la trama (ver health_frame.h). */
+enum : uint8_t {
+  W_VERSION = 4, W_SEQ = 8, W_UPTIME = 20, W_RESET = 3, W_RESET_CNT = 8,
+  W_TTFF = 10, W_TX_FAIL = 8, W_TX_ERR = 11, W_TEMP = 7, W_LOOP = 8,
+  W_HWM = 8, W_HEAP = 8
+};
+static const int8_t HLT_TEMP_OFFSET = 40;
+
+/**
+ * \brief Escritor de bits LSB primero sobre un buffer ya puesto a cero.
+ */
+struct BitWriter {
+  uint8_t* buf;
+  uint16_t pos;
+  void put(uint32_t v, uint8_t bits) {
+    for (uint8_t i = 0; i < bits; i++, pos++) {
+      if (v & (1UL << i)) buf[pos >> 3] |= (uint8_t)(1U << (pos & 7));
+    }
+  }
+};
+
+/**
+ * \brief Lector de bits LSB primero.
+ */
+struct BitReader {
+  const uint8_t* buf;
+  uint16_t pos;
+  uint32_t get(uint8_t bits) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bits; i++, pos++) {
+      if (buf[pos >> 3] & (1U << (pos & 7))) v |= 1UL << i;
+    }
+    return v;
+  }
+};
+
+/**
+ * \brief Satura \p v al máximo representable en \p bits.
+ */
+static uint32_t sat(uint32_t v, uint8_t bits) {
+  uint32_t max = (1UL << bits) - 1;
+  return v > max ? max : v;
+}
+
+/**
+ * \brief Campos en orden; el error de TX se guarda en magnitud (RadioLib usa ≤0).
+ */
+size_t HLT_buildFrame(const HealthFrame& in, uint8_t* out, size_t outSize) {
+  if (!out || outSize < HLT_FRAME_LEN) return 0;
+  memset(out, 0, HLT_FRAME_LEN);
+  out[0] = HLT_FRAME_TYPE;
+
+  int32_t temp = (int32_t)in.tempC + HLT_TEMP_OFFSET;
+  if (temp < 0) temp = 0;
+  uint32_t txErr = in.lastTxError < 0 ? (uint32_t)(-(int32_t)in.lastTxError) : 0;
+
+  BitWriter w = {out + 1, 0};
+  w.put(HLT_VERSION, W_VERSION);
+  w.put(in.seq, W_SEQ);
+  w.put(sat(in.uptimeMin, W_UPTIME), W_UPTIME);
+  w.put(in.resetReason <= HLT_RESET_OTHER ? in.resetReason : (uint8_t)HLT_RESET_OTHER, W_RESET);
+  w.put(in.resetCount, W_RESET_CNT);
+  w.put(sat(in.ttffLastS, W_TTFF), W_TTFF);
+  w.put(sat(in.ttffP90S, W_TTFF), W_TTFF);
+  w.put(in.txFailures, W_TX_FAIL);
+  w.put(sat(txErr, W_TX_ERR), W_TX_ERR);
+  w.put(sat((uint32_t)temp, W_TEMP), W_TEMP);
+  w.put(in.loopMaxMs, W_LOOP);
+  w.put(in.gpsRxHwm, W_HWM);
+  w.put(in.minFreeHeapKb, W_HEAP);
+  return HLT_FRAME_LEN;
+}
+
+/**
+ * \brief Inversa de HLT_buildFrame(); rechaza versiones desconocidas y relleno ≠ 0.
+ */
+bool HLT_parseFrame(const uint8_t* in, size_t len, HealthFrame& out) {
+  if (!in || len != HLT_FRAME_LEN || in[0] != HLT_FRAME_TYPE) return false;
+
+  BitReader r = {in + 1, 0};
+  if (r.get(W_VERSION) != HLT_VERSION) return false;
+  HealthFrame f;
+  f.seq           = (uint8_t)r.get(W_SEQ);
+  f.uptimeMin     = r.get(W_UPTIME);
+  f.resetReason   = (uint8_t)r.get(W_RESET);
+  f.resetCount    = (uint8_t)r.get(W_RESET_CNT);
+  f.ttffLastS     = (uint16_t)r.get(W_TTFF);
+  f.ttffP90S      = (uint16_t)r.get(W_TTFF);
+  f.txFailures    = (uint8_t)r.get(W_TX_FAIL);
+  f.lastTxError   = -(int16_t)r.get(W_TX_ERR);
+  f.tempC         = (int8_t)((int32_t)r.get(W_TEMP) - HLT_TEMP_OFFSET);
+  f.loopMaxMs     = (uint8_t)r.get(W_LOOP);
+  f.gpsRxHwm      = (uint8_t)r.get(W_HWM);
+  f.minFreeHeapKb = (uint8_t)r.get(W_HEAP);
+  if (f.resetReason > HLT_RESET_OTHER) return false;
+  if (r.get((HLT_FRAME_LEN - 1) * 8 - r.pos) != 0) return false;
+  out = f;
+  return true;
+}
+
+/**
+ * \brief airtime / (duty-cycle · fracción).
+ */
+uint32_t HLT_minIntervalS(float airtimeMs, float budgetFraction) {
+  if (!(airtimeMs > 0.0f) || !(budgetFraction > 0.0f)) return 0xFFFFFFFFUL;
+  float s = ceilf(airtimeMs / (1000.0f * HLT_DUTY_CYCLE * budgetFraction));
+  if (s < 1.0f) return 1;
+  if (s > 4.0e9f) return 0xFFFFFFFFUL;
+  return (uint32_t)s;
+}
+
+/**
+ * \brief Nombres usados en /health y en las etiquetas de métricas.
+ */
+const char* HLT_resetName(uint8_t reason) {
+  switch (reason) {
+    case HLT_RESET_POWER_ON: return "power_on";
+    case HLT_RESET_WATCHDOG: return "watchdog";
+    case HLT_RESET_SOFTWARE: return "software";
+    default:                 return "other";
+  }
+}
@@ -0,0 +1,106 @@
+/** @file health_frame.h
+ * @brief Trama de salud del collar (telemetría compacta de diagnóstico).
+ *
+ * Con una cadencia baja, el collar envía por el enlace de subida una trama de 16 B con
+ * su estado interno. Así, cuando falla en campo, la base puede ver reinicios, TTFF,
+ * fallos de TX, temperatura y márgenes de los buffers.
+ *
+ * Formato: `[0xB0][15 B de campos empaquetados por bits, LSB primero]`
+ * | campo          | bits | notas                                            |
+ * |----------------|------|--------------------------------------------------|
+ * | versión        | 4    | HLT_VERSION                                      |
+ * | seq            | 8    | módulo 256 (detecta tramas perdidas)             |
+ * | uptimeMin      | 20   | minutos desde el arranque (satura en ~728 días)  |
+ * | resetReason    | 3    | HltReset                                         |
+ * | resetCount     | 8    | arranques registrados, módulo 256                |
+ * | ttffLastS      | 10   | último TTFF (s), satura en 1023                  |
+ * | ttffP90S       | 10   | p90 de los últimos TTFF (s), satura en 1023      |
+ * | txFailures     | 8    | TX fallidas desde el arranque, módulo 256        |
+ * | lastTxError    | 11   | −código RadioLib del último fallo (0 = ninguno)  |
+ * | tempC          | 7    | temperatura del die + 40 (−40..87 °C)            |
+ * | loopMaxMs      | 8    | loop() más lento desde la trama anterior (satura) |
+ * | gpsRxHwm       | 8    | máximo de bytes pendientes en el UART del GNSS   |
+ * | minFreeHeapKb  | 8    | mínimo de heap libre observado (KiB, satura)     |
+ *
+ * Los 7 bits sobrantes van a cero. La trama mide 16 B para no confundirse con
+ * la posición (13 B) ni con las bajadas (comando y asistencia).
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo). Ambos nodos
+ * deben compilar la misma versión.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t HLT_FRAME_TYPE = 0xB0;
+static const size_t  HLT_FRAME_LEN  = 16;
+static const uint8_t HLT_VERSION    = 1;
+
+/** Duty-cycle de la sub-banda (ETSI EN 300 220). */
+static const float HLT_DUTY_CYCLE = 0.01f;
+
+/**
+ * \brief Porcentaje del presupuesto de duty-cycle que puede ocupar la trama de salud.
+ * \details Por defecto un 2 % del 1 %: con SF9 (≈198 ms de aire) sale una trama
+ *          cada ≈16,5 min.
+ */
+#ifndef HLT_BUDGET_PCT
+  #define HLT_BUDGET_PCT 2
+#endif
+
+/**
+ * \brief Causa del último reinicio.
+ */
+enum HltReset : uint8_t {
+  HLT_RESET_POWER_ON = 0,   ///< Alimentación o pin RUN.
+  HLT_RESET_WATCHDOG,       ///< Venció el watchdog.
+  HLT_RESET_SOFTWARE,       ///< Reinicio pedido por software (rp2040.reboot(), UF2...).
+  HLT_RESET_OTHER
+};
+
+/**
+ * \brief Campos de la trama de salud (ya decodificados, en sus unidades).
+ */
+struct HealthFrame {
+  uint8_t  seq;
+  uint32_t uptimeMin;
+  uint8_t  resetReason;     ///< HltReset.
+  uint8_t  resetCount;
+  uint16_t ttffLastS;
+  uint16_t ttffP90S;
+  uint8_t  txFailures;
+  int16_t  lastTxError;     ///< Código RadioLib (≤0).
+  int8_t   tempC;
+  uint8_t  loopMaxMs;
+  uint8_t  gpsRxHwm;
+  uint8_t  minFreeHeapKb;
+};
+
+/**
+ * \brief Serializa la trama; los valores fuera de rango se saturan.
+ * \return HLT_FRAME_LEN si OK, 0 si el buffer no basta.
+ */
+size_t HLT_buildFrame(const HealthFrame& in, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica la trama de salud.
+ * \return true si el tipo, la longitud, la versión y la causa de reinicio son válidos.
+ */
+bool HLT_parseFrame(const uint8_t* in, size_t len, HealthFrame& out);
+
+/**
+ * \brief Intervalo mínimo entre tramas para no superar la fracción del duty-cycle.
+ * \param airtimeMs      Tiempo en el aire de una trama (ms).
+ * \param budgetFraction Fracción del duty-cycle (p. ej. 0.02 para un 2 %).
+ * \return Segundos (redondeado hacia arriba, al menos 1).
+ */
+uint32_t HLT_minIntervalS(float airtimeMs, float budgetFraction);
+
+/**
+ * \brief Nombre corto de la causa de reinicio ("power_on", "watchdog"...).
+ */
+const char* HLT_resetName(uint8_t reason);
@@ -0,0 +1,105 @@
+/** @file metrics.cpp
+ * @brief Implementación del registro de métricas y de su volcado en formato Prometheus.
+ *
+ * La lista se construye en la inicialización estática (orden de declaración dentro
+ * de cada fichero). El volcado usa un único buffer de línea en la pila.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "metrics.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+// ----------------- Estado interno -----------------------
+static Metric* s_head = nullptr;
+static Metric* s_tail = nullptr;
+
+/**
+ * \brief Enlaza la métrica al final de la lista (mantiene el orden de declaración).
+ */
+Metric::Metric(const char* n, const char* h, const char* l, MetricType t)
+  : name(n), help(h), labels(l), type(t), next(nullptr) {
+  if (s_tail) s_tail->next = this;
+  else        s_head = this;
+  s_tail = this;
+}
+
+static const char* const TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+/**
+ * \brief Formatea una línea en \p line y la envía.
+ */
+static void emitf(MetricsSink sink, void* ctx, char* line, size_t size, const char* fmt, ...)
+  __attribute__((format(printf, 5, 6)));
+
+static void emitf(MetricsSink sink, void* ctx, char* line, size_t size, const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(line, size, fmt, ap);
+  va_end(ap);
+  if (n <= 0) return;
+  if ((size_t)n >= size) n = (int)size - 1;
+  sink(line, (size_t)n, ctx);
+}
+
+/**
+ * \brief `nombre{etiquetas} valor` para contadores y gauges.
+ */
+static void renderScalar(const Metric* m, MetricsSink sink, void* ctx, char* line, size_t size) {
+  const char* open  = m->labels ? "{" : "";
+  const char* lbl   = m->labels ? m->labels : "";
+  const char* close = m->labels ? "}" : "";
+  if (m->type == METRIC_TYPE_COUNTER) {
+    const MetricCounter* c = static_cast<const MetricCounter*>(m);
+    emitf(sink, ctx, line, size, "%s%s%s%s %lu\n", m->name, open, lbl, close,
+          (unsigned long)c->value());
+  } else {
+    const MetricGauge* g = static_cast<const MetricGauge*>(m);
+    emitf(sink, ctx, line, size, "%s%s%s%s %.3f\n", m->name, open, lbl, close,
+          (double)g->value());
+  }
+}
+
+/**
+ * \brief Cubetas acumuladas (`_bucket{le=...}`), `_sum` y `_count`.
+ */
+static void renderHistogram(const MetricHistogram* h, MetricsSink sink, void* ctx,
+                            char* line, size_t size) {
+  const uint8_t nb = h->nBounds + 1;
+  uint32_t cumulative = 0;
+  for (uint8_t i = 0; i < nb; i++) {
+    cumulative += h->counts[i] + h->counts[nb + i];
+    if (i < h->nBounds) {
+      emitf(sink, ctx, line, size, "%s_bucket{le=\"%g\"} %lu\n", h->name,
+            (double)h->bounds[i], (unsigned long)cumulative);
+    } else {
+      emitf(sink, ctx, line, size, "%s_bucket{le=\"+Inf\"} %lu\n", h->name,
+            (unsigned long)cumulative);
+    }
+  }
+  emitf(sink, ctx, line, size, "%s_sum %.3f\n", h->name, (double)(h->sums[0] + h->sums[1]));
+  emitf(sink, ctx, line, size, "%s_count %lu\n", h->name, (unsigned long)cumulative);
+}
+
+/**
+ * \brief Recorre la lista emitiendo HELP/TYPE una vez por nombre.
+ */
+void METRICS_render(MetricsSink sink, void* ctx) {
+  char line[160];
+  const char* lastName = nullptr;
+
+  for (const Metric* m = s_head; m; m = m->next) {
+    if (!lastName || strcmp(lastName, m->name) != 0) {
+      emitf(sink, ctx, line, sizeof(line), "# HELP %s %s\n", m->name, m->help);
+      emitf(sink, ctx, line, sizeof(line), "# TYPE %s %s\n", m->name, TYPE_NAMES[m->type]);
+      lastName = m->name;
+    }
+    if (m->type == METRIC_TYPE_HISTOGRAM) {
+      renderHistogram(static_cast<const MetricHistogram*>(m), sink, ctx, line, sizeof(line));
+    } else {
+      renderScalar(m, sink, ctx, line, sizeof(line));
+    }
+  }
+}
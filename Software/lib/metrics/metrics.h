@@ -0,0 +1,155 @@
+/** @file metrics.h
+ * @brief Registro estático de métricas (contadores, gauges e histogramas) en formato Prometheus.
+ *
+ * Cada módulo declara sus métricas como objetos estáticos con las macros
+ * `METRIC_COUNTER`, `METRIC_GAUGE` y `METRIC_HISTOGRAM`; el constructor las enlaza
+ * en una lista única durante la inicialización estática (sin memoria dinámica).
+ *
+ * Actualización barata y segura desde ISR:
+ * - Cada núcleo del RP2040 escribe en su propia celda (sin contención entre núcleos).
+ * - La ISR y el bucle del mismo núcleo se serializan enmascarando interrupciones
+ *   durante la suma (unos pocos ciclos; el Cortex-M0+ no tiene LDREX/STREX).
+ * - La lectura suma las celdas; las lecturas de 32 bits son atómicas.
+ *
+ * METRICS_render() genera el formato de texto de Prometheus línea a línea, de modo
+ * que puede enviarse por trozos (HTTP chunked o USB) sin construir el documento.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_RP2040)
+  #include <hardware/sync.h>
+  #include <pico/platform.h>
+  #define METRIC_LOCK()      uint32_t _irq = save_and_disable_interrupts()
+  #define METRIC_UNLOCK()    restore_interrupts(_irq)
+  #define METRIC_CORE()      get_core_num()
+#else
+  // Compilación nativa (tests en el host): un único hilo
+  #define METRIC_LOCK()      do {} while (0)
+  #define METRIC_UNLOCK()    do {} while (0)
+  #define METRIC_CORE()      0u
+#endif
+
+/**
+ * \brief Tipo de métrica (línea `# TYPE` de Prometheus).
+ */
+enum MetricType : uint8_t {
+  METRIC_TYPE_COUNTER = 0,
+  METRIC_TYPE_GAUGE,
+  METRIC_TYPE_HISTOGRAM
+};
+
+/**
+ * \brief Nodo común de la lista de métricas.
+ * \details \c labels es opcional (p.ej. `result="ok"`); las métricas con el mismo
+ * nombre deben declararse seguidas en el mismo fichero para compartir HELP/TYPE.
+ */
+struct Metric {
+  const char* name;
+  const char* help;
+  const char* labels;
+  MetricType  type;
+  Metric*     next;
+
+  Metric(const char* n, const char* h, const char* l, MetricType t);
+};
+
+/**
+ * \brief Contador monótono de 32 bits.
+ */
+struct MetricCounter : Metric {
+  volatile uint32_t cell[2];
+
+  MetricCounter(const char* n, const char* h, const char* l = nullptr)
+    : Metric(n, h, l, METRIC_TYPE_COUNTER), cell{0, 0} {}
+
+  inline void inc(uint32_t delta = 1) {
+    METRIC_LOCK();
+    cell[METRIC_CORE()] += delta;
+    METRIC_UNLOCK();
+  }
+  inline uint32_t value() const { return cell[0] + cell[1]; }
+};
+
+/**
+ * \brief Valor instantáneo (float almacenado como palabra de 32 bits: escritura atómica).
+ */
+struct MetricGauge : Metric {
+  volatile uint32_t bits;
+
+  MetricGauge(const char* n, const char* h, const char* l = nullptr)
+    : Metric(n, h, l, METRIC_TYPE_GAUGE), bits(0) {}
+
+  inline void set(float v) {
+    uint32_t b;
+    memcpy(&b, &v, sizeof(b));
+    bits = b;
+  }
+  inline float value() const {
+    uint32_t b = bits;
+    float v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+  }
+};
+
+/**
+ * \brief Histograma de cubetas fijas (límites superiores inclusivos, más +Inf).
+ * \details El almacenamiento lo aporta la macro METRIC_HISTOGRAM: 2·(n+1) contadores
+ * y 2 sumas (una por núcleo).
+ */
+struct MetricHistogram : Metric {
+  const float*       bounds;
+  uint8_t            nBounds;
+  volatile uint32_t* counts;   // [núcleo][cubeta]
+  volatile float*    sums;     // [núcleo]
+
+  MetricHistogram(const char* n, const char* h, const float* b, uint8_t nb,
+                  volatile uint32_t* c, volatile float* s)
+    : Metric(n, h, nullptr, METRIC_TYPE_HISTOGRAM), bounds(b), nBounds(nb), counts(c), sums(s) {}
+
+  inline void observe(float v) {
+    uint8_t i = 0;
+    while (i < nBounds && v > bounds[i]) i++;
+    METRIC_LOCK();
+    uint32_t core = METRIC_CORE();
+    counts[core * (nBounds + 1) + i]++;
+    sums[core] += v;
+    METRIC_UNLOCK();
+  }
+};
+
+/** \brief Declara un contador estático. */
+#define METRIC_COUNTER(var, name, help)          static MetricCounter var(name, help)
+/** \brief Declara un contador estático con etiquetas fijas, p.ej. `result="ok"`. */
+#define METRIC_COUNTER_L(var, name, help, labels) static MetricCounter var(name, help, labels)
+/** \brief Declara un gauge estático. */
+#define METRIC_GAUGE(var, name, help)            static MetricGauge var(name, help)
+/** \brief Declara un gauge estático con etiquetas fijas. */
+#define METRIC_GAUGE_L(var, name, help, labels)  static MetricGauge var(name, help, labels)
+/** \brief Declara un histograma estático con los límites dados (orden creciente). */
+#define METRIC_HISTOGRAM(var, name, help, ...)                                          \
+  static const float var##_bounds[] = {__VA_ARGS__};                                    \
+  static volatile uint32_t var##_counts[2 * (sizeof(var##_bounds) / sizeof(float) + 1)]; \
+  static volatile float var##_sums[2];                                                  \
+  static MetricHistogram var(name, help, var##_bounds,                                  \
+                             (uint8_t)(sizeof(var##_bounds) / sizeof(float)),           \
+                             var##_counts, var##_sums)
+
+/**
+ * \brief Destino de la salida: recibe cada línea ya formateada (con '\\n').
+ */
+typedef void (*MetricsSink)(const char* data, size_t len, void* ctx);
+
+/**
+ * \brief Genera todas las métricas registradas en formato de texto de Prometheus.
+ * \param sink Función que envía cada línea.
+ * \param ctx  Contexto opaco para \p sink.
+ */
+void METRICS_render(MetricsSink sink, void* ctx);
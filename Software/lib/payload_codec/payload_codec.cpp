@@ -0,0 +1,90 @@
+/** @file payload_codec.cpp
+ * @brief Implementación del códec del payload binario LoRa (13 B).
+ *
+ * Serializa/deserializa `GpsInfo` como `[fix|hhmmss|lat*1e5|lon*1e5]` (LE).
+ * Sin dependencias de Arduino: se enlaza también en los tests nativos.
+ * Ambas funciones cuentan en `HOT_SLOT_CODEC`: el collar sólo construye y la
+ * base sólo decodifica, así que cada nodo mide la suya con el mismo código.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "payload_codec.h"
+#include "hot_path.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * \brief |lat| ≤ 90, |lon| ≤ 180 (falla con NaN) y hh<24, mm<60, ss≤60 (segundo intercalar).
+ */
+bool HOT_FUNC(GPS_isPlausible)(const GpsInfo& info) {
+  if (!(info.lat >= -90.0 && info.lat <= 90.0))    return false;
+  if (!(info.lon >= -180.0 && info.lon <= 180.0))  return false;
+  return (info.hhmmss / 10000UL) < 24 &&
+         ((info.hhmmss / 100UL) % 100UL) < 60 &&
+         (info.hhmmss % 100UL) <= 60;
+}
+
+/**
+ * \brief Genera el payload de 13 B: [fix|hhmmss|lat*1e5|lon*1e5] (LE).
+ */
+size_t HOT_FUNC(GPS_buildBinaryPayload)(const GpsInfo& info, uint8_t* out, size_t outSize) {
+  HOT_PROF_SCOPE(HOT_SLOT_CODEC);
+  if (!out || outSize < 13 || !info.valid || !GPS_isPlausible(info)) return 0;
+
+  out[0] = 1;  // fix válido
+
+  // HHMMSS (uint32)
+  memcpy(&out[1], &info.hhmmss, 4);
+
+  // lat/lon * 1e5 → int32 (≈1 m)
+  int32_t latFixed = (int32_t)lround(info.lat * 100000.0);
+  int32_t lonFixed = (int32_t)lround(info.lon * 100000.0);
+  memcpy(&out[5],  &latFixed, 4);
+  memcpy(&out[9],  &lonFixed, 4);
+
+  return 13;
+}
+
+/**
+ * \brief Decodifica 13 B a GpsInfo; exige fix_flag==1.
+ */
+bool HOT_FUNC(GPS_parsePayload)(const uint8_t* in, size_t len, GpsInfo& out) {
+  HOT_PROF_SCOPE(HOT_SLOT_CODEC);
+  if (!in || len != 13) return false;
+  if (in[0] != 1) return false; 
+
+  uint32_t hhmmss = 0;
+  int32_t latFixed = 0, lonFixed = 0;
+
+  memcpy(&hhmmss,   &in[1], 4);
+  memcpy(&latFixed, &in[5], 4);
+  memcpy(&lonFixed, &in[9], 4);
+
+  out.hhmmss = hhmmss;
+  out.lat    = ((double)latFixed) / 100000.0;
+  out.lon    = ((double)lonFixed) / 100000.0;
+  out.valid  = true;
+  return true;
+}
+
+/**
+ * \brief HHMMSS → segundos desde las 00:00:00 UTC.
+ */
+uint32_t GPS_hhmmssToSod(uint32_t hhmmss) {
+  return (hhmmss / 10000UL) * 3600UL + ((hhmmss / 100UL) % 100UL) * 60UL + (hhmmss % 100UL);
+}
+
+// ----------------- Plano local -----------------------
+
+void GPS_localEN(double lat0, double lon0, double lat, double lon, double& eastM, double& northM) {
+  northM = (lat - lat0) * GPS_M_PER_DEG;
+  eastM  = (lon - lon0) * GPS_M_PER_DEG * cos(lat0 * M_PI / 180.0);
+}
+
+double GPS_distanceM(double lat1, double lon1, double lat2, double lon2) {
+  double e, n;
+  GPS_localEN(lat1, lon1, lat2, lon2, e, n);
+  return sqrt(e * e + n * n);
+}
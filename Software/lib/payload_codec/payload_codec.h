@@ -0,0 +1,72 @@
+/** @file payload_codec.h
+ * @brief Estructura GpsInfo y códec del payload binario LoRa (13 B).
+ *
+ * Separado de gps_handler para no depender de Arduino ni de TinyGPS++: se compila
+ * igual en el RP2040 y en el entorno nativo de tests (`pio test -e native`).
+ *
+ * Formato (little-endian): `[fix:1][hhmmss:4][lat*1e5:4][lon*1e5:4]`.
+ *
+ * Incluye también la proyección a un plano local que usan el minimapa, la
+ * DGNSS, las reglas y el plan de actividad: a las distancias de un collar
+ * (unos km) el error frente al elipsoide es despreciable.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * \brief Estructura estandarizada para intercambiar datos GNSS.
+ *
+ * Campos mínimos para el caso de uso.
+ *  - lat, lon en grados decimales (WGS84).
+ *  - hhmmss UTC (6 dígitos empaquetados en uint32_t).
+ *  - valid indica que lat/lon y hora son válidos y recientes.
+ */
+struct GpsInfo {
+  double   lat;      ///< Latitud (grados decimales, WGS84).
+  double   lon;      ///< Longitud (grados decimales, WGS84).
+  uint32_t hhmmss;   ///< Hora UTC en formato HHMMSS (p.ej., 211507 = 21:15:07).
+  bool     valid;    ///< true si posición y hora son válidas (ver GPS_hasFix()).
+};
+
+/**
+ * \brief Comprueba que posición y hora están en rango (WGS84 y HHMMSS válidos).
+ * \details Evita convertir a entero coordenadas absurdas (NaN o fuera de rango)
+ *          que podría entregar el parser NMEA con tramas corruptas.
+ */
+bool GPS_isPlausible(const GpsInfo& info);
+
+/**
+ * \brief Construye payload binario de 13B (1B=fix, 4B=HHMMSS, 4B=lat*1e5, 4B=lon*1e5).
+ * \return Devuelve 13 si OK, 0 si no hay fix, datos fuera de rango o buffer insuficiente.
+ */
+size_t GPS_buildBinaryPayload(const GpsInfo& info, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica un payload de 13B a GpsInfo.
+ * \return  Devuelve true si OK.
+ */
+bool GPS_parsePayload(const uint8_t* in, size_t len, GpsInfo& out);
+
+/**
+ * \brief Convierte una hora HHMMSS a segundos del día (0..86399).
+ */
+uint32_t GPS_hhmmssToSod(uint32_t hhmmss);
+
+/** Metros por grado de latitud (y de longitud en el ecuador) en el plano local. */
+static const double GPS_M_PER_DEG = 111319.5;
+
+/**
+ * \brief Metros este/norte de (lat, lon) respecto a (lat0, lon0) en el plano local.
+ * \details La escala de la longitud se toma en lat0.
+ */
+void GPS_localEN(double lat0, double lon0, double lat, double lon, double& eastM, double& northM);
+
+/**
+ * \brief Distancia (m) entre dos posiciones en el plano local centrado en la primera.
+ */
+double GPS_distanceM(double lat1, double lon1, double lat2, double lon2);
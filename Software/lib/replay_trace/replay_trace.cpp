@@ -0,0 +1,137 @@
+/** @file replay_trace.cpp
+ * @brief Implementación del formato y del ritmo de las trazas grabadas.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "replay_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// ----------------- Estado interno -----------------------
+static uint32_t s_passStartMs = 0;
+static uint32_t s_t0          = 0;       // instante grabado del primer registro de la pasada
+static bool     s_hasT0       = false;
+static RplStats s_stats{};
+
+// ----------------- Utilidades -----------------------
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * \brief Lee un float delimitado por espacios en [p, end).
+ */
+static bool parseFloat(const char*& p, const char* end, float& out) {
+  while (p < end && isBlank(*p)) p++;
+  char tmp[24];
+  size_t n = 0;
+  while (p < end && !isBlank(*p) && n < sizeof(tmp) - 1) tmp[n++] = *p++;
+  if (n == 0 || (p < end && !isBlank(*p))) return false;
+  tmp[n] = '\0';
+  char* stop;
+  out = strtof(tmp, &stop);
+  return *stop == '\0';
+}
+
+// ----------------- Formato -----------------------
+bool RPL_parseLine(const char* line, size_t len, RplRecord& out) {
+  const char* p   = line;
+  const char* end = line + len;
+  while (p < end && isBlank(*p)) p++;
+  if (p == end || *p < '0' || *p > '9') return false;   // vacía, comentario o sin instante
+
+  uint32_t t = 0;
+  while (p < end && *p >= '0' && *p <= '9') t = t * 10 + (uint32_t)(*p++ - '0');
+  if (p == end || !isBlank(*p)) return false;
+  while (p < end && isBlank(*p)) p++;
+  while (end > p && isBlank(end[-1])) end--;
+  if (p == end) return false;
+  out.tMs  = t;
+  out.text = p;
+  out.len  = (size_t)(end - p);
+  return true;
+}
+
+bool RPL_parseFrame(const char* text, size_t len, RplFrame& out) {
+  const char* p   = text;
+  const char* end = text + len;
+  if (!parseFloat(p, end, out.rssi) || !parseFloat(p, end, out.snr) ||
+      !parseFloat(p, end, out.freqErrHz))
+    return false;
+  while (p < end && isBlank(*p)) p++;
+  while (end > p && isBlank(end[-1])) end--;
+  size_t digits = (size_t)(end - p);
+  if (digits == 0 || digits % 2 || digits / 2 > RPL_MAX_FRAME) return false;
+  for (size_t i = 0; i < digits / 2; i++) {
+    int hi = hexValue(p[2 * i]), lo = hexValue(p[2 * i + 1]);
+    if (hi < 0 || lo < 0) return false;
+    out.data[i] = (uint8_t)(hi << 4 | lo);
+  }
+  out.len = digits / 2;
+  return true;
+}
+
+size_t RPL_formatFrame(uint32_t tMs, const RplFrame& frame, char* out, size_t outSize) {
+  int n = snprintf(out, outSize, "%lu %.1f %.2f %.0f ", (unsigned long)tMs,
+                   (double)frame.rssi, (double)frame.snr, (double)frame.freqErrHz);
+  if (n < 0 || (size_t)n + 2 * frame.len >= outSize) return 0;
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  for (size_t i = 0; i < frame.len; i++) {
+    out[n++] = HEX_DIGITS[frame.data[i] >> 4];
+    out[n++] = HEX_DIGITS[frame.data[i] & 0x0F];
+  }
+  out[n] = '\0';
+  return (size_t)n;
+}
+
+// ----------------- Ritmo -----------------------
+void RPL_begin(uint32_t nowMs) {
+  s_stats       = RplStats{};
+  s_passStartMs = nowMs;
+  s_hasT0       = false;
+}
+
+bool RPL_due(uint32_t tMs, uint32_t nowMs) {
+  return RPL_msUntil(tMs, nowMs) == 0;
+}
+
+uint32_t RPL_msUntil(uint32_t tMs, uint32_t nowMs) {
+  if (!s_hasT0) {
+    s_t0    = tMs;
+    s_hasT0 = true;
+  }
+  // Con signo: un instante anterior al primero (traza desordenada) sale ya
+  int32_t early = (int32_t)((tMs - s_t0) - (nowMs - s_passStartMs));
+  return early > 0 ? (uint32_t)early : 0;
+}
+
+void RPL_delivered(uint32_t tMs, uint32_t nowMs) {
+  int32_t late = (int32_t)((nowMs - s_passStartMs) - (tMs - s_t0));
+  if (late < 0) late = 0;
+  s_stats.records++;
+  s_stats.lateSumMs += (uint32_t)late;
+  if ((uint32_t)late > s_stats.lateMaxMs) s_stats.lateMaxMs = (uint32_t)late;
+}
+
+RplStats RPL_rewind(uint32_t nowMs) {
+  RplStats done = s_stats;
+  done.passes++;
+  s_stats         = RplStats{};
+  s_stats.passes  = done.passes;
+  s_passStartMs   = nowMs;
+  s_hasT0         = false;
+  return done;
+}
+
+const RplStats& RPL_stats() {
+  return s_stats;
+}
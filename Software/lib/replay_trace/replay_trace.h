@@ -0,0 +1,112 @@
+/** @file replay_trace.h
+ * @brief Trazas grabadas para reproducir en la placa (modo `-DREPLAY_MODE`).
+ *
+ * Las medidas en las placas (CPU, latencia, energía) dependen del cielo y de
+ * la radio, así que no sirven para comparar versiones del firmware. En modo
+ * reproducción el collar alimenta GPS_update() con NMEA grabado y la base
+ * inyecta tramas grabadas en la ruta de recepción, ambos respetando los
+ * tiempos de la grabación: cada pasada de la traza es la misma carga.
+ *
+ * Formato (texto, una línea por registro; `#` empieza un comentario):
+ *
+ *     <ms desde el inicio> <contenido>
+ *
+ * - Collar (`/replay.nmea`): el contenido es una sentencia NMEA.
+ * - Base (`/replay_rx.txt`): `<rssi> <snr> <error_hz> <hex>`, la trama tal
+ *   como salió de la radio con sus metadatos.
+ * Con `-DREPLAY_RECORD` cada nodo escribe por Serial sus registros con este
+ * formato, precedidos de `RPL `, para grabar trazas nuevas.
+ *
+ * El primer registro de cada pasada marca el instante cero; al acabar la
+ * traza se vuelve a empezar. El retraso de cada registro frente a su tiempo
+ * grabado se acumula por pasada: si crece, el firmware no da abasto.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const size_t RPL_MAX_LINE  = 192;   ///< Con el '\\0' (NMEA: 82; trama de 64 B: ~150).
+static const size_t RPL_MAX_FRAME = 64;
+
+/**
+ * \brief Registro de una línea de la traza (\p text apunta dentro de la línea).
+ */
+struct RplRecord {
+  uint32_t    tMs;
+  const char* text;
+  size_t      len;
+};
+
+/**
+ * \brief Trama grabada con sus metadatos de radio.
+ */
+struct RplFrame {
+  float   rssi;        ///< dBm.
+  float   snr;         ///< dB.
+  float   freqErrHz;
+  uint8_t data[RPL_MAX_FRAME];
+  size_t  len;
+};
+
+/**
+ * \brief Retrasos de la pasada en curso.
+ */
+struct RplStats {
+  uint32_t passes;      ///< Pasadas completas.
+  uint32_t records;     ///< Registros entregados en la pasada en curso.
+  uint32_t lateMaxMs;
+  uint64_t lateSumMs;
+};
+
+/**
+ * \brief Separa el instante y el contenido de una línea (sin el '\\n').
+ * \return false en líneas vacías, comentarios o sin instante.
+ */
+bool RPL_parseLine(const char* line, size_t len, RplRecord& out);
+
+/**
+ * \brief Lee `<rssi> <snr> <error_hz> <hex>`.
+ * \return false si falta algún campo o el hex es impar, no válido o mayor que RPL_MAX_FRAME.
+ */
+bool RPL_parseFrame(const char* text, size_t len, RplFrame& out);
+
+/**
+ * \brief Escribe la línea de una trama (sin '\\n'), para grabar.
+ * \return Caracteres escritos o 0 si no cabe.
+ */
+size_t RPL_formatFrame(uint32_t tMs, const RplFrame& frame, char* out, size_t outSize);
+
+/**
+ * \brief Empieza la primera pasada y pone a cero las estadísticas.
+ */
+void RPL_begin(uint32_t nowMs);
+
+/**
+ * \brief true si ha llegado el momento del registro grabado en \p tMs.
+ */
+bool RPL_due(uint32_t tMs, uint32_t nowMs);
+
+/**
+ * \brief Milisegundos que faltan para el registro \p tMs (0 si ya toca).
+ * \details Para armar una alarma que saque a loop() del WFI a su hora.
+ */
+uint32_t RPL_msUntil(uint32_t tMs, uint32_t nowMs);
+
+/**
+ * \brief Anota la entrega del registro \p tMs (retraso frente a la grabación).
+ */
+void RPL_delivered(uint32_t tMs, uint32_t nowMs);
+
+/**
+ * \brief Cierra la pasada en curso y empieza otra en \p nowMs.
+ * \return Estadísticas de la pasada cerrada.
+ */
+RplStats RPL_rewind(uint32_t nowMs);
+
+const RplStats& RPL_stats();
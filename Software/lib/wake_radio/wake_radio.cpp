@@ -0,0 +1,123 @@
+/** @file wake_radio.cpp
+ * @brief Implementación de las tramas de comando y del cálculo de coste de la escucha.
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#include "wake_radio.h"
+#include <math.h>
+#include <string.h>
+
+// ----------------- Modulación del enlace (ver LORA_begin) -----------------
+static const uint8_t  WOR_SF       = 9;
+static const uint8_t  WOR_CR       = 3;        // 4/7 → CR=3 en la fórmula de Semtech
+static const float    WOR_BW_KHZ   = 125.0f;
+static const uint32_t WOR_TSYM_US  = 4096;     // 2^SF / BW
+static const uint16_t WOR_PRE_MARGIN = 4;      // símbolos extra sobre un ciclo completo
+
+// ----------------- Consumo SX1262 (hoja de datos, valores típicos) ---------
+static const float    WOR_I_RX_UA       = 4600.0f;  // RX LoRa 125 kHz con DC-DC
+static const float    WOR_I_SLEEP_UA    = 1.2f;     // sleep, arranque en caliente + RTC
+static const uint32_t WOR_WAKE_OVERHEAD = 500;      // µs por ciclo (arranque + calibración)
+
+/**
+ * Ajustes de escucha: ventana de 8 símbolos y 250 ms … 2 s dormido.
+ */
+static const WorSniffPreset WOR_PRESETS[] = {
+  {8 * WOR_TSYM_US,  250000},
+  {8 * WOR_TSYM_US,  500000},
+  {8 * WOR_TSYM_US, 1000000},
+  {8 * WOR_TSYM_US, 2000000},
+};
+static const uint8_t WOR_N_PRESETS = sizeof(WOR_PRESETS) / sizeof(WOR_PRESETS[0]);
+
+/**
+ * \brief Tamaño de la tabla de ajustes.
+ */
+uint8_t WOR_presetCount() {
+  return WOR_N_PRESETS;
+}
+
+/**
+ * \brief Ajuste por índice (recortado al último).
+ */
+const WorSniffPreset& WOR_preset(uint8_t index) {
+  return WOR_PRESETS[index < WOR_N_PRESETS ? index : WOR_N_PRESETS - 1];
+}
+
+/**
+ * \brief `[0xC1][cmd][seq][param LE]`.
+ */
+size_t WOR_buildCommand(const WorCommand& cmd, uint8_t* out, size_t outSize) {
+  if (!out || outSize < WOR_FRAME_LEN) return 0;
+  out[0] = WOR_FRAME_TYPE;
+  out[1] = (uint8_t)cmd.cmd;
+  out[2] = cmd.seq;
+  memcpy(&out[3], &cmd.param, 2);
+  return WOR_FRAME_LEN;
+}
+
+/**
+ * \brief Exige tipo 0xC1, 5 B y un código de comando conocido.
+ */
+bool WOR_parseCommand(const uint8_t* in, size_t len, WorCommand& out) {
+  if (!in || len != WOR_FRAME_LEN || in[0] != WOR_FRAME_TYPE) return false;
+  if (in[1] < WOR_CMD_PING || in[1] > WOR_CMD_SET_UL_BW) return false;
+  out.cmd = (WorCmd)in[1];
+  out.seq = in[2];
+  memcpy(&out.param, &in[3], 2);
+  return true;
+}
+
+/**
+ * \brief El preámbulo debe cubrir un ciclo completo (dormido + ventana) más un margen.
+ */
+uint16_t WOR_preambleSymbols(uint8_t index) {
+  const WorSniffPreset& p = WOR_preset(index);
+  uint32_t cycleUs = p.sleepUs + p.rxUs + WOR_WAKE_OVERHEAD;
+  return (uint16_t)((cycleUs + WOR_TSYM_US - 1) / WOR_TSYM_US + WOR_PRE_MARGIN);
+}
+
+/**
+ * \brief Fórmula de Semtech (AN1200.13) sin optimización de baja tasa (Tsym < 16 ms
+ *        en los dos modos del enlace).
+ */
+static float airtimeMs(size_t payloadLen, uint16_t preambleSymbols, uint8_t sf, float bwKHz) {
+  const float tSymMs = (float)(1UL << sf) / bwKHz;
+  const float tPre   = (preambleSymbols + 4.25f) * tSymMs;
+  const int   num    = 8 * (int)payloadLen - 4 * sf + 28 + 16;   // CRC on, cabecera explícita
+  int nPayload = 8;
+  if (num > 0) nPayload += (int)ceilf((float)num / (4.0f * sf)) * (WOR_CR + 4);
+  return tPre + nPayload * tSymMs;
+}
+
+float WOR_airtimeMs(size_t payloadLen, uint16_t preambleSymbols) {
+  return airtimeMs(payloadLen, preambleSymbols, WOR_SF, WOR_BW_KHZ);
+}
+
+uint8_t WOR_uplinkSF(float bwKHz) {
+  return bwKHz < WOR_BW_KHZ ? WOR_NARROW_SF : WOR_SF;
+}
+
+float WOR_uplinkAirtimeMs(size_t payloadLen, uint16_t preambleSymbols, float bwKHz) {
+  return airtimeMs(payloadLen, preambleSymbols, WOR_uplinkSF(bwKHz), bwKHz);
+}
+
+/**
+ * \brief Media ponderada RX/sleep por ciclo, menos el consumo de la radio dormida.
+ */
+float WOR_addedCurrentUa(uint8_t index) {
+  const WorSniffPreset& p = WOR_preset(index);
+  float onUs  = (float)(p.rxUs + WOR_WAKE_OVERHEAD);
+  float cycle = onUs + (float)p.sleepUs;
+  float avg   = (WOR_I_RX_UA * onUs + WOR_I_SLEEP_UA * (float)p.sleepUs) / cycle;
+  return avg - WOR_I_SLEEP_UA;
+}
+
+/**
+ * \brief El collar sólo recibe la trama al final del preámbulo largo.
+ */
+float WOR_commandLatencyMs(uint8_t index) {
+  return WOR_airtimeMs(WOR_FRAME_LEN, WOR_preambleSymbols(index));
+}
@@ -0,0 +1,126 @@
+/** @file wake_radio.h
+ * @brief Wake-on-radio: tramas de comando base → collar y ajustes de escucha (sniff).
+ *
+ * Entre envíos el collar deja el SX1262 en modo RX duty-cycle: duerme
+ * `sleepUs`, escucha `rxUs` y repite. Para despertarlo, la base transmite el
+ * comando con un preámbulo que cubre un ciclo completo, de modo que alguna
+ * ventana de escucha cae siempre dentro del preámbulo.
+ *
+ * Trama de comando (5 B, little-endian): `[0xC1][cmd:1][seq:1][param:2]`.
+ *
+ * Sin dependencias de Arduino (se prueba en el entorno nativo). Ambos nodos
+ * deben compilar la misma tabla de ajustes.
+ *
+ * @note Las corrientes son valores típicos de la hoja de datos del SX1262
+ *       (RX con DC-DC 4,6 mA; sleep con arranque en caliente y RTC 1,2 µA).
+ *
+ * @author Verónica Lechón Rodríguez
+ * @date 18/10/2026
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t WOR_FRAME_TYPE = 0xC1;
+static const size_t  WOR_FRAME_LEN  = 5;
+
+/** Ajuste de escucha por defecto (índice en la tabla; `-DWOR_SNIFF_PRESET=n`). */
+#ifndef WOR_SNIFF_PRESET
+  #define WOR_SNIFF_PRESET 2
+#endif
+
+/**
+ * \brief Comandos que la base puede enviar al collar.
+ */
+enum WorCmd : uint8_t {
+  WOR_CMD_PING       = 1,  ///< Enviar la posición en el próximo fix (param ignorado).
+  WOR_CMD_SET_PERIOD = 2,  ///< Nuevo periodo de envío en segundos (param).
+  WOR_CMD_SET_SNIFF  = 3,  ///< Nuevo ajuste de escucha (param = índice).
+  WOR_CMD_FREQ_CORR  = 4,  ///< Desplazar la frecuencia del collar (param = Hz con signo, int16).
+  WOR_CMD_SET_UL_BW  = 5   ///< Ancho de banda de las subidas (param 0 = 125 kHz, 1 = WOR_NARROW_BW_KHZ).
+};
+
+/**
+ * \brief Ancho de banda estrecho de las subidas (kHz). Las bajadas y la escucha
+ *        siguen a 125 kHz, de modo que la base siempre puede ordenar volver.
+ */
+static const float WOR_NARROW_BW_KHZ = 62.5f;
+/**
+ * \brief SF de las subidas estrechas. Con SF9 el aire se duplica (y con él el
+ *        periodo mínimo por duty-cycle); con SF8 el símbolo dura lo mismo que
+ *        a SF9/125 kHz: el mismo aire (+0 %) a cambio de quedarse en +0,5 dB
+ *        de sensibilidad en lugar de +3 dB. Lo que se gana es sobre todo
+ *        rechazo de interferencias fuera del canal estrecho.
+ */
+static const uint8_t WOR_NARROW_SF = 8;
+
+/**
+ * \brief Comando decodificado.
+ */
+struct WorCommand {
+  WorCmd   cmd;
+  uint8_t  seq;     ///< Número de secuencia (descarta repeticiones).
+  uint16_t param;
+};
+
+/**
+ * \brief Ajuste de escucha del SX1262 (RX duty-cycle).
+ */
+struct WorSniffPreset {
+  uint32_t rxUs;     ///< Ventana de escucha (µs).
+  uint32_t sleepUs;  ///< Tiempo dormido entre ventanas (µs).
+};
+
+/**
+ * \brief Número de ajustes disponibles.
+ */
+uint8_t WOR_presetCount();
+
+/**
+ * \brief Ajuste \p index (se recorta al último si está fuera de rango).
+ */
+const WorSniffPreset& WOR_preset(uint8_t index);
+
+/**
+ * \brief Serializa un comando.
+ * \return WOR_FRAME_LEN si OK, 0 si el buffer no es suficiente.
+ */
+size_t WOR_buildCommand(const WorCommand& cmd, uint8_t* out, size_t outSize);
+
+/**
+ * \brief Decodifica una trama de comando.
+ * \return true si el tipo, la longitud y el código de comando son válidos.
+ */
+bool WOR_parseCommand(const uint8_t* in, size_t len, WorCommand& out);
+
+/**
+ * \brief Símbolos de preámbulo necesarios para despertar a un collar con el ajuste \p index.
+ */
+uint16_t WOR_preambleSymbols(uint8_t index);
+
+/**
+ * \brief Tiempo en el aire (ms) de una trama con la modulación del enlace
+ *        (SF9, BW 125 kHz, CR 4/7, cabecera explícita, CRC).
+ */
+float WOR_airtimeMs(size_t payloadLen, uint16_t preambleSymbols);
+
+/**
+ * \brief SF de las subidas con \p bwKHz: WOR_NARROW_SF en estrecho, 9 a 125 kHz.
+ */
+uint8_t WOR_uplinkSF(float bwKHz);
+
+/**
+ * \brief Tiempo en el aire (ms) de una subida con \p bwKHz y su SF (WOR_uplinkSF()).
+ */
+float WOR_uplinkAirtimeMs(size_t payloadLen, uint16_t preambleSymbols, float bwKHz);
+
+/**
+ * \brief Corriente media que añade la escucha respecto a la radio dormida (µA).
+ */
+float WOR_addedCurrentUa(uint8_t index);
+
+/**
+ * \brief Latencia de un comando (ms): aire de la trama con el preámbulo largo.
+ */
+float WOR_commandLatencyMs(uint8_t index);